@@ -31,7 +31,10 @@
 CERES_SRCS = ["internal/ceres/" + filename for filename in [
     "accelerate_sparse.cc",
     "array_utils.cc",
+    "batched_psd_matrix_inverter.cc",
+    "block_arena.cc",
     "block_evaluate_preparer.cc",
+    "block_incomplete_cholesky.cc",
     "block_jacobi_preconditioner.cc",
     "block_jacobian_writer.cc",
     "block_random_access_dense_matrix.cc",
@@ -45,9 +48,11 @@ CERES_SRCS = ["internal/ceres/" + filename for filename in [
     "canonical_views_clustering.cc",
     "cgnr_solver.cc",
     "compressed_col_sparse_matrix_utils.cc",
+    "compressed_graph.cc",
     "compressed_row_jacobian_writer.cc",
     "compressed_row_sparse_matrix.cc",
     "conditioned_cost_function.cc",
+    "conjugate_gradients_solver.cc",
     "context.cc",
     "context_impl.cc",
     "coordinate_descent_minimizer.cc",
@@ -55,6 +60,7 @@ CERES_SRCS = ["internal/ceres/" + filename for filename in [
     "cost_function.cc",
     "covariance.cc",
     "covariance_impl.cc",
+    "deflated_conjugate_gradients_solver.cc",
     "dense_cholesky.cc",
     "dense_normal_cholesky_solver.cc",
     "dense_qr.cc",
@@ -76,7 +82,10 @@ CERES_SRCS = ["internal/ceres/" + filename for filename in [
     "gradient_checking_cost_function.cc",
     "gradient_problem.cc",
     "gradient_problem_solver.cc",
+    "graph_algorithms.cc",
     "implicit_schur_complement.cc",
+    "incomplete_cholesky_preconditioner.cc",
+    "independent_components.cc",
     "inner_product_computer.cc",
     "is_close.cc",
     "iteration_callback.cc",
@@ -93,6 +102,7 @@ CERES_SRCS = ["internal/ceres/" + filename for filename in [
     "loss_function.cc",
     "low_rank_inverse_hessian.cc",
     "manifold.cc",
+    "marginalization.cc",
     "minimizer.cc",
     "normal_prior.cc",
     "parallel_invoke.cc",
@@ -103,6 +113,7 @@ CERES_SRCS = ["internal/ceres/" + filename for filename in [
     "polynomial.cc",
     "power_series_expansion_preconditioner.cc",
     "preconditioner.cc",
+    "preconditioner_refresh_policy.cc",
     "preprocessor.cc",
     "problem.cc",
     "problem_impl.cc",
@@ -214,6 +225,8 @@ def ceres_library(
         visibility = ["//visibility:public"],
         deps = [
             "@eigen//:eigen",
+            "@abseil-cpp//absl/container:flat_hash_map",
+            "@abseil-cpp//absl/container:flat_hash_set",
             "@abseil-cpp//absl/log",
             "@abseil-cpp//absl/log:check",
         ],
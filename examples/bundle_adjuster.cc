@@ -92,7 +92,7 @@ ABSL_FLAG(bool, explicit_schur_complement, false, "If using ITERATIVE_SCHUR "
             "then explicitly compute the Schur complement.");
 ABSL_FLAG(std::string, preconditioner, "jacobi", "Options are: "
               "identity, jacobi, schur_jacobi, schur_power_series_expansion, cluster_jacobi, "
-              "cluster_tridiagonal.");
+              "cluster_tridiagonal, incomplete_cholesky.");
 ABSL_FLAG(std::string, visibility_clustering, "canonical_views",
               "single_linkage, canonical_views");
 ABSL_FLAG(bool, use_spse_initialization, false,
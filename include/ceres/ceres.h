@@ -59,12 +59,14 @@
 #include "ceres/line_manifold.h"
 #include "ceres/loss_function.h"
 #include "ceres/manifold.h"
+#include "ceres/marginalization.h"
 #include "ceres/numeric_diff_cost_function.h"
 #include "ceres/numeric_diff_first_order_function.h"
 #include "ceres/numeric_diff_options.h"
 #include "ceres/ordered_groups.h"
 #include "ceres/problem.h"
 #include "ceres/product_manifold.h"
+#include "ceres/reverse_autodiff_cost_function.h"
 #include "ceres/sized_cost_function.h"
 #include "ceres/solver.h"
 #include "ceres/sphere_manifold.h"
@@ -0,0 +1,481 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+//
+// Reverse mode automatic differentiation.
+//
+// ReverseScalar is a scalar type which, in addition to its value, records
+// every elementary operation applied to it on a Tape. Each node of the tape
+// stores the local partial derivatives of one operation with respect to its
+// (at most two) operands. Once a function has been evaluated, the gradient
+// of any of its outputs with respect to all of its inputs is computed by a
+// single backward sweep over the tape.
+//
+// This is used by ReverseAutoDiffCostFunction. For a cost function with n
+// parameters and m residuals, forward mode automatic differentiation using
+// Jets costs O(n) evaluations of the functor, whereas reverse mode costs a
+// single evaluation and m backward sweeps over the tape. It is therefore
+// the better choice for functors with many parameters and few residuals.
+//
+// Constants, i.e., ReverseScalars constructed from a double, are not
+// recorded on the tape, and neither are operations whose operands are all
+// constants.
+
+#ifndef CERES_PUBLIC_INTERNAL_REVERSE_AUTODIFF_H_
+#define CERES_PUBLIC_INTERNAL_REVERSE_AUTODIFF_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/log/check.h"
+
+namespace ceres::internal {
+
+class Tape {
+ public:
+  // An elementary operation. parents are the indices of the nodes of the
+  // operands, or -1 for constant operands or unused slots, and partials are
+  // the derivatives of the result with respect to them.
+  struct Node {
+    double partials[2];
+    int parents[2];
+  };
+
+  // Adds an independent variable to the tape and returns its index. All
+  // the independent variables must be added before any other operation.
+  int AddVariable() {
+    DCHECK_EQ(nodes_.size(), num_variables_);
+    nodes_.push_back({{0.0, 0.0}, {-1, -1}});
+    return num_variables_++;
+  }
+
+  int AddNode(int parent0, double partial0, int parent1, double partial1) {
+    nodes_.push_back({{partial0, partial1}, {parent0, parent1}});
+    return static_cast<int>(nodes_.size()) - 1;
+  }
+
+  int num_variables() const { return num_variables_; }
+  int size() const { return static_cast<int>(nodes_.size()); }
+
+  // Computes the derivatives of the node output with respect to the
+  // independent variables. On return, adjoints()[i] is the derivative with
+  // respect to the i-th independent variable.
+  void Backpropagate(int output) {
+    DCHECK_GE(output, 0);
+    DCHECK_LT(output, size());
+    adjoints_.resize(nodes_.size());
+    std::fill_n(adjoints_.begin(), std::max(output + 1, num_variables_), 0.0);
+    adjoints_[output] = 1.0;
+    for (int i = output; i >= num_variables_; --i) {
+      const double adjoint = adjoints_[i];
+      if (adjoint == 0.0) {
+        continue;
+      }
+      const Node& node = nodes_[i];
+      if (node.parents[0] >= 0) {
+        adjoints_[node.parents[0]] += adjoint * node.partials[0];
+      }
+      if (node.parents[1] >= 0) {
+        adjoints_[node.parents[1]] += adjoint * node.partials[1];
+      }
+    }
+  }
+
+  const double* adjoints() const { return adjoints_.data(); }
+
+  // Removes all the nodes, keeping the allocated memory for reuse.
+  void Clear() {
+    nodes_.clear();
+    num_variables_ = 0;
+  }
+
+  bool in_use() const { return in_use_; }
+  void set_in_use(bool in_use) { in_use_ = in_use; }
+
+ private:
+  std::vector<Node> nodes_;
+  std::vector<double> adjoints_;
+  int num_variables_ = 0;
+  bool in_use_ = false;
+};
+
+// Returns a tape for the calling thread, reusing its memory across
+// evaluations. If the thread's tape is already in use, e.g., by a cost
+// function evaluated from inside another one, returns the fallback tape.
+inline Tape& ThreadLocalTapeOr(Tape& fallback) {
+  thread_local Tape tape;
+  return tape.in_use() ? fallback : tape;
+}
+
+class ReverseScalar {
+ public:
+  ReverseScalar() = default;
+  // Constants are not recorded on the tape.
+  explicit ReverseScalar(double value) : value_(value) {}
+  // Adds a new independent variable to the tape.
+  ReverseScalar(double value, Tape* tape)
+      : value_(value), tape_(tape), index_(tape->AddVariable()) {}
+
+  double value() const { return value_; }
+  Tape* tape() const { return tape_; }
+  int index() const { return index_; }
+  bool is_constant() const { return tape_ == nullptr; }
+
+  // Records the result of an operation with one operand.
+  static ReverseScalar Unary(const ReverseScalar& x,
+                             double value,
+                             double dx) {
+    if (x.is_constant()) {
+      return ReverseScalar(value);
+    }
+    return ReverseScalar(value, x.tape_, x.tape_->AddNode(x.index_, dx, -1, 0));
+  }
+
+  // Records the result of an operation with two operands.
+  static ReverseScalar Binary(const ReverseScalar& x,
+                              double dx,
+                              const ReverseScalar& y,
+                              double dy,
+                              double value) {
+    if (x.is_constant()) {
+      return Unary(y, value, dy);
+    }
+    if (y.is_constant()) {
+      return Unary(x, value, dx);
+    }
+    DCHECK_EQ(x.tape_, y.tape_);
+    return ReverseScalar(
+        value, x.tape_, x.tape_->AddNode(x.index_, dx, y.index_, dy));
+  }
+
+  ReverseScalar& operator+=(const ReverseScalar& y);
+  ReverseScalar& operator-=(const ReverseScalar& y);
+  ReverseScalar& operator*=(const ReverseScalar& y);
+  ReverseScalar& operator/=(const ReverseScalar& y);
+  ReverseScalar& operator+=(double s) { return *this = *this + s; }
+  ReverseScalar& operator-=(double s) { return *this = *this - s; }
+  ReverseScalar& operator*=(double s) { return *this = *this * s; }
+  ReverseScalar& operator/=(double s) { return *this = *this / s; }
+
+  friend ReverseScalar operator+(const ReverseScalar& x) { return x; }
+  friend ReverseScalar operator-(const ReverseScalar& x) {
+    return Unary(x, -x.value_, -1.0);
+  }
+
+  friend ReverseScalar operator+(const ReverseScalar& x,
+                                 const ReverseScalar& y) {
+    return Binary(x, 1.0, y, 1.0, x.value_ + y.value_);
+  }
+  friend ReverseScalar operator-(const ReverseScalar& x,
+                                 const ReverseScalar& y) {
+    return Binary(x, 1.0, y, -1.0, x.value_ - y.value_);
+  }
+  friend ReverseScalar operator*(const ReverseScalar& x,
+                                 const ReverseScalar& y) {
+    return Binary(x, y.value_, y, x.value_, x.value_ * y.value_);
+  }
+  friend ReverseScalar operator/(const ReverseScalar& x,
+                                 const ReverseScalar& y) {
+    const double inverse_y = 1.0 / y.value_;
+    const double value = x.value_ * inverse_y;
+    return Binary(x, inverse_y, y, -value * inverse_y, value);
+  }
+
+  friend ReverseScalar operator+(const ReverseScalar& x, double s) {
+    return Unary(x, x.value_ + s, 1.0);
+  }
+  friend ReverseScalar operator+(double s, const ReverseScalar& x) {
+    return Unary(x, s + x.value_, 1.0);
+  }
+  friend ReverseScalar operator-(const ReverseScalar& x, double s) {
+    return Unary(x, x.value_ - s, 1.0);
+  }
+  friend ReverseScalar operator-(double s, const ReverseScalar& x) {
+    return Unary(x, s - x.value_, -1.0);
+  }
+  friend ReverseScalar operator*(const ReverseScalar& x, double s) {
+    return Unary(x, x.value_ * s, s);
+  }
+  friend ReverseScalar operator*(double s, const ReverseScalar& x) {
+    return Unary(x, s * x.value_, s);
+  }
+  friend ReverseScalar operator/(const ReverseScalar& x, double s) {
+    const double inverse_s = 1.0 / s;
+    return Unary(x, x.value_ * inverse_s, inverse_s);
+  }
+  friend ReverseScalar operator/(double s, const ReverseScalar& x) {
+    const double inverse_x = 1.0 / x.value_;
+    const double value = s * inverse_x;
+    return Unary(x, value, -value * inverse_x);
+  }
+
+ private:
+  ReverseScalar(double value, Tape* tape, int index)
+      : value_(value), tape_(tape), index_(index) {}
+
+  double value_ = 0.0;
+  Tape* tape_ = nullptr;
+  int index_ = -1;
+};
+
+inline ReverseScalar& ReverseScalar::operator+=(const ReverseScalar& y) {
+  return *this = *this + y;
+}
+inline ReverseScalar& ReverseScalar::operator-=(const ReverseScalar& y) {
+  return *this = *this - y;
+}
+inline ReverseScalar& ReverseScalar::operator*=(const ReverseScalar& y) {
+  return *this = *this * y;
+}
+inline ReverseScalar& ReverseScalar::operator/=(const ReverseScalar& y) {
+  return *this = *this / y;
+}
+
+// Comparisons only look at the values.
+#define CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR(op)                   \
+  inline bool operator op(const ReverseScalar& x, const ReverseScalar& y) { \
+    return x.value() op y.value();                                          \
+  }                                                                         \
+  inline bool operator op(const ReverseScalar& x, double s) {               \
+    return x.value() op s;                                                  \
+  }                                                                         \
+  inline bool operator op(double s, const ReverseScalar& x) {               \
+    return s op x.value();                                                  \
+  }
+CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR(<)  // NOLINT
+CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR(<=)  // NOLINT
+CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR(>)  // NOLINT
+CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR(>=)  // NOLINT
+CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR(==)  // NOLINT
+CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR(!=)  // NOLINT
+#undef CERES_DEFINE_REVERSE_SCALAR_COMPARISON_OPERATOR
+
+// Mathematical functions, found by argument dependent lookup in the same
+// way as the ones for Jets.
+
+inline ReverseScalar abs(const ReverseScalar& x) {
+  return ReverseScalar::Unary(
+      x, std::abs(x.value()), std::copysign(1.0, x.value()));
+}
+inline ReverseScalar fabs(const ReverseScalar& x) { return abs(x); }
+
+inline ReverseScalar sqrt(const ReverseScalar& x) {
+  const double value = std::sqrt(x.value());
+  return ReverseScalar::Unary(x, value, 0.5 / value);
+}
+
+inline ReverseScalar cbrt(const ReverseScalar& x) {
+  const double value = std::cbrt(x.value());
+  return ReverseScalar::Unary(x, value, 1.0 / (3.0 * value * value));
+}
+
+inline ReverseScalar exp(const ReverseScalar& x) {
+  const double value = std::exp(x.value());
+  return ReverseScalar::Unary(x, value, value);
+}
+
+inline ReverseScalar expm1(const ReverseScalar& x) {
+  const double value = std::expm1(x.value());
+  return ReverseScalar::Unary(x, value, value + 1.0);
+}
+
+inline ReverseScalar log(const ReverseScalar& x) {
+  return ReverseScalar::Unary(x, std::log(x.value()), 1.0 / x.value());
+}
+
+inline ReverseScalar log1p(const ReverseScalar& x) {
+  return ReverseScalar::Unary(
+      x, std::log1p(x.value()), 1.0 / (1.0 + x.value()));
+}
+
+inline ReverseScalar log10(const ReverseScalar& x) {
+  return ReverseScalar::Unary(
+      x, std::log10(x.value()), 1.0 / (x.value() * std::log(10.0)));
+}
+
+inline ReverseScalar log2(const ReverseScalar& x) {
+  return ReverseScalar::Unary(
+      x, std::log2(x.value()), 1.0 / (x.value() * std::log(2.0)));
+}
+
+inline ReverseScalar sin(const ReverseScalar& x) {
+  return ReverseScalar::Unary(x, std::sin(x.value()), std::cos(x.value()));
+}
+
+inline ReverseScalar cos(const ReverseScalar& x) {
+  return ReverseScalar::Unary(x, std::cos(x.value()), -std::sin(x.value()));
+}
+
+inline ReverseScalar tan(const ReverseScalar& x) {
+  const double value = std::tan(x.value());
+  return ReverseScalar::Unary(x, value, 1.0 + value * value);
+}
+
+inline ReverseScalar asin(const ReverseScalar& x) {
+  return ReverseScalar::Unary(x,
+                              std::asin(x.value()),
+                              1.0 / std::sqrt(1.0 - x.value() * x.value()));
+}
+
+inline ReverseScalar acos(const ReverseScalar& x) {
+  return ReverseScalar::Unary(x,
+                              std::acos(x.value()),
+                              -1.0 / std::sqrt(1.0 - x.value() * x.value()));
+}
+
+inline ReverseScalar atan(const ReverseScalar& x) {
+  return ReverseScalar::Unary(
+      x, std::atan(x.value()), 1.0 / (1.0 + x.value() * x.value()));
+}
+
+inline ReverseScalar sinh(const ReverseScalar& x) {
+  return ReverseScalar::Unary(x, std::sinh(x.value()), std::cosh(x.value()));
+}
+
+inline ReverseScalar cosh(const ReverseScalar& x) {
+  return ReverseScalar::Unary(x, std::cosh(x.value()), std::sinh(x.value()));
+}
+
+inline ReverseScalar tanh(const ReverseScalar& x) {
+  const double value = std::tanh(x.value());
+  return ReverseScalar::Unary(x, value, 1.0 - value * value);
+}
+
+inline ReverseScalar floor(const ReverseScalar& x) {
+  return ReverseScalar(std::floor(x.value()));
+}
+
+inline ReverseScalar ceil(const ReverseScalar& x) {
+  return ReverseScalar(std::ceil(x.value()));
+}
+
+inline ReverseScalar atan2(const ReverseScalar& y, const ReverseScalar& x) {
+  const double squared_norm = x.value() * x.value() + y.value() * y.value();
+  return ReverseScalar::Binary(y,
+                               x.value() / squared_norm,
+                               x,
+                               -y.value() / squared_norm,
+                               std::atan2(y.value(), x.value()));
+}
+
+inline ReverseScalar hypot(const ReverseScalar& x, const ReverseScalar& y) {
+  const double value = std::hypot(x.value(), y.value());
+  return ReverseScalar::Binary(
+      x, x.value() / value, y, y.value() / value, value);
+}
+
+inline ReverseScalar pow(const ReverseScalar& x, double s) {
+  const double value = std::pow(x.value(), s);
+  return ReverseScalar::Unary(x, value, s * std::pow(x.value(), s - 1.0));
+}
+
+// The derivative with respect to the exponent is only defined for positive
+// bases. As for Jets, it is taken to be zero for a zero base.
+inline ReverseScalar pow(double s, const ReverseScalar& y) {
+  const double value = std::pow(s, y.value());
+  return ReverseScalar::Unary(y, value, s == 0.0 ? 0.0 : value * std::log(s));
+}
+
+inline ReverseScalar pow(const ReverseScalar& x, const ReverseScalar& y) {
+  const double value = std::pow(x.value(), y.value());
+  const double dx = y.value() * std::pow(x.value(), y.value() - 1.0);
+  const double dy = x.value() == 0.0 ? 0.0 : value * std::log(x.value());
+  return ReverseScalar::Binary(x, dx, y, dy, value);
+}
+
+inline ReverseScalar fmin(const ReverseScalar& x, const ReverseScalar& y) {
+  return y < x ? y : x;
+}
+
+inline ReverseScalar fmax(const ReverseScalar& x, const ReverseScalar& y) {
+  return x < y ? y : x;
+}
+
+inline bool isfinite(const ReverseScalar& x) {
+  return std::isfinite(x.value());
+}
+inline bool isinf(const ReverseScalar& x) { return std::isinf(x.value()); }
+inline bool isnan(const ReverseScalar& x) { return std::isnan(x.value()); }
+
+inline std::ostream& operator<<(std::ostream& s, const ReverseScalar& x) {
+  return s << x.value();
+}
+
+}  // namespace ceres::internal
+
+namespace Eigen {
+
+// Allows ReverseScalars to be used as the scalar type of Eigen matrices.
+template <>
+struct NumTraits<ceres::internal::ReverseScalar> {
+  using Real = ceres::internal::ReverseScalar;
+  using NonInteger = ceres::internal::ReverseScalar;
+  using Nested = ceres::internal::ReverseScalar;
+  using Literal = ceres::internal::ReverseScalar;
+
+  static inline Real dummy_precision() { return Real(1e-12); }
+  static inline Real epsilon() {
+    return Real(std::numeric_limits<double>::epsilon());
+  }
+  static inline int digits10() { return NumTraits<double>::digits10(); }
+
+  enum {
+    IsComplex = 0,
+    IsInteger = 0,
+    IsSigned,
+    ReadCost = 1,
+    AddCost = 2,
+    MulCost = 2,
+    HasFloatingPoint = 1,
+    RequireInitialization = 1
+  };
+
+  static inline Real highest() {
+    return Real((std::numeric_limits<double>::max)());
+  }
+  static inline Real lowest() {
+    return Real(-(std::numeric_limits<double>::max)());
+  }
+};
+
+template <typename BinaryOp>
+struct ScalarBinaryOpTraits<ceres::internal::ReverseScalar, double, BinaryOp> {
+  using ReturnType = ceres::internal::ReverseScalar;
+};
+template <typename BinaryOp>
+struct ScalarBinaryOpTraits<double, ceres::internal::ReverseScalar, BinaryOp> {
+  using ReturnType = ceres::internal::ReverseScalar;
+};
+
+}  // namespace Eigen
+
+#endif  // CERES_PUBLIC_INTERNAL_REVERSE_AUTODIFF_H_
@@ -0,0 +1,169 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+//
+// Marginalization of parameter blocks out of a Problem, for use in fixed-lag
+// smoothers and sliding window estimators.
+
+#ifndef CERES_PUBLIC_MARGINALIZATION_H_
+#define CERES_PUBLIC_MARGINALIZATION_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ceres/cost_function.h"
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/internal/export.h"
+#include "ceres/manifold.h"
+#include "ceres/problem.h"
+
+namespace ceres {
+
+// A linear (Gaussian) prior on a set of parameter blocks, obtained by
+// marginalizing other parameter blocks out of a non-linear least squares
+// problem. It implements the cost function
+//
+//   cost(x_1, ..., x_n) = 1/2 ||r0 + J [x_1 [-] x0_1; ...; x_n [-] x0_n]||^2
+//
+// where x0_i is the point at which the problem was linearized, [-] is the
+// Minus operation of the manifold associated with x_i (plain subtraction if
+// there is none), and the matrix J and the vector r0 are fixed.
+//
+// The Jacobian with respect to the tangent space of x_i is approximated by
+// the corresponding column block of J, which is exact when x_i = x0_i or when
+// x_i has no manifold. This keeps the prior consistent with the linearization
+// point, in the spirit of first estimate Jacobians.
+//
+// The manifolds are not owned by the prior and must outlive it.
+class CERES_EXPORT MarginalizationPrior final : public CostFunction {
+ public:
+  // linearization_points[i] holds the ambient values of the i-th parameter
+  // block at the linearization point and manifolds[i] is its manifold, or
+  // nullptr if the parameter block is Euclidean. The number of columns of
+  // jacobian must equal the sum of the tangent sizes of the parameter blocks,
+  // and the number of rows must equal the size of residuals.
+  MarginalizationPrior(std::vector<Vector> linearization_points,
+                       std::vector<const Manifold*> manifolds,
+                       Matrix jacobian,
+                       Vector residuals);
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override;
+
+  const std::vector<Vector>& linearization_points() const {
+    return linearization_points_;
+  }
+  const Matrix& jacobian() const { return jacobian_; }
+  const Vector& residuals() const { return residuals_; }
+
+ private:
+  std::vector<Vector> linearization_points_;
+  std::vector<const Manifold*> manifolds_;
+  std::vector<int> tangent_offsets_;
+  Matrix jacobian_;
+  Vector residuals_;
+};
+
+struct CERES_EXPORT MarginalizationOptions {
+  // The marginal information matrix is truncated to its eigenvalues larger
+  // than min_eigenvalue_ratio times the largest eigenvalue. The directions
+  // that are dropped are unobservable from the marginalized residuals and
+  // the resulting prior does not constrain them.
+  double min_eigenvalue_ratio = 1e-12;
+
+  // Whether the loss functions of the marginalized residual blocks are
+  // applied when linearizing them.
+  bool apply_loss_function = true;
+
+  // Number of threads used to evaluate the marginalized residual blocks.
+  int num_threads = 1;
+};
+
+// Computes the prior induced on the rest of the problem by the residual blocks
+// that depend on parameter_blocks_to_marginalize.
+//
+// The residual blocks depending on any of parameter_blocks_to_marginalize are
+// linearized at the current parameter values. The parameter blocks to
+// marginalize are then eliminated from the resulting normal equations using
+// a dense Cholesky factorization, and the Schur complement on the remaining
+// parameter blocks is factored into a MarginalizationPrior.
+//
+// On success, markov_blanket contains the non-constant parameter blocks the
+// prior depends on, in the order expected by the prior, and prior is set. If
+// the marginalized residual blocks do not depend on any other non-constant
+// parameter block, prior is set to nullptr and markov_blanket is empty.
+//
+// Returns false and sets error if the parameter blocks to marginalize are not
+// part of the problem, if the evaluation of the residual blocks fails, or if
+// the parameter blocks to marginalize are not fully determined by the
+// residual blocks that depend on them, i.e., their block of the Hessian is
+// rank deficient.
+//
+// The problem is not modified.
+CERES_EXPORT bool ComputeMarginalizationPrior(
+    const MarginalizationOptions& options,
+    const std::vector<double*>& parameter_blocks_to_marginalize,
+    Problem* problem,
+    std::vector<double*>* markov_blanket,
+    std::unique_ptr<MarginalizationPrior>* prior,
+    std::string* error);
+
+// Replaces parameter_blocks_to_marginalize and the residual blocks that
+// depend on them by a MarginalizationPrior on the parameter blocks they were
+// connected to. This is the basic step of a fixed-lag smoother: priors added
+// by earlier calls are themselves marginalized by later ones.
+//
+// The prior is added to the problem with AddResidualBlock and without a loss
+// function. If prior_residual_block_id is not nullptr, it is set to the id of
+// the new residual block, or nullptr if no prior was needed.
+//
+// If Problem::Options::cost_function_ownership is TAKE_OWNERSHIP, the
+// problem owns the prior and owned_prior may be nullptr. Otherwise the
+// caller owns the prior, which must outlive its use by the problem, and
+// owned_prior must not be nullptr. If owned_prior is not nullptr, it is set
+// to the prior if the caller owns it and to nullptr otherwise.
+//
+// Returns false and sets error, leaving the problem untouched, if
+// ComputeMarginalizationPrior fails, or if owned_prior is nullptr and the
+// problem does not take ownership of its cost functions.
+CERES_EXPORT bool MarginalizeOutParameterBlocks(
+    const MarginalizationOptions& options,
+    const std::vector<double*>& parameter_blocks_to_marginalize,
+    Problem* problem,
+    ResidualBlockId* prior_residual_block_id,
+    std::unique_ptr<MarginalizationPrior>* owned_prior,
+    std::string* error);
+
+}  // namespace ceres
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_PUBLIC_MARGINALIZATION_H_
@@ -129,20 +129,22 @@ class CERES_EXPORT Problem {
     Ownership loss_function_ownership = TAKE_OWNERSHIP;
     Ownership manifold_ownership = TAKE_OWNERSHIP;
 
-    // If true, trades memory for faster RemoveResidualBlock() and
-    // RemoveParameterBlock() operations.
+    // If true, trades memory for a faster RemoveResidualBlock() operation.
     //
-    // By default, RemoveParameterBlock() and RemoveResidualBlock() take time
-    // proportional to the size of the entire problem. If you only ever remove
-    // parameters or residuals from the problem occasionally, this might be
-    // acceptable. However, if you have memory to spare, enable this option to
-    // make RemoveParameterBlock() take time proportional to the number of
-    // residual blocks that depend on it, and RemoveResidualBlock() take (on
-    // average) constant time.
+    // Every parameter block keeps a hash set of the residual blocks that
+    // depend on it, so RemoveParameterBlock() always takes time proportional
+    // to the number of residual blocks that depend on it. By default,
+    // RemoveResidualBlock() takes time proportional to the size of the entire
+    // problem, because it checks that the residual block is in the problem. If
+    // you only ever remove residuals from the problem occasionally, this might
+    // be acceptable. However, if you have memory to spare, enable this option
+    // to make RemoveResidualBlock() take (on average) constant time. Together
+    // with disable_all_safety_checks, this makes adding and removing blocks
+    // take constant time on average, which is useful for sliding window
+    // problems.
     //
-    // The increase in memory usage is two-fold: an additional hash set per
-    // parameter block containing all the residuals that depend on the parameter
-    // block; and a hash set in the problem containing all residuals.
+    // The increase in memory usage is a hash set in the problem containing all
+    // residuals.
     bool enable_fast_removal = false;
 
     // By default, Ceres performs a variety of safety checks when constructing
@@ -152,6 +154,11 @@ class CERES_EXPORT Problem {
     // is truly an overhead you want to avoid, then you can set
     // disable_all_safety_checks to true.
     //
+    // The safety checks include detecting parameter blocks that overlap in
+    // memory, which requires an ordered index of the parameter blocks. With
+    // the checks enabled, adding and removing a parameter block takes time
+    // logarithmic in the number of parameter blocks.
+    //
     // WARNING: Do not set this to true, unless you are absolutely sure of what
     // you are doing.
     bool disable_all_safety_checks = false;
@@ -252,11 +259,65 @@ class CERES_EXPORT Problem {
                                    double* const* const parameter_blocks,
                                    int num_parameter_blocks);
 
+  // Add num_residual_blocks residual blocks in one call. This is equivalent
+  // to calling
+  //
+  //   AddResidualBlock(cost_functions[i], loss_functions[i], ...)
+  //
+  // for i = 0, ..., num_residual_blocks - 1, but it is considerably faster
+  // for large problems. The residual blocks, and the parameter blocks they
+  // add to the problem, are allocated from a few contiguous chunks of
+  // memory, and the bookkeeping is done once per call instead of once per
+  // residual block.
+  //
+  // The parameter blocks of all the residual blocks are concatenated in
+  // parameter_blocks, so the parameter blocks of residual block i start
+  // right after the parameter blocks of residual block i - 1. Residual block
+  // i has cost_functions[i]->parameter_block_sizes().size() parameter
+  // blocks.
+  //
+  // loss_functions may be nullptr, in which case none of the residual blocks
+  // have a loss function. If residual_block_ids is not nullptr, it must have
+  // room for num_residual_blocks entries, and the ids of the new residual
+  // blocks are stored in it.
+  //
+  // Example usage:
+  //
+  //   std::vector<CostFunction*> cost_functions;
+  //   std::vector<double*> parameter_blocks;
+  //   for (auto& observation : observations) {
+  //     cost_functions.push_back(new MyBinaryCostFunction(observation));
+  //     parameter_blocks.push_back(cameras[observation.camera]);
+  //     parameter_blocks.push_back(points[observation.point]);
+  //   }
+  //   problem.AddResidualBlocks(cost_functions.size(),
+  //                             cost_functions.data(),
+  //                             nullptr,
+  //                             parameter_blocks.data(),
+  //                             nullptr);
+  //
+  // Residual and parameter blocks added this way can be removed like any
+  // other, but their memory is only released when the Problem is destroyed.
+  void AddResidualBlocks(int num_residual_blocks,
+                         CostFunction* const* cost_functions,
+                         LossFunction* const* loss_functions,
+                         double* const* parameter_blocks,
+                         ResidualBlockId* residual_block_ids);
+
   // Add a parameter block with appropriate size to the problem. Repeated calls
   // with the same arguments are ignored. Repeated calls with the same double
   // pointer but a different size will result in a crash.
   void AddParameterBlock(double* values, int size);
 
+  // Add num_parameter_blocks parameter blocks in one call. This is
+  // equivalent to calling AddParameterBlock(values[i], sizes[i]) for
+  // i = 0, ..., num_parameter_blocks - 1, but the new parameter blocks are
+  // allocated from one contiguous chunk of memory, which is only released
+  // when the Problem is destroyed.
+  void AddParameterBlocks(int num_parameter_blocks,
+                          double* const* values,
+                          const int* sizes);
+
   // Add a parameter block with appropriate size and Manifold to the
   // problem. It is okay for manifold to be nullptr.
   //
@@ -275,9 +336,8 @@ class CERES_EXPORT Problem {
   // blocks that depend on the parameter are also removed, as described above
   // in RemoveResidualBlock().
   //
-  // If Problem::Options::enable_fast_removal is true, then the removal is fast
-  // (almost constant time). Otherwise, removing a parameter block will incur a
-  // scan of the entire Problem object.
+  // Removing a parameter block takes time proportional to the number of
+  // residual blocks that depend on it.
   //
   // WARNING: Removing a residual or parameter block will destroy the implicit
   // ordering, rendering the jacobian or residuals returned from the solver
@@ -370,6 +430,10 @@ class CERES_EXPORT Problem {
   // Fills the passed parameter_blocks vector with pointers to the parameter
   // blocks currently in the problem. After this call, parameter_block.size() ==
   // NumParameterBlocks.
+  //
+  // The parameter blocks are in the order in which they were added to the
+  // problem, except that removing a parameter block moves the last parameter
+  // block into its place.
   void GetParameterBlocks(std::vector<double*>* parameter_blocks) const;
 
   // Fills the passed residual_blocks vector with pointers to the residual
@@ -393,10 +457,8 @@ class CERES_EXPORT Problem {
 
   // Get all the residual blocks that depend on the given parameter block.
   //
-  // If Problem::Options::enable_fast_removal is true, then getting the residual
-  // blocks is fast and depends only on the number of residual
-  // blocks. Otherwise, getting the residual blocks for a parameter block will
-  // incur a scan of the entire Problem object.
+  // Getting the residual blocks is fast and depends only on the number of
+  // residual blocks that depend on the parameter block.
   void GetResidualBlocksForParameterBlock(
       const double* values,
       std::vector<ResidualBlockId>* residual_blocks) const;
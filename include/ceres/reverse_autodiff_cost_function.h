@@ -0,0 +1,212 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_PUBLIC_REVERSE_AUTODIFF_COST_FUNCTION_H_
+#define CERES_PUBLIC_REVERSE_AUTODIFF_COST_FUNCTION_H_
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/fixed_array.h"
+#include "absl/log/check.h"
+#include "ceres/dynamic_cost_function.h"
+#include "ceres/internal/reverse_autodiff.h"
+#include "ceres/types.h"
+
+namespace ceres {
+
+// A cost function which computes its Jacobian using reverse mode automatic
+// differentiation. The functor API and the sizing of the parameter blocks
+// and residuals are the same as for DynamicAutoDiffCostFunction:
+//
+//   struct MyCostFunctor {
+//     template<typename T>
+//     bool operator()(T const* const* parameters, T* residuals) const {
+//       // Use parameters[i] to access the i'th parameter block.
+//     }
+//   };
+//
+//   ReverseAutoDiffCostFunction<MyCostFunctor> cost_function;
+//   cost_function.AddParameterBlock(100);
+//   cost_function.AddParameterBlock(200);
+//   cost_function.SetNumResiduals(2);
+//
+// DynamicAutoDiffCostFunction evaluates the functor once for every Stride
+// parameters, so its cost grows with the product of the number of
+// parameters and the cost of the functor. ReverseAutoDiffCostFunction
+// instead evaluates the functor once, recording the operations on a tape,
+// and then computes each row of the Jacobian with a backward sweep over
+// the tape. This makes it much faster for cost functions with many
+// parameters and few residuals, e.g., terms which depend on many spline
+// control points or on a dense image patch. For cost functions with few
+// parameters, AutoDiffCostFunction is faster.
+//
+// The functor is evaluated with T = double when no Jacobians are requested,
+// and with T = ceres::internal::ReverseScalar otherwise. ReverseScalar
+// supports the arithmetic operators, the comparison operators and the
+// common mathematical functions in <cmath>, and can be used as the scalar
+// type of Eigen matrices. Branching on the values of the parameters is
+// fine, since the tape is recorded for every evaluation.
+//
+// The tape is kept in thread local storage and reused across evaluations,
+// so its memory is only allocated once per thread.
+template <typename CostFunctor>
+class ReverseAutoDiffCostFunction final : public DynamicCostFunction {
+ public:
+  // Constructs the CostFunctor on the heap and takes the ownership.
+  template <class... Args,
+            std::enable_if_t<std::is_constructible_v<CostFunctor, Args&&...>>* =
+                nullptr>
+  explicit ReverseAutoDiffCostFunction(Args&&... args)
+      // NOTE We explicitly use direct initialization using parentheses instead
+      // of uniform initialization using braces to avoid narrowing conversion
+      // warnings.
+      : ReverseAutoDiffCostFunction{
+            std::make_unique<CostFunctor>(std::forward<Args>(args)...)} {}
+
+  // Takes ownership by default.
+  explicit ReverseAutoDiffCostFunction(CostFunctor* functor,
+                                       Ownership ownership = TAKE_OWNERSHIP)
+      : ReverseAutoDiffCostFunction{std::unique_ptr<CostFunctor>{functor},
+                                    ownership} {}
+
+  explicit ReverseAutoDiffCostFunction(std::unique_ptr<CostFunctor> functor)
+      : ReverseAutoDiffCostFunction{std::move(functor), TAKE_OWNERSHIP} {}
+
+  ReverseAutoDiffCostFunction(const ReverseAutoDiffCostFunction& other) =
+      delete;
+  ReverseAutoDiffCostFunction& operator=(
+      const ReverseAutoDiffCostFunction& other) = delete;
+  ReverseAutoDiffCostFunction(ReverseAutoDiffCostFunction&& other) noexcept =
+      default;
+  ReverseAutoDiffCostFunction& operator=(
+      ReverseAutoDiffCostFunction&& other) noexcept = default;
+
+  ~ReverseAutoDiffCostFunction() override {
+    if (ownership_ == DO_NOT_TAKE_OWNERSHIP) {
+      functor_.release();
+    }
+  }
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override {
+    CHECK_GT(num_residuals(), 0)
+        << "You must call ReverseAutoDiffCostFunction::SetNumResiduals() "
+        << "before ReverseAutoDiffCostFunction::Evaluate().";
+
+    if (jacobians == nullptr) {
+      return (*functor_)(parameters, residuals);
+    }
+
+    using internal::ReverseScalar;
+    const std::vector<int32_t>& block_sizes = parameter_block_sizes();
+    const int num_parameter_blocks = static_cast<int>(block_sizes.size());
+    const int num_parameters =
+        std::accumulate(block_sizes.begin(), block_sizes.end(), 0);
+
+    internal::Tape fallback_tape;
+    internal::Tape& tape = internal::ThreadLocalTapeOr(fallback_tape);
+    tape.Clear();
+    tape.set_in_use(true);
+
+    // Parameters of the blocks whose Jacobians are requested are the
+    // independent variables of the tape, in order. The other parameters are
+    // constants, and the operations on them are not recorded.
+    absl::FixedArray<ReverseScalar, 256> inputs(num_parameters);
+    absl::FixedArray<ReverseScalar*> input_blocks(num_parameter_blocks);
+    for (int i = 0, cursor = 0; i < num_parameter_blocks; ++i) {
+      input_blocks[i] = &inputs[cursor];
+      for (int j = 0; j < block_sizes[i]; ++j, ++cursor) {
+        inputs[cursor] = jacobians[i] != nullptr
+                             ? ReverseScalar(parameters[i][j], &tape)
+                             : ReverseScalar(parameters[i][j]);
+      }
+    }
+
+    absl::FixedArray<ReverseScalar, 16> outputs(num_residuals());
+    const bool success = (*functor_)(input_blocks.data(), outputs.data());
+    if (success) {
+      for (int k = 0; k < num_residuals(); ++k) {
+        residuals[k] = outputs[k].value();
+        // A residual which does not depend on the variables has a zero row.
+        if (!outputs[k].is_constant()) {
+          tape.Backpropagate(outputs[k].index());
+        }
+        const double* adjoints = tape.adjoints();
+        for (int i = 0, variable = 0; i < num_parameter_blocks; ++i) {
+          if (jacobians[i] == nullptr) {
+            continue;
+          }
+          double* jacobian_row = jacobians[i] + k * block_sizes[i];
+          for (int j = 0; j < block_sizes[i]; ++j, ++variable) {
+            jacobian_row[j] =
+                outputs[k].is_constant() ? 0.0 : adjoints[variable];
+          }
+        }
+      }
+    }
+
+    tape.set_in_use(false);
+    return success;
+  }
+
+  const CostFunctor& functor() const { return *functor_; }
+
+ private:
+  explicit ReverseAutoDiffCostFunction(std::unique_ptr<CostFunctor> functor,
+                                       Ownership ownership)
+      : functor_(std::move(functor)), ownership_(ownership) {}
+
+  std::unique_ptr<CostFunctor> functor_;
+  Ownership ownership_;
+};
+
+// Deduction guides that allow the user to avoid explicitly specifying the
+// template parameter of ReverseAutoDiffCostFunction, e.g.
+//
+//   new ReverseAutoDiffCostFunction{new MyCostFunctor{}};
+//   new ReverseAutoDiffCostFunction{std::make_unique<MyCostFunctor>()};
+//
+template <typename CostFunctor>
+ReverseAutoDiffCostFunction(CostFunctor* functor)
+    -> ReverseAutoDiffCostFunction<CostFunctor>;
+template <typename CostFunctor>
+ReverseAutoDiffCostFunction(CostFunctor* functor, Ownership ownership)
+    -> ReverseAutoDiffCostFunction<CostFunctor>;
+template <typename CostFunctor>
+ReverseAutoDiffCostFunction(std::unique_ptr<CostFunctor> functor)
+    -> ReverseAutoDiffCostFunction<CostFunctor>;
+
+}  // namespace ceres
+
+#endif  // CERES_PUBLIC_REVERSE_AUTODIFF_COST_FUNCTION_H_
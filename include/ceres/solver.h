@@ -48,6 +48,10 @@
 
 namespace ceres {
 
+namespace internal {
+struct PreparedProblemImpl;
+}  // namespace internal
+
 // Interface for non-linear least squares solvers.
 class CERES_EXPORT Solver {
  public:
@@ -270,8 +274,29 @@ class CERES_EXPORT Solver {
 
     // Number of threads used by Ceres for evaluating the cost and
     // jacobians.
+    //
+    // With num_threads > 1, the linear solvers and preconditioners that
+    // compute a Schur complement do so without locking, with every row
+    // block of the Schur complement updated by a single thread. This
+    // stores E'F, E'E, its inverse and E'b for every eliminated parameter
+    // block (e.g., every point in bundle adjustment) for the lifetime of
+    // the linear solver, which takes about as much memory as the values of
+    // the Jacobian.
     int num_threads = 1;
 
+    // If true, the connected components of the problem, i.e., the sets
+    // of non-constant parameter blocks coupled by residual blocks, are
+    // solved as independent problems, each with its own trust region
+    // and termination test. Up to num_threads components are solved
+    // concurrently. The summaries of the components are merged into
+    // one summary.
+    //
+    // The problem is solved as a whole if it has only one component,
+    // if callbacks is not empty, if check_gradients is true, if the
+    // problem has an EvaluationCallback or if the linear solver uses
+    // CUDA. Ignored by PreparedProblem.
+    bool solve_independent_components = false;
+
     // Trust region minimizer settings.
     double initial_trust_region_radius = 1e4;
     double max_trust_region_radius = 1e16;
@@ -581,7 +606,14 @@ class CERES_EXPORT Solver {
     // in single precision.
     //
     // This options is available when linear solver uses sparse or dense
-    // cholesky factorization.
+    // cholesky factorization, and with ITERATIVE_SCHUR and CGNR. For the
+    // latter two, the conjugate gradients iterations use single precision
+    // copies of the Jacobian (and for ITERATIVE_SCHUR of the block
+    // diagonals of the Schur complement), which are kept in addition to
+    // the double precision matrices, and the refinement is controlled by
+    // max_num_cg_refinement_iterations instead. It is not available with
+    // use_explicit_schur_complement, or with CGNR when
+    // sparse_linear_algebra_library_type is CUDA_SPARSE.
     bool use_mixed_precision_solves = false;
 
     // Number steps of the iterative refinement process to run when computing
@@ -589,6 +621,94 @@ class CERES_EXPORT Solver {
     // use_mixed_precision = true.
     int max_num_refinement_iterations = 0;
 
+    // Maximum number of steps of iterative refinement to run when
+    // use_mixed_precision_solves is true and the linear solver is
+    // ITERATIVE_SCHUR or CGNR. Each step computes the residual of the
+    // linear system in double precision, and runs conjugate gradients in
+    // single precision to compute a correction. The refinement stops
+    // early once a correction decreases the quadratic model of the linear
+    // system by less than the tolerance used to terminate conjugate
+    // gradients (see eta), so this is only an upper bound. If it is zero,
+    // the step is computed in single precision.
+    int max_num_cg_refinement_iterations = 3;
+
+    // If use_single_precision_jacobian is true, the Jacobian is stored in
+    // single precision. Each Jacobian block is evaluated in double
+    // precision and rounded to single precision when it is written to the
+    // Jacobian, the gradient and the residuals are computed in double
+    // precision. This halves the memory used by the Jacobian values, and
+    // since the matrix-vector products in conjugate gradients are limited
+    // by memory bandwidth, it can also speed up the linear solver, at the
+    // cost of rounding the Jacobian to single precision. The products are
+    // accumulated in double precision.
+    //
+    // This option is only available with CGNR, when
+    // sparse_linear_algebra_library_type is not CUDA_SPARSE, with the
+    // IDENTITY and JACOBI preconditioners, and when
+    // use_mixed_precision_solves is false. In particular it is not
+    // supported with ITERATIVE_SCHUR, and Solver::Options::IsValid rejects
+    // these combinations.
+    bool use_single_precision_jacobian = false;
+
+    // If use_pipelined_conjugate_gradients is true, the iterative linear
+    // solver uses the pipelined variant of Conjugate Gradients due to
+    // Ghysels & Vanroose. It computes all the vector updates and dot
+    // products of an iteration in a single pass over the vectors, instead
+    // of a separate multi-threaded loop for each of them. This reduces the
+    // synchronization overhead per iteration, which can be significant for
+    // medium sized problems solved using many threads, at the cost of more
+    // memory and slightly worse numerical stability.
+    //
+    // This option is only available with CGNR when
+    // sparse_linear_algebra_library_type is not CUDA_SPARSE, and with
+    // ITERATIVE_SCHUR when use_explicit_schur_complement is false. It
+    // cannot be combined with use_mixed_precision_solves.
+    bool use_pipelined_conjugate_gradients = false;
+
+    // If num_deflation_vectors > 0, the iterative linear solver uses
+    // deflated Conjugate Gradients. Each solve estimates the eigenvectors
+    // of the linear system with the smallest eigenvalues, which usually
+    // are what slows down the convergence of Conjugate Gradients. The next
+    // solve, i.e., the next iteration of the minimizer, solves for the
+    // component of the solution along num_deflation_vectors of them
+    // exactly, and runs Conjugate Gradients on the rest. Since the linear
+    // systems solved in consecutive iterations are closely related, this
+    // can reduce the number of linear solver iterations considerably.
+    //
+    // The linear solver stores about 5 * num_deflation_vectors vectors of
+    // the size of the linear system, and every solve performs
+    // 2 * num_deflation_vectors additional matrix-vector products.
+    //
+    // This option is only available with CGNR when
+    // sparse_linear_algebra_library_type is not CUDA_SPARSE, and with
+    // ITERATIVE_SCHUR when use_explicit_schur_complement is false. It
+    // cannot be combined with use_mixed_precision_solves or
+    // use_pipelined_conjugate_gradients.
+    int num_deflation_vectors = 0;
+
+    // Updating the SCHUR_JACOBI, CLUSTER_JACOBI, CLUSTER_TRIDIAGONAL,
+    // SUBSET and INCOMPLETE_CHOLESKY preconditioners is expensive. Close to
+    // convergence, the Jacobian changes little from one iteration to the
+    // next, and the preconditioner computed for an earlier iteration is
+    // nearly as effective as a new one.
+    //
+    // If max_num_preconditioner_reuses > 0, the iterative linear solvers
+    // use a preconditioner for up to max_num_preconditioner_reuses linear
+    // solves after the one it was computed for. It is recomputed earlier
+    // if a linear solve takes more than
+    // preconditioner_refresh_iteration_ratio times the number of
+    // iterations of the solve it was computed for, or if a linear solve
+    // fails.
+    //
+    // The SCHUR_JACOBI and INCOMPLETE_CHOLESKY preconditioners are updated
+    // for the diagonal of the current linear system when they are reused.
+    // For SCHUR_JACOBI this is cheap compared to recomputing it. For
+    // INCOMPLETE_CHOLESKY the preconditioner matrix is factorized again, and
+    // reuse only saves computing A'A or the Schur complement. The other
+    // preconditioners are reused as they are.
+    int max_num_preconditioner_reuses = 0;
+    double preconditioner_refresh_iteration_ratio = 1.5;
+
     // Minimum number of iterations for which the linear solver should
     // run, even if the convergence criterion is satisfied.
     int min_linear_solver_iterations = 0;
@@ -878,6 +998,29 @@ class CERES_EXPORT Solver {
     // time is accounted for as preprocessing time.
     double preprocessor_time_in_seconds = -1.0;
 
+    // The following four times are the main stages of the
+    // preprocessor. Stages that were not run, e.g., because an earlier
+    // stage failed or because the problem was solved using a
+    // PreparedProblem, are reported as -1.
+
+    // Time (in seconds) spent checking that the values of the
+    // parameter blocks are finite and feasible.
+    double program_validation_time_in_seconds = -1.0;
+
+    // Time (in seconds) spent removing the constant parameter blocks
+    // and the residual blocks that only depend on them, including the
+    // evaluation of the cost of the removed residual blocks.
+    double program_reduction_time_in_seconds = -1.0;
+
+    // Time (in seconds) spent reordering the parameter and residual
+    // blocks for the linear solver, e.g., computing the Schur ordering
+    // or a fill reducing ordering.
+    double program_reordering_time_in_seconds = -1.0;
+
+    // Time (in seconds) spent creating the evaluator, including the
+    // computation of the layout of the Jacobian.
+    double evaluator_creation_time_in_seconds = -1.0;
+
     // Time spent in the TrustRegionMinimizer.
     double minimizer_time_in_seconds = -1.0;
 
@@ -983,6 +1126,10 @@ class CERES_EXPORT Solver {
     // residual evaluation.
     int num_threads_used = -1;
 
+    // Number of connected components of the problem that were solved
+    // independently. 1 if the problem was solved as a whole.
+    int num_independent_components = -1;
+
     // Type of the linear solver requested by the user.
     LinearSolverType linear_solver_type_given =
 #if defined(CERES_NO_SPARSE)
@@ -1113,13 +1260,68 @@ class CERES_EXPORT Solver {
   virtual void Solve(const Options& options,
                      Problem* problem,
                      Solver::Summary* summary);
+
+  // The result of preprocessing a problem for a particular set of
+  // options. Preprocessing removes the constant parameter and residual
+  // blocks, computes the orderings, builds the Jacobian and sets up the
+  // linear solver, including the symbolic factorization of the sparse
+  // linear algebra libraries. When the same problem is solved many times
+  // with different parameter values, e.g., in a tracking loop, this work
+  // can be done once by calling Prepare and then Solve(PreparedProblem*)
+  // for every solve.
+  //
+  // A PreparedProblem remains valid as long as the structure of the
+  // problem does not change, i.e., no residual or parameter blocks are
+  // added or removed, no parameter block is made constant or variable and
+  // no manifold is changed. The values and the bounds of the parameter
+  // blocks may change freely between solves. The problem must outlive the
+  // PreparedProblem.
+  //
+  // Gradient checking (Solver::Options::check_gradients) is not supported.
+  class CERES_EXPORT PreparedProblem {
+   public:
+    PreparedProblem();
+    PreparedProblem(const PreparedProblem&) = delete;
+    PreparedProblem& operator=(const PreparedProblem&) = delete;
+    ~PreparedProblem();
+
+    // Returns true if Prepare succeeded and the structure of the problem
+    // has not changed since.
+    bool IsValid() const;
+
+   private:
+    friend class Solver;
+    std::unique_ptr<internal::PreparedProblemImpl> impl_;
+  };
+
+  // Preprocesses the problem for the given options. Returns false and
+  // sets message if the options are invalid or preprocessing fails.
+  virtual bool Prepare(const Options& options,
+                       Problem* problem,
+                       PreparedProblem* prepared_problem,
+                       std::string* message);
+
+  // Solves a prepared problem starting from the current values of its
+  // parameter blocks. If the structure of the problem has changed since
+  // it was prepared, the solve fails without changing the parameter
+  // blocks and the problem must be prepared again.
+  virtual void Solve(PreparedProblem* prepared_problem,
+                     Solver::Summary* summary);
 };
 
-// Helper function which avoids going through the interface.
+// Helper functions which avoid going through the interface.
 CERES_EXPORT void Solve(const Solver::Options& options,
                         Problem* problem,
                         Solver::Summary* summary);
 
+CERES_EXPORT bool Prepare(const Solver::Options& options,
+                          Problem* problem,
+                          Solver::PreparedProblem* prepared_problem,
+                          std::string* message);
+
+CERES_EXPORT void Solve(Solver::PreparedProblem* prepared_problem,
+                        Solver::Summary* summary);
+
 }  // namespace ceres
 
 #include "ceres/internal/reenable_warnings.h"
@@ -137,7 +137,13 @@ enum PreconditionerType {
   // well the matrix Q approximates J'J, or how well the chosen
   // residual blocks approximate the non-linear least squares
   // problem.
-  SUBSET
+  SUBSET,
+
+  // Block incomplete Cholesky factorization with zero fill-in of the
+  // Gauss-Newton Hessian J'J when used with CGNR, or of the Schur
+  // complement when used with ITERATIVE_SCHUR, in which case the Schur
+  // complement is computed explicitly.
+  INCOMPLETE_CHOLESKY
 };
 
 enum VisibilityClusteringType {
@@ -0,0 +1,222 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/batched_psd_matrix_inverter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "absl/container/fixed_array.h"
+#include "absl/log/check.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/parallel_for.h"
+
+namespace ceres::internal {
+
+namespace {
+
+constexpr int kBatchSize = BatchedPSDMatrixInverter::kBatchSize;
+
+// Inverts the num_matrices <= kBatchSize matrices of size x size in
+// matrices[0, num_matrices). The template parameter kSize can either be
+// Eigen::Dynamic or equal to size.
+template <int kSize>
+void InvertBatch(const int dynamic_size,
+                 double* const* matrices,
+                 const int num_matrices) {
+  const int size = kSize == Eigen::Dynamic ? dynamic_size : kSize;
+  // Dynamically sized batches of matrices up to 12x12 also fit on the
+  // stack.
+  constexpr int kMaxInlineSize = kSize == Eigen::Dynamic ? 12 : kSize;
+  constexpr int kInlineSize = kMaxInlineSize * kMaxInlineSize * kBatchSize;
+
+  // u(i, j) points to the kBatchSize values of entry (i, j), i <= j, of
+  // the Cholesky factor U of the matrices, v(i, j) to those of the upper
+  // triangular matrix V = U^{-1}.
+  absl::FixedArray<double, kInlineSize> u_storage(size * size * kBatchSize);
+  absl::FixedArray<double, kInlineSize> v_storage(size * size * kBatchSize);
+  const auto u = [&u_storage, size](int i, int j) {
+    return u_storage.data() + (i * size + j) * kBatchSize;
+  };
+  const auto v = [&v_storage, size](int i, int j) {
+    return v_storage.data() + (i * size + j) * kBatchSize;
+  };
+
+  // Unused lanes are filled with the identity so that they factorize
+  // cleanly.
+  for (int l = 0; l < kBatchSize; ++l) {
+    const double* m = l < num_matrices ? matrices[l] : nullptr;
+    for (int i = 0; i < size; ++i) {
+      for (int j = i; j < size; ++j) {
+        u(i, j)[l] = m != nullptr ? m[i * size + j] : (i == j ? 1.0 : 0.0);
+      }
+    }
+  }
+
+  // Cholesky factorization A = U'U, computed row by row in place.
+  bool failed[kBatchSize] = {false};
+  for (int k = 0; k < size; ++k) {
+    double* u_kk = u(k, k);
+    for (int p = 0; p < k; ++p) {
+      const double* u_pk = u(p, k);
+      for (int l = 0; l < kBatchSize; ++l) {
+        u_kk[l] -= u_pk[l] * u_pk[l];
+      }
+    }
+    double* v_kk = v(k, k);
+    for (int l = 0; l < kBatchSize; ++l) {
+      failed[l] |= !(u_kk[l] > 0.0);
+      u_kk[l] = std::sqrt(u_kk[l]);
+      v_kk[l] = 1.0 / u_kk[l];
+    }
+    for (int j = k + 1; j < size; ++j) {
+      double* u_kj = u(k, j);
+      for (int p = 0; p < k; ++p) {
+        const double* u_pk = u(p, k);
+        const double* u_pj = u(p, j);
+        for (int l = 0; l < kBatchSize; ++l) {
+          u_kj[l] -= u_pk[l] * u_pj[l];
+        }
+      }
+      for (int l = 0; l < kBatchSize; ++l) {
+        u_kj[l] *= v_kk[l];
+      }
+    }
+  }
+
+  // V = U^{-1}, computed row by row. The diagonal was computed above.
+  for (int i = 0; i < size; ++i) {
+    for (int j = i + 1; j < size; ++j) {
+      double* v_ij = v(i, j);
+      for (int l = 0; l < kBatchSize; ++l) {
+        v_ij[l] = 0.0;
+      }
+      for (int k = i; k < j; ++k) {
+        const double* v_ik = v(i, k);
+        const double* u_kj = u(k, j);
+        for (int l = 0; l < kBatchSize; ++l) {
+          v_ij[l] -= v_ik[l] * u_kj[l];
+        }
+      }
+      const double* v_jj = v(j, j);
+      for (int l = 0; l < kBatchSize; ++l) {
+        v_ij[l] *= v_jj[l];
+      }
+    }
+  }
+
+  // A^{-1} = V V'. U is no longer needed, so its storage is reused for
+  // the upper triangular part of the inverse.
+  for (int i = 0; i < size; ++i) {
+    for (int j = i; j < size; ++j) {
+      double* a_ij = u(i, j);
+      for (int l = 0; l < kBatchSize; ++l) {
+        a_ij[l] = 0.0;
+      }
+      for (int k = j; k < size; ++k) {
+        const double* v_ik = v(i, k);
+        const double* v_jk = v(j, k);
+        for (int l = 0; l < kBatchSize; ++l) {
+          a_ij[l] += v_ik[l] * v_jk[l];
+        }
+      }
+    }
+  }
+
+  for (int l = 0; l < num_matrices; ++l) {
+    double* m = matrices[l];
+    if (failed[l]) {
+      // Fall back to the same computation as the unbatched code path,
+      // including its behaviour for matrices which are not positive
+      // definite.
+      MatrixRef b(m, size, size);
+      b = b.selfadjointView<Eigen::Upper>().llt().solve(
+          Matrix::Identity(size, size));
+      continue;
+    }
+    for (int i = 0; i < size; ++i) {
+      for (int j = i; j < size; ++j) {
+        m[i * size + j] = m[j * size + i] = u(i, j)[l];
+      }
+    }
+  }
+}
+
+using InvertBatchFunction = void (*)(int, double* const*, int);
+
+InvertBatchFunction GetInvertBatchFunction(const int size) {
+  switch (size) {
+    // clang-format off
+    case 1: return InvertBatch<1>;
+    case 2: return InvertBatch<2>;
+    case 3: return InvertBatch<3>;
+    case 4: return InvertBatch<4>;
+    case 5: return InvertBatch<5>;
+    case 6: return InvertBatch<6>;
+    case 7: return InvertBatch<7>;
+    case 8: return InvertBatch<8>;
+    case 9: return InvertBatch<9>;
+    default: return InvertBatch<Eigen::Dynamic>;
+      // clang-format on
+  }
+}
+
+}  // namespace
+
+void BatchedPSDMatrixInverter::AddMatrix(const int size, double* values) {
+  CHECK_GT(size, 0);
+  CHECK(values != nullptr);
+  matrices_[size].push_back(values);
+  ++num_matrices_;
+}
+
+void BatchedPSDMatrixInverter::Invert(ContextImpl* context,
+                                      const int num_threads) const {
+  for (auto it = matrices_.begin(); it != matrices_.end(); ++it) {
+    const int size = it->first;
+    const std::vector<double*>& matrices = it->second;
+    const int num_matrices = matrices.size();
+    const int num_batches = (num_matrices + kBatchSize - 1) / kBatchSize;
+    const InvertBatchFunction invert_batch = GetInvertBatchFunction(size);
+    ParallelFor(context,
+                0,
+                num_batches,
+                num_threads,
+                [invert_batch, size, num_matrices, &matrices](int i) {
+                  const int start = i * kBatchSize;
+                  invert_batch(size,
+                               matrices.data() + start,
+                               std::min(kBatchSize, num_matrices - start));
+                });
+  }
+}
+
+}  // namespace ceres::internal
@@ -0,0 +1,81 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_BATCHED_PSD_MATRIX_INVERTER_H_
+#define CERES_INTERNAL_BATCHED_PSD_MATRIX_INVERTER_H_
+
+#include <map>
+#include <vector>
+
+#include "ceres/context_impl.h"
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/export.h"
+
+namespace ceres::internal {
+
+// Inverts a fixed collection of small symmetric positive definite
+// matrices in place.
+//
+// Calling InvertPSDMatrix or Eigen's LLT once per block is dominated by
+// per call overhead when the blocks are small and numerous, e.g., the
+// 3x3 point blocks and 6x6 or 9x9 camera blocks of a bundle adjustment
+// problem. Instead, the matrices are grouped by size, and each group is
+// processed kBatchSize matrices at a time. The entries of a batch are
+// interleaved (entry (i, j) of all the matrices of the batch is stored
+// contiguously), so that the Cholesky factorization and the inversion
+// operate on all the matrices of the batch with the same sequence of
+// vectorizable instructions.
+//
+// Only the upper triangular part of each matrix is read, and the full
+// inverse is written back. Matrices for which the Cholesky factorization
+// fails are inverted using Eigen's LLT, exactly as if they had been
+// inverted one at a time.
+class CERES_NO_EXPORT BatchedPSDMatrixInverter {
+ public:
+  static constexpr int kBatchSize = 4;
+
+  // values points to size x size doubles storing a row-major matrix,
+  // which must remain valid for the lifetime of the inverter.
+  void AddMatrix(int size, double* values);
+
+  // Replaces each of the matrices added so far by its inverse.
+  void Invert(ContextImpl* context, int num_threads) const;
+
+  int num_matrices() const { return num_matrices_; }
+
+ private:
+  // Matrices grouped by size.
+  std::map<int, std::vector<double*>> matrices_;
+  int num_matrices_ = 0;
+};
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_BATCHED_PSD_MATRIX_INVERTER_H_
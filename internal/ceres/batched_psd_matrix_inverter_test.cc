@@ -0,0 +1,140 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/batched_psd_matrix_inverter.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "ceres/context_impl.h"
+#include "ceres/internal/eigen.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+static Matrix RandomPositiveDefiniteMatrix(int size, std::mt19937& prng) {
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  Matrix a(size, size);
+  for (int i = 0; i < a.size(); ++i) {
+    a.data()[i] = distribution(prng);
+  }
+  return a * a.transpose() + Matrix::Identity(size, size);
+}
+
+// Inverts a mix of matrices of all the sizes with specialized kernels and
+// a few larger ones, with numbers of matrices of each size which are and
+// are not multiples of the batch size.
+static void TestInversion(int num_threads) {
+  std::mt19937 prng;
+  ContextImpl context;
+  context.EnsureMinimumThreads(num_threads);
+
+  std::vector<Matrix> matrices;
+  for (int size = 1; size <= 13; ++size) {
+    const int num_matrices =
+        2 * BatchedPSDMatrixInverter::kBatchSize + size % 3;
+    for (int i = 0; i < num_matrices; ++i) {
+      matrices.push_back(RandomPositiveDefiniteMatrix(size, prng));
+    }
+  }
+
+  std::vector<Matrix> inverses = matrices;
+  BatchedPSDMatrixInverter inverter;
+  for (Matrix& inverse : inverses) {
+    inverter.AddMatrix(inverse.rows(), inverse.data());
+  }
+  EXPECT_EQ(inverter.num_matrices(), matrices.size());
+  inverter.Invert(&context, num_threads);
+
+  for (int i = 0; i < matrices.size(); ++i) {
+    const int size = matrices[i].rows();
+    const Matrix expected =
+        matrices[i].llt().solve(Matrix::Identity(size, size));
+    EXPECT_NEAR((inverses[i] - expected).norm() / expected.norm(),
+                0.0,
+                1000 * std::numeric_limits<double>::epsilon())
+        << "size: " << size;
+    EXPECT_EQ(inverses[i], inverses[i].transpose()) << "size: " << size;
+  }
+}
+
+TEST(BatchedPSDMatrixInverter, SingleThreaded) { TestInversion(1); }
+
+TEST(BatchedPSDMatrixInverter, MultiThreaded) { TestInversion(4); }
+
+TEST(BatchedPSDMatrixInverter, OnlyReadsUpperTriangle) {
+  std::mt19937 prng;
+  ContextImpl context;
+  const Matrix m = RandomPositiveDefiniteMatrix(6, prng);
+  Matrix inverse = m;
+  inverse.triangularView<Eigen::StrictlyLower>().setConstant(1e10);
+
+  BatchedPSDMatrixInverter inverter;
+  inverter.AddMatrix(6, inverse.data());
+  inverter.Invert(&context, 1);
+
+  EXPECT_NEAR((m * inverse - Matrix::Identity(6, 6)).norm(),
+              0.0,
+              1000 * std::numeric_limits<double>::epsilon());
+}
+
+TEST(BatchedPSDMatrixInverter, NotPositiveDefiniteMatchesLLT) {
+  std::mt19937 prng;
+  ContextImpl context;
+  std::vector<Matrix> matrices;
+  for (int i = 0; i < BatchedPSDMatrixInverter::kBatchSize; ++i) {
+    matrices.push_back(RandomPositiveDefiniteMatrix(3, prng));
+  }
+  matrices[1](2, 2) = -1.0;
+
+  std::vector<Matrix> inverses = matrices;
+  BatchedPSDMatrixInverter inverter;
+  for (Matrix& inverse : inverses) {
+    inverter.AddMatrix(3, inverse.data());
+  }
+  inverter.Invert(&context, 1);
+
+  // The indefinite matrix is handled by Eigen exactly as in the unbatched
+  // code path, and does not affect the other matrices of its batch.
+  const Matrix expected =
+      matrices[1].selfadjointView<Eigen::Upper>().llt().solve(
+          Matrix::Identity(3, 3));
+  EXPECT_EQ(inverses[1], expected);
+  for (int i = 0; i < matrices.size(); ++i) {
+    if (i == 1) {
+      continue;
+    }
+    EXPECT_NEAR((matrices[i] * inverses[i] - Matrix::Identity(3, 3)).norm(),
+                0.0,
+                1000 * std::numeric_limits<double>::epsilon());
+  }
+}
+
+}  // namespace ceres::internal
@@ -0,0 +1,75 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/block_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ceres::internal {
+
+void* BlockArena::AllocateBytes(std::size_t num_bytes) {
+  if (num_bytes == 0) {
+    return nullptr;
+  }
+
+  chunks_.emplace_back(new std::byte[num_bytes]);
+  const std::byte* begin = chunks_.back().get();
+  const std::pair<const std::byte*, const std::byte*> range(begin,
+                                                            begin + num_bytes);
+  ranges_.insert(std::upper_bound(ranges_.begin(), ranges_.end(), range),
+                 range);
+  num_bytes_ += num_bytes;
+  return chunks_.back().get();
+}
+
+bool BlockArena::Contains(const void* ptr) const {
+  if (ptr == nullptr || ranges_.empty()) {
+    return false;
+  }
+
+  // Find the last chunk that starts at or before ptr.
+  const auto* p = static_cast<const std::byte*>(ptr);
+  auto it = std::upper_bound(
+      ranges_.begin(),
+      ranges_.end(),
+      p,
+      [](const std::byte* value,
+         const std::pair<const std::byte*, const std::byte*>& range) {
+        return value < range.first;
+      });
+  if (it == ranges_.begin()) {
+    return false;
+  }
+  --it;
+  return p < it->second;
+}
+
+}  // namespace ceres::internal
@@ -0,0 +1,89 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_BLOCK_ARENA_H_
+#define CERES_INTERNAL_BLOCK_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/export.h"
+
+namespace ceres::internal {
+
+// An arena for the residual and parameter blocks created in bulk by
+// ProblemImpl::AddResidualBlocks and ProblemImpl::AddParameterBlocks.
+//
+// Each call to Allocate returns a new contiguous chunk of uninitialized
+// memory. The arena does not run constructors or destructors, the caller
+// does so with placement new and explicit destructor calls. The memory of
+// a chunk is only released when the arena is destroyed, so objects that
+// are destroyed individually do not return their memory to the arena.
+//
+// Contains() tells objects living in the arena apart from objects that
+// were allocated individually with new.
+class CERES_NO_EXPORT BlockArena {
+ public:
+  BlockArena() = default;
+  BlockArena(const BlockArena&) = delete;
+  void operator=(const BlockArena&) = delete;
+
+  // Returns storage for num_objects objects of type T.
+  template <typename T>
+  T* Allocate(int num_objects) {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "BlockArena does not support over-aligned types.");
+    return static_cast<T*>(
+        AllocateBytes(static_cast<std::size_t>(num_objects) * sizeof(T)));
+  }
+
+  // Returns true if ptr points into one of the chunks returned by
+  // Allocate. The cost is logarithmic in the number of chunks.
+  bool Contains(const void* ptr) const;
+
+  int NumChunks() const { return static_cast<int>(chunks_.size()); }
+  int64_t NumBytes() const { return num_bytes_; }
+
+ private:
+  void* AllocateBytes(std::size_t num_bytes);
+
+  std::vector<std::unique_ptr<std::byte[]>> chunks_;
+  // The [begin, end) address ranges of the chunks, sorted by begin.
+  std::vector<std::pair<const std::byte*, const std::byte*>> ranges_;
+  int64_t num_bytes_ = 0;
+};
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_BLOCK_ARENA_H_
@@ -0,0 +1,74 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/block_arena.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+TEST(BlockArena, EmptyArenaContainsNothing) {
+  BlockArena arena;
+  int x = 0;
+  EXPECT_FALSE(arena.Contains(&x));
+  EXPECT_FALSE(arena.Contains(nullptr));
+  EXPECT_EQ(arena.NumChunks(), 0);
+  EXPECT_EQ(arena.NumBytes(), 0);
+}
+
+TEST(BlockArena, ZeroSizedAllocation) {
+  BlockArena arena;
+  EXPECT_EQ(arena.Allocate<double>(0), nullptr);
+  EXPECT_EQ(arena.NumChunks(), 0);
+}
+
+TEST(BlockArena, Contains) {
+  BlockArena arena;
+  double* a = arena.Allocate<double>(10);
+  int* b = arena.Allocate<int>(3);
+  double* c = arena.Allocate<double>(1);
+  EXPECT_EQ(arena.NumChunks(), 3);
+  EXPECT_EQ(arena.NumBytes(), 11 * sizeof(double) + 3 * sizeof(int));
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(arena.Contains(a + i));
+  }
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(arena.Contains(b + i));
+  }
+  EXPECT_TRUE(arena.Contains(c));
+
+  auto outside = std::make_unique<double[]>(4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FALSE(arena.Contains(outside.get() + i));
+  }
+}
+
+}  // namespace ceres::internal
@@ -0,0 +1,300 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/block_incomplete_cholesky.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "Eigen/Cholesky"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "ceres/parallel_for.h"
+
+namespace ceres::internal {
+namespace {
+
+// If IC(0) breaks down, the diagonal of the matrix is scaled by 1 + shift,
+// starting with kInitialShift and doubling it after every failure, at most
+// kMaxNumShifts times.
+constexpr double kInitialShift = 1e-3;
+constexpr int kMaxNumShifts = 10;
+
+// Groups the indices i = 0, ..., levels.size() - 1 by levels[i].
+void GroupByLevel(const std::vector<int>& levels,
+                  std::vector<int>* level_offsets,
+                  std::vector<int>* level_rows) {
+  const int num_levels =
+      levels.empty() ? 0 : *std::max_element(levels.begin(), levels.end()) + 1;
+  level_offsets->assign(num_levels + 1, 0);
+  for (int level : levels) {
+    ++(*level_offsets)[level + 1];
+  }
+  for (int l = 0; l < num_levels; ++l) {
+    (*level_offsets)[l + 1] += (*level_offsets)[l];
+  }
+
+  level_rows->resize(levels.size());
+  std::vector<int> next(level_offsets->begin(), level_offsets->end() - 1);
+  for (int i = 0; i < levels.size(); ++i) {
+    (*level_rows)[next[levels[i]]++] = i;
+  }
+}
+
+}  // namespace
+
+BlockIncompleteCholesky::BlockIncompleteCholesky(
+    const CompressedRowBlockStructure& bs,
+    ContextImpl* context,
+    int num_threads)
+    : context_(context), num_threads_(num_threads), blocks_(bs.cols) {
+  const int num_blocks = blocks_.size();
+  CHECK_EQ(bs.rows.size(), num_blocks);
+  num_rows_ = NumScalarEntries(blocks_);
+
+  int num_values = 0;
+  row_cell_offsets_.resize(num_blocks + 1);
+  row_cell_offsets_[0] = 0;
+  for (int i = 0; i < num_blocks; ++i) {
+    const CompressedRow& row = bs.rows[i];
+    CHECK_EQ(row.block.size, blocks_[i].size);
+    CHECK(!row.cells.empty());
+    CHECK_EQ(row.cells.front().block_id, i)
+        << "The diagonal block of block row " << i << " is missing.";
+    for (int c = 0; c < row.cells.size(); ++c) {
+      const Cell& cell = row.cells[c];
+      if (c > 0) {
+        CHECK_GT(cell.block_id, row.cells[c - 1].block_id);
+      }
+      cell_col_block_ids_.push_back(cell.block_id);
+      cell_row_block_ids_.push_back(i);
+      cell_positions_.push_back(cell.position);
+      const int cell_size = row.block.size * blocks_[cell.block_id].size;
+      num_values = std::max(num_values, cell.position + cell_size);
+    }
+    row_cell_offsets_[i + 1] = cell_col_block_ids_.size();
+  }
+
+  // Transpose the off-diagonal cells.
+  col_cell_offsets_.assign(num_blocks + 1, 0);
+  for (int i = 0; i < num_blocks; ++i) {
+    for (int c = row_cell_offsets_[i] + 1; c < row_cell_offsets_[i + 1]; ++c) {
+      ++col_cell_offsets_[cell_col_block_ids_[c] + 1];
+    }
+  }
+  for (int i = 0; i < num_blocks; ++i) {
+    col_cell_offsets_[i + 1] += col_cell_offsets_[i];
+  }
+  col_cell_ids_.resize(col_cell_offsets_.back());
+  std::vector<int> next(col_cell_offsets_.begin(), col_cell_offsets_.end() - 1);
+  for (int i = 0; i < num_blocks; ++i) {
+    for (int c = row_cell_offsets_[i] + 1; c < row_cell_offsets_[i + 1]; ++c) {
+      col_cell_ids_[next[cell_col_block_ids_[c]]++] = c;
+    }
+  }
+
+  // Level scheduling.
+  std::vector<int> levels(num_blocks, 0);
+  for (int i = 0; i < num_blocks; ++i) {
+    for (int t = col_cell_offsets_[i]; t < col_cell_offsets_[i + 1]; ++t) {
+      const int k = cell_row_block_ids_[col_cell_ids_[t]];
+      levels[i] = std::max(levels[i], levels[k] + 1);
+    }
+  }
+  GroupByLevel(levels, &forward_level_offsets_, &forward_level_rows_);
+
+  std::fill(levels.begin(), levels.end(), 0);
+  for (int i = num_blocks - 1; i >= 0; --i) {
+    for (int c = row_cell_offsets_[i] + 1; c < row_cell_offsets_[i + 1]; ++c) {
+      levels[i] = std::max(levels[i], levels[cell_col_block_ids_[c]] + 1);
+    }
+  }
+  GroupByLevel(levels, &backward_level_offsets_, &backward_level_rows_);
+
+  VLOG(2) << "Block incomplete Cholesky: " << num_blocks << " block rows, "
+          << num_factorization_levels() << " factorization levels.";
+
+  values_.resize(num_values);
+  tmp_.resize(num_rows_);
+}
+
+bool BlockIncompleteCholesky::FactorizeRow(int i) {
+  double* values = values_.data();
+  const int size_i = blocks_[i].size;
+  const int row_begin = row_cell_offsets_[i];
+  const int row_end = row_cell_offsets_[i + 1];
+
+  // H(i, j) - sum_k R(k, i)' R(k, j), for the cells (i, j) in the block
+  // structure of R.
+  for (int t = col_cell_offsets_[i]; t < col_cell_offsets_[i + 1]; ++t) {
+    const int ki = col_cell_ids_[t];
+    const int k = cell_row_block_ids_[ki];
+    const int size_k = blocks_[k].size;
+    ConstMatrixRef r_ki(values + cell_positions_[ki], size_k, size_i);
+
+    // Both block rows are sorted by column block, so the matching cells
+    // are found by merging them.
+    int ij = row_begin;
+    for (int kj = ki; kj < row_cell_offsets_[k + 1]; ++kj) {
+      const int j = cell_col_block_ids_[kj];
+      while (ij < row_end && cell_col_block_ids_[ij] < j) {
+        ++ij;
+      }
+      if (ij == row_end) {
+        break;
+      }
+      if (cell_col_block_ids_[ij] != j) {
+        continue;
+      }
+      const int size_j = blocks_[j].size;
+      MatrixRef h_ij(values + cell_positions_[ij], size_i, size_j);
+      h_ij.noalias() -=
+          r_ki.transpose() *
+          ConstMatrixRef(values + cell_positions_[kj], size_k, size_j);
+    }
+  }
+
+  // R(i, i) = chol(H(i, i))' and R(i, j) = R(i, i)^-T H(i, j).
+  MatrixRef r_ii(values + cell_positions_[row_begin], size_i, size_i);
+  const Eigen::LLT<Matrix> llt(r_ii);
+  if (llt.info() != Eigen::Success) {
+    return false;
+  }
+  r_ii = llt.matrixU();
+  for (int ij = row_begin + 1; ij < row_end; ++ij) {
+    MatrixRef r_ij(values + cell_positions_[ij],
+                   size_i,
+                   blocks_[cell_col_block_ids_[ij]].size);
+    llt.matrixL().solveInPlace(r_ij);
+  }
+  return true;
+}
+
+bool BlockIncompleteCholesky::Factorize(const double* values) {
+  const int num_blocks = blocks_.size();
+  const int num_levels = num_factorization_levels();
+  double shift = 0.0;
+  for (int attempt = 0; attempt <= kMaxNumShifts; ++attempt) {
+    values_ = ConstVectorRef(values, values_.size());
+    if (shift > 0.0) {
+      for (int i = 0; i < num_blocks; ++i) {
+        MatrixRef h_ii(values_.data() + cell_positions_[row_cell_offsets_[i]],
+                       blocks_[i].size,
+                       blocks_[i].size);
+        h_ii.diagonal() *= 1.0 + shift;
+      }
+    }
+
+    std::atomic<bool> success(true);
+    for (int l = 0; l < num_levels && success; ++l) {
+      ParallelFor(context_,
+                  forward_level_offsets_[l],
+                  forward_level_offsets_[l + 1],
+                  num_threads_,
+                  [this, &success](int index) {
+                    if (!FactorizeRow(forward_level_rows_[index])) {
+                      success = false;
+                    }
+                  });
+    }
+    if (success) {
+      return true;
+    }
+
+    shift = (shift == 0.0) ? kInitialShift : 2.0 * shift;
+    VLOG(2) << "Incomplete Cholesky factorization failed. Retrying with the "
+            << "diagonal scaled by " << 1.0 + shift;
+  }
+  return false;
+}
+
+void BlockIncompleteCholesky::RightMultiplyAndAccumulate(const double* x,
+                                                         double* y) const {
+  const double* values = values_.data();
+  tmp_ = ConstVectorRef(x, num_rows_);
+
+  // Forward substitution, R'z = x.
+  const int num_forward_levels = forward_level_offsets_.size() - 1;
+  for (int l = 0; l < num_forward_levels; ++l) {
+    ParallelFor(
+        context_,
+        forward_level_offsets_[l],
+        forward_level_offsets_[l + 1],
+        num_threads_,
+        [this, values](int index) {
+          const int i = forward_level_rows_[index];
+          const Block& block_i = blocks_[i];
+          auto z_i = tmp_.segment(block_i.position, block_i.size);
+          for (int t = col_cell_offsets_[i]; t < col_cell_offsets_[i + 1];
+               ++t) {
+            const int ki = col_cell_ids_[t];
+            const Block& block_k = blocks_[cell_row_block_ids_[ki]];
+            ConstMatrixRef r_ki(
+                values + cell_positions_[ki], block_k.size, block_i.size);
+            z_i.noalias() -=
+                r_ki.transpose() * tmp_.segment(block_k.position, block_k.size);
+          }
+          ConstMatrixRef r_ii(values + cell_positions_[row_cell_offsets_[i]],
+                              block_i.size,
+                              block_i.size);
+          r_ii.transpose().triangularView<Eigen::Lower>().solveInPlace(z_i);
+        });
+  }
+
+  // Backward substitution, R y = z.
+  const int num_backward_levels = backward_level_offsets_.size() - 1;
+  for (int l = 0; l < num_backward_levels; ++l) {
+    ParallelFor(
+        context_,
+        backward_level_offsets_[l],
+        backward_level_offsets_[l + 1],
+        num_threads_,
+        [this, values](int index) {
+          const int i = backward_level_rows_[index];
+          const Block& block_i = blocks_[i];
+          auto y_i = tmp_.segment(block_i.position, block_i.size);
+          for (int ij = row_cell_offsets_[i] + 1; ij < row_cell_offsets_[i + 1];
+               ++ij) {
+            const Block& block_j = blocks_[cell_col_block_ids_[ij]];
+            ConstMatrixRef r_ij(
+                values + cell_positions_[ij], block_i.size, block_j.size);
+            y_i.noalias() -=
+                r_ij * tmp_.segment(block_j.position, block_j.size);
+          }
+          ConstMatrixRef r_ii(values + cell_positions_[row_cell_offsets_[i]],
+                              block_i.size,
+                              block_i.size);
+          r_ii.triangularView<Eigen::Upper>().solveInPlace(y_i);
+        });
+  }
+
+  VectorRef(y, num_rows_) += tmp_;
+}
+
+}  // namespace ceres::internal
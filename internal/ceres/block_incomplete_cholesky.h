@@ -0,0 +1,131 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_BLOCK_INCOMPLETE_CHOLESKY_H_
+#define CERES_INTERNAL_BLOCK_INCOMPLETE_CHOLESKY_H_
+
+#include <vector>
+
+#include "ceres/block_structure.h"
+#include "ceres/context_impl.h"
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/internal/export.h"
+
+namespace ceres::internal {
+
+// Block incomplete Cholesky factorization with zero fill-in, IC(0), of a
+// symmetric positive definite block sparse matrix H, i.e.,
+//
+//   H ~ R'R,
+//
+// where R is block upper triangular and has the same block sparsity
+// structure as the upper triangle of H. Entries of the exact Cholesky
+// factor outside of this structure are dropped.
+//
+// IC(0) can break down even if H is positive definite. If it does, the
+// factorization is retried with an increasing multiple of the diagonal of
+// H added to H, see
+//
+//   T.A. Manteuffel, An incomplete factorization technique for positive
+//   definite linear systems, Mathematics of Computation 34(150), 473-497,
+//   1980.
+//
+// Both the factorization and the triangular solves are parallelized using
+// level scheduling. The block rows of R are grouped into levels, such that
+// each block row only depends on the block rows in the previous levels, and
+// the block rows in a level are processed in parallel. The number of levels
+// depends on the sparsity structure of H, e.g., a block tridiagonal H has as
+// many levels as block rows, while a block diagonal H has one.
+class CERES_NO_EXPORT BlockIncompleteCholesky {
+ public:
+  // bs is the block structure of the upper triangle of H, i.e., a square
+  // block sparse matrix whose row and column blocks are the same, and whose
+  // block row i consists of the cells (i, j), j >= i, sorted by j. The
+  // diagonal cells must be present.
+  BlockIncompleteCholesky(const CompressedRowBlockStructure& bs,
+                          ContextImpl* context,
+                          int num_threads);
+
+  // Computes the factorization of the matrix with the block structure
+  // passed to the constructor, and values laid out as in a
+  // BlockSparseMatrix with that block structure. Returns false if the
+  // factorization fails even after shifting the diagonal.
+  bool Factorize(const double* values);
+
+  // y += (R'R)^-1 x.
+  void RightMultiplyAndAccumulate(const double* x, double* y) const;
+
+  int num_rows() const { return num_rows_; }
+  int num_factorization_levels() const {
+    return static_cast<int>(forward_level_offsets_.size()) - 1;
+  }
+
+ private:
+  // Computes the block row i of R. Returns false if the diagonal block is
+  // not positive definite.
+  bool FactorizeRow(int i);
+
+  ContextImpl* context_ = nullptr;
+  const int num_threads_ = 1;
+  int num_rows_ = 0;
+  std::vector<Block> blocks_;
+
+  // The cells of block row i of R are [row_cell_offsets_[i],
+  // row_cell_offsets_[i + 1]), sorted by column block. The first one is the
+  // diagonal block.
+  std::vector<int> row_cell_offsets_;
+  std::vector<int> cell_col_block_ids_;
+  std::vector<int> cell_positions_;
+
+  // The cells (k, i), k < i, of block column i of R are
+  // col_cell_ids_[col_cell_offsets_[i], col_cell_offsets_[i + 1]), sorted
+  // by k.
+  std::vector<int> col_cell_offsets_;
+  std::vector<int> col_cell_ids_;
+  std::vector<int> cell_row_block_ids_;
+
+  // The block rows in level l of the factorization and the forward
+  // substitution are forward_level_rows_[forward_level_offsets_[l],
+  // forward_level_offsets_[l + 1]). Block row i depends on the block rows k
+  // with R(k, i) != 0. Similarly for the backward substitution, where block
+  // row i depends on the block rows j with R(i, j) != 0.
+  std::vector<int> forward_level_offsets_;
+  std::vector<int> forward_level_rows_;
+  std::vector<int> backward_level_offsets_;
+  std::vector<int> backward_level_rows_;
+
+  Vector values_;
+  mutable Vector tmp_;
+};
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_BLOCK_INCOMPLETE_CHOLESKY_H_
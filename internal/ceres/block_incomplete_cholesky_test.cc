@@ -0,0 +1,202 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/block_incomplete_cholesky.h"
+
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "ceres/block_random_access_sparse_matrix.h"
+#include "ceres/block_sparse_matrix.h"
+#include "ceres/context_impl.h"
+#include "ceres/internal/eigen.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+constexpr int kNumThreads = 4;
+
+class BlockIncompleteCholeskyTest : public ::testing::Test {
+ protected:
+  void SetUp() final { context_.EnsureMinimumThreads(kNumThreads); }
+
+  // Creates a random symmetric positive definite matrix with the given block
+  // sizes, whose upper triangle has non-zero cells exactly at block_pairs.
+  // The diagonal cells must be included.
+  void CreateMatrix(const std::vector<int>& block_sizes,
+                    const std::set<std::pair<int, int>>& block_pairs) {
+    int position = 0;
+    for (int size : block_sizes) {
+      blocks_.emplace_back(size, position);
+      position += size;
+    }
+    const int num_rows = position;
+
+    std::mt19937 prng;
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    dense_ = Matrix::Zero(num_rows, num_rows);
+    for (const auto& [i, j] : block_pairs) {
+      for (int r = 0; r < blocks_[i].size; ++r) {
+        for (int c = 0; c < blocks_[j].size; ++c) {
+          const double value = distribution(prng);
+          dense_(blocks_[i].position + r, blocks_[j].position + c) = value;
+          dense_(blocks_[j].position + c, blocks_[i].position + r) = value;
+        }
+      }
+    }
+    // Make the matrix diagonally dominant.
+    dense_.diagonal() =
+        dense_.cwiseAbs().rowwise().sum() + Vector::Ones(num_rows);
+
+    m_ = std::make_unique<BlockRandomAccessSparseMatrix>(
+        blocks_, block_pairs, &context_, kNumThreads);
+    for (const auto& [i, j] : block_pairs) {
+      int row, col, row_stride, col_stride;
+      CellInfo* cell = m_->GetCell(i, j, &row, &col, &row_stride, &col_stride);
+      MatrixRef(cell->values, row_stride, col_stride)
+          .block(row, col, blocks_[i].size, blocks_[j].size) =
+          dense_.block(blocks_[i].position,
+                       blocks_[j].position,
+                       blocks_[i].size,
+                       blocks_[j].size);
+    }
+  }
+
+  Matrix PreconditionerToDenseMatrix(const BlockIncompleteCholesky& ic) {
+    const int num_rows = ic.num_rows();
+    Matrix result = Matrix::Zero(num_rows, num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+      const Vector x = Vector::Unit(num_rows, i);
+      Vector y = Vector::Zero(num_rows);
+      ic.RightMultiplyAndAccumulate(x.data(), y.data());
+      result.col(i) = y;
+    }
+    return result;
+  }
+
+  ContextImpl context_;
+  std::vector<Block> blocks_;
+  Matrix dense_;
+  std::unique_ptr<BlockRandomAccessSparseMatrix> m_;
+};
+
+// If the upper triangle is dense, there is nothing to drop and the
+// factorization is exact.
+TEST_F(BlockIncompleteCholeskyTest, DenseMatrixIsFactorizedExactly) {
+  const std::vector<int> block_sizes = {2, 3, 1, 4, 2};
+  std::set<std::pair<int, int>> block_pairs;
+  for (int i = 0; i < block_sizes.size(); ++i) {
+    for (int j = i; j < block_sizes.size(); ++j) {
+      block_pairs.emplace(i, j);
+    }
+  }
+  CreateMatrix(block_sizes, block_pairs);
+
+  BlockIncompleteCholesky ic(
+      *m_->matrix()->block_structure(), &context_, kNumThreads);
+  ASSERT_TRUE(ic.Factorize(m_->matrix()->values()));
+  EXPECT_EQ(ic.num_factorization_levels(), block_sizes.size());
+  const Matrix expected = dense_.inverse();
+  EXPECT_LE((PreconditionerToDenseMatrix(ic) - expected).norm(),
+            1e-12 * expected.norm());
+}
+
+// The Cholesky factor of a block tridiagonal matrix has no fill-in either.
+TEST_F(BlockIncompleteCholeskyTest, BlockTridiagonalMatrixIsFactorizedExactly) {
+  const std::vector<int> block_sizes(20, 3);
+  std::set<std::pair<int, int>> block_pairs;
+  for (int i = 0; i < block_sizes.size(); ++i) {
+    block_pairs.emplace(i, i);
+    if (i + 1 < block_sizes.size()) {
+      block_pairs.emplace(i, i + 1);
+    }
+  }
+  CreateMatrix(block_sizes, block_pairs);
+
+  BlockIncompleteCholesky ic(
+      *m_->matrix()->block_structure(), &context_, kNumThreads);
+  ASSERT_TRUE(ic.Factorize(m_->matrix()->values()));
+  const Matrix expected = dense_.inverse();
+  EXPECT_LE((PreconditionerToDenseMatrix(ic) - expected).norm(),
+            1e-12 * expected.norm());
+}
+
+// Without any coupling between the blocks, all block rows are in one level
+// and the factorization is block Jacobi.
+TEST_F(BlockIncompleteCholeskyTest, BlockDiagonalMatrixHasOneLevel) {
+  const std::vector<int> block_sizes(50, 2);
+  std::set<std::pair<int, int>> block_pairs;
+  for (int i = 0; i < block_sizes.size(); ++i) {
+    block_pairs.emplace(i, i);
+  }
+  CreateMatrix(block_sizes, block_pairs);
+
+  BlockIncompleteCholesky ic(
+      *m_->matrix()->block_structure(), &context_, kNumThreads);
+  ASSERT_TRUE(ic.Factorize(m_->matrix()->values()));
+  EXPECT_EQ(ic.num_factorization_levels(), 1);
+  const Matrix expected = dense_.inverse();
+  EXPECT_LE((PreconditionerToDenseMatrix(ic) - expected).norm(),
+            1e-12 * expected.norm());
+}
+
+// With fill-in, R'R matches H on the sparsity structure of H.
+TEST_F(BlockIncompleteCholeskyTest, MatchesMatrixOnSparsityStructure) {
+  const std::vector<int> block_sizes = {2, 3, 2, 3, 2, 3};
+  const std::set<std::pair<int, int>> block_pairs = {
+      {0, 0}, {0, 2}, {0, 4}, {1, 1}, {1, 3}, {1, 5}, {2, 2},
+      {2, 3}, {3, 3}, {3, 4}, {4, 4}, {4, 5}, {5, 5}};
+  CreateMatrix(block_sizes, block_pairs);
+
+  BlockIncompleteCholesky ic(
+      *m_->matrix()->block_structure(), &context_, kNumThreads);
+  ASSERT_TRUE(ic.Factorize(m_->matrix()->values()));
+  const Matrix approximation = PreconditionerToDenseMatrix(ic).inverse();
+  for (const auto& [i, j] : block_pairs) {
+    const Matrix difference =
+        approximation.block(blocks_[i].position,
+                            blocks_[j].position,
+                            blocks_[i].size,
+                            blocks_[j].size) -
+        dense_.block(blocks_[i].position,
+                     blocks_[j].position,
+                     blocks_[i].size,
+                     blocks_[j].size);
+    EXPECT_LE(difference.norm(), 1e-10 * dense_.norm())
+        << "Block (" << i << ", " << j << ")";
+  }
+  // The approximation is not exact, since the factorization drops the
+  // fill-in.
+  EXPECT_GT((approximation - dense_).norm(), 1e-6 * dense_.norm());
+}
+
+}  // namespace ceres::internal
@@ -47,19 +47,81 @@
 
 namespace ceres::internal {
 
+namespace {
+
+// m += A'A for a cell A of a block sparse matrix.
+void AddCellTransposeCell(const double* values,
+                          int row_block_size,
+                          int col_block_size,
+                          double* m,
+                          int r,
+                          int c,
+                          int row_stride,
+                          int col_stride) {
+  // clang-format off
+  MatrixTransposeMatrixMultiply<Eigen::Dynamic, Eigen::Dynamic,
+      Eigen::Dynamic,Eigen::Dynamic, 1>(
+          values, row_block_size,col_block_size,
+          values, row_block_size,col_block_size,
+          m,r, c,row_stride,col_stride);
+  // clang-format on
+}
+
+// The single precision values are converted to double precision before
+// the product is computed.
+void AddCellTransposeCell(const float* values,
+                          int row_block_size,
+                          int col_block_size,
+                          double* m,
+                          int r,
+                          int c,
+                          int row_stride,
+                          int col_stride) {
+  const Matrix a =
+      Eigen::Map<const Eigen::Matrix<float,
+                                     Eigen::Dynamic,
+                                     Eigen::Dynamic,
+                                     Eigen::RowMajor>>(
+          values, row_block_size, col_block_size)
+          .cast<double>();
+  MatrixRef(m, row_stride, col_stride)
+      .block(r, c, col_block_size, col_block_size)
+      .noalias() += a.transpose() * a;
+}
+
+}  // namespace
+
 BlockSparseJacobiPreconditioner::BlockSparseJacobiPreconditioner(
     Preconditioner::Options options, const BlockSparseMatrix& A)
-    : options_(std::move(options)) {
+    : options_(std::move(options)), single_precision_(false) {
+  m_ = std::make_unique<BlockRandomAccessDiagonalMatrix>(
+      A.block_structure()->cols, options_.context, options_.num_threads);
+}
+
+BlockSparseJacobiPreconditioner::BlockSparseJacobiPreconditioner(
+    Preconditioner::Options options, const FloatBlockSparseMatrix& A)
+    : options_(std::move(options)), single_precision_(true) {
   m_ = std::make_unique<BlockRandomAccessDiagonalMatrix>(
       A.block_structure()->cols, options_.context, options_.num_threads);
 }
 
 BlockSparseJacobiPreconditioner::~BlockSparseJacobiPreconditioner() = default;
 
-bool BlockSparseJacobiPreconditioner::UpdateImpl(const BlockSparseMatrix& A,
+bool BlockSparseJacobiPreconditioner::UpdateImpl(const SparseMatrix& A,
                                                  const double* D) {
-  const CompressedRowBlockStructure* bs = A.block_structure();
-  const double* values = A.values();
+  if (single_precision_) {
+    const auto& float_A = *down_cast<const FloatBlockSparseMatrix*>(&A);
+    UpdateImpl(float_A.block_structure(), float_A.float_values(), D);
+  } else {
+    const auto& block_A = *down_cast<const BlockSparseMatrix*>(&A);
+    UpdateImpl(block_A.block_structure(), block_A.values(), D);
+  }
+  return true;
+}
+
+template <typename T>
+void BlockSparseJacobiPreconditioner::UpdateImpl(
+    const CompressedRowBlockStructure* bs, const T* values, const double* D) {
   m_->SetZero();
 
   ParallelFor(options_.context,
@@ -75,18 +137,16 @@ bool BlockSparseJacobiPreconditioner::UpdateImpl(const BlockSparseMatrix& A,
                   int r, c, row_stride, col_stride;
                   CellInfo* cell_info = m_->GetCell(
                       block_id, block_id, &r, &c, &row_stride, &col_stride);
-                  MatrixRef m(cell_info->values, row_stride, col_stride);
-                  ConstMatrixRef b(
-                      values + cell.position, row_block_size, col_block_size);
                   auto lock =
                       MakeConditionalLock(options_.num_threads, cell_info->m);
-                  // clang-format off
-                  MatrixTransposeMatrixMultiply<Eigen::Dynamic, Eigen::Dynamic,
-                      Eigen::Dynamic,Eigen::Dynamic, 1>(
-                          values + cell.position, row_block_size,col_block_size,
-                          values + cell.position, row_block_size,col_block_size,
-                          cell_info->values,r, c,row_stride,col_stride);
-                  // clang-format on
+                  AddCellTransposeCell(values + cell.position,
+                                       row_block_size,
+                                       col_block_size,
+                                       cell_info->values,
+                                       r,
+                                       c,
+                                       row_stride,
+                                       col_stride);
                 }
               });
 
@@ -111,7 +171,6 @@ bool BlockSparseJacobiPreconditioner::UpdateImpl(const BlockSparseMatrix& A,
   }
 
   m_->Invert();
-  return true;
 }
 
 BlockCRSJacobiPreconditioner::BlockCRSJacobiPreconditioner(
@@ -152,6 +211,11 @@ BlockCRSJacobiPreconditioner::BlockCRSJacobiPreconditioner(
   std::vector<std::mutex> locks(A.num_cols());
   locks_.swap(locks);
   CHECK_EQ(m_rows[A.num_cols()], m_nnz);
+
+  double* m_values = m_->mutable_values();
+  for (auto& block : col_blocks) {
+    inverter_.AddMatrix(block.size, m_values + m_rows[block.position]);
+  }
 }
 
 BlockCRSJacobiPreconditioner::~BlockCRSJacobiPreconditioner() = default;
@@ -201,26 +265,24 @@ bool BlockCRSJacobiPreconditioner::UpdateImpl(
         }
       });
 
-  ParallelFor(
-      options_.context,
-      0,
-      num_col_blocks,
-      options_.num_threads,
-      [col_blocks, m_rows, m_values, D](int i) {
-        const int col = col_blocks[i].position;
-        const int col_block_size = col_blocks[i].size;
-        MatrixRef m(m_values + m_rows[col], col_block_size, col_block_size);
-
-        if (D != nullptr) {
+  if (D != nullptr) {
+    ParallelFor(
+        options_.context,
+        0,
+        num_col_blocks,
+        options_.num_threads,
+        [col_blocks, m_rows, m_values, D](int i) {
+          const int col = col_blocks[i].position;
+          const int col_block_size = col_blocks[i].size;
+          MatrixRef m(m_values + m_rows[col], col_block_size, col_block_size);
           m.diagonal() +=
               ConstVectorRef(D + col, col_block_size).array().square().matrix();
-        }
-
-        // TODO(sameeragarwal): Deal with Cholesky inversion failure here and
-        // elsewhere.
-        m = m.llt().solve(Matrix::Identity(col_block_size, col_block_size));
-      });
+        });
+  }
 
+  // TODO(sameeragarwal): Deal with Cholesky inversion failure here and
+  // elsewhere.
+  inverter_.Invert(options_.context, options_.num_threads);
   return true;
 }
 
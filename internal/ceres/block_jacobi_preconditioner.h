@@ -33,6 +33,7 @@
 
 #include <memory>
 
+#include "ceres/batched_psd_matrix_inverter.h"
 #include "ceres/block_random_access_diagonal_matrix.h"
 #include "ceres/internal/disable_warnings.h"
 #include "ceres/internal/export.h"
@@ -42,22 +43,27 @@ namespace ceres::internal {
 
 class BlockSparseMatrix;
 class CompressedRowSparseMatrix;
+class FloatBlockSparseMatrix;
 
 // A block Jacobi preconditioner. This is intended for use with
 // conjugate gradients, or other iterative symmetric solvers.
 
 // This version of the preconditioner is for use with BlockSparseMatrix
-// Jacobians.
+// Jacobians, and with FloatBlockSparseMatrix Jacobians, whose products are
+// accumulated in double precision.
 //
 // TODO(https://github.com/ceres-solver/ceres-solver/issues/936):
 // BlockSparseJacobiPreconditioner::RightMultiply will benefit from
 // multithreading
 class CERES_NO_EXPORT BlockSparseJacobiPreconditioner
-    : public BlockSparseMatrixPreconditioner {
+    : public SparseMatrixPreconditioner {
  public:
-  // A must remain valid while the BlockJacobiPreconditioner is.
+  // A must remain valid while the BlockJacobiPreconditioner is. The
+  // preconditioner must be updated with matrices of the same type as A.
   explicit BlockSparseJacobiPreconditioner(Preconditioner::Options,
                                            const BlockSparseMatrix& A);
+  explicit BlockSparseJacobiPreconditioner(Preconditioner::Options,
+                                           const FloatBlockSparseMatrix& A);
   ~BlockSparseJacobiPreconditioner() override;
   void RightMultiplyAndAccumulate(const double* x, double* y) const final {
     return m_->RightMultiplyAndAccumulate(x, y);
@@ -67,9 +73,14 @@ class CERES_NO_EXPORT BlockSparseJacobiPreconditioner
   const BlockRandomAccessDiagonalMatrix& matrix() const { return *m_; }
 
  private:
-  bool UpdateImpl(const BlockSparseMatrix& A, const double* D) final;
+  bool UpdateImpl(const SparseMatrix& A, const double* D) final;
+  template <typename T>
+  void UpdateImpl(const CompressedRowBlockStructure* bs,
+                  const T* values,
+                  const double* D);
 
   Preconditioner::Options options_;
+  const bool single_precision_;
   std::unique_ptr<BlockRandomAccessDiagonalMatrix> m_;
 };
 
@@ -95,6 +106,7 @@ class CERES_NO_EXPORT BlockCRSJacobiPreconditioner
   Preconditioner::Options options_;
   std::vector<std::mutex> locks_;
   std::unique_ptr<CompressedRowSparseMatrix> m_;
+  BatchedPSDMatrixInverter inverter_;
 };
 
 }  // namespace ceres::internal
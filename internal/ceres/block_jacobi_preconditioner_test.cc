@@ -95,6 +95,46 @@ TEST(BlockSparseJacobiPreconditioner, _) {
   }
 }
 
+// A single precision Jacobian gives the same preconditioner as its double
+// precision counterpart after rounding.
+TEST(BlockSparseJacobiPreconditioner, SinglePrecisionJacobian) {
+  BlockSparseMatrix::RandomMatrixOptions options;
+  options.num_col_blocks = 5;
+  options.min_col_block_size = 1;
+  options.max_col_block_size = 3;
+  options.num_row_blocks = 10;
+  options.min_row_block_size = 1;
+  options.max_row_block_size = 4;
+  options.block_density = 0.25;
+  std::mt19937 prng;
+
+  Preconditioner::Options preconditioner_options;
+  ContextImpl context;
+  preconditioner_options.context = &context;
+
+  auto jacobian = BlockSparseMatrix::CreateRandomMatrix(options, prng);
+  for (int i = 0; i < jacobian->num_nonzeros(); ++i) {
+    jacobian->mutable_values()[i] =
+        static_cast<float>(jacobian->values()[i]);
+  }
+  FloatBlockSparseMatrix float_jacobian(*jacobian);
+  float_jacobian.UpdateValues(*jacobian, &context, 1);
+  const Vector diagonal = Vector::Ones(jacobian->num_cols());
+
+  BlockSparseJacobiPreconditioner expected(preconditioner_options, *jacobian);
+  expected.Update(*jacobian, diagonal.data());
+  BlockSparseJacobiPreconditioner actual(preconditioner_options,
+                                         float_jacobian);
+  actual.Update(float_jacobian, diagonal.data());
+
+  const Vector x = Vector::Random(jacobian->num_cols());
+  Vector expected_y = Vector::Zero(jacobian->num_cols());
+  Vector actual_y = Vector::Zero(jacobian->num_cols());
+  expected.RightMultiplyAndAccumulate(x.data(), expected_y.data());
+  actual.RightMultiplyAndAccumulate(x.data(), actual_y.data());
+  EXPECT_LT((actual_y - expected_y).norm(), 1e-12 * expected_y.norm());
+}
+
 TEST(CompressedRowSparseJacobiPreconditioner, _) {
   constexpr int kNumtrials = 10;
   CompressedRowSparseMatrix::RandomMatrixOptions options;
@@ -31,18 +31,25 @@
 #include "ceres/block_jacobian_writer.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "ceres/block_evaluate_preparer.h"
 #include "ceres/block_sparse_matrix.h"
+#include "ceres/casts.h"
 #include "ceres/internal/eigen.h"
 #include "ceres/internal/export.h"
+#include "ceres/parallel_for.h"
 #include "ceres/parameter_block.h"
 #include "ceres/program.h"
 #include "ceres/residual_block.h"
+#include "ceres/scratch_evaluate_preparer.h"
 
 namespace ceres::internal {
 
@@ -63,106 +70,143 @@ namespace {
 // increasing column-block id (with cells corresponding to E sub-matrix stored
 // separately).
 //
+// The layout is computed in three passes. First, the number of jacobian
+// blocks and the sizes of the E and F cells of each residual block are
+// computed in parallel. Their prefix sums then give the position of the
+// cells of each residual block, which are filled in parallel.
+//
 // TODO(keir): Consider if we should use a boolean for each parameter block
 // instead of num_eliminate_blocks.
 bool BuildJacobianLayout(const Program& program,
                          int num_eliminate_blocks,
+                         ContextImpl* context,
+                         int num_threads,
                          std::vector<int*>* jacobian_layout,
                          std::vector<int>* jacobian_layout_storage) {
   const std::vector<ResidualBlock*>& residual_blocks =
       program.residual_blocks();
+  const int num_residual_blocks = residual_blocks.size();
 
-  // Iterate over all the active residual blocks and determine how many E blocks
-  // are there. This will determine where the F blocks start in the jacobian
-  // matrix. Also compute the number of jacobian blocks.
-  unsigned int f_block_pos = 0;
-  unsigned int num_jacobian_blocks = 0;
-  for (auto* residual_block : residual_blocks) {
-    const int num_residuals = residual_block->NumResiduals();
-    const int num_parameter_blocks = residual_block->NumParameterBlocks();
-
-    // Advance f_block_pos over each E block for this residual.
-    for (int j = 0; j < num_parameter_blocks; ++j) {
-      ParameterBlock* parameter_block = residual_block->parameter_blocks()[j];
-      if (!parameter_block->IsConstant()) {
-        // Only count blocks for active parameters.
-        num_jacobian_blocks++;
-        if (parameter_block->index() < num_eliminate_blocks) {
-          f_block_pos += num_residuals * parameter_block->TangentSize();
-        }
-      }
-    }
-    if (num_jacobian_blocks > std::numeric_limits<int>::max()) {
-      LOG(ERROR) << "Overflow error. Too many blocks in the jacobian matrix : "
-                 << num_jacobian_blocks;
-      return false;
-    }
-  }
-
-  // We now know that the E blocks are laid out starting at zero, and the F
-  // blocks are laid out starting at f_block_pos. Iterate over the residual
-  // blocks again, and this time fill the jacobian_layout array with the
-  // position information.
-
-  jacobian_layout->resize(program.NumResidualBlocks());
-  jacobian_layout_storage->resize(num_jacobian_blocks);
-
-  int e_block_pos = 0;
-  int* jacobian_pos = jacobian_layout_storage->data();
-  std::vector<std::pair<int, int>> active_parameter_blocks;
-  for (int i = 0; i < residual_blocks.size(); ++i) {
+  // For each active residual block determine the number of jacobian
+  // blocks, and the sizes of its cells in the E and F sub-matrices.
+  // Entry i + 1 of these arrays corresponds to residual block i, so that
+  // the prefix sums below give the starting position of each residual
+  // block.
+  std::vector<int64_t> num_jacobian_blocks(num_residual_blocks + 1, 0);
+  std::vector<int64_t> e_block_sizes(num_residual_blocks + 1, 0);
+  std::vector<int64_t> f_block_sizes(num_residual_blocks + 1, 0);
+  ParallelFor(context, 0, num_residual_blocks, num_threads, [&](int i) {
     const ResidualBlock* residual_block = residual_blocks[i];
     const int num_residuals = residual_block->NumResiduals();
     const int num_parameter_blocks = residual_block->NumParameterBlocks();
-
-    (*jacobian_layout)[i] = jacobian_pos;
-    // Cells from F sub-matrix are to be stored sequentially with increasing
-    // column block id. For each non-constant parameter block, a pair of indices
-    // (index in the list of active parameter blocks and index in the list of
-    // all parameter blocks) is computed, and index pairs are sorted by the
-    // index of corresponding column block id.
-    active_parameter_blocks.clear();
-    active_parameter_blocks.reserve(num_parameter_blocks);
     for (int j = 0; j < num_parameter_blocks; ++j) {
       ParameterBlock* parameter_block = residual_block->parameter_blocks()[j];
+      // Only count blocks for active parameters.
       if (parameter_block->IsConstant()) {
         continue;
       }
-      const int k = active_parameter_blocks.size();
-      active_parameter_blocks.emplace_back(k, j);
-    }
-    std::sort(active_parameter_blocks.begin(),
-              active_parameter_blocks.end(),
-              [&residual_block](const std::pair<int, int>& a,
-                                const std::pair<int, int>& b) {
-                return residual_block->parameter_blocks()[a.second]->index() <
-                       residual_block->parameter_blocks()[b.second]->index();
-              });
-    // Cell positions for each active parameter block are filled in the order of
-    // active parameter block indices sorted by columnd block index. This
-    // guarantees that cells are laid out sequentially with increasing column
-    // block indices.
-    for (const auto& indices : active_parameter_blocks) {
-      const auto [k, j] = indices;
-      ParameterBlock* parameter_block = residual_block->parameter_blocks()[j];
-      const int parameter_block_index = parameter_block->index();
-      const int jacobian_block_size =
-          num_residuals * parameter_block->TangentSize();
-      if (parameter_block_index < num_eliminate_blocks) {
-        jacobian_pos[k] = e_block_pos;
-        e_block_pos += jacobian_block_size;
+      ++num_jacobian_blocks[i + 1];
+      const int64_t jacobian_block_size =
+          static_cast<int64_t>(num_residuals) * parameter_block->TangentSize();
+      if (parameter_block->index() < num_eliminate_blocks) {
+        e_block_sizes[i + 1] += jacobian_block_size;
       } else {
-        jacobian_pos[k] = static_cast<int>(f_block_pos);
-        f_block_pos += jacobian_block_size;
-        if (f_block_pos > std::numeric_limits<int>::max()) {
-          LOG(ERROR)
-              << "Overflow error. Too many entries in the Jacobian matrix.";
-          return false;
-        }
+        f_block_sizes[i + 1] += jacobian_block_size;
       }
     }
-    jacobian_pos += active_parameter_blocks.size();
+  });
+
+  std::partial_sum(num_jacobian_blocks.begin(),
+                   num_jacobian_blocks.end(),
+                   num_jacobian_blocks.begin());
+  if (num_jacobian_blocks.back() > std::numeric_limits<int>::max()) {
+    LOG(ERROR) << "Overflow error. Too many blocks in the jacobian matrix : "
+               << num_jacobian_blocks.back();
+    return false;
+  }
+
+  // The E blocks are laid out starting at zero, and the F blocks are laid
+  // out after all the E blocks.
+  std::partial_sum(
+      e_block_sizes.begin(), e_block_sizes.end(), e_block_sizes.begin());
+  f_block_sizes[0] = e_block_sizes.back();
+  std::partial_sum(
+      f_block_sizes.begin(), f_block_sizes.end(), f_block_sizes.begin());
+  if (f_block_sizes.back() > std::numeric_limits<int>::max()) {
+    LOG(ERROR) << "Overflow error. Too many entries in the Jacobian matrix.";
+    return false;
   }
+
+  jacobian_layout->resize(num_residual_blocks);
+  jacobian_layout_storage->resize(num_jacobian_blocks.back());
+
+  // Scratch space for the indices of the active parameter blocks of a
+  // residual block, one per thread.
+  std::vector<std::vector<std::pair<int, int>>> active_parameter_blocks(
+      num_threads);
+  ParallelFor(
+      context,
+      0,
+      num_residual_blocks,
+      num_threads,
+      [&](int thread_id, int i) {
+        const ResidualBlock* residual_block = residual_blocks[i];
+        const int num_residuals = residual_block->NumResiduals();
+        const int num_parameter_blocks = residual_block->NumParameterBlocks();
+
+        int* jacobian_pos =
+            jacobian_layout_storage->data() + num_jacobian_blocks[i];
+        (*jacobian_layout)[i] = jacobian_pos;
+        int e_block_pos = static_cast<int>(e_block_sizes[i]);
+        int f_block_pos = static_cast<int>(f_block_sizes[i]);
+
+        // Cells from F sub-matrix are to be stored sequentially with
+        // increasing column block id. For each non-constant parameter
+        // block, a pair of indices (index in the list of active parameter
+        // blocks and index in the list of all parameter blocks) is
+        // computed, and index pairs are sorted by the index of
+        // corresponding column block id.
+        std::vector<std::pair<int, int>>& active =
+            active_parameter_blocks[thread_id];
+        active.clear();
+        active.reserve(num_parameter_blocks);
+        for (int j = 0; j < num_parameter_blocks; ++j) {
+          ParameterBlock* parameter_block =
+              residual_block->parameter_blocks()[j];
+          if (parameter_block->IsConstant()) {
+            continue;
+          }
+          const int k = active.size();
+          active.emplace_back(k, j);
+        }
+        std::sort(active.begin(),
+                  active.end(),
+                  [&residual_block](const std::pair<int, int>& a,
+                                    const std::pair<int, int>& b) {
+                    return residual_block->parameter_blocks()[a.second]
+                               ->index() <
+                           residual_block->parameter_blocks()[b.second]
+                               ->index();
+                  });
+        // Cell positions for each active parameter block are filled in the
+        // order of active parameter block indices sorted by columnd block
+        // index. This guarantees that cells are laid out sequentially with
+        // increasing column block indices.
+        for (const auto& indices : active) {
+          const auto [k, j] = indices;
+          ParameterBlock* parameter_block =
+              residual_block->parameter_blocks()[j];
+          const int jacobian_block_size =
+              num_residuals * parameter_block->TangentSize();
+          if (parameter_block->index() < num_eliminate_blocks) {
+            jacobian_pos[k] = e_block_pos;
+            e_block_pos += jacobian_block_size;
+          } else {
+            jacobian_pos[k] = f_block_pos;
+            f_block_pos += jacobian_block_size;
+          }
+        }
+      });
   return true;
 }
 
@@ -176,6 +220,8 @@ BlockJacobianWriter::BlockJacobianWriter(const Evaluator::Options& options,
 
   jacobian_layout_is_valid_ = BuildJacobianLayout(*program,
                                                   options.num_eliminate_blocks,
+                                                  options.context,
+                                                  options.num_threads,
                                                   &jacobian_layout_,
                                                   &jacobian_layout_storage_);
 }
@@ -196,6 +242,16 @@ BlockJacobianWriter::CreateEvaluatePreparers(unsigned num_threads) {
 }
 
 std::unique_ptr<SparseMatrix> BlockJacobianWriter::CreateJacobian() const {
+  CompressedRowBlockStructure* bs = CreateBlockStructure();
+  if (bs == nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<BlockSparseMatrix>(
+      bs, options_.sparse_linear_algebra_library_type == CUDA_SPARSE);
+}
+
+CompressedRowBlockStructure* BlockJacobianWriter::CreateBlockStructure()
+    const {
   if (!jacobian_layout_is_valid_) {
     LOG(ERROR) << "Unable to create Jacobian matrix. Too many entries in the "
                   "Jacobian matrix.";
@@ -258,8 +314,56 @@ std::unique_ptr<SparseMatrix> BlockJacobianWriter::CreateJacobian() const {
     std::sort(row->cells.begin(), row->cells.end(), CellLessThan);
   }
 
-  return std::make_unique<BlockSparseMatrix>(
-      bs, options_.sparse_linear_algebra_library_type == CUDA_SPARSE);
+  return bs;
+}
+
+FloatBlockJacobianWriter::FloatBlockJacobianWriter(
+    const Evaluator::Options& options, Program* program)
+    : program_(program), block_jacobian_writer_(options, program) {}
+
+std::unique_ptr<ScratchEvaluatePreparer[]>
+FloatBlockJacobianWriter::CreateEvaluatePreparers(unsigned num_threads) {
+  return ScratchEvaluatePreparer::Create(*program_, num_threads);
+}
+
+std::unique_ptr<SparseMatrix> FloatBlockJacobianWriter::CreateJacobian()
+    const {
+  CompressedRowBlockStructure* bs =
+      block_jacobian_writer_.CreateBlockStructure();
+  if (bs == nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<FloatBlockSparseMatrix>(bs);
+}
+
+void FloatBlockJacobianWriter::Write(int residual_id,
+                                     int /* residual_offset */,
+                                     double** jacobians,
+                                     SparseMatrix* base_jacobian) {
+  auto* jacobian = down_cast<FloatBlockSparseMatrix*>(base_jacobian);
+  float* values = jacobian->mutable_float_values();
+  const int* jacobian_layout =
+      block_jacobian_writer_.jacobian_layout(residual_id);
+
+  const ResidualBlock* residual_block =
+      program_->residual_blocks()[residual_id];
+  const int num_residuals = residual_block->NumResiduals();
+  const int num_parameter_blocks = residual_block->NumParameterBlocks();
+  for (int j = 0, k = 0; j < num_parameter_blocks; ++j) {
+    const ParameterBlock* parameter_block =
+        residual_block->parameter_blocks()[j];
+    if (parameter_block->IsConstant()) {
+      continue;
+    }
+    const int jacobian_block_size =
+        num_residuals * parameter_block->TangentSize();
+    Eigen::Map<Eigen::VectorXf>(values + jacobian_layout[k],
+                                jacobian_block_size) =
+        ConstVectorRef(jacobians[j], jacobian_block_size).cast<float>();
+    // Only increment k for active parameters, since there is only layout
+    // information for active parameters.
+    ++k;
+  }
 }
 
 }  // namespace ceres::internal
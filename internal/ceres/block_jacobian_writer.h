@@ -47,7 +47,9 @@
 namespace ceres::internal {
 
 class BlockEvaluatePreparer;
+class CompressedRowBlockStructure;
 class Program;
+class ScratchEvaluatePreparer;
 class SparseMatrix;
 
 // TODO(sameeragarwal): This class needs documentation.
@@ -75,6 +77,16 @@ class CERES_NO_EXPORT BlockJacobianWriter {
 
   std::unique_ptr<SparseMatrix> CreateJacobian() const;
 
+  // Returns the block structure of the jacobian, or nullptr if the layout
+  // of the jacobian could not be computed. The caller takes ownership.
+  CompressedRowBlockStructure* CreateBlockStructure() const;
+
+  // The positions of the jacobian blocks of residual block residual_id,
+  // indexed by active argument position, see jacobian_layout_ below.
+  const int* jacobian_layout(int residual_id) const {
+    return jacobian_layout_[residual_id];
+  }
+
   void Write(int /* residual_id */,
              int /* residual_offset */,
              double** /* jacobians */,
@@ -141,6 +153,32 @@ class CERES_NO_EXPORT BlockJacobianWriter {
   bool jacobian_layout_is_valid_ = false;
 };
 
+// A jacobian writer that writes to block sparse matrices whose values are
+// stored in single precision, see FloatBlockSparseMatrix. The jacobian
+// has the same layout as the one written by BlockJacobianWriter, but the
+// cost functions cannot write to it directly. So they are evaluated into
+// scratch space, and Write() rounds the jacobian blocks into place.
+class CERES_NO_EXPORT FloatBlockJacobianWriter {
+ public:
+  FloatBlockJacobianWriter(const Evaluator::Options& options, Program* program);
+
+  // JacobianWriter interface.
+
+  std::unique_ptr<ScratchEvaluatePreparer[]> CreateEvaluatePreparers(
+      unsigned num_threads);
+
+  std::unique_ptr<SparseMatrix> CreateJacobian() const;
+
+  void Write(int residual_id,
+             int residual_offset,
+             double** jacobians,
+             SparseMatrix* jacobian);
+
+ private:
+  Program* program_;
+  BlockJacobianWriter block_jacobian_writer_;
+};
+
 }  // namespace ceres::internal
 
 #endif  // CERES_INTERNAL_BLOCK_JACOBIAN_WRITER_H_
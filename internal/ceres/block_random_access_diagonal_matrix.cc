@@ -55,6 +55,7 @@ BlockRandomAccessDiagonalMatrix::BlockRandomAccessDiagonalMatrix(
   layout_ = std::make_unique<CellInfo[]>(blocks.size());
   for (int i = 0; i < blocks.size(); ++i) {
     layout_[i].values = values;
+    inverter_.AddMatrix(blocks[i].size, values);
     values += blocks[i].size * blocks[i].size;
   }
 }
@@ -88,15 +89,7 @@ void BlockRandomAccessDiagonalMatrix::SetZero() {
 }
 
 void BlockRandomAccessDiagonalMatrix::Invert() {
-  auto& blocks = m_->row_blocks();
-  const int num_blocks = blocks.size();
-  ParallelFor(context_, 0, num_blocks, num_threads_, [this, blocks](int i) {
-    auto& cell_info = layout_[i];
-    auto& block = blocks[i];
-    MatrixRef b(cell_info.values, block.size, block.size);
-    b = b.selfadjointView<Eigen::Upper>().llt().solve(
-        Matrix::Identity(block.size, block.size));
-  });
+  inverter_.Invert(context_, num_threads_);
 }
 
 void BlockRandomAccessDiagonalMatrix::RightMultiplyAndAccumulate(
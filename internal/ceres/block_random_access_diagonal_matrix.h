@@ -34,6 +34,7 @@
 #include <memory>
 #include <utility>
 
+#include "ceres/batched_psd_matrix_inverter.h"
 #include "ceres/block_random_access_matrix.h"
 #include "ceres/block_structure.h"
 #include "ceres/compressed_row_sparse_matrix.h"
@@ -85,6 +86,7 @@ class CERES_NO_EXPORT BlockRandomAccessDiagonalMatrix
   const int num_threads_ = 1;
   std::unique_ptr<CompressedRowSparseMatrix> m_;
   std::unique_ptr<CellInfo[]> layout_;
+  BatchedPSDMatrixInverter inverter_;
 };
 
 }  // namespace ceres::internal
@@ -86,15 +86,23 @@ BlockRandomAccessSparseMatrix::BlockRandomAccessSparseMatrix(
   bsm_ = std::make_unique<BlockSparseMatrix>(block_structure_);
   VLOG(1) << "Matrix Size [" << num_cols << "," << num_cols << "] "
           << num_nonzeros;
+
+  // The cells of each row block are stored in the order of their column
+  // blocks, so that GetCell can find them using binary search.
   double* values = bsm_->mutable_values();
+  cell_offsets_.resize(num_blocks + 1);
+  cell_col_block_ids_.resize(block_pairs.size());
+  cells_ = std::make_unique<CellInfo[]>(block_pairs.size());
+  int cell_index = 0;
   for (int row_block_id = 0; row_block_id < num_blocks; ++row_block_id) {
-    const auto& cells = block_structure_->rows[row_block_id].cells;
-    for (auto& c : cells) {
-      const int col_block_id = c.block_id;
-      double* const data = values + c.position;
-      layout_.emplace(IntPairToInt64(row_block_id, col_block_id), data);
+    cell_offsets_[row_block_id] = cell_index;
+    for (const auto& c : block_structure_->rows[row_block_id].cells) {
+      cell_col_block_ids_[cell_index] = c.block_id;
+      cells_[cell_index].values = values + c.position;
+      ++cell_index;
     }
   }
+  cell_offsets_[num_blocks] = cell_index;
 }
 
 CellInfo* BlockRandomAccessSparseMatrix::GetCell(int row_block_id,
@@ -103,8 +111,12 @@ CellInfo* BlockRandomAccessSparseMatrix::GetCell(int row_block_id,
                                                  int* col,
                                                  int* row_stride,
                                                  int* col_stride) {
-  const auto it = layout_.find(IntPairToInt64(row_block_id, col_block_id));
-  if (it == layout_.end()) {
+  const auto row_begin =
+      cell_col_block_ids_.begin() + cell_offsets_[row_block_id];
+  const auto row_end =
+      cell_col_block_ids_.begin() + cell_offsets_[row_block_id + 1];
+  const auto it = std::lower_bound(row_begin, row_end, col_block_id);
+  if (it == row_end || *it != col_block_id) {
     return nullptr;
   }
 
@@ -113,7 +125,7 @@ CellInfo* BlockRandomAccessSparseMatrix::GetCell(int row_block_id,
   *col = 0;
   *row_stride = blocks_[row_block_id].size;
   *col_stride = blocks_[col_block_id].size;
-  return &it->second;
+  return &cells_[it - cell_col_block_ids_.begin()];
 }
 
 // Assume that the user does not hold any locks on any cell blocks
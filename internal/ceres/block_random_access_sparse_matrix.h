@@ -34,7 +34,6 @@
 #include <cstdint>
 #include <memory>
 #include <set>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -52,7 +51,8 @@ namespace ceres::internal {
 // A thread safe square block sparse implementation of
 // BlockRandomAccessMatrix. Internally a BlockSparseMatrix is used
 // for doing the actual storage. This class augments this matrix with
-// an unordered_map that allows random read/write access.
+// a flat block compressed row index of its cells that allows random
+// read/write access.
 class CERES_NO_EXPORT BlockRandomAccessSparseMatrix
     : public BlockRandomAccessMatrix {
  public:
@@ -96,31 +96,21 @@ class CERES_NO_EXPORT BlockRandomAccessSparseMatrix
   BlockSparseMatrix* mutable_matrix() { return bsm_.get(); }
 
  private:
-  int64_t IntPairToInt64(int row, int col) const {
-    return row * kRowShift + col;
-  }
-
-  void Int64ToIntPair(int64_t index, int* row, int* col) const {
-    *row = index / kRowShift;
-    *col = index % kRowShift;
-  }
-
-  constexpr static int64_t kRowShift{1ll << 32};
-
   // row/column block sizes.
   const std::vector<Block> blocks_;
   ContextImpl* context_ = nullptr;
   const int num_threads_ = 1;
 
-  // A mapping from <row_block_id, col_block_id> to the position in
-  // the values array of bsm_ where the block is stored.
-  using LayoutType = std::unordered_map<std::int64_t, CellInfo>;
-  LayoutType layout_;
+  // The cells of row block i are cells_[cell_offsets_[i], cell_offsets_[i +
+  // 1]), sorted by column block. cell_col_block_ids_[j] is the column block
+  // of cells_[j], and cells_[j] points into the values array of bsm_ where
+  // the cell is stored.
+  std::vector<int> cell_offsets_;
+  std::vector<int> cell_col_block_ids_;
+  std::unique_ptr<CellInfo[]> cells_;
 
   // The underlying matrix object which actually stores the cells.
   std::unique_ptr<BlockSparseMatrix> bsm_;
-
-  friend class BlockRandomAccessSparseMatrixTest;
 };
 
 }  // namespace ceres::internal
@@ -129,52 +129,49 @@ TEST(BlockRandomAccessSparseMatrix, GetCell) {
       << "expected: " << expected_y.transpose() << "matrix: \n " << dense;
 }
 
-// IntPairToInt64 is private, thus this fixture is needed to access and
-// test it.
-class BlockRandomAccessSparseMatrixTest : public ::testing::Test {
- public:
-  void SetUp() final {
-    std::vector<Block> blocks;
-    blocks.emplace_back(1, 0);
-    std::set<std::pair<int, int>> block_pairs;
-    block_pairs.emplace(0, 0);
-    m_ = std::make_unique<BlockRandomAccessSparseMatrix>(
-        blocks, block_pairs, &context_, 1);
-  }
+TEST(BlockRandomAccessSparseMatrix, GetCellReturnsNullForMissingCells) {
+  ContextImpl context;
+  std::vector<Block> blocks;
+  blocks.emplace_back(2, 0);
+  blocks.emplace_back(3, 2);
+  blocks.emplace_back(1, 5);
+  blocks.emplace_back(4, 6);
 
-  void CheckIntPairToInt64(int a, int b) {
-    int64_t value = m_->IntPairToInt64(a, b);
-    EXPECT_GT(value, 0) << "Overflow a = " << a << " b = " << b;
-    EXPECT_GT(value, a) << "Overflow a = " << a << " b = " << b;
-    EXPECT_GT(value, b) << "Overflow a = " << a << " b = " << b;
-  }
+  std::set<std::pair<int, int>> block_pairs;
+  block_pairs.emplace(0, 0);
+  block_pairs.emplace(0, 3);
+  block_pairs.emplace(1, 1);
+  block_pairs.emplace(1, 2);
+  block_pairs.emplace(3, 3);
 
-  void CheckInt64ToIntPair() {
-    uint64_t max_rows = m_->kRowShift;
-    for (int row = max_rows - 10; row < max_rows; ++row) {
-      for (int col = 0; col < 10; ++col) {
-        int row_computed;
-        int col_computed;
-        m_->Int64ToIntPair(
-            m_->IntPairToInt64(row, col), &row_computed, &col_computed);
-        EXPECT_EQ(row, row_computed);
-        EXPECT_EQ(col, col_computed);
+  BlockRandomAccessSparseMatrix m(blocks, block_pairs, &context, 1);
+  const BlockSparseMatrix* bsm = m.matrix();
+  for (int row_block_id = 0; row_block_id < blocks.size(); ++row_block_id) {
+    for (int col_block_id = 0; col_block_id < blocks.size(); ++col_block_id) {
+      int row;
+      int col;
+      int row_stride;
+      int col_stride;
+      CellInfo* cell = m.GetCell(
+          row_block_id, col_block_id, &row, &col, &row_stride, &col_stride);
+      if (block_pairs.count({row_block_id, col_block_id}) == 0) {
+        EXPECT_EQ(cell, nullptr);
+        continue;
+      }
+
+      // The cell points to the position of the corresponding cell of the
+      // underlying block sparse matrix.
+      ASSERT_NE(cell, nullptr);
+      const CompressedRow& bsm_row = bsm->block_structure()->rows[row_block_id];
+      int position = -1;
+      for (const auto& bsm_cell : bsm_row.cells) {
+        if (bsm_cell.block_id == col_block_id) {
+          position = bsm_cell.position;
+        }
       }
+      EXPECT_EQ(cell->values, bsm->values() + position);
     }
   }
-
- private:
-  ContextImpl context_;
-  std::unique_ptr<BlockRandomAccessSparseMatrix> m_;
-};
-
-TEST_F(BlockRandomAccessSparseMatrixTest, IntPairToInt64Overflow) {
-  CheckIntPairToInt64(std::numeric_limits<int32_t>::max(),
-                      std::numeric_limits<int32_t>::max());
-}
-
-TEST_F(BlockRandomAccessSparseMatrixTest, Int64ToIntPair) {
-  CheckInt64ToIntPair();
 }
 
 }  // namespace ceres::internal
@@ -32,9 +32,12 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 #include "absl/log/check.h"
@@ -173,6 +176,525 @@ void SetBlockStructureOfCompressedRowSparseMatrix(
   col_blocks = block_structure->cols;
 }
 
+// The matrix-vector products below are specialized for the commonly
+// occurring row and column block sizes, e.g., 2x3 and 2x9 blocks of the
+// Jacobian of a bundle adjustment problem. DispatchOnRowBlockSize and
+// DispatchOnColBlockSize call f with a std::integral_constant holding
+// the block size if it is one of the specialized sizes, and with
+// Eigen::Dynamic otherwise.
+template <typename F>
+void DispatchOnRowBlockSize(const int row_block_size, F&& f) {
+  switch (row_block_size) {
+    case 1:
+      f(std::integral_constant<int, 1>());
+      return;
+    case 2:
+      f(std::integral_constant<int, 2>());
+      return;
+    case 3:
+      f(std::integral_constant<int, 3>());
+      return;
+    case 4:
+      f(std::integral_constant<int, 4>());
+      return;
+    default:
+      f(std::integral_constant<int, Eigen::Dynamic>());
+  }
+}
+
+template <typename F>
+void DispatchOnColBlockSize(const int col_block_size, F&& f) {
+  switch (col_block_size) {
+    case 1:
+      f(std::integral_constant<int, 1>());
+      return;
+    case 2:
+      f(std::integral_constant<int, 2>());
+      return;
+    case 3:
+      f(std::integral_constant<int, 3>());
+      return;
+    case 4:
+      f(std::integral_constant<int, 4>());
+      return;
+    case 6:
+      f(std::integral_constant<int, 6>());
+      return;
+    case 9:
+      f(std::integral_constant<int, 9>());
+      return;
+    default:
+      f(std::integral_constant<int, Eigen::Dynamic>());
+  }
+}
+
+// Dispatches on the row and column block sizes of a matrix. The column
+// block size is only specialized when the row block size is, since
+// kernels with a fixed number of columns and a dynamic number of rows
+// gain little over the fully dynamic ones.
+template <typename F>
+void DispatchOnBlockSizes(const int row_block_size,
+                          const int col_block_size,
+                          F&& f) {
+  DispatchOnRowBlockSize(row_block_size, [&](auto row_block_size_c) {
+    if constexpr (decltype(row_block_size_c)::value == Eigen::Dynamic) {
+      f(row_block_size_c, std::integral_constant<int, Eigen::Dynamic>());
+    } else {
+      DispatchOnColBlockSize(col_block_size, [&](auto col_block_size_c) {
+        f(row_block_size_c, col_block_size_c);
+      });
+    }
+  });
+}
+
+// y += A * x for a single cell A of a block sparse matrix.
+template <int kRowA, int kColA>
+inline void CellRightMultiplyAndAccumulate(const double* A,
+                                           const int num_row_a,
+                                           const int num_col_a,
+                                           const double* x,
+                                           double* y) {
+  MatrixVectorMultiply<kRowA, kColA, 1>(A, num_row_a, num_col_a, x, y);
+}
+
+// A single precision cell of fixed size. Cells are stored row-major, but
+// Eigen does not allow row-major column vectors.
+template <int kRows, int kCols>
+using FloatCellMatrix =
+    Eigen::Matrix<float,
+                  kRows,
+                  kCols,
+                  (kCols == 1 ? Eigen::ColMajor : Eigen::RowMajor)>;
+
+// Single precision cells are converted to double precision as they are
+// read, and the products are accumulated in double precision.
+template <int kRowA, int kColA>
+inline void CellRightMultiplyAndAccumulate(const float* A,
+                                           const int num_row_a,
+                                           const int num_col_a,
+                                           const double* x,
+                                           double* y) {
+  if constexpr (kRowA != Eigen::Dynamic && kColA != Eigen::Dynamic) {
+    Eigen::Map<const FloatCellMatrix<kRowA, kColA>> a(A);
+    Eigen::Map<Eigen::Matrix<double, kRowA, 1>>(y).noalias() +=
+        a.template cast<double>().lazyProduct(
+            Eigen::Map<const Eigen::Matrix<double, kColA, 1>>(x));
+  } else {
+    const int num_rows = (kRowA != Eigen::Dynamic ? kRowA : num_row_a);
+    const int num_cols = (kColA != Eigen::Dynamic ? kColA : num_col_a);
+    for (int r = 0; r < num_rows; ++r) {
+      double sum = 0.0;
+      for (int c = 0; c < num_cols; ++c) {
+        sum += static_cast<double>(A[r * num_cols + c]) * x[c];
+      }
+      y[r] += sum;
+    }
+  }
+}
+
+// y += A' * x for a single cell A of a block sparse matrix.
+template <int kRowA, int kColA>
+inline void CellLeftMultiplyAndAccumulate(const double* A,
+                                          const int num_row_a,
+                                          const int num_col_a,
+                                          const double* x,
+                                          double* y) {
+  MatrixTransposeVectorMultiply<kRowA, kColA, 1>(
+      A, num_row_a, num_col_a, x, y);
+}
+
+template <int kRowA, int kColA>
+inline void CellLeftMultiplyAndAccumulate(const float* A,
+                                          const int num_row_a,
+                                          const int num_col_a,
+                                          const double* x,
+                                          double* y) {
+  if constexpr (kRowA != Eigen::Dynamic && kColA != Eigen::Dynamic) {
+    Eigen::Map<const FloatCellMatrix<kRowA, kColA>> a(A);
+    Eigen::Map<Eigen::Matrix<double, kColA, 1>>(y).noalias() +=
+        a.transpose().template cast<double>().lazyProduct(
+            Eigen::Map<const Eigen::Matrix<double, kRowA, 1>>(x));
+  } else {
+    const int num_rows = (kRowA != Eigen::Dynamic ? kRowA : num_row_a);
+    const int num_cols = (kColA != Eigen::Dynamic ? kColA : num_col_a);
+    for (int r = 0; r < num_rows; ++r) {
+      const double x_r = x[r];
+      for (int c = 0; c < num_cols; ++c) {
+        y[c] += static_cast<double>(A[r * num_cols + c]) * x_r;
+      }
+    }
+  }
+}
+
+// Calls f with the column block size of a cell. If kColBlockSize is
+// dynamic, i.e., the column blocks are not all of the same size, and the
+// row block size is specialized, the column block size is dispatched on
+// cell by cell.
+template <int kRowBlockSize, int kColBlockSize, typename F>
+inline void DispatchOnCellColBlockSize(const int col_block_size, F&& f) {
+  if constexpr (kRowBlockSize == Eigen::Dynamic ||
+                kColBlockSize != Eigen::Dynamic) {
+    f(std::integral_constant<int, kColBlockSize>());
+  } else {
+    DispatchOnColBlockSize(col_block_size, f);
+  }
+}
+
+// y += A * x for a single row block of A.
+template <int kRowBlockSize, int kColBlockSize, typename T>
+inline void RightMultiplyAndAccumulateRowBlock(
+    const T* values,
+    const CompressedRowBlockStructure* block_structure,
+    const int row_block_id,
+    const double* x,
+    double* y) {
+  const auto& row = block_structure->rows[row_block_id];
+  const int row_block_pos = row.block.position;
+  const int row_block_size = row.block.size;
+  for (const auto& cell : row.cells) {
+    const auto& col = block_structure->cols[cell.block_id];
+    DispatchOnCellColBlockSize<kRowBlockSize, kColBlockSize>(
+        col.size, [&](auto col_block_size_c) {
+          constexpr int kCellColBlockSize = decltype(col_block_size_c)::value;
+          CellRightMultiplyAndAccumulate<kRowBlockSize, kCellColBlockSize>(
+              values + cell.position,
+              row_block_size,
+              col.size,
+              x + col.position,
+              y + row_block_pos);
+        });
+  }
+}
+
+// y += A' * x for a single row block of A.
+template <int kRowBlockSize, int kColBlockSize, typename T>
+inline void LeftMultiplyAndAccumulateRowBlock(
+    const T* values,
+    const CompressedRowBlockStructure* block_structure,
+    const int row_block_id,
+    const double* x,
+    double* y) {
+  const auto& row = block_structure->rows[row_block_id];
+  const int row_block_pos = row.block.position;
+  const int row_block_size = row.block.size;
+  for (const auto& cell : row.cells) {
+    const auto& col = block_structure->cols[cell.block_id];
+    DispatchOnCellColBlockSize<kRowBlockSize, kColBlockSize>(
+        col.size, [&](auto col_block_size_c) {
+          constexpr int kCellColBlockSize = decltype(col_block_size_c)::value;
+          CellLeftMultiplyAndAccumulate<kRowBlockSize, kCellColBlockSize>(
+              values + cell.position,
+              row_block_size,
+              col.size,
+              x + row_block_pos,
+              y + col.position);
+        });
+  }
+}
+
+// y += A' * x for a single column block of A, i.e., a single row block of
+// the transpose block structure of A. The size of the column block is
+// fixed across the cells, so it is dispatched on once per column block.
+template <int kRowBlockSize, int kColBlockSize, typename T>
+inline void LeftMultiplyAndAccumulateColBlock(
+    const T* values,
+    const CompressedRowBlockStructure* transpose_block_structure,
+    const int col_block_id,
+    const double* x,
+    double* y) {
+  const auto& col = transpose_block_structure->rows[col_block_id];
+  const int col_block_pos = col.block.position;
+  const int col_block_size = col.block.size;
+  DispatchOnCellColBlockSize<kRowBlockSize, kColBlockSize>(
+      col_block_size, [&](auto col_block_size_c) {
+        constexpr int kCellColBlockSize = decltype(col_block_size_c)::value;
+        for (const auto& cell : col.cells) {
+          const auto& row = transpose_block_structure->cols[cell.block_id];
+          CellLeftMultiplyAndAccumulate<kRowBlockSize, kCellColBlockSize>(
+              values + cell.position,
+              row.size,
+              col_block_size,
+              x + row.position,
+              y + col_block_pos);
+        }
+      });
+}
+
+// Implementations of the matrix-vector products shared by
+// BlockSparseMatrix and FloatBlockSparseMatrix. row_block_size and
+// col_block_size are the uniform block sizes of the matrix, or
+// Eigen::Dynamic.
+template <typename T>
+void RightMultiplyAndAccumulateImpl(
+    const T* values,
+    const CompressedRowBlockStructure* block_structure,
+    const int row_block_size,
+    const int col_block_size,
+    const double* x,
+    double* y,
+    ContextImpl* context,
+    const int num_threads) {
+  const int num_row_blocks = block_structure->rows.size();
+  DispatchOnBlockSizes(
+      row_block_size,
+      col_block_size,
+      [&](auto row_block_size_c, auto col_block_size_c) {
+        constexpr int kRowBlockSize = decltype(row_block_size_c)::value;
+        constexpr int kColBlockSize = decltype(col_block_size_c)::value;
+        ParallelFor(context,
+                    0,
+                    num_row_blocks,
+                    num_threads,
+                    [values, block_structure, x, y](int row_block_id) {
+                      RightMultiplyAndAccumulateRowBlock<kRowBlockSize,
+                                                         kColBlockSize>(
+                          values, block_structure, row_block_id, x, y);
+                    });
+      });
+}
+
+// Single-threaded left products are always computed using a non-transpose
+// block structure, because it has linear access pattern to matrix elements
+template <typename T>
+void LeftMultiplyAndAccumulateImpl(
+    const T* values,
+    const CompressedRowBlockStructure* block_structure,
+    const int row_block_size,
+    const int col_block_size,
+    const double* x,
+    double* y) {
+  const int num_row_blocks = block_structure->rows.size();
+  DispatchOnBlockSizes(
+      row_block_size,
+      col_block_size,
+      [&](auto row_block_size_c, auto col_block_size_c) {
+        constexpr int kRowBlockSize = decltype(row_block_size_c)::value;
+        constexpr int kColBlockSize = decltype(col_block_size_c)::value;
+        for (int i = 0; i < num_row_blocks; ++i) {
+          LeftMultiplyAndAccumulateRowBlock<kRowBlockSize, kColBlockSize>(
+              values, block_structure, i, x, y);
+        }
+      });
+}
+
+// While utilizing transposed structure allows to perform parallel
+// left-multiplication by dense vector, it makes access patterns to matrix
+// elements scattered. Thus, multiplication using transposed structure
+// is only useful for parallel execution
+template <typename T>
+void LeftMultiplyAndAccumulateImpl(
+    const T* values,
+    const CompressedRowBlockStructure* block_structure,
+    const CompressedRowBlockStructure* transpose_block_structure,
+    const int row_block_size,
+    const int col_block_size,
+    const double* x,
+    double* y,
+    ContextImpl* context,
+    const int num_threads) {
+  if (transpose_block_structure == nullptr || num_threads == 1) {
+    LeftMultiplyAndAccumulateImpl(
+        values, block_structure, row_block_size, col_block_size, x, y);
+    return;
+  }
+
+  const int num_col_blocks = transpose_block_structure->rows.size();
+  if (!num_col_blocks) {
+    return;
+  }
+
+  // Use non-zero count as iteration cost for guided parallel-for loop
+  DispatchOnBlockSizes(
+      row_block_size,
+      col_block_size,
+      [&](auto row_block_size_c, auto col_block_size_c) {
+        constexpr int kRowBlockSize = decltype(row_block_size_c)::value;
+        constexpr int kColBlockSize = decltype(col_block_size_c)::value;
+        ParallelFor(
+            context,
+            0,
+            num_col_blocks,
+            num_threads,
+            [values, transpose_block_structure, x, y](int col_block_id) {
+              LeftMultiplyAndAccumulateColBlock<kRowBlockSize, kColBlockSize>(
+                  values, transpose_block_structure, col_block_id, x, y);
+            },
+            transpose_block_structure->rows.data(),
+            [](const CompressedRow& row) { return row.cumulative_nnz; });
+      });
+}
+
+// A cell of a block sparse matrix whose values are of type T.
+template <typename T>
+using CellRef = Eigen::Map<
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+template <typename T>
+using ConstCellRef = Eigen::Map<
+    const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+// Implementations of the column scaling and norms and of the conversions
+// shared by BlockSparseMatrix and FloatBlockSparseMatrix. The transpose
+// block structure is only used with multiple threads.
+template <typename T>
+void SquaredColumnNormImpl(
+    const T* values,
+    const CompressedRowBlockStructure* block_structure,
+    const CompressedRowBlockStructure* transpose_block_structure,
+    const int num_cols,
+    double* x,
+    ContextImpl* context,
+    const int num_threads) {
+  CHECK(x != nullptr);
+  if (transpose_block_structure == nullptr || num_threads == 1) {
+    VectorRef(x, num_cols).setZero();
+    for (const auto& row : block_structure->rows) {
+      for (const auto& cell : row.cells) {
+        const auto& col = block_structure->cols[cell.block_id];
+        const ConstCellRef<T> m(
+            values + cell.position, row.block.size, col.size);
+        VectorRef(x + col.position, col.size) +=
+            m.template cast<double>().colwise().squaredNorm();
+      }
+    }
+    return;
+  }
+
+  ParallelSetZero(context, num_threads, x, num_cols);
+  auto transpose_bs = transpose_block_structure;
+  const int num_col_blocks = transpose_bs->rows.size();
+  ParallelFor(
+      context,
+      0,
+      num_col_blocks,
+      num_threads,
+      [values, transpose_bs, x](int row_block_id) {
+        const auto& row = transpose_bs->rows[row_block_id];
+
+        for (auto& cell : row.cells) {
+          const auto& col = transpose_bs->cols[cell.block_id];
+          const ConstCellRef<T> m(
+              values + cell.position, col.size, row.block.size);
+          VectorRef(x + row.block.position, row.block.size) +=
+              m.template cast<double>().colwise().squaredNorm();
+        }
+      },
+      transpose_bs->rows.data(),
+      [](const CompressedRow& row) { return row.cumulative_nnz; });
+}
+
+template <typename T>
+void ScaleColumnsImpl(
+    T* values,
+    const CompressedRowBlockStructure* block_structure,
+    const CompressedRowBlockStructure* transpose_block_structure,
+    const double* scale,
+    ContextImpl* context,
+    const int num_threads) {
+  CHECK(scale != nullptr);
+  if (transpose_block_structure == nullptr || num_threads == 1) {
+    for (const auto& row : block_structure->rows) {
+      for (const auto& cell : row.cells) {
+        const auto& col = block_structure->cols[cell.block_id];
+        CellRef<T> m(values + cell.position, row.block.size, col.size);
+        m *= ConstVectorRef(scale + col.position, col.size)
+                 .template cast<T>()
+                 .asDiagonal();
+      }
+    }
+    return;
+  }
+
+  auto transpose_bs = transpose_block_structure;
+  const int num_col_blocks = transpose_bs->rows.size();
+  ParallelFor(
+      context,
+      0,
+      num_col_blocks,
+      num_threads,
+      [values, transpose_bs, scale](int row_block_id) {
+        const auto& row = transpose_bs->rows[row_block_id];
+
+        for (auto& cell : row.cells) {
+          const auto& col = transpose_bs->cols[cell.block_id];
+          CellRef<T> m(values + cell.position, col.size, row.block.size);
+          m *= ConstVectorRef(scale + row.block.position, row.block.size)
+                   .template cast<T>()
+                   .asDiagonal();
+        }
+      },
+      transpose_bs->rows.data(),
+      [](const CompressedRow& row) { return row.cumulative_nnz; });
+}
+
+template <typename T>
+void ToDenseMatrixImpl(const T* values,
+                       const CompressedRowBlockStructure* block_structure,
+                       const int num_rows,
+                       const int num_cols,
+                       Matrix* dense_matrix) {
+  CHECK(dense_matrix != nullptr);
+
+  dense_matrix->resize(num_rows, num_cols);
+  dense_matrix->setZero();
+  Matrix& m = *dense_matrix;
+
+  for (const auto& row : block_structure->rows) {
+    for (const auto& cell : row.cells) {
+      const auto& col = block_structure->cols[cell.block_id];
+      m.block(row.block.position, col.position, row.block.size, col.size) +=
+          ConstCellRef<T>(values + cell.position, row.block.size, col.size)
+              .template cast<double>();
+    }
+  }
+}
+
+template <typename T>
+void ToTextFileImpl(const T* values,
+                    const CompressedRowBlockStructure* block_structure,
+                    FILE* file) {
+  CHECK(file != nullptr);
+  for (const auto& row : block_structure->rows) {
+    for (const auto& cell : row.cells) {
+      const auto& col = block_structure->cols[cell.block_id];
+      int jac_pos = cell.position;
+      for (int r = 0; r < row.block.size; ++r) {
+        for (int c = 0; c < col.size; ++c) {
+          absl::FPrintF(file,
+                        "% 10d % 10d %17f\n",
+                        row.block.position + r,
+                        col.position + c,
+                        static_cast<double>(values[jac_pos++]));
+        }
+      }
+    }
+  }
+}
+
+// Returns the size shared by all the blocks, or Eigen::Dynamic if there
+// are no blocks or they are not all of the same size.
+template <typename Blocks, typename BlockSize>
+int UniformBlockSize(const Blocks& blocks, BlockSize&& block_size) {
+  if (blocks.empty()) {
+    return Eigen::Dynamic;
+  }
+  const int size = block_size(blocks.front());
+  for (const auto& block : blocks) {
+    if (block_size(block) != size) {
+      return Eigen::Dynamic;
+    }
+  }
+  return size;
+}
+
+int UniformRowBlockSize(const CompressedRowBlockStructure& bs) {
+  return UniformBlockSize(
+      bs.rows, [](const CompressedRow& row) { return row.block.size; });
+}
+
+int UniformColBlockSize(const CompressedRowBlockStructure& bs) {
+  return UniformBlockSize(bs.cols, [](const Block& col) { return col.size; });
+}
+
 }  // namespace
 
 BlockSparseMatrix::BlockSparseMatrix(
@@ -213,6 +735,7 @@ BlockSparseMatrix::BlockSparseMatrix(
   max_num_nonzeros_ = num_nonzeros_;
   CHECK(values_ != nullptr);
   AddTransposeBlockStructure();
+  DetectUniformBlockSizes();
 }
 
 BlockSparseMatrix::~BlockSparseMatrix() { FreeValues(values_); }
@@ -223,6 +746,11 @@ void BlockSparseMatrix::AddTransposeBlockStructure() {
   }
 }
 
+void BlockSparseMatrix::DetectUniformBlockSizes() {
+  row_block_size_ = UniformRowBlockSize(*block_structure_);
+  col_block_size_ = UniformColBlockSize(*block_structure_);
+}
+
 void BlockSparseMatrix::SetZero() {
   std::fill(values_, values_ + num_nonzeros_, 0.0);
 }
@@ -243,34 +771,14 @@ void BlockSparseMatrix::RightMultiplyAndAccumulate(const double* x,
   CHECK(x != nullptr);
   CHECK(y != nullptr);
 
-  const auto values = values_;
-  const auto block_structure = block_structure_.get();
-  const auto num_row_blocks = block_structure->rows.size();
-
-  ParallelFor(context,
-              0,
-              num_row_blocks,
-              num_threads,
-              [values, block_structure, x, y](int row_block_id) {
-                const int row_block_pos =
-                    block_structure->rows[row_block_id].block.position;
-                const int row_block_size =
-                    block_structure->rows[row_block_id].block.size;
-                const auto& cells = block_structure->rows[row_block_id].cells;
-                for (const auto& cell : cells) {
-                  const int col_block_id = cell.block_id;
-                  const int col_block_size =
-                      block_structure->cols[col_block_id].size;
-                  const int col_block_pos =
-                      block_structure->cols[col_block_id].position;
-                  MatrixVectorMultiply<Eigen::Dynamic, Eigen::Dynamic, 1>(
-                      values + cell.position,
-                      row_block_size,
-                      col_block_size,
-                      x + col_block_pos,
-                      y + row_block_pos);
-                }
-              });
+  RightMultiplyAndAccumulateImpl(values_,
+                                 block_structure_.get(),
+                                 row_block_size_,
+                                 col_block_size_,
+                                 x,
+                                 y,
+                                 context,
+                                 num_threads);
 }
 
 // TODO(https://github.com/ceres-solver/ceres-solver/issues/933): This method
@@ -279,90 +787,30 @@ void BlockSparseMatrix::LeftMultiplyAndAccumulate(const double* x,
                                                   double* y,
                                                   ContextImpl* context,
                                                   int num_threads) const {
-  // While utilizing transposed structure allows to perform parallel
-  // left-multiplication by dense vector, it makes access patterns to matrix
-  // elements scattered. Thus, multiplication using transposed structure
-  // is only useful for parallel execution
   CHECK(x != nullptr);
   CHECK(y != nullptr);
-  if (transpose_block_structure_ == nullptr || num_threads == 1) {
-    LeftMultiplyAndAccumulate(x, y);
-    return;
-  }
-
-  auto transpose_bs = transpose_block_structure_.get();
-  const auto values = values_;
-  const int num_col_blocks = transpose_bs->rows.size();
-  if (!num_col_blocks) {
-    return;
-  }
-
-  // Use non-zero count as iteration cost for guided parallel-for loop
-  ParallelFor(
-      context,
-      0,
-      num_col_blocks,
-      num_threads,
-      [values, transpose_bs, x, y](int row_block_id) {
-        int row_block_pos = transpose_bs->rows[row_block_id].block.position;
-        int row_block_size = transpose_bs->rows[row_block_id].block.size;
-        auto& cells = transpose_bs->rows[row_block_id].cells;
-
-        for (auto& cell : cells) {
-          const int col_block_id = cell.block_id;
-          const int col_block_size = transpose_bs->cols[col_block_id].size;
-          const int col_block_pos = transpose_bs->cols[col_block_id].position;
-          MatrixTransposeVectorMultiply<Eigen::Dynamic, Eigen::Dynamic, 1>(
-              values + cell.position,
-              col_block_size,
-              row_block_size,
-              x + col_block_pos,
-              y + row_block_pos);
-        }
-      },
-      transpose_bs->rows.data(),
-      [](const CompressedRow& row) { return row.cumulative_nnz; });
+  LeftMultiplyAndAccumulateImpl(values_,
+                                block_structure_.get(),
+                                transpose_block_structure_.get(),
+                                row_block_size_,
+                                col_block_size_,
+                                x,
+                                y,
+                                context,
+                                num_threads);
 }
 
 void BlockSparseMatrix::LeftMultiplyAndAccumulate(const double* x,
                                                   double* y) const {
   CHECK(x != nullptr);
   CHECK(y != nullptr);
-  // Single-threaded left products are always computed using a non-transpose
-  // block structure, because it has linear access pattern to matrix elements
-  for (int i = 0; i < block_structure_->rows.size(); ++i) {
-    int row_block_pos = block_structure_->rows[i].block.position;
-    int row_block_size = block_structure_->rows[i].block.size;
-    const auto& cells = block_structure_->rows[i].cells;
-    for (const auto& cell : cells) {
-      int col_block_id = cell.block_id;
-      int col_block_size = block_structure_->cols[col_block_id].size;
-      int col_block_pos = block_structure_->cols[col_block_id].position;
-      MatrixTransposeVectorMultiply<Eigen::Dynamic, Eigen::Dynamic, 1>(
-          values_ + cell.position,
-          row_block_size,
-          col_block_size,
-          x + row_block_pos,
-          y + col_block_pos);
-    }
-  }
+  LeftMultiplyAndAccumulateImpl(
+      values_, block_structure_.get(), row_block_size_, col_block_size_, x, y);
 }
 
 void BlockSparseMatrix::SquaredColumnNorm(double* x) const {
-  CHECK(x != nullptr);
-  VectorRef(x, num_cols_).setZero();
-  for (int i = 0; i < block_structure_->rows.size(); ++i) {
-    int row_block_size = block_structure_->rows[i].block.size;
-    auto& cells = block_structure_->rows[i].cells;
-    for (const auto& cell : cells) {
-      int col_block_id = cell.block_id;
-      int col_block_size = block_structure_->cols[col_block_id].size;
-      int col_block_pos = block_structure_->cols[col_block_id].position;
-      const MatrixRef m(
-          values_ + cell.position, row_block_size, col_block_size);
-      VectorRef(x + col_block_pos, col_block_size) += m.colwise().squaredNorm();
-    }
-  }
+  SquaredColumnNormImpl(
+      values_, block_structure_.get(), nullptr, num_cols_, x, nullptr, 1);
 }
 
 // TODO(https://github.com/ceres-solver/ceres-solver/issues/933): This method
@@ -370,50 +818,17 @@ void BlockSparseMatrix::SquaredColumnNorm(double* x) const {
 void BlockSparseMatrix::SquaredColumnNorm(double* x,
                                           ContextImpl* context,
                                           int num_threads) const {
-  if (transpose_block_structure_ == nullptr || num_threads == 1) {
-    SquaredColumnNorm(x);
-    return;
-  }
-
-  CHECK(x != nullptr);
-  ParallelSetZero(context, num_threads, x, num_cols_);
-
-  auto transpose_bs = transpose_block_structure_.get();
-  const auto values = values_;
-  const int num_col_blocks = transpose_bs->rows.size();
-  ParallelFor(
-      context,
-      0,
-      num_col_blocks,
-      num_threads,
-      [values, transpose_bs, x](int row_block_id) {
-        const auto& row = transpose_bs->rows[row_block_id];
-
-        for (auto& cell : row.cells) {
-          const auto& col = transpose_bs->cols[cell.block_id];
-          const MatrixRef m(values + cell.position, col.size, row.block.size);
-          VectorRef(x + row.block.position, row.block.size) +=
-              m.colwise().squaredNorm();
-        }
-      },
-      transpose_bs->rows.data(),
-      [](const CompressedRow& row) { return row.cumulative_nnz; });
+  SquaredColumnNormImpl(values_,
+                        block_structure_.get(),
+                        transpose_block_structure_.get(),
+                        num_cols_,
+                        x,
+                        context,
+                        num_threads);
 }
 
 void BlockSparseMatrix::ScaleColumns(const double* scale) {
-  CHECK(scale != nullptr);
-
-  for (int i = 0; i < block_structure_->rows.size(); ++i) {
-    int row_block_size = block_structure_->rows[i].block.size;
-    auto& cells = block_structure_->rows[i].cells;
-    for (const auto& cell : cells) {
-      int col_block_id = cell.block_id;
-      int col_block_size = block_structure_->cols[col_block_id].size;
-      int col_block_pos = block_structure_->cols[col_block_id].position;
-      MatrixRef m(values_ + cell.position, row_block_size, col_block_size);
-      m *= ConstVectorRef(scale + col_block_pos, col_block_size).asDiagonal();
-    }
-  }
+  ScaleColumnsImpl(values_, block_structure_.get(), nullptr, scale, nullptr, 1);
 }
 
 // TODO(https://github.com/ceres-solver/ceres-solver/issues/933): This method
@@ -421,33 +836,14 @@ void BlockSparseMatrix::ScaleColumns(const double* scale) {
 void BlockSparseMatrix::ScaleColumns(const double* scale,
                                      ContextImpl* context,
                                      int num_threads) {
-  if (transpose_block_structure_ == nullptr || num_threads == 1) {
-    ScaleColumns(scale);
-    return;
-  }
-
-  CHECK(scale != nullptr);
-  auto transpose_bs = transpose_block_structure_.get();
-  auto values = values_;
-  const int num_col_blocks = transpose_bs->rows.size();
-  ParallelFor(
-      context,
-      0,
-      num_col_blocks,
-      num_threads,
-      [values, transpose_bs, scale](int row_block_id) {
-        const auto& row = transpose_bs->rows[row_block_id];
-
-        for (auto& cell : row.cells) {
-          const auto& col = transpose_bs->cols[cell.block_id];
-          MatrixRef m(values + cell.position, col.size, row.block.size);
-          m *= ConstVectorRef(scale + row.block.position, row.block.size)
-                   .asDiagonal();
-        }
-      },
-      transpose_bs->rows.data(),
-      [](const CompressedRow& row) { return row.cumulative_nnz; });
+  ScaleColumnsImpl(values_,
+                   block_structure_.get(),
+                   transpose_block_structure_.get(),
+                   scale,
+                   context,
+                   num_threads);
 }
+
 std::unique_ptr<CompressedRowSparseMatrix>
 BlockSparseMatrix::ToCompressedRowSparseMatrixTranspose() const {
   auto bs = transpose_block_structure_.get();
@@ -492,25 +888,8 @@ void BlockSparseMatrix::UpdateCompressedRowSparseMatrix(
 }
 
 void BlockSparseMatrix::ToDenseMatrix(Matrix* dense_matrix) const {
-  CHECK(dense_matrix != nullptr);
-
-  dense_matrix->resize(num_rows_, num_cols_);
-  dense_matrix->setZero();
-  Matrix& m = *dense_matrix;
-
-  for (int i = 0; i < block_structure_->rows.size(); ++i) {
-    int row_block_pos = block_structure_->rows[i].block.position;
-    int row_block_size = block_structure_->rows[i].block.size;
-    auto& cells = block_structure_->rows[i].cells;
-    for (const auto& cell : cells) {
-      int col_block_id = cell.block_id;
-      int col_block_size = block_structure_->cols[col_block_id].size;
-      int col_block_pos = block_structure_->cols[col_block_id].position;
-      int jac_pos = cell.position;
-      m.block(row_block_pos, col_block_pos, row_block_size, col_block_size) +=
-          MatrixRef(values_ + jac_pos, row_block_size, col_block_size);
-    }
-  }
+  ToDenseMatrixImpl(
+      values_, block_structure_.get(), num_rows_, num_cols_, dense_matrix);
 }
 
 void BlockSparseMatrix::ToTripletSparseMatrix(
@@ -556,27 +935,7 @@ BlockSparseMatrix::transpose_block_structure() const {
 }
 
 void BlockSparseMatrix::ToTextFile(FILE* file) const {
-  CHECK(file != nullptr);
-  for (int i = 0; i < block_structure_->rows.size(); ++i) {
-    const int row_block_pos = block_structure_->rows[i].block.position;
-    const int row_block_size = block_structure_->rows[i].block.size;
-    const auto& cells = block_structure_->rows[i].cells;
-    for (const auto& cell : cells) {
-      const int col_block_id = cell.block_id;
-      const int col_block_size = block_structure_->cols[col_block_id].size;
-      const int col_block_pos = block_structure_->cols[col_block_id].position;
-      int jac_pos = cell.position;
-      for (int r = 0; r < row_block_size; ++r) {
-        for (int c = 0; c < col_block_size; ++c) {
-          absl::FPrintF(file,
-                        "% 10d % 10d %17f\n",
-                        row_block_pos + r,
-                        col_block_pos + c,
-                        values_[jac_pos++]);
-        }
-      }
-    }
-  }
+  ToTextFileImpl(values_, block_structure_.get(), file);
 }
 
 std::unique_ptr<BlockSparseMatrix> BlockSparseMatrix::CreateDiagonalMatrix(
@@ -660,6 +1019,7 @@ void BlockSparseMatrix::AppendRows(const BlockSparseMatrix& m) {
 
   std::copy(
       m.values(), m.values() + m.num_nonzeros(), values_ + old_num_nonzeros);
+  DetectUniformBlockSizes();
 
   if (transpose_block_structure_ == nullptr) {
     return;
@@ -698,6 +1058,7 @@ void BlockSparseMatrix::DeleteRowBlocks(const int delta_row_blocks) {
   num_nonzeros_ -= delta_num_nonzeros;
   num_rows_ -= delta_num_rows;
   block_structure_->rows.resize(new_num_row_blocks);
+  DetectUniformBlockSizes();
 
   if (transpose_block_structure_ == nullptr) {
     return;
@@ -841,4 +1202,156 @@ void BlockSparseMatrix::FreeValues(double*& values) {
 #endif
 };
 
+FloatBlockSparseMatrix::FloatBlockSparseMatrix(const BlockSparseMatrix& m)
+    : block_structure_(m.block_structure()),
+      transpose_block_structure_(m.transpose_block_structure()),
+      num_rows_(m.num_rows()),
+      num_cols_(m.num_cols()),
+      row_block_size_(UniformRowBlockSize(*block_structure_)),
+      col_block_size_(UniformColBlockSize(*block_structure_)),
+      values_(m.num_nonzeros()) {}
+
+FloatBlockSparseMatrix::FloatBlockSparseMatrix(
+    CompressedRowBlockStructure* block_structure)
+    : owned_block_structure_(block_structure),
+      block_structure_(block_structure),
+      num_rows_(0),
+      num_cols_(0) {
+  CHECK(block_structure_ != nullptr);
+  owned_transpose_block_structure_ = CreateTranspose(*block_structure_);
+  transpose_block_structure_ = owned_transpose_block_structure_.get();
+  row_block_size_ = UniformRowBlockSize(*block_structure_);
+  col_block_size_ = UniformColBlockSize(*block_structure_);
+
+  for (const auto& col : block_structure_->cols) {
+    num_cols_ += col.size;
+  }
+  int64_t num_nonzeros = 0;
+  for (const auto& row : block_structure_->rows) {
+    num_rows_ += row.block.size;
+    for (const auto& cell : row.cells) {
+      num_nonzeros += static_cast<int64_t>(row.block.size) *
+                      block_structure_->cols[cell.block_id].size;
+    }
+  }
+  CHECK_LE(num_nonzeros, std::numeric_limits<int>::max());
+  VLOG(2) << "Allocating values array with " << num_nonzeros * sizeof(float)
+          << " bytes.";  // NOLINT
+  values_.resize(num_nonzeros);
+}
+
+void FloatBlockSparseMatrix::UpdateValues(const BlockSparseMatrix& m,
+                                          ContextImpl* context,
+                                          int num_threads) {
+  CHECK_EQ(m.block_structure(), block_structure_);
+  CHECK_EQ(m.num_nonzeros(), values_.size());
+  ParallelAssign(context,
+                 num_threads,
+                 values_,
+                 ConstVectorRef(m.values(), m.num_nonzeros()).cast<float>());
+}
+
+void FloatBlockSparseMatrix::RightMultiplyAndAccumulate(const double* x,
+                                                        double* y) const {
+  RightMultiplyAndAccumulate(x, y, nullptr, 1);
+}
+
+void FloatBlockSparseMatrix::RightMultiplyAndAccumulate(
+    const double* x, double* y, ContextImpl* context, int num_threads) const {
+  CHECK(x != nullptr);
+  CHECK(y != nullptr);
+  RightMultiplyAndAccumulateImpl(values_.data(),
+                                 block_structure_,
+                                 row_block_size_,
+                                 col_block_size_,
+                                 x,
+                                 y,
+                                 context,
+                                 num_threads);
+}
+
+void FloatBlockSparseMatrix::LeftMultiplyAndAccumulate(const double* x,
+                                                       double* y) const {
+  CHECK(x != nullptr);
+  CHECK(y != nullptr);
+  LeftMultiplyAndAccumulateImpl(
+      values_.data(), block_structure_, row_block_size_, col_block_size_, x, y);
+}
+
+void FloatBlockSparseMatrix::LeftMultiplyAndAccumulate(
+    const double* x, double* y, ContextImpl* context, int num_threads) const {
+  CHECK(x != nullptr);
+  CHECK(y != nullptr);
+  LeftMultiplyAndAccumulateImpl(values_.data(),
+                                block_structure_,
+                                transpose_block_structure_,
+                                row_block_size_,
+                                col_block_size_,
+                                x,
+                                y,
+                                context,
+                                num_threads);
+}
+
+void FloatBlockSparseMatrix::SetZero() { values_.setZero(); }
+
+void FloatBlockSparseMatrix::SetZero(ContextImpl* context, int num_threads) {
+  ParallelAssign(
+      context, num_threads, values_, Eigen::VectorXf::Zero(values_.size()));
+}
+
+void FloatBlockSparseMatrix::SquaredColumnNorm(double* x) const {
+  SquaredColumnNormImpl(
+      values_.data(), block_structure_, nullptr, num_cols_, x, nullptr, 1);
+}
+
+void FloatBlockSparseMatrix::SquaredColumnNorm(double* x,
+                                               ContextImpl* context,
+                                               int num_threads) const {
+  SquaredColumnNormImpl(values_.data(),
+                        block_structure_,
+                        transpose_block_structure_,
+                        num_cols_,
+                        x,
+                        context,
+                        num_threads);
+}
+
+void FloatBlockSparseMatrix::ScaleColumns(const double* scale) {
+  ScaleColumnsImpl(
+      values_.data(), block_structure_, nullptr, scale, nullptr, 1);
+}
+
+void FloatBlockSparseMatrix::ScaleColumns(const double* scale,
+                                          ContextImpl* context,
+                                          int num_threads) {
+  ScaleColumnsImpl(values_.data(),
+                   block_structure_,
+                   transpose_block_structure_,
+                   scale,
+                   context,
+                   num_threads);
+}
+
+void FloatBlockSparseMatrix::ToDenseMatrix(Matrix* dense_matrix) const {
+  ToDenseMatrixImpl(
+      values_.data(), block_structure_, num_rows_, num_cols_, dense_matrix);
+}
+
+void FloatBlockSparseMatrix::ToTextFile(FILE* file) const {
+  ToTextFileImpl(values_.data(), block_structure_, file);
+}
+
+const double* FloatBlockSparseMatrix::values() const {
+  LOG(FATAL) << "FloatBlockSparseMatrix stores its values in single "
+             << "precision. Use float_values() instead.";
+  return nullptr;
+}
+
+double* FloatBlockSparseMatrix::mutable_values() {
+  LOG(FATAL) << "FloatBlockSparseMatrix stores its values in single "
+             << "precision. Use mutable_float_values() instead.";
+  return nullptr;
+}
+
 }  // namespace ceres::internal
@@ -31,6 +31,7 @@
 #include "ceres/block_sparse_matrix.h"
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <memory>
 #include <random>
@@ -670,5 +671,228 @@ TEST(BlockSparseMatrix, CreateTranspose) {
   }
 }
 
+// The matrix-vector products are specialized for uniform row and column
+// block sizes. Compare them against dense products for specialized,
+// mixed and unspecialized block sizes.
+TEST(BlockSparseMatrix, MultiplyAndAccumulateSpecializedBlockSizes) {
+  constexpr int kNumThreads = 4;
+  ContextImpl context;
+  context.EnsureMinimumThreads(kNumThreads);
+  std::mt19937 prng;
+
+  // {min_row, max_row, min_col, max_col} block sizes.
+  const std::vector<std::array<int, 4>> block_sizes = {{2, 2, 3, 3},
+                                                       {2, 2, 9, 9},
+                                                       {3, 3, 6, 6},
+                                                       {4, 4, 4, 4},
+                                                       {2, 2, 3, 9},
+                                                       {1, 4, 3, 3},
+                                                       {5, 5, 7, 7}};
+  for (const auto& [min_row, max_row, min_col, max_col] : block_sizes) {
+    BlockSparseMatrix::RandomMatrixOptions options;
+    options.num_row_blocks = 30;
+    options.min_row_block_size = min_row;
+    options.max_row_block_size = max_row;
+    options.num_col_blocks = 10;
+    options.min_col_block_size = min_col;
+    options.max_col_block_size = max_col;
+    options.block_density = 0.3;
+    auto a = BlockSparseMatrix::CreateRandomMatrix(options, prng);
+
+    Matrix dense;
+    a->ToDenseMatrix(&dense);
+    const Vector x = Vector::Random(a->num_cols());
+    const Vector y = Vector::Random(a->num_rows());
+    const Vector expected_ax = dense * x;
+    const Vector expected_aty = dense.transpose() * y;
+
+    for (const int num_threads : {1, kNumThreads}) {
+      Vector ax = Vector::Zero(a->num_rows());
+      Vector aty = Vector::Zero(a->num_cols());
+      a->RightMultiplyAndAccumulate(
+          x.data(), ax.data(), &context, num_threads);
+      a->LeftMultiplyAndAccumulate(
+          y.data(), aty.data(), &context, num_threads);
+      EXPECT_LT((ax - expected_ax).norm(), 1e-12 * expected_ax.norm());
+      EXPECT_LT((aty - expected_aty).norm(), 1e-12 * expected_aty.norm());
+    }
+  }
+}
+
+TEST(FloatBlockSparseMatrix, MultiplyAndAccumulate) {
+  constexpr int kNumThreads = 4;
+  ContextImpl context;
+  context.EnsureMinimumThreads(kNumThreads);
+  std::mt19937 prng;
+
+  // {min_row, max_row, min_col, max_col} block sizes.
+  const std::vector<std::array<int, 4>> block_sizes = {
+      {2, 2, 3, 3}, {2, 2, 3, 9}, {1, 5, 1, 7}};
+  for (const auto& [min_row, max_row, min_col, max_col] : block_sizes) {
+    BlockSparseMatrix::RandomMatrixOptions options;
+    options.num_row_blocks = 30;
+    options.min_row_block_size = min_row;
+    options.max_row_block_size = max_row;
+    options.num_col_blocks = 10;
+    options.min_col_block_size = min_col;
+    options.max_col_block_size = max_col;
+    options.block_density = 0.3;
+    auto a = BlockSparseMatrix::CreateRandomMatrix(options, prng);
+
+    FloatBlockSparseMatrix a_float(*a);
+    a_float.UpdateValues(*a, &context, kNumThreads);
+    EXPECT_EQ(a_float.num_rows(), a->num_rows());
+    EXPECT_EQ(a_float.num_cols(), a->num_cols());
+    for (int i = 0; i < a->num_nonzeros(); ++i) {
+      EXPECT_EQ(a_float.float_values()[i], static_cast<float>(a->values()[i]));
+    }
+
+    const Vector x = Vector::Random(a->num_cols());
+    const Vector y = Vector::Random(a->num_rows());
+    Vector expected_ax = Vector::Zero(a->num_rows());
+    Vector expected_aty = Vector::Zero(a->num_cols());
+    a->RightMultiplyAndAccumulate(x.data(), expected_ax.data());
+    a->LeftMultiplyAndAccumulate(y.data(), expected_aty.data());
+
+    // The products differ from the double precision ones only by the
+    // rounding of the matrix to single precision.
+    constexpr double kTolerance = 1e-6;
+    for (const int num_threads : {1, kNumThreads}) {
+      Vector ax = Vector::Zero(a->num_rows());
+      Vector aty = Vector::Zero(a->num_cols());
+      a_float.RightMultiplyAndAccumulate(
+          x.data(), ax.data(), &context, num_threads);
+      a_float.LeftMultiplyAndAccumulate(
+          y.data(), aty.data(), &context, num_threads);
+      EXPECT_LT((ax - expected_ax).norm(), kTolerance * expected_ax.norm());
+      EXPECT_LT((aty - expected_aty).norm(),
+                kTolerance * expected_aty.norm());
+    }
+  }
+}
+
+TEST(FloatBlockSparseMatrix, ColumnNormsScalingAndDenseMatrix) {
+  constexpr int kNumThreads = 4;
+  ContextImpl context;
+  context.EnsureMinimumThreads(kNumThreads);
+  std::mt19937 prng;
+  BlockSparseMatrix::RandomMatrixOptions options;
+  options.num_row_blocks = 30;
+  options.min_row_block_size = 1;
+  options.max_row_block_size = 4;
+  options.num_col_blocks = 10;
+  options.min_col_block_size = 1;
+  options.max_col_block_size = 5;
+  options.block_density = 0.3;
+  auto a = BlockSparseMatrix::CreateRandomMatrix(options, prng);
+
+  // Round the values of a to single precision, so that both matrices
+  // represent the same matrix.
+  for (int i = 0; i < a->num_nonzeros(); ++i) {
+    a->mutable_values()[i] = static_cast<float>(a->values()[i]);
+  }
+  FloatBlockSparseMatrix a_float(*a);
+  a_float.UpdateValues(*a, &context, kNumThreads);
+
+  Matrix expected_dense;
+  a->ToDenseMatrix(&expected_dense);
+  Matrix dense;
+  a_float.ToDenseMatrix(&dense);
+  EXPECT_EQ((dense - expected_dense).norm(), 0.0);
+
+  Vector expected_norms(a->num_cols());
+  a->SquaredColumnNorm(expected_norms.data());
+  constexpr double kTolerance = 1e-6;
+  for (const int num_threads : {1, kNumThreads}) {
+    Vector norms(a->num_cols());
+    a_float.SquaredColumnNorm(norms.data(), &context, num_threads);
+    EXPECT_LT((norms - expected_norms).norm(),
+              kTolerance * expected_norms.norm());
+  }
+
+  const Vector scale = Vector::Random(a->num_cols());
+  a->ScaleColumns(scale.data());
+  a->ToDenseMatrix(&expected_dense);
+  a_float.ScaleColumns(scale.data(), &context, kNumThreads);
+  a_float.ToDenseMatrix(&dense);
+  EXPECT_LT((dense - expected_dense).norm(),
+            kTolerance * expected_dense.norm());
+
+  a_float.SetZero(&context, kNumThreads);
+  a_float.ToDenseMatrix(&dense);
+  EXPECT_EQ(dense.norm(), 0.0);
+}
+
+// The owning constructor builds the same matrix structure as the copy
+// constructor, which is what the single precision Jacobian writer relies on.
+TEST(FloatBlockSparseMatrix, OwningConstructor) {
+  std::mt19937 prng;
+  BlockSparseMatrix::RandomMatrixOptions options;
+  options.num_row_blocks = 10;
+  options.min_row_block_size = 1;
+  options.max_row_block_size = 3;
+  options.num_col_blocks = 5;
+  options.min_col_block_size = 1;
+  options.max_col_block_size = 3;
+  options.block_density = 0.5;
+  auto a = BlockSparseMatrix::CreateRandomMatrix(options, prng);
+
+  auto* bs = new CompressedRowBlockStructure(*a->block_structure());
+  FloatBlockSparseMatrix a_float(bs);
+  EXPECT_EQ(a_float.num_rows(), a->num_rows());
+  EXPECT_EQ(a_float.num_cols(), a->num_cols());
+  EXPECT_EQ(a_float.num_nonzeros(), a->num_nonzeros());
+  ASSERT_NE(a_float.transpose_block_structure(), nullptr);
+
+  for (int i = 0; i < a->num_nonzeros(); ++i) {
+    a_float.mutable_float_values()[i] = static_cast<float>(a->values()[i]);
+  }
+  const Vector y = Vector::Random(a->num_rows());
+  Vector expected_aty = Vector::Zero(a->num_cols());
+  a->LeftMultiplyAndAccumulate(y.data(), expected_aty.data());
+  Vector aty = Vector::Zero(a->num_cols());
+  a_float.LeftMultiplyAndAccumulate(y.data(), aty.data());
+  EXPECT_LT((aty - expected_aty).norm(), 1e-6 * expected_aty.norm());
+}
+
+// Appending and deleting rows may change whether the row blocks are of
+// uniform size.
+TEST(BlockSparseMatrix, MultiplyAndAccumulateAfterAppendAndDeleteRows) {
+  std::mt19937 prng;
+  BlockSparseMatrix::RandomMatrixOptions options;
+  options.num_row_blocks = 20;
+  options.min_row_block_size = 2;
+  options.max_row_block_size = 2;
+  options.num_col_blocks = 10;
+  options.min_col_block_size = 3;
+  options.max_col_block_size = 3;
+  options.block_density = 0.3;
+  auto a = BlockSparseMatrix::CreateRandomMatrix(options, prng);
+
+  options.min_row_block_size = 5;
+  options.max_row_block_size = 5;
+  options.col_blocks = a->block_structure()->cols;
+  auto b = BlockSparseMatrix::CreateRandomMatrix(options, prng);
+
+  const auto check_products = [](const BlockSparseMatrix& m) {
+    Matrix dense;
+    m.ToDenseMatrix(&dense);
+    const Vector x = Vector::Random(m.num_cols());
+    const Vector y = Vector::Random(m.num_rows());
+    Vector ax = Vector::Zero(m.num_rows());
+    Vector aty = Vector::Zero(m.num_cols());
+    m.RightMultiplyAndAccumulate(x.data(), ax.data());
+    m.LeftMultiplyAndAccumulate(y.data(), aty.data());
+    EXPECT_LT((ax - dense * x).norm(), 1e-12 * ax.norm());
+    EXPECT_LT((aty - dense.transpose() * y).norm(), 1e-12 * aty.norm());
+  };
+
+  check_products(*a);
+  a->AppendRows(*b);
+  check_products(*a);
+  a->DeleteRowBlocks(b->block_structure()->rows.size());
+  check_products(*a);
+}
+
 }  // namespace internal
 }  // namespace ceres
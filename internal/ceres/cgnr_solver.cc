@@ -36,10 +36,14 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "ceres/block_jacobi_preconditioner.h"
+#include "ceres/block_sparse_matrix.h"
+#include "ceres/casts.h"
 #include "ceres/conjugate_gradients_solver.h"
 #include "ceres/cuda_sparse_matrix.h"
 #include "ceres/cuda_vector.h"
+#include "ceres/deflated_conjugate_gradients_solver.h"
 #include "ceres/event_logger.h"
+#include "ceres/incomplete_cholesky_preconditioner.h"
 #include "ceres/internal/eigen.h"
 #include "ceres/linear_solver.h"
 #include "ceres/subset_preconditioner.h"
@@ -123,10 +127,15 @@ class CERES_NO_EXPORT CgnrLinearOperator final
 };
 
 CgnrSolver::CgnrSolver(LinearSolver::Options options)
-    : options_(std::move(options)) {
+    : options_(std::move(options)),
+      preconditioner_refresh_policy_(
+          options_.preconditioner_type,
+          options_.max_num_preconditioner_reuses,
+          options_.preconditioner_refresh_iteration_ratio) {
   if (options_.preconditioner_type != JACOBI &&
       options_.preconditioner_type != IDENTITY &&
-      options_.preconditioner_type != SUBSET) {
+      options_.preconditioner_type != SUBSET &&
+      options_.preconditioner_type != INCOMPLETE_CHOLESKY) {
     LOG(FATAL)
         << "Preconditioner = "
         << PreconditionerTypeToString(options_.preconditioner_type) << ". "
@@ -135,7 +144,7 @@ CgnrSolver::CgnrSolver(LinearSolver::Options options)
 }
 
 CgnrSolver::~CgnrSolver() {
-  for (int i = 0; i < 4; ++i) {
+  for (int i = 0; i < 9; ++i) {
     if (scratch_[i]) {
       delete scratch_[i];
       scratch_[i] = nullptr;
@@ -144,7 +153,7 @@ CgnrSolver::~CgnrSolver() {
 }
 
 LinearSolver::Summary CgnrSolver::SolveImpl(
-    BlockSparseMatrix* A,
+    SparseMatrix* A,
     const double* b,
     const LinearSolver::PerSolveOptions& per_solve_options,
     double* x) {
@@ -160,17 +169,42 @@ LinearSolver::Summary CgnrSolver::SolveImpl(
     preconditioner_options.num_threads = options_.num_threads;
     preconditioner_options.context = options_.context;
 
+    // A single precision Jacobian is only allowed with the JACOBI and
+    // IDENTITY preconditioners, see Solver::Options::IsValid.
     if (options_.preconditioner_type == JACOBI) {
-      preconditioner_ = std::make_unique<BlockSparseJacobiPreconditioner>(
-          preconditioner_options, *A);
+      if (options_.use_single_precision_jacobian) {
+        preconditioner_ = std::make_unique<BlockSparseJacobiPreconditioner>(
+            preconditioner_options, *down_cast<FloatBlockSparseMatrix*>(A));
+      } else {
+        preconditioner_ = std::make_unique<BlockSparseJacobiPreconditioner>(
+            preconditioner_options, *down_cast<BlockSparseMatrix*>(A));
+      }
     } else if (options_.preconditioner_type == SUBSET) {
+      CHECK(!options_.use_single_precision_jacobian);
+      preconditioner_ = std::make_unique<SubsetPreconditioner>(
+          preconditioner_options, *down_cast<BlockSparseMatrix*>(A));
+    } else if (options_.preconditioner_type == INCOMPLETE_CHOLESKY) {
+      CHECK(!options_.use_single_precision_jacobian);
       preconditioner_ =
-          std::make_unique<SubsetPreconditioner>(preconditioner_options, *A);
+          std::make_unique<BlockSparseIncompleteCholeskyPreconditioner>(
+              preconditioner_options, *down_cast<BlockSparseMatrix*>(A));
     } else {
       preconditioner_ = std::make_unique<IdentityPreconditioner>(A->num_cols());
     }
   }
-  preconditioner_->Update(*A, per_solve_options.D);
+  const bool refresh_preconditioner =
+      preconditioner_refresh_policy_.RefreshNeeded();
+  const bool success =
+      refresh_preconditioner
+          ? preconditioner_->Update(*A, per_solve_options.D)
+          : preconditioner_->UpdateDiagonal(per_solve_options.D);
+  if (!success) {
+    LinearSolver::Summary summary;
+    summary.num_iterations = 0;
+    summary.termination_type = LinearSolverTerminationType::FAILURE;
+    summary.message = "Preconditioner update failed.";
+    return summary;
+  }
 
   ConjugateGradientsSolverOptions cg_options;
   cg_options.min_num_iterations = options_.min_num_iterations;
@@ -181,9 +215,21 @@ LinearSolver::Summary CgnrSolver::SolveImpl(
   cg_options.context = options_.context;
   cg_options.num_threads = options_.num_threads;
 
+  // With mixed precision solves, the products with A inside conjugate
+  // gradients use a single precision copy of A.
+  const LinearOperator* lhs_A = A;
+  if (options_.use_mixed_precision_solves) {
+    auto* block_A = down_cast<BlockSparseMatrix*>(A);
+    if (!float_A_) {
+      float_A_ = std::make_unique<FloatBlockSparseMatrix>(*block_A);
+    }
+    float_A_->UpdateValues(*block_A, options_.context, options_.num_threads);
+    lhs_A = float_A_.get();
+  }
+
   // lhs = AtA + DtD
   CgnrLinearOperator lhs(
-      *A, per_solve_options.D, options_.context, options_.num_threads);
+      *lhs_A, per_solve_options.D, options_.context, options_.num_threads);
   // rhs = Atb.
   Vector rhs(A->num_cols());
   rhs.setZero();
@@ -191,7 +237,15 @@ LinearSolver::Summary CgnrSolver::SolveImpl(
       b, rhs.data(), options_.context, options_.num_threads);
 
   cg_solution_ = Vector::Zero(A->num_cols());
-  for (int i = 0; i < 4; ++i) {
+  // Mixed precision solves need two more vectors for the refinement, and
+  // pipelined conjugate gradients needs nine vectors.
+  int num_scratch = 4;
+  if (options_.use_mixed_precision_solves) {
+    num_scratch = 6;
+  } else if (options_.use_pipelined_conjugate_gradients) {
+    num_scratch = 9;
+  }
+  for (int i = 0; i < num_scratch; ++i) {
     if (scratch_[i] == nullptr) {
       scratch_[i] = new Vector(A->num_cols());
     }
@@ -199,9 +253,37 @@ LinearSolver::Summary CgnrSolver::SolveImpl(
   event_logger.AddEvent("Setup");
 
   LinearOperatorAdapter preconditioner(*preconditioner_);
-  auto summary = ConjugateGradientsSolver(
-      cg_options, lhs, rhs, preconditioner, scratch_, cg_solution_);
+  LinearSolver::Summary summary;
+  if (options_.use_mixed_precision_solves) {
+    // Iterative refinement using the products with A recovers the
+    // accuracy lost by using its single precision copy.
+    CgnrLinearOperator refinement_lhs(
+        *A, per_solve_options.D, options_.context, options_.num_threads);
+    summary = RefinedConjugateGradientsSolver(
+        cg_options,
+        refinement_lhs,
+        lhs,
+        rhs,
+        preconditioner,
+        options_.max_num_cg_refinement_iterations,
+        scratch_,
+        cg_solution_);
+  } else if (options_.use_pipelined_conjugate_gradients) {
+    summary = PipelinedConjugateGradientsSolver(
+        cg_options, lhs, rhs, preconditioner, scratch_, cg_solution_);
+  } else if (options_.num_deflation_vectors > 0) {
+    if (deflated_cg_solver_ == nullptr) {
+      deflated_cg_solver_ = std::make_unique<DeflatedConjugateGradientsSolver>(
+          options_.num_deflation_vectors, 3 * options_.num_deflation_vectors);
+    }
+    summary = deflated_cg_solver_->Solve(
+        cg_options, lhs, rhs, preconditioner, cg_solution_);
+  } else {
+    summary = ConjugateGradientsSolver(
+        cg_options, lhs, rhs, preconditioner, scratch_, cg_solution_);
+  }
   VectorRef(x, A->num_cols()) = cg_solution_;
+  preconditioner_refresh_policy_.RecordSolve(refresh_preconditioner, summary);
   event_logger.AddEvent("Solve");
   return summary;
 }
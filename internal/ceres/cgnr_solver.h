@@ -38,12 +38,14 @@
 #include "ceres/cuda_vector.h"
 #include "ceres/internal/export.h"
 #include "ceres/linear_solver.h"
+#include "ceres/preconditioner_refresh_policy.h"
 
 namespace ceres::internal {
 
 class Preconditioner;
 
 class BlockJacobiPreconditioner;
+class DeflatedConjugateGradientsSolver;
 
 // A conjugate gradients on the normal equations solver. This directly solves
 // for the solution to
@@ -52,14 +54,18 @@ class BlockJacobiPreconditioner;
 //
 // as required for solving for x in the least squares sense. Currently only
 // block diagonal preconditioning is supported.
-class CERES_NO_EXPORT CgnrSolver final : public BlockSparseMatrixSolver {
+//
+// A is a BlockSparseMatrix, or a FloatBlockSparseMatrix if
+// options.use_single_precision_jacobian is true.
+class CERES_NO_EXPORT CgnrSolver final
+    : public TypedLinearSolver<SparseMatrix> {
  public:
   explicit CgnrSolver(LinearSolver::Options options);
   CgnrSolver(const CgnrSolver&) = delete;
   void operator=(const CgnrSolver&) = delete;
   ~CgnrSolver() override;
 
-  Summary SolveImpl(BlockSparseMatrix* A,
+  Summary SolveImpl(SparseMatrix* A,
                     const double* b,
                     const LinearSolver::PerSolveOptions& per_solve_options,
                     double* x) final;
@@ -67,8 +73,16 @@ class CERES_NO_EXPORT CgnrSolver final : public BlockSparseMatrixSolver {
  private:
   const LinearSolver::Options options_;
   std::unique_ptr<Preconditioner> preconditioner_;
+  PreconditionerRefreshPolicy preconditioner_refresh_policy_;
+  // Single precision copy of A, used if options_.use_mixed_precision_solves
+  // is true.
+  std::unique_ptr<FloatBlockSparseMatrix> float_A_;
   Vector cg_solution_;
-  Vector* scratch_[4] = {nullptr, nullptr, nullptr, nullptr};
+  Vector* scratch_[9] = {nullptr};
+  // Used if options_.num_deflation_vectors > 0. It is kept across calls to
+  // Solve, so that each solve can deflate the eigenvectors estimated by the
+  // previous one.
+  std::unique_ptr<DeflatedConjugateGradientsSolver> deflated_cg_solver_;
 };
 
 #ifndef CERES_NO_CUDA
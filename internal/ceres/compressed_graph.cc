@@ -0,0 +1,130 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/compressed_graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "ceres/parallel_for.h"
+
+namespace ceres::internal {
+
+std::unique_ptr<CompressedGraph> CompressedGraph::FromCliques(
+    int num_vertices,
+    const std::vector<int>& clique_offsets,
+    const std::vector<int>& clique_vertices,
+    ContextImpl* context,
+    int num_threads) {
+  CHECK_GE(num_vertices, 0);
+  CHECK(!clique_offsets.empty());
+  CHECK_EQ(clique_offsets.back(), clique_vertices.size());
+  const int num_cliques = static_cast<int>(clique_offsets.size()) - 1;
+
+  // The cliques containing vertex v are
+  // vertex_cliques[vertex_clique_offsets[v], vertex_clique_offsets[v + 1]).
+  std::vector<int> vertex_clique_offsets(num_vertices + 1, 0);
+  for (const int vertex : clique_vertices) {
+    DCHECK_GE(vertex, 0);
+    DCHECK_LT(vertex, num_vertices);
+    ++vertex_clique_offsets[vertex + 1];
+  }
+  std::partial_sum(vertex_clique_offsets.begin(),
+                   vertex_clique_offsets.end(),
+                   vertex_clique_offsets.begin());
+  std::vector<int> vertex_cliques(clique_vertices.size());
+  {
+    std::vector<int> position(vertex_clique_offsets.begin(),
+                              vertex_clique_offsets.end() - 1);
+    for (int c = 0; c < num_cliques; ++c) {
+      for (int i = clique_offsets[c]; i < clique_offsets[c + 1]; ++i) {
+        vertex_cliques[position[clique_vertices[i]]++] = c;
+      }
+    }
+  }
+
+  // Gather the neighbors of every vertex, including duplicates and the
+  // vertex itself, into the row reserved for it in candidates.
+  std::vector<int> candidate_offsets(num_vertices + 1, 0);
+  ParallelFor(context, 0, num_vertices, num_threads, [&](int v) {
+    int num_candidates = 0;
+    for (int i = vertex_clique_offsets[v]; i < vertex_clique_offsets[v + 1];
+         ++i) {
+      const int c = vertex_cliques[i];
+      num_candidates += clique_offsets[c + 1] - clique_offsets[c];
+    }
+    candidate_offsets[v + 1] = num_candidates;
+  });
+  int64_t num_candidates = 0;
+  for (int v = 0; v < num_vertices; ++v) {
+    num_candidates += candidate_offsets[v + 1];
+    CHECK_LE(num_candidates, std::numeric_limits<int>::max())
+        << "Graph is too large.";
+    candidate_offsets[v + 1] = static_cast<int>(num_candidates);
+  }
+
+  // Sort and deduplicate the candidates of each vertex, and drop the
+  // vertex itself.
+  std::vector<int> candidates(num_candidates);
+  std::vector<int> degrees(num_vertices);
+  ParallelFor(context, 0, num_vertices, num_threads, [&](int v) {
+    int* row = candidates.data() + candidate_offsets[v];
+    int* row_end = row;
+    for (int i = vertex_clique_offsets[v]; i < vertex_clique_offsets[v + 1];
+         ++i) {
+      const int c = vertex_cliques[i];
+      row_end = std::copy(clique_vertices.data() + clique_offsets[c],
+                          clique_vertices.data() + clique_offsets[c + 1],
+                          row_end);
+    }
+    std::sort(row, row_end);
+    row_end = std::unique(row, row_end);
+    row_end = std::remove(row, row_end, v);
+    degrees[v] = static_cast<int>(row_end - row);
+  });
+
+  auto graph = std::unique_ptr<CompressedGraph>(new CompressedGraph);
+  graph->offsets_.resize(num_vertices + 1);
+  graph->offsets_[0] = 0;
+  std::partial_sum(
+      degrees.begin(), degrees.end(), graph->offsets_.begin() + 1);
+  graph->neighbors_.resize(graph->offsets_.back());
+  ParallelFor(context, 0, num_vertices, num_threads, [&](int v) {
+    std::copy_n(candidates.data() + candidate_offsets[v],
+                degrees[v],
+                graph->neighbors_.data() + graph->offsets_[v]);
+  });
+  return graph;
+}
+
+}  // namespace ceres::internal
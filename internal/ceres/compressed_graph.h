@@ -0,0 +1,103 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_COMPRESSED_GRAPH_H_
+#define CERES_INTERNAL_COMPRESSED_GRAPH_H_
+
+#include <memory>
+#include <vector>
+
+#include "ceres/context_impl.h"
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/export.h"
+
+namespace ceres::internal {
+
+// An immutable unweighted undirected graph on the vertices 0, ...,
+// num_vertices - 1, stored in compressed row format. The neighbors of
+// vertex i are stored contiguously in increasing order.
+//
+// Unlike Graph, which stores a hash set of neighbors per vertex, this
+// uses one int per vertex and one int per (directed) edge, and it can be
+// built in parallel. It is used for computing orderings of large
+// problems, see graph_algorithms.h.
+class CERES_NO_EXPORT CompressedGraph {
+ public:
+  // A range of neighbors of a vertex, usable in range based for loops.
+  class NeighborRange {
+   public:
+    NeighborRange(const int* begin, const int* end)
+        : begin_(begin), end_(end) {}
+    const int* begin() const { return begin_; }
+    const int* end() const { return end_; }
+    int size() const { return static_cast<int>(end_ - begin_); }
+
+   private:
+    const int* begin_;
+    const int* end_;
+  };
+
+  // Creates the graph in which the vertices of each clique are pairwise
+  // connected. The vertices of clique c are
+  //
+  //   clique_vertices[clique_offsets[c], clique_offsets[c + 1]).
+  //
+  // The same edge may be implied by any number of cliques. Repeated
+  // vertices in a clique do not create self loops.
+  static std::unique_ptr<CompressedGraph> FromCliques(
+      int num_vertices,
+      const std::vector<int>& clique_offsets,
+      const std::vector<int>& clique_vertices,
+      ContextImpl* context,
+      int num_threads);
+
+  int num_vertices() const { return static_cast<int>(offsets_.size()) - 1; }
+  // The number of undirected edges.
+  int num_edges() const { return static_cast<int>(neighbors_.size()) / 2; }
+
+  int Degree(int vertex) const {
+    return offsets_[vertex + 1] - offsets_[vertex];
+  }
+
+  NeighborRange Neighbors(int vertex) const {
+    return NeighborRange(neighbors_.data() + offsets_[vertex],
+                         neighbors_.data() + offsets_[vertex + 1]);
+  }
+
+ private:
+  CompressedGraph() = default;
+
+  std::vector<int> offsets_;
+  std::vector<int> neighbors_;
+};
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_COMPRESSED_GRAPH_H_
@@ -0,0 +1,118 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/compressed_graph.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ceres/context_impl.h"
+#include "ceres/graph.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+TEST(CompressedGraph, EmptyGraph) {
+  ContextImpl context;
+  auto graph = CompressedGraph::FromCliques(0, {0}, {}, &context, 1);
+  EXPECT_EQ(graph->num_vertices(), 0);
+  EXPECT_EQ(graph->num_edges(), 0);
+}
+
+TEST(CompressedGraph, FromCliques) {
+  ContextImpl context;
+  // Cliques {0, 1, 2}, {2, 3}, {1, 0} and {4}.
+  const std::vector<int> clique_offsets = {0, 3, 5, 7, 8};
+  const std::vector<int> clique_vertices = {0, 1, 2, 2, 3, 1, 0, 4};
+  auto graph = CompressedGraph::FromCliques(
+      5, clique_offsets, clique_vertices, &context, 1);
+
+  EXPECT_EQ(graph->num_vertices(), 5);
+  EXPECT_EQ(graph->num_edges(), 4);
+  const std::vector<std::vector<int>> expected_neighbors = {
+      {1, 2}, {0, 2}, {0, 1, 3}, {2}, {}};
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(graph->Degree(i), expected_neighbors[i].size());
+    const auto neighbors = graph->Neighbors(i);
+    EXPECT_EQ(std::vector<int>(neighbors.begin(), neighbors.end()),
+              expected_neighbors[i]);
+  }
+}
+
+// Building the graph in parallel gives the same graph as Graph.
+TEST(CompressedGraph, MatchesGraph) {
+  const int kNumVertices = 1000;
+  const int kNumCliques = 3000;
+  const int kNumThreads = 4;
+  std::mt19937 prng;
+  std::uniform_int_distribution<int> vertex_distribution(0, kNumVertices - 1);
+  std::uniform_int_distribution<int> size_distribution(1, 4);
+
+  Graph<int> expected;
+  for (int i = 0; i < kNumVertices; ++i) {
+    expected.AddVertex(i);
+  }
+  std::vector<int> clique_offsets = {0};
+  std::vector<int> clique_vertices;
+  for (int c = 0; c < kNumCliques; ++c) {
+    const int clique_begin = clique_vertices.size();
+    const int clique_size = size_distribution(prng);
+    for (int i = 0; i < clique_size; ++i) {
+      const int vertex = vertex_distribution(prng);
+      for (int j = clique_begin; j < clique_vertices.size(); ++j) {
+        if (clique_vertices[j] != vertex) {
+          expected.AddEdge(clique_vertices[j], vertex);
+        }
+      }
+      clique_vertices.push_back(vertex);
+    }
+    clique_offsets.push_back(clique_vertices.size());
+  }
+
+  ContextImpl context;
+  context.EnsureMinimumThreads(kNumThreads);
+  auto graph = CompressedGraph::FromCliques(
+      kNumVertices, clique_offsets, clique_vertices, &context, kNumThreads);
+  ASSERT_EQ(graph->num_vertices(), kNumVertices);
+  int num_edges = 0;
+  for (int i = 0; i < kNumVertices; ++i) {
+    const auto& expected_neighbors = expected.Neighbors(i);
+    ASSERT_EQ(graph->Degree(i), expected_neighbors.size());
+    int previous = -1;
+    for (const int neighbor : graph->Neighbors(i)) {
+      EXPECT_GT(neighbor, previous);
+      EXPECT_EQ(expected_neighbors.count(neighbor), 1);
+      previous = neighbor;
+    }
+    num_edges += expected_neighbors.size();
+  }
+  EXPECT_EQ(graph->num_edges(), num_edges / 2);
+}
+
+}  // namespace ceres::internal
@@ -0,0 +1,371 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/conjugate_gradients_solver.h"
+
+#include <cmath>
+#include <tuple>
+
+#include "absl/container/fixed_array.h"
+#include "absl/strings/str_format.h"
+#include "ceres/context_impl.h"
+#include "ceres/eigen_vector_ops.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/linear_solver.h"
+#include "ceres/parallel_for.h"
+#include "ceres/parallel_vector_ops.h"
+#include "ceres/types.h"
+
+namespace ceres::internal {
+namespace {
+
+// The dot products needed by an iteration of the pipelined Conjugate
+// Gradients algorithm.
+struct PipelinedDots {
+  // r'u
+  double gamma = 0.0;
+  // w'u
+  double delta = 0.0;
+  // r'r
+  double norm_r_squared = 0.0;
+  // x'(b + r), used by the quadratic model based termination test.
+  double xtbr = 0.0;
+};
+
+PipelinedDots SumDots(const absl::FixedArray<PipelinedDots>& partial_dots) {
+  PipelinedDots dots;
+  for (const PipelinedDots& partial : partial_dots) {
+    dots.gamma += partial.gamma;
+    dots.delta += partial.delta;
+    dots.norm_r_squared += partial.norm_r_squared;
+    dots.xtbr += partial.xtbr;
+  }
+  return dots;
+}
+
+PipelinedDots ComputeDots(const Vector& b,
+                          const Vector& x,
+                          const Vector& r,
+                          const Vector& u,
+                          const Vector& w,
+                          ContextImpl* context,
+                          int num_threads) {
+  absl::FixedArray<PipelinedDots> partial_dots(num_threads);
+  ParallelFor(
+      context,
+      0,
+      b.rows(),
+      num_threads,
+      [&](int thread_id, std::tuple<int, int> range) {
+        auto [start, end] = range;
+        PipelinedDots dots;
+        for (int i = start; i < end; ++i) {
+          dots.gamma += r[i] * u[i];
+          dots.delta += w[i] * u[i];
+          dots.norm_r_squared += r[i] * r[i];
+          dots.xtbr += x[i] * (b[i] + r[i]);
+        }
+        PipelinedDots& thread_dots = partial_dots[thread_id];
+        thread_dots.gamma += dots.gamma;
+        thread_dots.delta += dots.delta;
+        thread_dots.norm_r_squared += dots.norm_r_squared;
+        thread_dots.xtbr += dots.xtbr;
+      },
+      kMinBlockSizeParallelVectorOps);
+  return SumDots(partial_dots);
+}
+
+// Computes the vector updates of an iteration of the pipelined Conjugate
+// Gradients algorithm, i.e.,
+//
+//   z = n + beta * z
+//   q = m + beta * q
+//   s = w + beta * s
+//   p = u + beta * p
+//   x = x + alpha * p
+//   r = r - alpha * s
+//   u = u - alpha * q
+//   w = w - alpha * z
+//
+// and the dot products needed by the next iteration in a single pass over
+// the vectors.
+PipelinedDots UpdateAndComputeDots(double alpha,
+                                   double beta,
+                                   const Vector& b,
+                                   const Vector& m,
+                                   const Vector& n,
+                                   Vector& x,
+                                   Vector& r,
+                                   Vector& u,
+                                   Vector& w,
+                                   Vector& p,
+                                   Vector& s,
+                                   Vector& q,
+                                   Vector& z,
+                                   ContextImpl* context,
+                                   int num_threads) {
+  absl::FixedArray<PipelinedDots> partial_dots(num_threads);
+  ParallelFor(
+      context,
+      0,
+      b.rows(),
+      num_threads,
+      [&](int thread_id, std::tuple<int, int> range) {
+        auto [start, end] = range;
+        PipelinedDots dots;
+        for (int i = start; i < end; ++i) {
+          z[i] = n[i] + beta * z[i];
+          q[i] = m[i] + beta * q[i];
+          s[i] = w[i] + beta * s[i];
+          p[i] = u[i] + beta * p[i];
+          x[i] += alpha * p[i];
+          r[i] -= alpha * s[i];
+          u[i] -= alpha * q[i];
+          w[i] -= alpha * z[i];
+          dots.gamma += r[i] * u[i];
+          dots.delta += w[i] * u[i];
+          dots.norm_r_squared += r[i] * r[i];
+          dots.xtbr += x[i] * (b[i] + r[i]);
+        }
+        PipelinedDots& thread_dots = partial_dots[thread_id];
+        thread_dots.gamma += dots.gamma;
+        thread_dots.delta += dots.delta;
+        thread_dots.norm_r_squared += dots.norm_r_squared;
+        thread_dots.xtbr += dots.xtbr;
+      },
+      kMinBlockSizeParallelVectorOps);
+  return SumDots(partial_dots);
+}
+
+}  // namespace
+
+LinearSolver::Summary PipelinedConjugateGradientsSolver(
+    const ConjugateGradientsSolverOptions options,
+    ConjugateGradientsLinearOperator<Vector>& lhs,
+    const Vector& rhs,
+    ConjugateGradientsLinearOperator<Vector>& preconditioner,
+    Vector* scratch[9],
+    Vector& solution) {
+  auto IsZeroOrInfinity = [](double x) {
+    return ((x == 0.0) || std::isinf(x));
+  };
+
+  ContextImpl* context = options.context;
+  const int num_threads = options.num_threads;
+
+  // In the notation of Ghysels & Vanroose, with M the preconditioner and A
+  // the lhs, these vectors satisfy
+  //
+  //   u = M r, w = A u, m = M w, n = A m,
+  //   s = A p, q = M s, z = A q.
+  Vector& r = *scratch[0];
+  Vector& u = *scratch[1];
+  Vector& w = *scratch[2];
+  Vector& m = *scratch[3];
+  Vector& n = *scratch[4];
+  Vector& p = *scratch[5];
+  Vector& s = *scratch[6];
+  Vector& q = *scratch[7];
+  Vector& z = *scratch[8];
+
+  LinearSolver::Summary summary;
+  summary.termination_type = LinearSolverTerminationType::NO_CONVERGENCE;
+  summary.message = "Maximum number of iterations reached.";
+  summary.num_iterations = 0;
+
+  const double norm_rhs = Norm(rhs, context, num_threads);
+  if (norm_rhs == 0.0) {
+    SetZero(solution, context, num_threads);
+    summary.termination_type = LinearSolverTerminationType::SUCCESS;
+    summary.message = "Convergence. |b| = 0.";
+    return summary;
+  }
+
+  const double tol_r = options.r_tolerance * norm_rhs;
+
+  // r = rhs - A * solution, u = M r, w = A u.
+  auto ComputeResidual = [&]() {
+    SetZero(w, context, num_threads);
+    lhs.RightMultiplyAndAccumulate(solution, w);
+    Axpby(1.0, rhs, -1.0, w, r, context, num_threads);
+    SetZero(u, context, num_threads);
+    preconditioner.RightMultiplyAndAccumulate(r, u);
+    SetZero(w, context, num_threads);
+    lhs.RightMultiplyAndAccumulate(u, w);
+  };
+
+  ComputeResidual();
+  PipelinedDots dots =
+      ComputeDots(rhs, solution, r, u, w, context, num_threads);
+  double norm_r = std::sqrt(dots.norm_r_squared);
+  if (options.min_num_iterations == 0 && norm_r <= tol_r) {
+    summary.termination_type = LinearSolverTerminationType::SUCCESS;
+    summary.message =
+        absl::StrFormat("Convergence. |r| = %e <= %e.", norm_r, tol_r);
+    return summary;
+  }
+
+  // The first iteration uses beta = 0, which requires the search direction
+  // and its products to be finite.
+  SetZero(p, context, num_threads);
+  SetZero(s, context, num_threads);
+  SetZero(q, context, num_threads);
+  SetZero(z, context, num_threads);
+
+  double last_gamma = 1.0;
+  double last_alpha = 1.0;
+
+  // Initial value of the quadratic model Q = x'Ax - 2 * b'x.
+  double Q0 = -dots.xtbr;
+
+  for (summary.num_iterations = 1;; ++summary.num_iterations) {
+    // gamma = r'u plays the role of rho = r'z in ConjugateGradientsSolver.
+    const double gamma = dots.gamma;
+    if (IsZeroOrInfinity(gamma)) {
+      summary.termination_type = LinearSolverTerminationType::FAILURE;
+      summary.message =
+          absl::StrFormat("Numerical failure. gamma = r'u = %e.", gamma);
+      break;
+    }
+
+    double beta = 0.0;
+    // p'Ap, which for the first iteration is u'Au = w'u.
+    double pq = dots.delta;
+    if (summary.num_iterations > 1) {
+      beta = gamma / last_gamma;
+      if (IsZeroOrInfinity(beta)) {
+        summary.termination_type = LinearSolverTerminationType::FAILURE;
+        summary.message = absl::StrFormat(
+            "Numerical failure. beta = gamma_n / gamma_{n-1} = %e, "
+            "gamma_n = %e, gamma_{n-1} = %e",
+            beta,
+            gamma,
+            last_gamma);
+        break;
+      }
+      pq = dots.delta - beta * gamma / last_alpha;
+    }
+
+    if ((pq <= 0) || std::isinf(pq)) {
+      summary.termination_type = LinearSolverTerminationType::NO_CONVERGENCE;
+      summary.message = absl::StrFormat(
+          "Matrix is indefinite, no more progress can be made. p'Ap = %e.",
+          pq);
+      break;
+    }
+
+    const double alpha = gamma / pq;
+    if (std::isinf(alpha)) {
+      summary.termination_type = LinearSolverTerminationType::FAILURE;
+      summary.message = absl::StrFormat(
+          "Numerical failure. alpha = gamma / pq = %e, gamma = %e, pq = %e.",
+          alpha,
+          gamma,
+          pq);
+      break;
+    }
+
+    // m = M w, n = A m.
+    SetZero(m, context, num_threads);
+    preconditioner.RightMultiplyAndAccumulate(w, m);
+    SetZero(n, context, num_threads);
+    lhs.RightMultiplyAndAccumulate(m, n);
+
+    dots = UpdateAndComputeDots(alpha,
+                                beta,
+                                rhs,
+                                m,
+                                n,
+                                solution,
+                                r,
+                                u,
+                                w,
+                                p,
+                                s,
+                                q,
+                                z,
+                                context,
+                                num_threads);
+
+    // The recurrences for r, u and w (and s, q and z which are used to
+    // update them) drift faster than the recurrence for r in
+    // ConjugateGradientsSolver. So every residual_reset_period iterations
+    // all of them are recomputed from solution and p.
+    if (summary.num_iterations % options.residual_reset_period == 0) {
+      ComputeResidual();
+      SetZero(s, context, num_threads);
+      lhs.RightMultiplyAndAccumulate(p, s);
+      SetZero(q, context, num_threads);
+      preconditioner.RightMultiplyAndAccumulate(s, q);
+      SetZero(z, context, num_threads);
+      lhs.RightMultiplyAndAccumulate(q, z);
+      dots = ComputeDots(rhs, solution, r, u, w, context, num_threads);
+    }
+
+    last_gamma = gamma;
+    last_alpha = alpha;
+    norm_r = std::sqrt(dots.norm_r_squared);
+
+    // Quadratic model based termination. See ConjugateGradientsSolver for
+    // details.
+    const double Q1 = -dots.xtbr;
+    const double zeta = summary.num_iterations * (Q1 - Q0) / Q1;
+    if (zeta < options.q_tolerance &&
+        summary.num_iterations >= options.min_num_iterations) {
+      summary.termination_type = LinearSolverTerminationType::SUCCESS;
+      summary.message =
+          absl::StrFormat("Iteration: %d Convergence: zeta = %e < %e. |r| = %e",
+                          summary.num_iterations,
+                          zeta,
+                          options.q_tolerance,
+                          norm_r);
+      break;
+    }
+    Q0 = Q1;
+
+    // Residual based termination.
+    if (norm_r <= tol_r &&
+        summary.num_iterations >= options.min_num_iterations) {
+      summary.termination_type = LinearSolverTerminationType::SUCCESS;
+      summary.message =
+          absl::StrFormat("Iteration: %d Convergence. |r| = %e <= %e.",
+                          summary.num_iterations,
+                          norm_r,
+                          tol_r);
+      break;
+    }
+
+    if (summary.num_iterations >= options.max_num_iterations) {
+      break;
+    }
+  }
+
+  return summary;
+}
+
+}  // namespace ceres::internal
@@ -304,6 +304,160 @@ LinearSolver::Summary ConjugateGradientsSolver(
   return summary;
 }
 
+// Pipelined Conjugate Gradients of Ghysels & Vanroose, "Hiding global
+// synchronization latency in the preconditioned Conjugate Gradient
+// algorithm", Parallel Computing 40(7), 2014.
+//
+// ConjugateGradientsSolver performs several dot products and vector updates
+// per iteration, each of which is a separate parallel loop ending in a
+// barrier. For medium sized systems solved using many threads, these
+// barriers dominate the cost of an iteration. The pipelined variant keeps
+// additional vectors so that the recurrences for the residual and the
+// search direction only need the preconditioned residual and its products
+// with lhs. All vector updates of an iteration and the dot products needed
+// by the next one are then computed in a single parallel sweep, so that
+// apart from the products with lhs and the preconditioner, an iteration has
+// one barrier.
+//
+// The price is one more product with lhs in the setup, more memory traffic
+// per iteration, and somewhat worse numerical stability. As with
+// ConjugateGradientsSolver, every options.residual_reset_period iterations
+// the recurrences are reset by computing the residual as rhs - lhs *
+// solution. This requires three products with lhs and two with the
+// preconditioner.
+//
+// The termination criteria are the same as the ones of
+// ConjugateGradientsSolver.
+//
+// scratch must contain pointers to nine Vector objects of the same size as
+// rhs and solution.
+CERES_NO_EXPORT LinearSolver::Summary PipelinedConjugateGradientsSolver(
+    const ConjugateGradientsSolverOptions options,
+    ConjugateGradientsLinearOperator<Vector>& lhs,
+    const Vector& rhs,
+    ConjugateGradientsLinearOperator<Vector>& preconditioner,
+    Vector* scratch[9],
+    Vector& solution);
+
+// Mixed precision Conjugate Gradients. Solves lhs * solution = rhs by
+// running ConjugateGradientsSolver on low_precision_lhs, an approximation
+// to lhs whose products are cheaper, e.g., because they read single
+// precision copies of the matrices involved. The result is improved using
+// up to max_num_refinement_iterations steps of iterative refinement, i.e.,
+// the residual r = rhs - lhs * solution is computed using lhs, and the
+// correction is computed by solving low_precision_lhs * correction = r.
+//
+// The refinement uses the same termination criteria as
+// ConjugateGradientsSolver, evaluated using lhs. It stops if |r| satisfies
+// options.r_tolerance, or if a correction decreases the quadratic model
+//
+//   Q(x) = x'lhs x / 2 - x'rhs
+//
+// by less than options.q_tolerance * |Q(solution)|. The decrease is
+// estimated as correction'r / 2, which is exact if the correction solves
+// lhs * correction = r. The trust region minimizer disables r_tolerance,
+// so this is the criterion which ends the refinement of its steps.
+//
+// scratch must contain pointers to six DenseVector objects of the same
+// size as rhs and solution. The first four are used as the scratch space
+// of ConjugateGradientsSolver.
+template <typename DenseVectorType>
+LinearSolver::Summary RefinedConjugateGradientsSolver(
+    const ConjugateGradientsSolverOptions options,
+    ConjugateGradientsLinearOperator<DenseVectorType>& lhs,
+    ConjugateGradientsLinearOperator<DenseVectorType>& low_precision_lhs,
+    const DenseVectorType& rhs,
+    ConjugateGradientsLinearOperator<DenseVectorType>& preconditioner,
+    const int max_num_refinement_iterations,
+    DenseVectorType* scratch[6],
+    DenseVectorType& solution) {
+  DenseVectorType& residual = *scratch[4];
+  DenseVectorType& correction = *scratch[5];
+
+  LinearSolver::Summary summary = ConjugateGradientsSolver(
+      options, low_precision_lhs, rhs, preconditioner, scratch, solution);
+  const double norm_rhs = Norm(rhs, options.context, options.num_threads);
+  const double tol_r = options.r_tolerance * norm_rhs;
+  for (int i = 0; i < max_num_refinement_iterations; ++i) {
+    if (summary.termination_type == LinearSolverTerminationType::FAILURE ||
+        summary.termination_type == LinearSolverTerminationType::FATAL_ERROR ||
+        norm_rhs == 0.0) {
+      break;
+    }
+
+    // residual = rhs - lhs * solution
+    SetZero(correction, options.context, options.num_threads);
+    lhs.RightMultiplyAndAccumulate(solution, correction);
+    Axpby(1.0,
+          rhs,
+          -1.0,
+          correction,
+          residual,
+          options.context,
+          options.num_threads);
+    const double norm_r = Norm(residual, options.context, options.num_threads);
+    if (norm_r <= tol_r) {
+      summary.termination_type = LinearSolverTerminationType::SUCCESS;
+      summary.message = absl::StrFormat(
+          "Refinement: %d Convergence. |r| = %e <= %e.", i + 1, norm_r, tol_r);
+      break;
+    }
+
+    // Since lhs * solution = rhs - residual,
+    //
+    //   Q(solution) = -(solution'rhs + solution'residual) / 2.
+    const double Q0 =
+        -0.5 * (Dot(solution, rhs, options.context, options.num_threads) +
+                Dot(solution, residual, options.context, options.num_threads));
+
+    ConjugateGradientsSolverOptions refinement_options = options;
+    refinement_options.min_num_iterations = 0;
+    refinement_options.r_tolerance = (tol_r > 0.0) ? tol_r / norm_r : -1.0;
+    SetZero(correction, options.context, options.num_threads);
+    const LinearSolver::Summary refinement_summary =
+        ConjugateGradientsSolver(refinement_options,
+                                 low_precision_lhs,
+                                 residual,
+                                 preconditioner,
+                                 scratch,
+                                 correction);
+    summary.num_iterations += refinement_summary.num_iterations;
+    summary.termination_type = refinement_summary.termination_type;
+    summary.message = absl::StrFormat(
+        "Refinement: %d %s", i + 1, refinement_summary.message);
+    if (refinement_summary.termination_type ==
+            LinearSolverTerminationType::FAILURE ||
+        refinement_summary.termination_type ==
+            LinearSolverTerminationType::FATAL_ERROR) {
+      break;
+    }
+
+    // solution = solution + correction
+    Axpby(1.0,
+          solution,
+          1.0,
+          correction,
+          solution,
+          options.context,
+          options.num_threads);
+
+    const double decrease =
+        0.5 * Dot(correction, residual, options.context, options.num_threads);
+    const double Q1 = Q0 - decrease;
+    if (decrease <= options.q_tolerance * std::abs(Q1)) {
+      summary.termination_type = LinearSolverTerminationType::SUCCESS;
+      summary.message =
+          absl::StrFormat("Refinement: %d Convergence: decrease = %e <= %e.",
+                          i + 1,
+                          decrease,
+                          options.q_tolerance * std::abs(Q1));
+      break;
+    }
+  }
+
+  return summary;
+}
+
 }  // namespace ceres::internal
 
 #include "ceres/internal/reenable_warnings.h"
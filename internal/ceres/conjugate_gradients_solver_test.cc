@@ -33,10 +33,15 @@
 
 #include "ceres/conjugate_gradients_solver.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <vector>
 
+#include "ceres/context_impl.h"
 #include "ceres/internal/eigen.h"
 #include "ceres/linear_solver.h"
+#include "ceres/parallel_vector_ops.h"
 #include "ceres/preconditioner.h"
 #include "ceres/triplet_sparse_matrix.h"
 #include "ceres/types.h"
@@ -152,4 +157,211 @@ TEST(ConjuateGradientTest, Solves3x3SymmetricSystem) {
   ASSERT_DOUBLE_EQ(2, x(2));
 }
 
+// Conjugate gradients on a perturbed copy of A only solves the system to
+// the accuracy of the perturbation. Iterative refinement using A recovers
+// the solution.
+static Vector RefinedSolve(int max_num_refinement_iterations,
+                           double r_tolerance = 1e-12,
+                           double q_tolerance = 0.0,
+                           LinearSolver::Summary* summary = nullptr) {
+  double diagonal[] = {1.0, 2.0, 3.0};
+  double perturbed_diagonal[] = {1.001, 2.001, 2.999};
+  std::unique_ptr<TripletSparseMatrix> A(
+      TripletSparseMatrix::CreateSparseDiagonalMatrix(diagonal, 3));
+  std::unique_ptr<TripletSparseMatrix> low_precision_A(
+      TripletSparseMatrix::CreateSparseDiagonalMatrix(perturbed_diagonal, 3));
+  Vector b(3);
+  b(0) = 1.0;
+  b(1) = 4.0;
+  b(2) = 9.0;
+  Vector x = Vector::Zero(3);
+
+  ConjugateGradientsSolverOptions cg_options;
+  cg_options.min_num_iterations = 1;
+  cg_options.max_num_iterations = 10;
+  cg_options.residual_reset_period = 20;
+  cg_options.q_tolerance = q_tolerance;
+  cg_options.r_tolerance = r_tolerance;
+
+  Vector scratch[6];
+  for (int i = 0; i < 6; ++i) {
+    scratch[i] = Vector::Zero(A->num_cols());
+  }
+  Vector* scratch_array[6] = {&scratch[0],
+                              &scratch[1],
+                              &scratch[2],
+                              &scratch[3],
+                              &scratch[4],
+                              &scratch[5]};
+  IdentityPreconditioner identity(A->num_cols());
+  LinearOperatorAdapter lhs(*A);
+  LinearOperatorAdapter low_precision_lhs(*low_precision_A);
+  LinearOperatorAdapter preconditioner(identity);
+
+  auto refined_summary =
+      RefinedConjugateGradientsSolver(cg_options,
+                                      lhs,
+                                      low_precision_lhs,
+                                      b,
+                                      preconditioner,
+                                      max_num_refinement_iterations,
+                                      scratch_array,
+                                      x);
+  EXPECT_EQ(refined_summary.termination_type,
+            LinearSolverTerminationType::SUCCESS);
+  if (summary != nullptr) {
+    *summary = refined_summary;
+  }
+  return x;
+}
+
+TEST(ConjugateGradientTest, IterativeRefinement) {
+  const Vector expected = Vector::LinSpaced(3, 1.0, 3.0);
+  EXPECT_GT((RefinedSolve(0) - expected).norm(), 1e-4);
+  EXPECT_LT((RefinedSolve(10) - expected).norm(), 1e-11);
+}
+
+// The trust region minimizer disables r_tolerance, so the refinement has
+// to terminate using q_tolerance. Each correction reduces the error by a
+// factor of about 1e-3, and the decrease of the quadratic model due to a
+// correction is quadratic in the error it removes. So the decrease falls
+// below q_tolerance = 1e-20 after four corrections, by which point the
+// solution is accurate to double precision.
+TEST(ConjugateGradientTest, IterativeRefinementTerminatesUsingQTolerance) {
+  const Vector expected = Vector::LinSpaced(3, 1.0, 3.0);
+  LinearSolver::Summary summary;
+  const Vector x = RefinedSolve(100, -1.0, 1e-20, &summary);
+  EXPECT_LT((x - expected).norm(), 1e-13);
+  // Conjugate gradients solves each of the 3x3 diagonal systems in three
+  // iterations, and q_tolerance terminates it in the fourth.
+  EXPECT_LE(summary.num_iterations, 4 * (1 + 4));
+}
+
+TEST(ConjugateGradientTest, PipelinedSolves3x3SymmetricSystem) {
+  //      | 2  -1  0|
+  //  A = |-1   2 -1| is symmetric positive definite.
+  //      | 0  -1  2|
+  std::unique_ptr<TripletSparseMatrix> A(new TripletSparseMatrix(3, 3, 7));
+  const double values[] = {2.0, -1.0, -1.0, 2.0, -1.0, -1.0, 2.0};
+  const int rows[] = {0, 0, 1, 1, 1, 2, 2};
+  const int cols[] = {0, 1, 0, 1, 2, 1, 2};
+  std::copy(values, values + 7, A->mutable_values());
+  std::copy(rows, rows + 7, A->mutable_rows());
+  std::copy(cols, cols + 7, A->mutable_cols());
+  A->set_num_nonzeros(7);
+
+  Vector b(3);
+  b << -1.0, 0.0, 3.0;
+  Vector x = Vector::Ones(3);
+
+  ConjugateGradientsSolverOptions cg_options;
+  cg_options.min_num_iterations = 1;
+  cg_options.max_num_iterations = 10;
+  cg_options.residual_reset_period = 20;
+  cg_options.q_tolerance = 0.0;
+  cg_options.r_tolerance = 1e-9;
+
+  Vector scratch[9];
+  Vector* scratch_array[9];
+  for (int i = 0; i < 9; ++i) {
+    scratch[i] = Vector::Zero(A->num_cols());
+    scratch_array[i] = &scratch[i];
+  }
+  IdentityPreconditioner identity(A->num_cols());
+  LinearOperatorAdapter lhs(*A);
+  LinearOperatorAdapter preconditioner(identity);
+
+  auto summary = PipelinedConjugateGradientsSolver(
+      cg_options, lhs, b, preconditioner, scratch_array, x);
+
+  EXPECT_EQ(summary.termination_type, LinearSolverTerminationType::SUCCESS);
+  EXPECT_NEAR(0.0, x(0), 1e-12);
+  EXPECT_NEAR(1.0, x(1), 1e-12);
+  EXPECT_NEAR(2.0, x(2), 1e-12);
+}
+
+// Preconditioner which multiplies by the inverse of a diagonal matrix.
+class InverseDiagonalOperator final
+    : public ConjugateGradientsLinearOperator<Vector> {
+ public:
+  explicit InverseDiagonalOperator(const Vector& diagonal)
+      : inverse_diagonal_(diagonal.cwiseInverse()) {}
+  void RightMultiplyAndAccumulate(const Vector& x, Vector& y) final {
+    y.array() += inverse_diagonal_.array() * x.array();
+  }
+
+ private:
+  const Vector inverse_diagonal_;
+};
+
+// The pipelined and the classical conjugate gradients compute the same
+// iterates in exact arithmetic. The system is large enough for the vector
+// operations to be split between threads, and the residual is reset a few
+// times before convergence.
+TEST(ConjugateGradientTest, PipelinedMatchesClassicalConjugateGradients) {
+  const int num_rows = 3 * kMinBlockSizeParallelVectorOps;
+  const int num_threads = 4;
+  ContextImpl context;
+  context.EnsureMinimumThreads(num_threads);
+
+  // A tridiagonal matrix with a varying diagonal, which is strictly
+  // diagonally dominant and hence positive definite.
+  Vector diagonal(num_rows);
+  std::vector<int> rows;
+  std::vector<int> cols;
+  std::vector<double> values;
+  for (int i = 0; i < num_rows; ++i) {
+    diagonal[i] = 2.5 + (i % 7);
+    rows.push_back(i);
+    cols.push_back(i);
+    values.push_back(diagonal[i]);
+    if (i + 1 < num_rows) {
+      rows.push_back(i);
+      cols.push_back(i + 1);
+      values.push_back(-1.0);
+      rows.push_back(i + 1);
+      cols.push_back(i);
+      values.push_back(-1.0);
+    }
+  }
+  TripletSparseMatrix A(num_rows, num_rows, rows, cols, values);
+  Vector b(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    b[i] = 1.0 + (i % 5);
+  }
+
+  ConjugateGradientsSolverOptions cg_options;
+  cg_options.min_num_iterations = 1;
+  cg_options.max_num_iterations = 100;
+  cg_options.residual_reset_period = 3;
+  cg_options.q_tolerance = 0.0;
+  cg_options.r_tolerance = 1e-6;
+  cg_options.context = &context;
+  cg_options.num_threads = num_threads;
+
+  Vector scratch[9];
+  Vector* scratch_array[9];
+  for (int i = 0; i < 9; ++i) {
+    scratch[i] = Vector::Zero(num_rows);
+    scratch_array[i] = &scratch[i];
+  }
+  LinearOperatorAdapter lhs(A);
+  InverseDiagonalOperator preconditioner(diagonal);
+
+  Vector expected = Vector::Zero(num_rows);
+  const auto expected_summary = ConjugateGradientsSolver(
+      cg_options, lhs, b, preconditioner, scratch_array, expected);
+  EXPECT_EQ(expected_summary.termination_type,
+            LinearSolverTerminationType::SUCCESS);
+
+  Vector x = Vector::Zero(num_rows);
+  const auto summary = PipelinedConjugateGradientsSolver(
+      cg_options, lhs, b, preconditioner, scratch_array, x);
+  EXPECT_EQ(summary.termination_type, LinearSolverTerminationType::SUCCESS);
+  EXPECT_GT(summary.num_iterations, cg_options.residual_reset_period);
+  EXPECT_LE(std::abs(summary.num_iterations - expected_summary.num_iterations),
+            1);
+  EXPECT_LT((x - expected).norm(), 1e-10 * expected.norm());
+}
+
 }  // namespace ceres::internal
@@ -265,9 +265,12 @@ bool CoordinateDescentMinimizer::IsOrderingValid(
 // seems to work better in practice, i.e., Cameras before
 // points.
 std::shared_ptr<ParameterBlockOrdering>
-CoordinateDescentMinimizer::CreateOrdering(const Program& program) {
+CoordinateDescentMinimizer::CreateOrdering(const Program& program,
+                                           ContextImpl* context,
+                                           int num_threads) {
   auto ordering = std::make_shared<ParameterBlockOrdering>();
-  ComputeRecursiveIndependentSetOrdering(program, ordering.get());
+  ComputeRecursiveIndependentSetOrdering(
+      program, context, num_threads, ordering.get());
   ordering->Reverse();
   return ordering;
 }
@@ -82,7 +82,7 @@ class CERES_NO_EXPORT CoordinateDescentMinimizer final : public Minimizer {
   // seems to work better in practice, i.e., Cameras before
   // points.
   static std::shared_ptr<ParameterBlockOrdering> CreateOrdering(
-      const Program& program);
+      const Program& program, ContextImpl* context, int num_threads);
 
  private:
   void Solve(Program* program,
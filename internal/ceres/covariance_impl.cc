@@ -366,6 +366,7 @@ bool CovarianceImpl::ComputeCovarianceSparsity(
   // parameter blocks by their pointers.
   std::vector<double*> all_parameter_blocks;
   problem->GetParameterBlocks(&all_parameter_blocks);
+  std::sort(all_parameter_blocks.begin(), all_parameter_blocks.end());
   const ProblemImpl::ParameterMap& parameter_map = problem->parameter_map();
   std::unordered_set<ParameterBlock*> parameter_blocks_in_use;
   std::vector<ResidualBlock*> residual_blocks;
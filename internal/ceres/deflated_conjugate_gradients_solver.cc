@@ -0,0 +1,424 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/deflated_conjugate_gradients_solver.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Eigen/Eigenvalues"
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "ceres/eigen_vector_ops.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/linear_solver.h"
+#include "ceres/types.h"
+
+namespace ceres::internal {
+namespace {
+
+// Directions in the span of the deflation subspace and the Ritz vectors of
+// the Lanczos window, along which the Gram matrix of their (normalized)
+// basis is smaller than this relative to its largest eigenvalue, are
+// considered to be numerically dependent and are dropped by the
+// Rayleigh-Ritz procedure.
+constexpr double kRelativeRankTolerance = 1e-8;
+
+}  // namespace
+
+DeflatedConjugateGradientsSolver::DeflatedConjugateGradientsSolver(
+    int num_deflation_vectors, int num_lanczos_vectors)
+    : num_deflation_vectors_(num_deflation_vectors),
+      num_lanczos_vectors_(num_lanczos_vectors) {
+  CHECK_GT(num_deflation_vectors_, 0);
+  CHECK_GT(num_lanczos_vectors_, 2 * num_deflation_vectors_);
+}
+
+bool DeflatedConjugateGradientsSolver::SetupDeflationSubspace(
+    ConjugateGradientsLinearOperator<Vector>& lhs) {
+  const int num_rows = W_.rows();
+  const int num_cols = W_.cols();
+  AW_.resize(num_rows, num_cols);
+  for (int i = 0; i < num_cols; ++i) {
+    tmp_ = W_.col(i);
+    q_.setZero();
+    lhs.RightMultiplyAndAccumulate(tmp_, q_);
+    AW_.col(i) = q_;
+  }
+
+  Matrix WtAW = W_.transpose() * AW_;
+  WtAW = 0.5 * (WtAW + WtAW.transpose()).eval();
+  WtAW_llt_.compute(WtAW);
+  if (WtAW_llt_.info() != Eigen::Success) {
+    W_.resize(num_rows, 0);
+    return false;
+  }
+  return true;
+}
+
+void DeflatedConjugateGradientsSolver::ProjectOut(const Vector& y,
+                                                  Vector& x) {
+  const Vector mu = WtAW_llt_.solve(AW_.transpose() * y);
+  x.noalias() -= W_ * mu;
+}
+
+void DeflatedConjugateGradientsSolver::AddLanczosVector(const Vector& z,
+                                                        double scale,
+                                                        double diagonal,
+                                                        double off_diagonal) {
+  if (num_window_vectors_ == num_lanczos_vectors_) {
+    RestartLanczosWindow();
+  }
+
+  const int i = num_window_vectors_;
+  V_.col(i) = scale * z;
+  T_(i, i) = diagonal;
+  if (i > 0) {
+    T_.col(i).head(i) = off_diagonal * last_lanczos_vector_coordinates_;
+    T_.row(i).head(i) = T_.col(i).head(i).transpose();
+  }
+  last_lanczos_vector_coordinates_ = Vector::Unit(i + 1, i);
+  ++num_window_vectors_;
+}
+
+void DeflatedConjugateGradientsSolver::RestartLanczosWindow() {
+  const int m = num_window_vectors_;
+  const int k = num_deflation_vectors_;
+
+  // The Ritz vectors of the k smallest Ritz values of the window and of the
+  // window without its last vector. Keeping the latter as well preserves
+  // the information that the Conjugate Gradients recurrence would otherwise
+  // discard, see Stathopoulos & Orginos for details.
+  Matrix Y = Matrix::Zero(m, 2 * k);
+  Eigen::SelfAdjointEigenSolver<Matrix> eigensolver(T_.topLeftCorner(m, m));
+  Y.leftCols(k) = eigensolver.eigenvectors().leftCols(k);
+  eigensolver.compute(T_.topLeftCorner(m - 1, m - 1));
+  Y.block(0, k, m - 1, k) = eigensolver.eigenvectors().leftCols(k);
+
+  // Orthonormalize the combined basis and compute the Ritz vectors in its
+  // span.
+  const Matrix Q = Eigen::HouseholderQR<Matrix>(Y).householderQ() *
+                   Matrix::Identity(m, 2 * k);
+  eigensolver.compute(Q.transpose() * T_.topLeftCorner(m, m) * Q);
+  const Matrix QZ = Q * eigensolver.eigenvectors();
+
+  V_.leftCols(2 * k) = (V_.leftCols(m) * QZ).eval();
+  T_.setZero();
+  T_.diagonal().head(2 * k) = eigensolver.eigenvalues();
+  last_lanczos_vector_coordinates_ = QZ.row(m - 1).transpose();
+  num_window_vectors_ = 2 * k;
+}
+
+void DeflatedConjugateGradientsSolver::UpdateDeflationSubspace(
+    ConjugateGradientsLinearOperator<Vector>& lhs) {
+  const int num_rows = W_.rows();
+  const int num_old_cols = W_.cols();
+  const int num_new_cols =
+      std::min(num_deflation_vectors_, num_window_vectors_);
+  const int num_cols = num_old_cols + num_new_cols;
+
+  // The Ritz vectors of the Lanczos window.
+  Eigen::SelfAdjointEigenSolver<Matrix> window_eigensolver(
+      T_.topLeftCorner(num_window_vectors_, num_window_vectors_));
+  ColMajorMatrix B(num_rows, num_cols);
+  ColMajorMatrix AB(num_rows, num_cols);
+  B.leftCols(num_old_cols) = W_;
+  AB.leftCols(num_old_cols) = AW_;
+  B.rightCols(num_new_cols) =
+      V_.leftCols(num_window_vectors_) *
+      window_eigensolver.eigenvectors().leftCols(num_new_cols);
+  for (int i = num_old_cols; i < num_cols; ++i) {
+    B.col(i).normalize();
+    tmp_ = B.col(i);
+    q_.setZero();
+    lhs.RightMultiplyAndAccumulate(tmp_, q_);
+    AB.col(i) = q_;
+  }
+
+  // The Ritz vectors of A in the span of the columns of B are B * y, where
+  // y solves the generalized eigenvalue problem
+  //
+  //   B'AB y = theta B'B y.
+  //
+  // B'B may be singular, so instead of solving it directly, the problem is
+  // restricted to the range of B'B, i.e., with B'B = V diag(lambda) V' and S
+  // = V diag(lambda^-1/2) restricted to the large enough eigenvalues, y = S
+  // u, where u is an eigenvector of S'B'AB S.
+  const Matrix BtB = B.transpose() * B;
+  Matrix BtAB = B.transpose() * AB;
+  BtAB = 0.5 * (BtAB + BtAB.transpose()).eval();
+
+  Eigen::SelfAdjointEigenSolver<Matrix> gram_eigensolver(BtB);
+  const Vector& gram_eigenvalues = gram_eigensolver.eigenvalues();
+  const double threshold =
+      kRelativeRankTolerance * gram_eigenvalues(num_cols - 1);
+  const int rank =
+      std::count_if(gram_eigenvalues.data(),
+                    gram_eigenvalues.data() + num_cols,
+                    [threshold](double lambda) { return lambda > threshold; });
+  if (rank == 0) {
+    return;
+  }
+
+  // The eigenvalues are sorted in increasing order.
+  const Matrix S =
+      gram_eigensolver.eigenvectors().rightCols(rank) *
+      gram_eigenvalues.tail(rank).cwiseSqrt().cwiseInverse().asDiagonal();
+  const Matrix H = S.transpose() * BtAB * S;
+  Eigen::SelfAdjointEigenSolver<Matrix> ritz_eigensolver(H);
+  const int num_ritz_vectors = std::min(num_deflation_vectors_, rank);
+  const Matrix Y =
+      S * ritz_eigensolver.eigenvectors().leftCols(num_ritz_vectors);
+  W_ = B * Y;
+  for (int i = 0; i < num_ritz_vectors; ++i) {
+    W_.col(i).normalize();
+  }
+}
+
+LinearSolver::Summary DeflatedConjugateGradientsSolver::Solve(
+    const ConjugateGradientsSolverOptions& options,
+    ConjugateGradientsLinearOperator<Vector>& lhs,
+    const Vector& rhs,
+    ConjugateGradientsLinearOperator<Vector>& preconditioner,
+    Vector& solution) {
+  auto IsZeroOrInfinity = [](double x) {
+    return ((x == 0.0) || std::isinf(x));
+  };
+
+  ContextImpl* context = options.context;
+  const int num_threads = options.num_threads;
+
+  const int num_rows = rhs.rows();
+  if (W_.rows() != num_rows) {
+    W_.resize(num_rows, 0);
+  }
+  if (V_.rows() != num_rows) {
+    V_.resize(num_rows, num_lanczos_vectors_);
+    T_.resize(num_lanczos_vectors_, num_lanczos_vectors_);
+  }
+  T_.setZero();
+  num_window_vectors_ = 0;
+  r_.resize(num_rows);
+  z_.resize(num_rows);
+  p_.resize(num_rows);
+  q_.resize(num_rows);
+  tmp_.resize(num_rows);
+
+  LinearSolver::Summary summary;
+  summary.termination_type = LinearSolverTerminationType::NO_CONVERGENCE;
+  summary.message = "Maximum number of iterations reached.";
+  summary.num_iterations = 0;
+
+  const double norm_rhs = Norm(rhs, context, num_threads);
+  if (norm_rhs == 0.0) {
+    SetZero(solution, context, num_threads);
+    summary.termination_type = LinearSolverTerminationType::SUCCESS;
+    summary.message = "Convergence. |b| = 0.";
+    return summary;
+  }
+
+  const double tol_r = options.r_tolerance * norm_rhs;
+
+  const bool use_deflation = W_.cols() > 0 && SetupDeflationSubspace(lhs);
+  if (!use_deflation) {
+    AW_.resize(num_rows, 0);
+  }
+
+  SetZero(tmp_, context, num_threads);
+  lhs.RightMultiplyAndAccumulate(solution, tmp_);
+  // r = rhs - tmp
+  Axpby(1.0, rhs, -1.0, tmp_, r_, context, num_threads);
+  if (use_deflation) {
+    // Solve for the component of the solution in the deflation subspace,
+    // i.e., solution = solution + W (W'AW)^-1 W'r, which makes the residual
+    // orthogonal to W.
+    const Vector mu = WtAW_llt_.solve(W_.transpose() * r_);
+    solution.noalias() += W_ * mu;
+    r_.noalias() -= AW_ * mu;
+  }
+
+  double norm_r = Norm(r_, context, num_threads);
+  if (options.min_num_iterations == 0 && norm_r <= tol_r) {
+    summary.termination_type = LinearSolverTerminationType::SUCCESS;
+    summary.message =
+        absl::StrFormat("Convergence. |r| = %e <= %e.", norm_r, tol_r);
+    return summary;
+  }
+
+  double rho = 1.0;
+  double beta = 0.0;
+  double last_alpha = 1.0;
+
+  // Initial value of the quadratic model Q = x'Ax - 2 * b'x.
+  Axpby(1.0, rhs, 1.0, r_, tmp_, context, num_threads);
+  double Q0 = -Dot(solution, tmp_, context, num_threads);
+
+  for (summary.num_iterations = 1;; ++summary.num_iterations) {
+    SetZero(z_, context, num_threads);
+    preconditioner.RightMultiplyAndAccumulate(r_, z_);
+    // Keep the search direction A-orthogonal to the deflation subspace.
+    // Since r is orthogonal to W, this does not change r'z.
+    if (use_deflation) {
+      ProjectOut(z_, z_);
+    }
+
+    const double last_rho = rho;
+    // rho = r.dot(z);
+    rho = Dot(r_, z_, context, num_threads);
+    // Since r is orthogonal to W, the projection of z can only make r'z
+    // vanish if r = 0. A non-positive value means that the residual is
+    // zero up to round off error.
+    if (use_deflation && rho <= 0.0) {
+      summary.termination_type = LinearSolverTerminationType::SUCCESS;
+      summary.message = absl::StrFormat(
+          "Iteration: %d Convergence. rho = r'z = %e <= 0 after deflation.",
+          summary.num_iterations,
+          rho);
+      break;
+    }
+    if (IsZeroOrInfinity(rho)) {
+      summary.termination_type = LinearSolverTerminationType::FAILURE;
+      summary.message =
+          absl::StrFormat("Numerical failure. rho = r'z = %e.", rho);
+      break;
+    }
+
+    if (summary.num_iterations == 1) {
+      Copy(z_, p_, context, num_threads);
+    } else {
+      beta = rho / last_rho;
+      if (IsZeroOrInfinity(beta)) {
+        summary.termination_type = LinearSolverTerminationType::FAILURE;
+        summary.message = absl::StrFormat(
+            "Numerical failure. beta = rho_n / rho_{n-1} = %e, "
+            "rho_n = %e, rho_{n-1} = %e",
+            beta,
+            rho,
+            last_rho);
+        break;
+      }
+      // p = z + beta * p;
+      Axpby(1.0, z_, beta, p_, p_, context, num_threads);
+    }
+
+    SetZero(q_, context, num_threads);
+    lhs.RightMultiplyAndAccumulate(p_, q_);
+    const double pq = Dot(p_, q_, context, num_threads);
+    if ((pq <= 0) || std::isinf(pq)) {
+      summary.termination_type = LinearSolverTerminationType::NO_CONVERGENCE;
+      summary.message = absl::StrFormat(
+          "Matrix is indefinite, no more progress can be made. "
+          "p'q = %e. |p| = %e, |q| = %e",
+          pq,
+          Norm(p_, context, num_threads),
+          Norm(q_, context, num_threads));
+      break;
+    }
+
+    const double alpha = rho / pq;
+    if (std::isinf(alpha)) {
+      summary.termination_type = LinearSolverTerminationType::FAILURE;
+      summary.message = absl::StrFormat(
+          "Numerical failure. alpha = rho / pq = %e, rho = %e, pq = %e.",
+          alpha,
+          rho,
+          pq);
+      break;
+    }
+
+    // The entries of the Lanczos tridiagonal matrix in terms of the
+    // Conjugate Gradients coefficients, see Saad, Iterative Methods for
+    // Sparse Linear Systems, Section 6.7.3.
+    if (summary.num_iterations == 1) {
+      AddLanczosVector(z_, 1.0 / std::sqrt(rho), 1.0 / alpha, 0.0);
+    } else {
+      AddLanczosVector(z_,
+                       1.0 / std::sqrt(rho),
+                       1.0 / alpha + beta / last_alpha,
+                       -std::sqrt(beta) / last_alpha);
+    }
+    last_alpha = alpha;
+
+    // solution = solution + alpha * p;
+    Axpby(1.0, solution, alpha, p_, solution, context, num_threads);
+
+    // See ConjugateGradientsSolver for why the residual is reset.
+    if (summary.num_iterations % options.residual_reset_period == 0) {
+      SetZero(tmp_, context, num_threads);
+      lhs.RightMultiplyAndAccumulate(solution, tmp_);
+      // r = rhs - tmp;
+      Axpby(1.0, rhs, -1.0, tmp_, r_, context, num_threads);
+    } else {
+      // r = r - alpha * q;
+      Axpby(1.0, r_, -alpha, q_, r_, context, num_threads);
+    }
+
+    // Quadratic model based termination. See ConjugateGradientsSolver for
+    // details.
+    Axpby(1.0, rhs, 1.0, r_, tmp_, context, num_threads);
+    const double Q1 = -Dot(solution, tmp_, context, num_threads);
+    const double zeta = summary.num_iterations * (Q1 - Q0) / Q1;
+    if (zeta < options.q_tolerance &&
+        summary.num_iterations >= options.min_num_iterations) {
+      summary.termination_type = LinearSolverTerminationType::SUCCESS;
+      summary.message =
+          absl::StrFormat("Iteration: %d Convergence: zeta = %e < %e. |r| = %e",
+                          summary.num_iterations,
+                          zeta,
+                          options.q_tolerance,
+                          Norm(r_, context, num_threads));
+      break;
+    }
+    Q0 = Q1;
+
+    // Residual based termination.
+    norm_r = Norm(r_, context, num_threads);
+    if (norm_r <= tol_r &&
+        summary.num_iterations >= options.min_num_iterations) {
+      summary.termination_type = LinearSolverTerminationType::SUCCESS;
+      summary.message =
+          absl::StrFormat("Iteration: %d Convergence. |r| = %e <= %e.",
+                          summary.num_iterations,
+                          norm_r,
+                          tol_r);
+      break;
+    }
+
+    if (summary.num_iterations >= options.max_num_iterations) {
+      break;
+    }
+  }
+
+  if (summary.termination_type != LinearSolverTerminationType::FAILURE &&
+      num_window_vectors_ > 0) {
+    UpdateDeflationSubspace(lhs);
+  }
+  return summary;
+}
+
+}  // namespace ceres::internal
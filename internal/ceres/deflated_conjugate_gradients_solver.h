@@ -0,0 +1,147 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_DEFLATED_CONJUGATE_GRADIENTS_SOLVER_H_
+#define CERES_INTERNAL_DEFLATED_CONJUGATE_GRADIENTS_SOLVER_H_
+
+#include "Eigen/Cholesky"
+#include "ceres/conjugate_gradients_solver.h"
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/internal/export.h"
+#include "ceres/linear_solver.h"
+
+namespace ceres::internal {
+
+// Deflated Preconditioned Conjugate Gradients for sequences of closely
+// related positive definite linear systems, e.g., the linear systems solved
+// in consecutive iterations of the Levenberg-Marquardt algorithm.
+//
+// The convergence of Conjugate Gradients is slowed down by a few small
+// eigenvalues of the (preconditioned) linear system. Given a subspace W
+// spanned by approximate eigenvectors corresponding to them, the deflated
+// algorithm starts from the solution projected onto W and keeps the search
+// directions A-orthogonal to W, i.e., the component of the solution in W is
+// computed exactly and the iterations only have to deal with the rest of the
+// spectrum. See
+//
+//   Y. Saad, M. Yeung, J. Erhel and F. Guyomarc'h, A deflated version of
+//   the conjugate gradient algorithm, SIAM Journal on Scientific Computing
+//   21(5), 1909-1926, 2000.
+//
+// W is recycled between calls to Solve. The coefficients computed by
+// Conjugate Gradients define the Lanczos tridiagonal matrix of the system,
+// and the Lanczos vectors are the normalized preconditioned residuals. Each
+// solve keeps a window of the most recent num_lanczos_vectors Lanczos
+// vectors, and whenever it fills up, it is restarted using the Ritz vectors
+// of the smallest Ritz values of the current and the previous step. This is
+// the eigCG algorithm of
+//
+//   A. Stathopoulos and K. Orginos, Computing and deflating eigenvalues
+//   while solving multiple right hand side linear systems with an
+//   application to quantum chromodynamics, SIAM Journal on Scientific
+//   Computing 32(1), 439-462, 2010.
+//
+// At the end of a solve, the Rayleigh-Ritz procedure on the span of W and
+// the Ritz vectors computed by the solve gives the next W.
+//
+// Setting up W for a solve costs num_deflation_vectors products with A,
+// which are needed because A changes between solves, and as many to
+// update W. Each iteration does num_deflation_vectors more dot products and
+// axpys than ConjugateGradientsSolver, and a restart of the window costs
+// O(n * num_lanczos_vectors * num_deflation_vectors) operations.
+class CERES_NO_EXPORT DeflatedConjugateGradientsSolver {
+ public:
+  // num_deflation_vectors is the maximum dimension of W and
+  // num_lanczos_vectors, which must be larger than 2 *
+  // num_deflation_vectors, is the size of the window of Lanczos vectors.
+  DeflatedConjugateGradientsSolver(int num_deflation_vectors,
+                                   int num_lanczos_vectors);
+
+  // Solves lhs * solution = rhs, using the value of solution as the
+  // starting point. The options and the termination criteria are the same
+  // as the ones of ConjugateGradientsSolver.
+  LinearSolver::Summary Solve(
+      const ConjugateGradientsSolverOptions& options,
+      ConjugateGradientsLinearOperator<Vector>& lhs,
+      const Vector& rhs,
+      ConjugateGradientsLinearOperator<Vector>& preconditioner,
+      Vector& solution);
+
+  // The current deflation subspace, one unit norm vector per column.
+  const ColMajorMatrix& deflation_subspace() const { return W_; }
+
+ private:
+  // Computes AW_ and the Cholesky factorization of W'AW. Returns false and
+  // discards W_ if W'AW is not positive definite.
+  bool SetupDeflationSubspace(ConjugateGradientsLinearOperator<Vector>& lhs);
+  // x = x - W (W'AW)^-1 (AW)' y, which makes x A-orthogonal to W if x = y.
+  void ProjectOut(const Vector& y, Vector& x);
+  // Appends the Lanczos vector scale * z to the window, along with the new
+  // diagonal and off-diagonal entries of the Lanczos tridiagonal matrix.
+  void AddLanczosVector(const Vector& z,
+                        double scale,
+                        double diagonal,
+                        double off_diagonal);
+  // Replaces the window with the Ritz vectors corresponding to the
+  // num_deflation_vectors_ smallest Ritz values of the window and of the
+  // window without its last vector.
+  void RestartLanczosWindow();
+  // Replaces W_ with the Ritz vectors of A in the span of W_ and the Ritz
+  // vectors of the Lanczos window, corresponding to the smallest Ritz
+  // values.
+  void UpdateDeflationSubspace(ConjugateGradientsLinearOperator<Vector>& lhs);
+
+  const int num_deflation_vectors_;
+  const int num_lanczos_vectors_;
+
+  ColMajorMatrix W_;
+  ColMajorMatrix AW_;
+  Eigen::LLT<Matrix> WtAW_llt_;
+
+  // The window of Lanczos vectors V_, the projection T_ = V_'AV_ of the
+  // linear system onto it, and the number of vectors in the window.
+  ColMajorMatrix V_;
+  Matrix T_;
+  int num_window_vectors_ = 0;
+  // The coordinates of the last Lanczos vector in the window, which are
+  // needed to compute the projection of A onto the next one.
+  Vector last_lanczos_vector_coordinates_;
+
+  Vector r_;
+  Vector z_;
+  Vector p_;
+  Vector q_;
+  Vector tmp_;
+};
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_DEFLATED_CONJUGATE_GRADIENTS_SOLVER_H_
@@ -0,0 +1,143 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/deflated_conjugate_gradients_solver.h"
+
+#include <memory>
+#include <random>
+
+#include "ceres/conjugate_gradients_solver.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/linear_solver.h"
+#include "ceres/preconditioner.h"
+#include "ceres/triplet_sparse_matrix.h"
+#include "ceres/types.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+constexpr int kNumRows = 200;
+constexpr int kNumSmallEigenvalues = 6;
+
+// A diagonal matrix with a few small eigenvalues and the rest in [1, 2],
+// scaled by 1 + scale to get a sequence of closely related matrices.
+static std::unique_ptr<TripletSparseMatrix> CreateMatrix(double scale) {
+  Vector diagonal(kNumRows);
+  for (int i = 0; i < kNumRows; ++i) {
+    diagonal[i] = (i < kNumSmallEigenvalues)
+                      ? 1e-4 * (i + 1)
+                      : 1.0 + static_cast<double>(i) / kNumRows;
+  }
+  diagonal *= 1.0 + scale;
+  return std::unique_ptr<TripletSparseMatrix>(
+      TripletSparseMatrix::CreateSparseDiagonalMatrix(diagonal.data(),
+                                                      kNumRows));
+}
+
+static ConjugateGradientsSolverOptions CreateOptions() {
+  ConjugateGradientsSolverOptions options;
+  options.min_num_iterations = 1;
+  options.max_num_iterations = kNumRows;
+  options.residual_reset_period = 10;
+  options.q_tolerance = 0.0;
+  options.r_tolerance = 1e-10;
+  return options;
+}
+
+TEST(DeflatedConjugateGradientsSolver, SolvesSequenceOfSystems) {
+  std::mt19937 prng;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  const ConjugateGradientsSolverOptions options = CreateOptions();
+  IdentityPreconditioner identity(kNumRows);
+  LinearOperatorAdapter preconditioner(identity);
+
+  DeflatedConjugateGradientsSolver solver(kNumSmallEigenvalues, 16);
+  for (int i = 0; i < 4; ++i) {
+    std::unique_ptr<TripletSparseMatrix> A = CreateMatrix(0.01 * i);
+    LinearOperatorAdapter lhs(*A);
+    Vector b(kNumRows);
+    for (int j = 0; j < kNumRows; ++j) {
+      b[j] = distribution(prng);
+    }
+
+    Vector x = Vector::Zero(kNumRows);
+    const LinearSolver::Summary summary =
+        solver.Solve(options, lhs, b, preconditioner, x);
+    EXPECT_EQ(summary.termination_type, LinearSolverTerminationType::SUCCESS)
+        << summary.message;
+
+    Vector Ax = Vector::Zero(kNumRows);
+    A->RightMultiplyAndAccumulate(x.data(), Ax.data());
+    EXPECT_LE((b - Ax).norm(), 1e-9 * b.norm());
+
+    // After the first solve, the deflation subspace consists of the
+    // harvested Ritz vectors.
+    EXPECT_EQ(solver.deflation_subspace().cols(), kNumSmallEigenvalues);
+  }
+}
+
+// The first solve captures approximations to the eigenvectors with small
+// eigenvalues, which the second solve deflates. It should need far fewer
+// iterations than Conjugate Gradients without deflation.
+TEST(DeflatedConjugateGradientsSolver, ReducesNumberOfIterations) {
+  const ConjugateGradientsSolverOptions options = CreateOptions();
+  IdentityPreconditioner identity(kNumRows);
+  LinearOperatorAdapter preconditioner(identity);
+  const Vector b = Vector::Ones(kNumRows);
+
+  DeflatedConjugateGradientsSolver solver(kNumSmallEigenvalues, 16);
+  std::unique_ptr<TripletSparseMatrix> A = CreateMatrix(0.0);
+  LinearOperatorAdapter lhs(*A);
+  Vector x = Vector::Zero(kNumRows);
+  solver.Solve(options, lhs, b, preconditioner, x);
+
+  std::unique_ptr<TripletSparseMatrix> next_A = CreateMatrix(0.01);
+  LinearOperatorAdapter next_lhs(*next_A);
+  x.setZero();
+  const LinearSolver::Summary deflated_summary =
+      solver.Solve(options, next_lhs, b, preconditioner, x);
+  EXPECT_EQ(deflated_summary.termination_type,
+            LinearSolverTerminationType::SUCCESS);
+
+  Vector scratch[4];
+  Vector* scratch_array[4];
+  for (int i = 0; i < 4; ++i) {
+    scratch[i].resize(kNumRows);
+    scratch_array[i] = &scratch[i];
+  }
+  Vector expected = Vector::Zero(kNumRows);
+  const LinearSolver::Summary summary = ConjugateGradientsSolver(
+      options, next_lhs, b, preconditioner, scratch_array, expected);
+  EXPECT_EQ(summary.termination_type, LinearSolverTerminationType::SUCCESS);
+
+  EXPECT_LT(deflated_summary.num_iterations, summary.num_iterations / 2)
+      << deflated_summary.num_iterations << " " << summary.num_iterations;
+  EXPECT_LE((x - expected).norm(), 1e-6 * expected.norm());
+}
+
+}  // namespace ceres::internal
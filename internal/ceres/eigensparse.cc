@@ -34,7 +34,9 @@
 
 #ifdef CERES_USE_EIGEN_SPARSE
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #ifndef CERES_NO_EIGEN_METIS
 #include <iostream>  // This is needed because MetisSupport depends on iostream.
@@ -52,6 +54,126 @@
 
 namespace ceres::internal {
 
+namespace {
+
+// Eigen's SimplicialLDLT extended with rank one updates and downdates of the
+// factorization P A P' = L D L'. These depend on the representation of the
+// factorization in Eigen::SimplicialCholeskyBase: m_matrix holds the strictly
+// lower triangular part of L column-wise with sorted row indices, m_diag
+// holds D, m_parent the elimination tree of P A P' and P is m_P.
+//
+// A rank one update of L D L' by a vector w only modifies the columns of L
+// on the path from the first non-zero of w to the root of the elimination
+// tree [1]. If the pattern of w w' is contained in that of A, L does not
+// change sparsity and the update is done in place using Method C1 of [2].
+//
+// [1] T. A. Davis and W. W. Hager, Modifying a Sparse Cholesky
+//     Factorization, SIAM J. Matrix Anal. Appl., 20(3), 1999.
+// [2] P. E. Gill, G. H. Golub, W. Murray and M. A. Saunders, Methods for
+//     Modifying Matrix Factorizations, Math. Comp., 28(126), 1974.
+template <typename Scalar, typename Ordering>
+class UpdatableSimplicialLDLT final
+    : public Eigen::SimplicialLDLT<Eigen::SparseMatrix<Scalar>,
+                                   Eigen::Upper,
+                                   Ordering> {
+ public:
+  // Returns true if updating the factorization with a row of W would add a
+  // non-zero to L.
+  bool UpdateCausesFillIn(const CompressedRowSparseMatrix& W) {
+    const int* Lp = this->m_matrix.outerIndexPtr();
+    const int* Li = this->m_matrix.innerIndexPtr();
+    for (int row = 0; row < W.num_rows(); ++row) {
+      pattern_.clear();
+      for (int idx = W.rows()[row]; idx < W.rows()[row + 1]; ++idx) {
+        pattern_.push_back(PermutedIndex(W.cols()[idx]));
+      }
+      if (pattern_.empty()) {
+        continue;
+      }
+
+      // The update only preserves the sparsity of L if the rest of the
+      // pattern of w is in the column of L at its first non-zero. The
+      // elimination tree then guarantees that this holds for all the
+      // subsequent columns along the path.
+      std::sort(pattern_.begin(), pattern_.end());
+      const int first = pattern_[0];
+      const int* column_begin = Li + Lp[first];
+      const int* column_end = column_begin + this->m_nonZerosPerCol[first];
+      for (int i = 1; i < pattern_.size(); ++i) {
+        if (pattern_[i] != pattern_[i - 1] &&
+            !std::binary_search(column_begin, column_end, pattern_[i])) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Replaces the factorization of A by that of A + sigma * W' W, where sigma
+  // is 1 or -1, one row of W at a time. Returns false if the result is not
+  // positive definite, in which case the factorization is no longer valid.
+  bool RankUpdate(const CompressedRowSparseMatrix& W, const Scalar sigma) {
+    const int* Lp = this->m_matrix.outerIndexPtr();
+    const int* Li = this->m_matrix.innerIndexPtr();
+    Scalar* Lx = this->m_matrix.valuePtr();
+    auto& D = this->m_diag;
+    const auto& parent = this->m_parent;
+
+    // w_ is all zeros between rows, as each row clears the entries it sets.
+    w_.setZero(this->cols());
+    for (int row = 0; row < W.num_rows(); ++row) {
+      int first = this->cols();
+      for (int idx = W.rows()[row]; idx < W.rows()[row + 1]; ++idx) {
+        const int j = PermutedIndex(W.cols()[idx]);
+        w_[j] += static_cast<Scalar>(W.values()[idx]);
+        first = std::min(first, j);
+      }
+      if (first == this->cols()) {
+        continue;
+      }
+
+      bool positive_definite = true;
+      Scalar alpha = sigma;
+      for (int j = first; j != -1; j = parent[j]) {
+        const Scalar p = w_[j];
+        w_[j] = Scalar(0);
+        if (p == Scalar(0) || !positive_definite) {
+          continue;
+        }
+        const Scalar d = D[j];
+        const Scalar d_bar = d + alpha * p * p;
+        if (!(d_bar > Scalar(0))) {
+          // Keep walking up the tree to clear w_.
+          positive_definite = false;
+          continue;
+        }
+        const Scalar beta = p * alpha / d_bar;
+        alpha *= d / d_bar;
+        D[j] = d_bar;
+        for (int k = Lp[j]; k < Lp[j] + this->m_nonZerosPerCol[j]; ++k) {
+          Scalar& w_i = w_[Li[k]];
+          w_i -= p * Lx[k];
+          Lx[k] += beta * w_i;
+        }
+      }
+      if (!positive_definite) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  int PermutedIndex(int i) const {
+    return this->m_P.size() > 0 ? this->m_P.indices()[i] : i;
+  }
+
+  std::vector<int> pattern_;
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> w_;
+};
+
+}  // namespace
+
 template <typename Solver>
 class EigenSparseCholeskyTemplate final : public SparseCholesky {
  public:
@@ -80,11 +202,41 @@ class EigenSparseCholeskyTemplate final : public SparseCholesky {
       analyzed_ = true;
     }
 
+    factorized_ = false;
     solver_.factorize(lhs);
     if (solver_.info() != Eigen::Success) {
       *message = "Eigen failure. Unable to find numeric factorization.";
       return LinearSolverTerminationType::FAILURE;
     }
+    factorized_ = true;
+    return LinearSolverTerminationType::SUCCESS;
+  }
+
+  LinearSolverTerminationType UpdateFactorization(
+      const CompressedRowSparseMatrix& W,
+      bool downdate,
+      std::string* message) final {
+    CHECK_EQ(W.storage_type(),
+             CompressedRowSparseMatrix::StorageType::UNSYMMETRIC);
+    if (!factorized_) {
+      *message = "UpdateFactorization called without a valid factorization.";
+      return LinearSolverTerminationType::FATAL_ERROR;
+    }
+    CHECK_EQ(W.num_cols(), solver_.cols());
+
+    if (solver_.UpdateCausesFillIn(W)) {
+      *message =
+          "Unable to update the factorization in place, the update changes "
+          "its sparsity.";
+      return LinearSolverTerminationType::FATAL_ERROR;
+    }
+
+    using Scalar = typename Solver::Scalar;
+    if (!solver_.RankUpdate(W, downdate ? Scalar(-1) : Scalar(1))) {
+      factorized_ = false;
+      *message = "Eigen failure. Downdated matrix is not positive definite.";
+      return LinearSolverTerminationType::FAILURE;
+    }
     return LinearSolverTerminationType::SUCCESS;
   }
 
@@ -143,26 +295,23 @@ class EigenSparseCholeskyTemplate final : public SparseCholesky {
   Eigen::Matrix<typename Solver::Scalar, Eigen::Dynamic, 1> values_;
 
   bool analyzed_{false};
+  bool factorized_{false};
   Solver solver_;
 };
 
 std::unique_ptr<SparseCholesky> EigenSparseCholesky::Create(
     const OrderingType ordering_type) {
-  using WithAMDOrdering = Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>,
-                                                Eigen::Upper,
-                                                Eigen::AMDOrdering<int>>;
+  using WithAMDOrdering =
+      UpdatableSimplicialLDLT<double, Eigen::AMDOrdering<int>>;
   using WithNaturalOrdering =
-      Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>,
-                            Eigen::Upper,
-                            Eigen::NaturalOrdering<int>>;
+      UpdatableSimplicialLDLT<double, Eigen::NaturalOrdering<int>>;
 
   if (ordering_type == OrderingType::AMD) {
     return std::make_unique<EigenSparseCholeskyTemplate<WithAMDOrdering>>();
   } else if (ordering_type == OrderingType::NESDIS) {
 #ifndef CERES_NO_EIGEN_METIS
-    using WithMetisOrdering = Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>,
-                                                    Eigen::Upper,
-                                                    Eigen::MetisOrdering<int>>;
+    using WithMetisOrdering =
+        UpdatableSimplicialLDLT<double, Eigen::MetisOrdering<int>>;
     return std::make_unique<EigenSparseCholeskyTemplate<WithMetisOrdering>>();
 #else
     LOG(FATAL)
@@ -178,20 +327,16 @@ EigenSparseCholesky::~EigenSparseCholesky() = default;
 
 std::unique_ptr<SparseCholesky> FloatEigenSparseCholesky::Create(
     const OrderingType ordering_type) {
-  using WithAMDOrdering = Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>,
-                                                Eigen::Upper,
-                                                Eigen::AMDOrdering<int>>;
+  using WithAMDOrdering =
+      UpdatableSimplicialLDLT<float, Eigen::AMDOrdering<int>>;
   using WithNaturalOrdering =
-      Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>,
-                            Eigen::Upper,
-                            Eigen::NaturalOrdering<int>>;
+      UpdatableSimplicialLDLT<float, Eigen::NaturalOrdering<int>>;
   if (ordering_type == OrderingType::AMD) {
     return std::make_unique<EigenSparseCholeskyTemplate<WithAMDOrdering>>();
   } else if (ordering_type == OrderingType::NESDIS) {
 #ifndef CERES_NO_EIGEN_METIS
-    using WithMetisOrdering = Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>,
-                                                    Eigen::Upper,
-                                                    Eigen::MetisOrdering<int>>;
+    using WithMetisOrdering =
+        UpdatableSimplicialLDLT<float, Eigen::MetisOrdering<int>>;
     return std::make_unique<EigenSparseCholeskyTemplate<WithMetisOrdering>>();
 #else
     LOG(FATAL)
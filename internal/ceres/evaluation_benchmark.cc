@@ -44,6 +44,7 @@
 #include "ceres/cuda_vector.h"
 #include "ceres/evaluator.h"
 #include "ceres/implicit_schur_complement.h"
+#include "ceres/inner_product_computer.h"
 #include "ceres/partitioned_matrix_view.h"
 #include "ceres/power_series_expansion_preconditioner.h"
 #include "ceres/preprocessor.h"
@@ -727,6 +728,21 @@ static void JacobianLeftMultiplyAndAccumulate(benchmark::State& state,
   CHECK_GT(y.squaredNorm(), 0.);
 }
 
+static void JacobianInnerProduct(benchmark::State& state,
+                                 BALData* data,
+                                 ContextImpl* context) {
+  const int num_threads = static_cast<int>(state.range(0));
+
+  auto jacobian = data->BlockSparseJacobian(context);
+  auto inner_product_computer = InnerProductComputer::Create(
+      *jacobian, CompressedRowSparseMatrix::StorageType::UPPER_TRIANGULAR);
+
+  for (auto _ : state) {
+    inner_product_computer->Compute(context, num_threads);
+  }
+  CHECK_GT(inner_product_computer->result().num_nonzeros(), 0);
+}
+
 #ifndef CERES_NO_CUDA
 static void JacobianRightMultiplyAndAccumulateCuda(benchmark::State& state,
                                                    BALData* data,
@@ -1059,6 +1075,19 @@ int main(int argc, char** argv) {
         ->Arg(8)
         ->Arg(16);
 
+    const std::string name_inner_product =
+        "JacobianInnerProduct<" + path + ">";
+    ::benchmark::RegisterBenchmark(name_inner_product.c_str(),
+                                   ceres::internal::JacobianInnerProduct,
+                                   data,
+                                   &context)
+        ->Arg(1)
+        ->Arg(2)
+        ->Arg(4)
+        ->Arg(8)
+        ->Arg(16)
+        ->Arg(32);
+
     const std::string name_to_crs = "JacobianToCRS<" + path + ">";
     ::benchmark::RegisterBenchmark(
         name_to_crs.c_str(), ceres::internal::JacobianToCRS, data, &context);
@@ -73,6 +73,10 @@ std::unique_ptr<Evaluator> Evaluator::Create(const Evaluator::Options& options,
         return std::make_unique<ProgramEvaluator<ScratchEvaluatePreparer,
                                                  CompressedRowJacobianWriter>>(
             options, program);
+      } else if (options.use_single_precision_jacobian) {
+        return std::make_unique<ProgramEvaluator<ScratchEvaluatePreparer,
+                                                 FloatBlockJacobianWriter>>(
+            options, program);
       } else {
         return std::make_unique<
             ProgramEvaluator<BlockEvaluatePreparer, BlockJacobianWriter>>(
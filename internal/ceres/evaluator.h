@@ -68,6 +68,8 @@ class CERES_NO_EXPORT Evaluator {
     SparseLinearAlgebraLibraryType sparse_linear_algebra_library_type =
         NO_SPARSE;
     bool dynamic_sparsity = false;
+    // Only used with CGNR, see FloatBlockJacobianWriter.
+    bool use_single_precision_jacobian = false;
     ContextImpl* context = nullptr;
     EvaluationCallback* evaluation_callback = nullptr;
   };
@@ -33,14 +33,22 @@
 
 #include "ceres/evaluator.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
 #include "absl/strings/str_format.h"
+#include "ceres/block_evaluate_preparer.h"
+#include "ceres/block_jacobian_writer.h"
+#include "ceres/block_sparse_matrix.h"
 #include "ceres/casts.h"
+#include "ceres/context_impl.h"
 #include "ceres/cost_function.h"
 #include "ceres/crs_matrix.h"
 #include "ceres/evaluator_test_utils.h"
@@ -48,6 +56,7 @@
 #include "ceres/manifold.h"
 #include "ceres/problem_impl.h"
 #include "ceres/program.h"
+#include "ceres/program_evaluator.h"
 #include "ceres/sized_cost_function.h"
 #include "ceres/sparse_matrix.h"
 #include "ceres/types.h"
@@ -106,14 +115,17 @@ class ParameterIgnoringCostFunction
 struct EvaluatorTestOptions {
   EvaluatorTestOptions(LinearSolverType linear_solver_type,
                        int num_eliminate_blocks,
-                       bool dynamic_sparsity = false)
+                       bool dynamic_sparsity = false,
+                       bool use_single_precision_jacobian = false)
       : linear_solver_type(linear_solver_type),
         num_eliminate_blocks(num_eliminate_blocks),
-        dynamic_sparsity(dynamic_sparsity) {}
+        dynamic_sparsity(dynamic_sparsity),
+        use_single_precision_jacobian(use_single_precision_jacobian) {}
 
   LinearSolverType linear_solver_type;
   int num_eliminate_blocks;
   bool dynamic_sparsity;
+  bool use_single_precision_jacobian;
 };
 
 struct EvaluatorTest : public ::testing::TestWithParam<EvaluatorTestOptions> {
@@ -138,6 +150,8 @@ struct EvaluatorTest : public ::testing::TestWithParam<EvaluatorTestOptions> {
     options.linear_solver_type = GetParam().linear_solver_type;
     options.num_eliminate_blocks = GetParam().num_eliminate_blocks;
     options.dynamic_sparsity = GetParam().dynamic_sparsity;
+    options.use_single_precision_jacobian =
+        GetParam().use_single_precision_jacobian;
     options.context = problem.context();
     std::string error;
     return Evaluator::Create(options, program, &error);
@@ -577,7 +591,9 @@ INSTANTIATE_TEST_SUITE_P(
                       EvaluatorTestOptions(ITERATIVE_SCHUR, 3),
                       EvaluatorTestOptions(ITERATIVE_SCHUR, 4),
                       EvaluatorTestOptions(SPARSE_NORMAL_CHOLESKY, 0, false),
-                      EvaluatorTestOptions(SPARSE_NORMAL_CHOLESKY, 0, true)));
+                      EvaluatorTestOptions(SPARSE_NORMAL_CHOLESKY, 0, true),
+                      EvaluatorTestOptions(CGNR, 0),
+                      EvaluatorTestOptions(CGNR, 0, false, true)));
 
 // Simple cost function used to check if the evaluator is sensitive to
 // state changes.
@@ -676,6 +692,241 @@ TEST(Evaluator, EvaluatorRespectsParameterChanges) {
   }
 }
 
+TEST(Evaluator, MultiThreadedEvaluationWithCostBalancing) {
+  constexpr int kNumResidualBlocks = 1000;
+  constexpr int kNumThreads = 4;
+  ProblemImpl problem;
+  std::vector<double> x(2 * kNumResidualBlocks);
+  for (int i = 0; i < kNumResidualBlocks; ++i) {
+    x[2 * i] = i;
+    x[2 * i + 1] = -i;
+    problem.AddResidualBlock(
+        new ParameterSensitiveCostFunction(), nullptr, &x[2 * i]);
+  }
+  Program* program = problem.mutable_program();
+  program->SetParameterOffsetsAndIndex();
+  problem.context()->EnsureMinimumThreads(kNumThreads);
+
+  Evaluator::Options options;
+  options.linear_solver_type = SPARSE_NORMAL_CHOLESKY;
+  options.num_eliminate_blocks = 0;
+  options.num_threads = kNumThreads;
+  options.context = problem.context();
+  std::string error;
+  std::unique_ptr<Evaluator> evaluator =
+      Evaluator::Create(options, program, &error);
+  std::unique_ptr<SparseMatrix> jacobian = evaluator->CreateJacobian();
+
+  Vector state(evaluator->NumParameters());
+  program->ParameterBlocksToStateVector(state.data());
+  const double expected_cost = 0.5 * state.array().pow(4).sum();
+  Vector expected_gradient = 2.0 * state.array().pow(3);
+
+  // Run enough evaluations for the costs of the residual blocks to be measured
+  // and used to partition the subsequent evaluations several times.
+  Vector residuals(evaluator->NumResiduals());
+  Vector gradient(evaluator->NumEffectiveParameters());
+  for (int i = 0; i < 40; ++i) {
+    double cost = -1.0;
+    ASSERT_TRUE(evaluator->Evaluate(state.data(),
+                                    &cost,
+                                    residuals.data(),
+                                    gradient.data(),
+                                    jacobian.get()));
+    EXPECT_NEAR(cost, expected_cost, 1e-12 * expected_cost);
+    EXPECT_LT((gradient - expected_gradient).norm(),
+              1e-12 * expected_gradient.norm());
+
+    ASSERT_TRUE(evaluator->Evaluate(
+        state.data(), &cost, residuals.data(), nullptr, nullptr));
+    EXPECT_NEAR(cost, expected_cost, 1e-12 * expected_cost);
+  }
+}
+
+// A cost function which sleeps while *slow is true, to make the cost of
+// evaluating its residual block measurably larger than that of the others.
+class SlowCostFunction : public SizedCostFunction<1, 1> {
+ public:
+  explicit SlowCostFunction(const bool* slow) : slow_(slow) {}
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const final {
+    if (*slow_) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    residuals[0] = parameters[0][0];
+    if (jacobians != nullptr && jacobians[0] != nullptr) {
+      jacobians[0][0] = 1.0;
+    }
+    return true;
+  }
+
+ private:
+  const bool* slow_;
+};
+
+// The residual blocks are partitioned by their measured costs, which are
+// measured on the first evaluation and then once every 16 evaluations.
+TEST(Evaluator, CostBalancedPartitionsFollowMeasuredCosts) {
+  constexpr int kNumResidualBlocks = 40;
+  constexpr int kNumSlowResidualBlocks = 10;
+  constexpr int kNumThreads = 2;
+  // The number of residual blocks in each range if they were split evenly
+  // into four ranges per thread.
+  constexpr int kEvenRangeSize = kNumResidualBlocks / (4 * kNumThreads);
+  constexpr int kNumEvaluationsPerCostMeasurement = 16;
+  ProblemImpl problem;
+  std::vector<double> x(kNumResidualBlocks, 1.0);
+  auto slow = std::make_unique<bool[]>(kNumResidualBlocks);
+  for (int i = 0; i < kNumResidualBlocks; ++i) {
+    slow[i] = (i < kNumSlowResidualBlocks);
+    problem.AddResidualBlock(new SlowCostFunction(&slow[i]), nullptr, &x[i]);
+  }
+  Program* program = problem.mutable_program();
+  program->SetParameterOffsetsAndIndex();
+  problem.context()->EnsureMinimumThreads(kNumThreads);
+
+  Evaluator::Options options;
+  options.linear_solver_type = SPARSE_NORMAL_CHOLESKY;
+  options.num_eliminate_blocks = 0;
+  options.num_threads = kNumThreads;
+  options.context = problem.context();
+  std::string error;
+  std::unique_ptr<Evaluator> evaluator =
+      Evaluator::Create(options, program, &error);
+  const auto* program_evaluator =
+      down_cast<ProgramEvaluator<BlockEvaluatePreparer, BlockJacobianWriter>*>(
+          evaluator.get());
+  std::unique_ptr<SparseMatrix> jacobian = evaluator->CreateJacobian();
+  const std::vector<double> state = x;
+  double cost;
+
+  ASSERT_TRUE(program_evaluator->jacobian_partitions().empty());
+  ASSERT_TRUE(evaluator->Evaluate(
+      state.data(), &cost, nullptr, nullptr, jacobian.get()));
+
+  // Each range holds about an eighth of the total cost, which is dominated by
+  // the slow residual blocks, so the ranges of slow residual blocks are
+  // shorter than those of an even split.
+  std::vector<int> partitions = program_evaluator->jacobian_partitions();
+  ASSERT_EQ(partitions.front(), 0);
+  ASSERT_EQ(partitions.back(), kNumResidualBlocks);
+  EXPECT_LT(partitions[1] - partitions[0], kEvenRangeSize);
+  // Residual only evaluations are measured separately.
+  EXPECT_TRUE(program_evaluator->residual_partitions().empty());
+
+  // Move the slow residual blocks to the end. The partitions are unchanged
+  // until the costs are measured again.
+  std::fill(slow.get(), slow.get() + kNumResidualBlocks, false);
+  std::fill(slow.get() + kNumResidualBlocks - kNumSlowResidualBlocks,
+            slow.get() + kNumResidualBlocks,
+            true);
+  for (int i = 1; i < kNumEvaluationsPerCostMeasurement; ++i) {
+    ASSERT_TRUE(evaluator->Evaluate(
+        state.data(), &cost, nullptr, nullptr, jacobian.get()));
+    EXPECT_EQ(program_evaluator->jacobian_partitions(), partitions);
+  }
+
+  ASSERT_TRUE(evaluator->Evaluate(
+      state.data(), &cost, nullptr, nullptr, jacobian.get()));
+  partitions = program_evaluator->jacobian_partitions();
+  ASSERT_GE(partitions.size(), 2);
+  EXPECT_LT(partitions.back() - partitions[partitions.size() - 2],
+            kEvenRangeSize);
+}
+
+// With a single thread the costs are not measured.
+TEST(Evaluator, SingleThreadedEvaluationDoesNotMeasureCosts) {
+  ProblemImpl problem;
+  bool slow = false;
+  double x[2] = {1.0, 2.0};
+  problem.AddResidualBlock(new SlowCostFunction(&slow), nullptr, &x[0]);
+  problem.AddResidualBlock(new SlowCostFunction(&slow), nullptr, &x[1]);
+  Program* program = problem.mutable_program();
+  program->SetParameterOffsetsAndIndex();
+
+  Evaluator::Options options;
+  options.linear_solver_type = SPARSE_NORMAL_CHOLESKY;
+  options.num_eliminate_blocks = 0;
+  options.num_threads = 1;
+  options.context = problem.context();
+  std::string error;
+  std::unique_ptr<Evaluator> evaluator =
+      Evaluator::Create(options, program, &error);
+  const auto* program_evaluator =
+      down_cast<ProgramEvaluator<BlockEvaluatePreparer, BlockJacobianWriter>*>(
+          evaluator.get());
+  std::unique_ptr<SparseMatrix> jacobian = evaluator->CreateJacobian();
+
+  double cost;
+  ASSERT_TRUE(evaluator->Evaluate(x, &cost, nullptr, nullptr, jacobian.get()));
+  ASSERT_TRUE(evaluator->Evaluate(x, &cost, nullptr, nullptr, nullptr));
+  EXPECT_TRUE(program_evaluator->jacobian_partitions().empty());
+  EXPECT_TRUE(program_evaluator->residual_partitions().empty());
+}
+
+TEST(Evaluator, BlockJacobianLayoutDoesNotDependOnNumThreads) {
+  constexpr int kNumPoints = 100;
+  constexpr int kNumCameras = 10;
+  constexpr int kNumThreads = 4;
+  ProblemImpl problem;
+  std::vector<double> points(3 * kNumPoints);
+  std::vector<double> cameras(2 * kNumCameras);
+  // The points are the first parameter blocks, so that they are the E
+  // blocks of the Jacobian.
+  for (int i = 0; i < kNumPoints; ++i) {
+    problem.AddParameterBlock(&points[3 * i], 3);
+  }
+  for (int i = 0; i < kNumPoints; ++i) {
+    double* camera_a = &cameras[2 * (i % kNumCameras)];
+    double* camera_b = &cameras[2 * ((i + 3) % kNumCameras)];
+    // Alternate the order of the cameras, so that the cells of some of
+    // the row blocks need to be sorted by their column block.
+    if (i % 2 == 1) {
+      std::swap(camera_a, camera_b);
+    }
+    problem.AddResidualBlock(
+        new ParameterIgnoringCostFunction<1, 2, 3, 2, 2>,
+        nullptr,
+        &points[3 * i],
+        camera_a,
+        camera_b);
+  }
+  Program* program = problem.mutable_program();
+  program->SetParameterOffsetsAndIndex();
+  problem.context()->EnsureMinimumThreads(kNumThreads);
+
+  Evaluator::Options options;
+  options.linear_solver_type = DENSE_SCHUR;
+  options.num_eliminate_blocks = kNumPoints;
+  options.context = problem.context();
+  std::string error;
+  options.num_threads = 1;
+  std::unique_ptr<SparseMatrix> expected_jacobian =
+      Evaluator::Create(options, program, &error)->CreateJacobian();
+  options.num_threads = kNumThreads;
+  std::unique_ptr<SparseMatrix> jacobian =
+      Evaluator::Create(options, program, &error)->CreateJacobian();
+
+  const CompressedRowBlockStructure* expected_block_structure =
+      down_cast<BlockSparseMatrix*>(expected_jacobian.get())->block_structure();
+  const CompressedRowBlockStructure* block_structure =
+      down_cast<BlockSparseMatrix*>(jacobian.get())->block_structure();
+  ASSERT_EQ(block_structure->rows.size(),
+            expected_block_structure->rows.size());
+  for (int i = 0; i < block_structure->rows.size(); ++i) {
+    const std::vector<Cell>& expected_cells =
+        expected_block_structure->rows[i].cells;
+    const std::vector<Cell>& cells = block_structure->rows[i].cells;
+    ASSERT_EQ(cells.size(), expected_cells.size());
+    for (int j = 0; j < cells.size(); ++j) {
+      EXPECT_EQ(cells[j].block_id, expected_cells[j].block_id);
+      EXPECT_EQ(cells[j].position, expected_cells[j].position);
+    }
+  }
+}
+
 class HugeCostFunction : public SizedCostFunction<46341, 46345> {
   bool Evaluate(double const* const* parameters,
                 double* residuals,
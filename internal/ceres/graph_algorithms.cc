@@ -0,0 +1,137 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/graph_algorithms.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "ceres/compressed_graph.h"
+#include "ceres/parallel_for.h"
+
+namespace ceres::internal {
+
+int StableIndependentSetOrdering(const CompressedGraph& graph,
+                                 ContextImpl* context,
+                                 int num_threads,
+                                 std::vector<int>* ordering) {
+  CHECK(ordering != nullptr);
+  const int num_vertices = graph.num_vertices();
+  const int num_ordered_vertices = ordering->size();
+  CHECK_LE(num_ordered_vertices, num_vertices);
+
+  // Colors for labeling the graph during the BFS. Vertices which are not
+  // in the input ordering are never colored.
+  const char kRemoved = 0;
+  const char kWhite = 1;
+  const char kGrey = 2;
+  const char kBlack = 3;
+
+  std::vector<char> vertex_color(num_vertices, kRemoved);
+  for (const int vertex : *ordering) {
+    DCHECK_EQ(vertex_color[vertex], kRemoved);
+    vertex_color[vertex] = kWhite;
+  }
+
+  // Degrees of the vertices in the subgraph induced by the input ordering.
+  std::vector<int> degrees(num_ordered_vertices);
+  const bool is_full_graph = (num_ordered_vertices == num_vertices);
+  ParallelFor(context, 0, num_ordered_vertices, num_threads, [&](int i) {
+    const int vertex = (*ordering)[i];
+    if (is_full_graph) {
+      degrees[i] = graph.Degree(vertex);
+      return;
+    }
+    int degree = 0;
+    for (const int neighbor : graph.Neighbors(vertex)) {
+      degree += (vertex_color[neighbor] != kRemoved);
+    }
+    degrees[i] = degree;
+  });
+
+  // Stable counting sort of the vertices in increasing order of their
+  // degree.
+  const int max_degree =
+      degrees.empty() ? 0 : *std::max_element(degrees.begin(), degrees.end());
+  std::vector<int> degree_offsets(max_degree + 2, 0);
+  for (const int degree : degrees) {
+    ++degree_offsets[degree + 1];
+  }
+  std::partial_sum(
+      degree_offsets.begin(), degree_offsets.end(), degree_offsets.begin());
+  std::vector<int> vertex_queue(num_ordered_vertices);
+  for (int i = 0; i < num_ordered_vertices; ++i) {
+    vertex_queue[degree_offsets[degrees[i]]++] = (*ordering)[i];
+  }
+
+  ordering->clear();
+  // Iterate over vertex_queue. Pick the first white vertex, add it
+  // to the independent set. Mark it black and its neighbors grey.
+  for (const int vertex : vertex_queue) {
+    if (vertex_color[vertex] != kWhite) {
+      continue;
+    }
+
+    ordering->push_back(vertex);
+    vertex_color[vertex] = kBlack;
+    for (const int neighbor : graph.Neighbors(vertex)) {
+      if (vertex_color[neighbor] == kWhite) {
+        vertex_color[neighbor] = kGrey;
+      }
+    }
+  }
+
+  const int independent_set_size = ordering->size();
+
+  // Iterate over the vertices and add all the grey vertices to the
+  // ordering. At this stage there should only be black or grey
+  // vertices in the queue.
+  for (const int vertex : vertex_queue) {
+    DCHECK_NE(vertex_color[vertex], kWhite);
+    if (vertex_color[vertex] != kBlack) {
+      ordering->push_back(vertex);
+    }
+  }
+
+  CHECK_EQ(ordering->size(), num_ordered_vertices);
+  return independent_set_size;
+}
+
+int IndependentSetOrdering(const CompressedGraph& graph,
+                           ContextImpl* context,
+                           int num_threads,
+                           std::vector<int>* ordering) {
+  CHECK(ordering != nullptr);
+  ordering->resize(graph.num_vertices());
+  std::iota(ordering->begin(), ordering->end(), 0);
+  return StableIndependentSetOrdering(graph, context, num_threads, ordering);
+}
+
+}  // namespace ceres::internal
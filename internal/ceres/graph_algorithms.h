@@ -41,6 +41,8 @@
 #include <vector>
 
 #include "absl/log/check.h"
+#include "ceres/compressed_graph.h"
+#include "ceres/context_impl.h"
 #include "ceres/graph.h"
 #include "ceres/internal/export.h"
 
@@ -220,6 +222,28 @@ int StableIndependentSetOrdering(const Graph<Vertex>& graph,
   return independent_set_size;
 }
 
+// Same as StableIndependentSetOrdering above for a CompressedGraph. The
+// input ordering may contain a subset of the vertices of the graph, in
+// which case the other vertices are treated as if they were removed from
+// the graph. Ties between vertices of the same degree are resolved in
+// favour of their order in the input ordering.
+//
+// The vertices are sorted by degree using a counting sort, so the cost
+// is linear in the size of the graph. The degrees are computed using
+// num_threads threads.
+CERES_NO_EXPORT int StableIndependentSetOrdering(const CompressedGraph& graph,
+                                                 ContextImpl* context,
+                                                 int num_threads,
+                                                 std::vector<int>* ordering);
+
+// Same as IndependentSetOrdering above for a CompressedGraph, i.e., ties
+// between vertices of the same degree are resolved in favour of the
+// vertex with the smaller id.
+CERES_NO_EXPORT int IndependentSetOrdering(const CompressedGraph& graph,
+                                           ContextImpl* context,
+                                           int num_threads,
+                                           std::vector<int>* ordering);
+
 // Find the connected component for a vertex implemented using the
 // find and update operation for disjoint-set. Recursively traverse
 // the disjoint set structure till you reach a vertex whose connected
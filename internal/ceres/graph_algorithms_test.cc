@@ -33,8 +33,11 @@
 #include <algorithm>
 #include <memory>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "ceres/compressed_graph.h"
+#include "ceres/context_impl.h"
 #include "ceres/graph.h"
 #include "ceres/internal/export.h"
 #include "gtest/gtest.h"
@@ -242,4 +245,78 @@ TEST(StableIndependentSet, BreakTies) {
   }
 }
 
+// Creates a CompressedGraph from a list of edges.
+static std::unique_ptr<CompressedGraph> CreateCompressedGraph(
+    int num_vertices,
+    const std::vector<std::pair<int, int>>& edges,
+    ContextImpl* context) {
+  std::vector<int> clique_offsets = {0};
+  std::vector<int> clique_vertices;
+  for (const auto& [vertex1, vertex2] : edges) {
+    clique_vertices.push_back(vertex1);
+    clique_vertices.push_back(vertex2);
+    clique_offsets.push_back(clique_vertices.size());
+  }
+  return CompressedGraph::FromCliques(
+      num_vertices, clique_offsets, clique_vertices, context, 1);
+}
+
+TEST(CompressedIndependentSetOrdering, Chain) {
+  ContextImpl context;
+  // 0-1-2-3-4
+  auto graph =
+      CreateCompressedGraph(5, {{0, 1}, {1, 2}, {2, 3}, {3, 4}}, &context);
+
+  std::vector<int> ordering;
+  const int independent_set_size =
+      IndependentSetOrdering(*graph, &context, 1, &ordering);
+  EXPECT_EQ(independent_set_size, 3);
+  EXPECT_EQ(ordering, std::vector<int>({0, 4, 2, 1, 3}));
+}
+
+TEST(CompressedIndependentSetOrdering, Star) {
+  ContextImpl context;
+  //      1
+  //      |
+  //    4-0-2
+  //      |
+  //      3
+  auto graph =
+      CreateCompressedGraph(5, {{0, 1}, {0, 2}, {0, 3}, {0, 4}}, &context);
+
+  std::vector<int> ordering;
+  const int independent_set_size =
+      IndependentSetOrdering(*graph, &context, 1, &ordering);
+  EXPECT_EQ(independent_set_size, 4);
+  EXPECT_EQ(ordering, std::vector<int>({1, 2, 3, 4, 0}));
+}
+
+TEST(CompressedStableIndependentSet, BreakTies) {
+  ContextImpl context;
+  auto graph = CreateCompressedGraph(
+      4, {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}}, &context);
+
+  std::vector<int> ordering = {1, 0, 2, 3};
+  const int independent_set_size =
+      StableIndependentSetOrdering(*graph, &context, 1, &ordering);
+  EXPECT_EQ(independent_set_size, 1);
+  EXPECT_EQ(ordering, std::vector<int>({1, 0, 2, 3}));
+}
+
+// Vertices which are not in the input ordering are ignored, including
+// when computing the degrees of the others.
+TEST(CompressedStableIndependentSet, Subgraph) {
+  ContextImpl context;
+  // 0-1-2-3-4
+  auto graph =
+      CreateCompressedGraph(5, {{0, 1}, {1, 2}, {2, 3}, {3, 4}}, &context);
+
+  // In the subgraph 1-2-3-4, vertices 1 and 4 have the smallest degree.
+  std::vector<int> ordering = {4, 3, 2, 1};
+  const int independent_set_size =
+      StableIndependentSetOrdering(*graph, &context, 1, &ordering);
+  EXPECT_EQ(independent_set_size, 2);
+  EXPECT_EQ(ordering, std::vector<int>({4, 1, 3, 2}));
+}
+
 }  // namespace ceres::internal
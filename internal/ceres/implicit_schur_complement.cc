@@ -30,6 +30,8 @@
 
 #include "ceres/implicit_schur_complement.h"
 
+#include <memory>
+
 #include "Eigen/Dense"
 #include "absl/log/check.h"
 #include "ceres/block_sparse_matrix.h"
@@ -92,41 +94,62 @@ void ImplicitSchurComplement::Init(const BlockSparseMatrix& A,
                          block_diagonal_FtF_inverse_.get());
   }
 
+  if (options_.use_mixed_precision_solves) {
+    UpdateSinglePrecisionCopies(A);
+  }
+
   // Compute the RHS of the Schur complement system.
   UpdateRhs();
 }
 
+void ImplicitSchurComplement::UpdateSinglePrecisionCopies(
+    const BlockSparseMatrix& A) {
+  if (float_A_ == nullptr) {
+    float_A_ = std::make_unique<FloatBlockSparseMatrix>(A);
+    float_block_diagonal_EtE_inverse_ =
+        std::make_unique<FloatBlockSparseMatrix>(*block_diagonal_EtE_inverse_);
+    if (compute_ftf_inverse_) {
+      float_block_diagonal_FtF_inverse_ =
+          std::make_unique<FloatBlockSparseMatrix>(
+              *block_diagonal_FtF_inverse_);
+    }
+  }
+  float_A_->UpdateValues(A, options_.context, options_.num_threads);
+  float_block_diagonal_EtE_inverse_->UpdateValues(
+      *block_diagonal_EtE_inverse_, options_.context, options_.num_threads);
+  if (compute_ftf_inverse_) {
+    float_block_diagonal_FtF_inverse_->UpdateValues(
+        *block_diagonal_FtF_inverse_, options_.context, options_.num_threads);
+  }
+}
+
 // Evaluate the product
 //
 //   Sx = [F'F - F'E (E'E)^-1 E'F]x
 //
-// By breaking it down into individual matrix vector products
-// involving the matrices E and F. This is implemented using a
-// PartitionedMatrixView of the input matrix A.
+// using PartitionedMatrixView::SchurComplementRightMultiplyAndAccumulate,
+// which reads each row block of A once instead of computing the
+// individual matrix vector products involving E and F.
 void ImplicitSchurComplement::RightMultiplyAndAccumulate(const double* x,
                                                          double* y) const {
-  // y1 = F x
-  ParallelSetZero(options_.context, options_.num_threads, tmp_rows_);
-  A_->RightMultiplyAndAccumulateF(x, tmp_rows_.data());
-
-  // y2 = E' y1
-  ParallelSetZero(options_.context, options_.num_threads, tmp_e_cols_);
-  A_->LeftMultiplyAndAccumulateE(tmp_rows_.data(), tmp_e_cols_.data());
-
-  // y3 = -(E'E)^-1 y2
-  ParallelSetZero(options_.context, options_.num_threads, tmp_e_cols_2_);
-  block_diagonal_EtE_inverse_->RightMultiplyAndAccumulate(tmp_e_cols_.data(),
-                                                          tmp_e_cols_2_.data(),
-                                                          options_.context,
-                                                          options_.num_threads);
+  // y = D * x
+  DiagonalRightMultiply(x, y);
 
-  ParallelAssign(
-      options_.context, options_.num_threads, tmp_e_cols_2_, -tmp_e_cols_2_);
+  // y += F'F x - F'E (E'E)^-1 E'F x
+  A_->SchurComplementRightMultiplyAndAccumulate(
+      *block_diagonal_EtE_inverse_, x, y);
+}
 
-  // y1 = y1 + E y3
-  A_->RightMultiplyAndAccumulateE(tmp_e_cols_2_.data(), tmp_rows_.data());
+void ImplicitSchurComplement::SinglePrecisionRightMultiplyAndAccumulate(
+    const double* x, double* y) const {
+  CHECK(float_A_ != nullptr);
+  DiagonalRightMultiply(x, y);
+  A_->SchurComplementRightMultiplyAndAccumulate(
+      *float_A_, *float_block_diagonal_EtE_inverse_, x, y);
+}
 
-  // y5 = D * x
+void ImplicitSchurComplement::DiagonalRightMultiply(const double* x,
+                                                    double* y) const {
   if (D_ != nullptr) {
     ConstVectorRef Dref(D_ + A_->num_cols_e(), num_cols());
     VectorRef y_cols(y, num_cols());
@@ -138,9 +161,6 @@ void ImplicitSchurComplement::RightMultiplyAndAccumulate(const double* x,
   } else {
     ParallelSetZero(options_.context, options_.num_threads, y, num_cols());
   }
-
-  // y = y5 + F' y1
-  A_->LeftMultiplyAndAccumulateF(tmp_rows_.data(), y);
 }
 
 void ImplicitSchurComplement::InversePowerSeriesOperatorRightMultiplyAccumulate(
@@ -48,6 +48,7 @@
 namespace ceres::internal {
 
 class BlockSparseMatrix;
+class FloatBlockSparseMatrix;
 
 // This class implements various linear algebraic operations related
 // to the Schur complement without explicitly forming it.
@@ -123,6 +124,13 @@ class CERES_NO_EXPORT ImplicitSchurComplement final : public LinearOperator {
     RightMultiplyAndAccumulate(x, y);
   }
 
+  // y += Sx, where the products with A and (E'E)^-1 read single
+  // precision copies of them, which are updated by Init. Used by the
+  // inner iterations of mixed precision solves, and only available if
+  // options.use_mixed_precision_solves is true.
+  void SinglePrecisionRightMultiplyAndAccumulate(const double* x,
+                                                 double* y) const;
+
   // Following is useful for approximation of S^-1 via power series expansion.
   // Z = (F'F)^-1 F'E (E'E)^-1 E'F
   // y += Zx
@@ -148,9 +156,21 @@ class CERES_NO_EXPORT ImplicitSchurComplement final : public LinearOperator {
     return block_diagonal_FtF_inverse_.get();
   }
 
+  // Single precision copy of block_diagonal_FtF_inverse(), only
+  // available if options.use_mixed_precision_solves is true.
+  const FloatBlockSparseMatrix* single_precision_block_diagonal_FtF_inverse()
+      const {
+    CHECK(compute_ftf_inverse_);
+    CHECK(options_.use_mixed_precision_solves);
+    return float_block_diagonal_FtF_inverse_.get();
+  }
+
  private:
   void AddDiagonalAndInvert(const double* D, BlockSparseMatrix* matrix);
   void UpdateRhs();
+  void UpdateSinglePrecisionCopies(const BlockSparseMatrix& A);
+  // y = D_f^2 x, where D_f is the part of D corresponding to F.
+  void DiagonalRightMultiply(const double* x, double* y) const;
 
   const LinearSolver::Options& options_;
   bool compute_ftf_inverse_ = false;
@@ -161,9 +181,15 @@ class CERES_NO_EXPORT ImplicitSchurComplement final : public LinearOperator {
   std::unique_ptr<BlockSparseMatrix> block_diagonal_EtE_inverse_;
   std::unique_ptr<BlockSparseMatrix> block_diagonal_FtF_inverse_;
 
+  // Single precision copies of A and of the block diagonals, used if
+  // options_.use_mixed_precision_solves is true.
+  std::unique_ptr<FloatBlockSparseMatrix> float_A_;
+  std::unique_ptr<FloatBlockSparseMatrix> float_block_diagonal_EtE_inverse_;
+  std::unique_ptr<FloatBlockSparseMatrix> float_block_diagonal_FtF_inverse_;
+
   Vector rhs_;
 
-  // Temporary storage vectors used to implement RightMultiplyAndAccumulate.
+  // Temporary storage vectors used by the products with E and F.
   mutable Vector tmp_rows_;
   mutable Vector tmp_e_cols_;
   mutable Vector tmp_e_cols_2_;
@@ -0,0 +1,246 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/incomplete_cholesky_preconditioner.h"
+
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "ceres/block_incomplete_cholesky.h"
+#include "ceres/block_random_access_sparse_matrix.h"
+#include "ceres/block_sparse_matrix.h"
+#include "ceres/block_structure.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/linear_solver.h"
+#include "ceres/parallel_for.h"
+#include "ceres/schur_complement_solver.h"
+#include "ceres/schur_eliminator.h"
+#include "ceres/small_blas.h"
+
+namespace ceres::internal {
+namespace {
+
+// Adds the difference between the squares of the entries of D and
+// diagonal_squared to the diagonal of m, and stores the squares of the
+// entries of D in diagonal_squared. D can be nullptr, in which case it is
+// treated as zero.
+void UpdateDiagonalSquared(const double* D,
+                           BlockRandomAccessSparseMatrix* m,
+                           Vector* diagonal_squared) {
+  const std::vector<Block>& blocks = m->matrix()->block_structure()->cols;
+  for (int i = 0; i < blocks.size(); ++i) {
+    const Block& block = blocks[i];
+    Vector new_diagonal_squared = Vector::Zero(block.size);
+    if (D != nullptr) {
+      new_diagonal_squared =
+          ConstVectorRef(D + block.position, block.size).array().square();
+    }
+    int r, c, row_stride, col_stride;
+    CellInfo* cell_info = m->GetCell(i, i, &r, &c, &row_stride, &col_stride);
+    MatrixRef cell(cell_info->values, row_stride, col_stride);
+    cell.block(r, c, block.size, block.size).diagonal() +=
+        new_diagonal_squared -
+        diagonal_squared->segment(block.position, block.size);
+    diagonal_squared->segment(block.position, block.size) =
+        new_diagonal_squared;
+  }
+}
+
+}  // namespace
+
+BlockSparseIncompleteCholeskyPreconditioner::
+    BlockSparseIncompleteCholeskyPreconditioner(Preconditioner::Options options,
+                                                const BlockSparseMatrix& A)
+    : options_(std::move(options)) {
+  CHECK(options_.context != nullptr);
+  const CompressedRowBlockStructure* bs = A.block_structure();
+
+  // Block (i, j), i <= j, of A'A is non-zero if the column blocks i and j
+  // share a row block.
+  std::set<std::pair<int, int>> block_pairs;
+  for (int i = 0; i < bs->cols.size(); ++i) {
+    block_pairs.emplace(i, i);
+  }
+  for (const CompressedRow& row : bs->rows) {
+    for (const Cell& cell1 : row.cells) {
+      for (const Cell& cell2 : row.cells) {
+        if (cell1.block_id < cell2.block_id) {
+          block_pairs.emplace(cell1.block_id, cell2.block_id);
+        }
+      }
+    }
+  }
+
+  m_ = std::make_unique<BlockRandomAccessSparseMatrix>(
+      bs->cols, block_pairs, options_.context, options_.num_threads);
+  factorization_ = std::make_unique<BlockIncompleteCholesky>(
+      *m_->matrix()->block_structure(), options_.context, options_.num_threads);
+}
+
+BlockSparseIncompleteCholeskyPreconditioner::
+    ~BlockSparseIncompleteCholeskyPreconditioner() = default;
+
+bool BlockSparseIncompleteCholeskyPreconditioner::UpdateImpl(
+    const BlockSparseMatrix& A, const double* D) {
+  const CompressedRowBlockStructure* bs = A.block_structure();
+  const CompressedRowBlockStructure* transpose_bs =
+      A.transpose_block_structure();
+  CHECK(transpose_bs != nullptr);
+  const double* values = A.values();
+  m_->SetZero();
+
+  // Block row i of the upper triangle of A'A is the sum over the row blocks
+  // r in column block i of A of A(r, i)' A(r, j), j >= i. Each block row is
+  // only written to by one thread, so no locking is needed.
+  ParallelFor(
+      options_.context,
+      0,
+      bs->cols.size(),
+      options_.num_threads,
+      [this, bs, transpose_bs, values](int i) {
+        const int col_block_size_i = bs->cols[i].size;
+        for (const Cell& cell_i : transpose_bs->rows[i].cells) {
+          const int row_block_id = cell_i.block_id;
+          const int row_block_size = bs->rows[row_block_id].block.size;
+          for (const Cell& cell_j : bs->rows[row_block_id].cells) {
+            const int j = cell_j.block_id;
+            if (j < i) {
+              continue;
+            }
+            const int col_block_size_j = bs->cols[j].size;
+            int r, c, row_stride, col_stride;
+            CellInfo* cell_info =
+                m_->GetCell(i, j, &r, &c, &row_stride, &col_stride);
+            // clang-format off
+            MatrixTransposeMatrixMultiply<Eigen::Dynamic, Eigen::Dynamic,
+                Eigen::Dynamic, Eigen::Dynamic, 1>(
+                    values + cell_i.position, row_block_size, col_block_size_i,
+                    values + cell_j.position, row_block_size, col_block_size_j,
+                    cell_info->values, r, c, row_stride, col_stride);
+            // clang-format on
+          }
+        }
+
+      });
+
+  // H does not contain D'D yet.
+  diagonal_squared_.setZero(m_->num_rows());
+  return UpdateDiagonal(D);
+}
+
+bool BlockSparseIncompleteCholeskyPreconditioner::UpdateDiagonal(
+    const double* D) {
+  CHECK_EQ(diagonal_squared_.size(), m_->num_rows())
+      << "UpdateDiagonal called before Update.";
+  UpdateDiagonalSquared(D, m_.get(), &diagonal_squared_);
+  return factorization_->Factorize(m_->matrix()->values());
+}
+
+void BlockSparseIncompleteCholeskyPreconditioner::RightMultiplyAndAccumulate(
+    const double* x, double* y) const {
+  factorization_->RightMultiplyAndAccumulate(x, y);
+}
+
+int BlockSparseIncompleteCholeskyPreconditioner::num_rows() const {
+  return m_->num_rows();
+}
+
+SchurIncompleteCholeskyPreconditioner::SchurIncompleteCholeskyPreconditioner(
+    const CompressedRowBlockStructure& bs, Preconditioner::Options options)
+    : options_(std::move(options)) {
+  CHECK_GT(options_.elimination_groups.size(), 1);
+  CHECK_GT(options_.elimination_groups[0], 0);
+  CHECK_GT(bs.cols.size() - options_.elimination_groups[0], 0)
+      << "Jacobian should have at least 1 f_block for "
+      << "INCOMPLETE_CHOLESKY preconditioner.";
+  CHECK(options_.context != nullptr);
+
+  const int num_eliminate_blocks = options_.elimination_groups[0];
+  m_ = std::make_unique<BlockRandomAccessSparseMatrix>(
+      Tail(bs.cols, bs.cols.size() - num_eliminate_blocks),
+      SchurComplementBlockPairs(bs, num_eliminate_blocks),
+      options_.context,
+      options_.num_threads);
+  f_block_position_ = bs.cols[num_eliminate_blocks].position;
+  factorization_ = std::make_unique<BlockIncompleteCholesky>(
+      *m_->matrix()->block_structure(), options_.context, options_.num_threads);
+  InitEliminator(bs);
+}
+
+SchurIncompleteCholeskyPreconditioner::
+    ~SchurIncompleteCholeskyPreconditioner() = default;
+
+void SchurIncompleteCholeskyPreconditioner::InitEliminator(
+    const CompressedRowBlockStructure& bs) {
+  LinearSolver::Options eliminator_options;
+  eliminator_options.elimination_groups = options_.elimination_groups;
+  eliminator_options.num_threads = options_.num_threads;
+  eliminator_options.e_block_size = options_.e_block_size;
+  eliminator_options.f_block_size = options_.f_block_size;
+  eliminator_options.row_block_size = options_.row_block_size;
+  eliminator_options.context = options_.context;
+  eliminator_ = SchurEliminatorBase::Create(eliminator_options);
+  const bool kFullRankETE = true;
+  eliminator_->Init(
+      eliminator_options.elimination_groups[0], kFullRankETE, &bs);
+}
+
+bool SchurIncompleteCholeskyPreconditioner::UpdateImpl(
+    const BlockSparseMatrix& A, const double* D) {
+  eliminator_->Eliminate(
+      BlockSparseMatrixData(A), nullptr, D, m_.get(), nullptr);
+  if (D == nullptr) {
+    diagonal_squared_.setZero(m_->num_rows());
+  } else {
+    diagonal_squared_ =
+        ConstVectorRef(D + f_block_position_, m_->num_rows()).array().square();
+  }
+  return factorization_->Factorize(m_->matrix()->values());
+}
+
+bool SchurIncompleteCholeskyPreconditioner::UpdateDiagonal(const double* D) {
+  CHECK_EQ(diagonal_squared_.size(), m_->num_rows())
+      << "UpdateDiagonal called before Update.";
+  const double* f_block_D = (D == nullptr) ? nullptr : D + f_block_position_;
+  UpdateDiagonalSquared(f_block_D, m_.get(), &diagonal_squared_);
+  return factorization_->Factorize(m_->matrix()->values());
+}
+
+void SchurIncompleteCholeskyPreconditioner::RightMultiplyAndAccumulate(
+    const double* x, double* y) const {
+  factorization_->RightMultiplyAndAccumulate(x, y);
+}
+
+int SchurIncompleteCholeskyPreconditioner::num_rows() const {
+  return m_->num_rows();
+}
+
+}  // namespace ceres::internal
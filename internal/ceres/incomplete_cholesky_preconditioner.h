@@ -0,0 +1,138 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_INCOMPLETE_CHOLESKY_PRECONDITIONER_H_
+#define CERES_INTERNAL_INCOMPLETE_CHOLESKY_PRECONDITIONER_H_
+
+#include <memory>
+
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/internal/export.h"
+#include "ceres/preconditioner.h"
+
+namespace ceres::internal {
+
+class BlockIncompleteCholesky;
+class BlockRandomAccessSparseMatrix;
+class BlockSparseMatrix;
+struct CompressedRowBlockStructure;
+class SchurEliminatorBase;
+
+// The INCOMPLETE_CHOLESKY preconditioner for CGNR. It computes the block
+// incomplete Cholesky factorization with zero fill-in of the normal
+// equations
+//
+//   H = A'A + D'D
+//
+// with the block sparsity structure of H, i.e., block (i, j) of H is
+// structurally non-zero if the column blocks i and j of A share a row
+// block. See block_incomplete_cholesky.h for details.
+class CERES_NO_EXPORT BlockSparseIncompleteCholeskyPreconditioner
+    : public BlockSparseMatrixPreconditioner {
+ public:
+  // A is the matrix to build the preconditioner for. Only its block
+  // structure is used, the values are read in Update.
+  BlockSparseIncompleteCholeskyPreconditioner(Preconditioner::Options options,
+                                              const BlockSparseMatrix& A);
+  BlockSparseIncompleteCholeskyPreconditioner(
+      const BlockSparseIncompleteCholeskyPreconditioner&) = delete;
+  void operator=(const BlockSparseIncompleteCholeskyPreconditioner&) = delete;
+  ~BlockSparseIncompleteCholeskyPreconditioner() override;
+
+  // Preconditioner interface.
+  //
+  // UpdateDiagonal replaces D'D in H with the squares of the entries of the
+  // new D and factorizes H again, without recomputing A'A.
+  bool UpdateDiagonal(const double* D) final;
+  void RightMultiplyAndAccumulate(const double* x, double* y) const final;
+  int num_rows() const final;
+
+ private:
+  bool UpdateImpl(const BlockSparseMatrix& A, const double* D) final;
+
+  Preconditioner::Options options_;
+  // The upper triangle of H.
+  std::unique_ptr<BlockRandomAccessSparseMatrix> m_;
+  // The squares of the entries of D included in m_.
+  Vector diagonal_squared_;
+  std::unique_ptr<BlockIncompleteCholesky> factorization_;
+};
+
+// The INCOMPLETE_CHOLESKY preconditioner for ITERATIVE_SCHUR. It computes
+// the Schur complement S explicitly, with the same block sparsity
+// structure as SPARSE_SCHUR, and the block incomplete Cholesky
+// factorization with zero fill-in of S. Computing S has the same cost as
+// for SPARSE_SCHUR, but the factorization has no fill-in and does not need
+// a sparse linear algebra library.
+//
+// It has the same structural requirement as other Schur complement based
+// solvers. Please see schur_eliminator.h for more details.
+class CERES_NO_EXPORT SchurIncompleteCholeskyPreconditioner
+    : public BlockSparseMatrixPreconditioner {
+ public:
+  SchurIncompleteCholeskyPreconditioner(const CompressedRowBlockStructure& bs,
+                                        Preconditioner::Options options);
+  SchurIncompleteCholeskyPreconditioner(
+      const SchurIncompleteCholeskyPreconditioner&) = delete;
+  void operator=(const SchurIncompleteCholeskyPreconditioner&) = delete;
+  ~SchurIncompleteCholeskyPreconditioner() override;
+
+  // Preconditioner interface.
+  //
+  // UpdateDiagonal adds the change in the squares of the entries of D
+  // corresponding to the f-blocks to the diagonal of the Schur complement
+  // computed by the last call to Update, and factorizes it again. As for
+  // SCHUR_JACOBI, the contribution of the e-blocks of D to the Schur
+  // complement is not updated, which would require eliminating the e-blocks
+  // again.
+  bool UpdateDiagonal(const double* D) final;
+  void RightMultiplyAndAccumulate(const double* x, double* y) const final;
+  int num_rows() const final;
+
+ private:
+  void InitEliminator(const CompressedRowBlockStructure& bs);
+  bool UpdateImpl(const BlockSparseMatrix& A, const double* D) final;
+
+  Preconditioner::Options options_;
+  std::unique_ptr<SchurEliminatorBase> eliminator_;
+  // The upper triangle of the Schur complement.
+  std::unique_ptr<BlockRandomAccessSparseMatrix> m_;
+  // Position of the first f-block column in the linear system.
+  int f_block_position_ = 0;
+  // The squares of the entries of D corresponding to the f-blocks included
+  // in m_.
+  Vector diagonal_squared_;
+  std::unique_ptr<BlockIncompleteCholesky> factorization_;
+};
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_INCOMPLETE_CHOLESKY_PRECONDITIONER_H_
@@ -0,0 +1,164 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/incomplete_cholesky_preconditioner.h"
+
+#include <memory>
+
+#include "Eigen/Dense"
+#include "ceres/block_sparse_matrix.h"
+#include "ceres/block_structure.h"
+#include "ceres/casts.h"
+#include "ceres/context_impl.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/linear_least_squares_problems.h"
+#include "ceres/preconditioner.h"
+#include "ceres/test_util.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+class IncompleteCholeskyPreconditionerTest : public ::testing::Test {
+ protected:
+  void SetUp() final {
+    problem_ = CreateLinearLeastSquaresProblemFromId(2);
+    ASSERT_TRUE(problem_ != nullptr);
+    A_.reset(down_cast<BlockSparseMatrix*>(problem_->A.release()));
+    const int num_cols = A_->num_cols();
+    D_ = ConstVectorRef(problem_->D.get(), num_cols);
+
+    Matrix dense_A;
+    A_->ToDenseMatrix(&dense_A);
+    H_ = dense_A.transpose() * dense_A;
+    H_.diagonal() += D_.array().square().matrix();
+
+    options_.type = INCOMPLETE_CHOLESKY;
+    options_.num_threads = 2;
+    options_.context = &context_;
+  }
+
+  std::unique_ptr<LinearLeastSquaresProblem> problem_;
+  std::unique_ptr<BlockSparseMatrix> A_;
+  Vector D_;
+  // H = A'A + D'D.
+  Matrix H_;
+  ContextImpl context_;
+  Preconditioner::Options options_;
+};
+
+// The incomplete factorization R'R matches H on the sparsity structure of
+// H.
+TEST_F(IncompleteCholeskyPreconditionerTest, NormalEquations) {
+  context_.EnsureMinimumThreads(options_.num_threads);
+  BlockSparseIncompleteCholeskyPreconditioner preconditioner(options_, *A_);
+  ASSERT_TRUE(preconditioner.Update(*A_, D_.data()));
+  ASSERT_EQ(preconditioner.num_rows(), H_.rows());
+
+  const Matrix RtR = PreconditionerToDenseMatrix(preconditioner).inverse();
+  for (int i = 0; i < H_.rows(); ++i) {
+    for (int j = 0; j < H_.cols(); ++j) {
+      if (H_(i, j) != 0.0) {
+        EXPECT_NEAR(RtR(i, j), H_(i, j), 1e-10 * H_.norm())
+            << "i: " << i << " j: " << j;
+      }
+    }
+  }
+}
+
+// The Schur complement of this problem is dense, so its incomplete
+// factorization is exact.
+TEST_F(IncompleteCholeskyPreconditionerTest, SchurComplement) {
+  context_.EnsureMinimumThreads(options_.num_threads);
+  options_.elimination_groups.push_back(problem_->num_eliminate_blocks);
+  options_.elimination_groups.push_back(0);
+
+  const CompressedRowBlockStructure& bs = *A_->block_structure();
+  const int num_e_cols = bs.cols[problem_->num_eliminate_blocks].position;
+  const int num_f_cols = A_->num_cols() - num_e_cols;
+  const Matrix S =
+      H_.bottomRightCorner(num_f_cols, num_f_cols) -
+      H_.bottomLeftCorner(num_f_cols, num_e_cols) *
+          H_.topLeftCorner(num_e_cols, num_e_cols).inverse() *
+          H_.topRightCorner(num_e_cols, num_f_cols);
+
+  SchurIncompleteCholeskyPreconditioner preconditioner(bs, options_);
+  ASSERT_TRUE(preconditioner.Update(*A_, D_.data()));
+  ASSERT_EQ(preconditioner.num_rows(), num_f_cols);
+
+  const Matrix identity = PreconditionerToDenseMatrix(preconditioner) * S;
+  EXPECT_LE((identity - Matrix::Identity(num_f_cols, num_f_cols)).norm(),
+            1e-10);
+}
+
+// Replacing D in H without recomputing A'A gives the same preconditioner as
+// recomputing it.
+TEST_F(IncompleteCholeskyPreconditionerTest,
+       NormalEquationsUpdateDiagonalMatchesUpdate) {
+  context_.EnsureMinimumThreads(options_.num_threads);
+  const Vector new_D = 2.0 * D_;
+
+  BlockSparseIncompleteCholeskyPreconditioner expected(options_, *A_);
+  ASSERT_TRUE(expected.Update(*A_, new_D.data()));
+
+  BlockSparseIncompleteCholeskyPreconditioner preconditioner(options_, *A_);
+  ASSERT_TRUE(preconditioner.Update(*A_, D_.data()));
+  ASSERT_TRUE(preconditioner.UpdateDiagonal(new_D.data()));
+
+  const Matrix expected_dense = PreconditionerToDenseMatrix(expected);
+  EXPECT_LE(
+      (PreconditionerToDenseMatrix(preconditioner) - expected_dense).norm(),
+      1e-10 * expected_dense.norm());
+}
+
+// Updating the diagonal of the Schur complement is exact if only the
+// entries of D corresponding to the f-blocks change.
+TEST_F(IncompleteCholeskyPreconditionerTest,
+       SchurComplementUpdateDiagonalMatchesUpdate) {
+  context_.EnsureMinimumThreads(options_.num_threads);
+  options_.elimination_groups.push_back(problem_->num_eliminate_blocks);
+  options_.elimination_groups.push_back(0);
+
+  const CompressedRowBlockStructure& bs = *A_->block_structure();
+  const int num_e_cols = bs.cols[problem_->num_eliminate_blocks].position;
+  Vector new_D = D_;
+  new_D.tail(A_->num_cols() - num_e_cols) *= 2.0;
+
+  SchurIncompleteCholeskyPreconditioner expected(bs, options_);
+  ASSERT_TRUE(expected.Update(*A_, new_D.data()));
+
+  SchurIncompleteCholeskyPreconditioner preconditioner(bs, options_);
+  ASSERT_TRUE(preconditioner.Update(*A_, D_.data()));
+  ASSERT_TRUE(preconditioner.UpdateDiagonal(new_D.data()));
+
+  const Matrix expected_dense = PreconditionerToDenseMatrix(expected);
+  EXPECT_LE(
+      (PreconditionerToDenseMatrix(preconditioner) - expected_dense).norm(),
+      1e-10 * expected_dense.norm());
+}
+
+}  // namespace ceres::internal
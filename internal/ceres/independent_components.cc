@@ -0,0 +1,206 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/independent_components.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "ceres/parameter_block.h"
+#include "ceres/problem_impl.h"
+#include "ceres/program.h"
+#include "ceres/residual_block.h"
+
+namespace ceres::internal {
+namespace {
+
+// Returns the root of the set containing element, halving the paths along
+// the way.
+int FindRoot(int element, std::vector<int>* parent) {
+  std::vector<int>& p = *parent;
+  while (p[element] != element) {
+    p[element] = p[p[element]];
+    element = p[element];
+  }
+  return element;
+}
+
+}  // namespace
+
+int ComputeIndependentComponents(Program* program,
+                                 std::vector<int>* residual_block_component) {
+  CHECK(residual_block_component != nullptr);
+  program->SetParameterOffsetsAndIndex();
+  const std::vector<ResidualBlock*>& residual_blocks =
+      program->residual_blocks();
+
+  // Disjoint-set forest over the parameter blocks, using union by size.
+  const int num_parameter_blocks = program->NumParameterBlocks();
+  std::vector<int> parent(num_parameter_blocks);
+  std::iota(parent.begin(), parent.end(), 0);
+  std::vector<int> set_size(num_parameter_blocks, 1);
+
+  // The root of the first non-constant parameter block of each residual
+  // block, or -1 if there is none.
+  std::vector<int> residual_block_root(residual_blocks.size(), -1);
+  for (int i = 0; i < residual_blocks.size(); ++i) {
+    const ResidualBlock* residual_block = residual_blocks[i];
+    int root = -1;
+    for (int j = 0; j < residual_block->NumParameterBlocks(); ++j) {
+      const ParameterBlock* parameter_block =
+          residual_block->parameter_blocks()[j];
+      if (parameter_block->IsConstant()) {
+        continue;
+      }
+
+      int other_root = FindRoot(parameter_block->index(), &parent);
+      if (root == -1) {
+        root = other_root;
+      } else if (root != other_root) {
+        if (set_size[root] < set_size[other_root]) {
+          std::swap(root, other_root);
+        }
+        parent[other_root] = root;
+        set_size[root] += set_size[other_root];
+      }
+    }
+    residual_block_root[i] = root;
+  }
+
+  // Number the components in the order in which they first appear. The
+  // roots stored above may have been merged into other sets since, so they
+  // are looked up again.
+  std::vector<int> root_to_component(num_parameter_blocks, -1);
+  int num_components = 0;
+  residual_block_component->resize(residual_blocks.size());
+  for (int i = 0; i < residual_blocks.size(); ++i) {
+    if (residual_block_root[i] == -1) {
+      (*residual_block_component)[i] = -1;
+      continue;
+    }
+
+    const int root = FindRoot(residual_block_root[i], &parent);
+    if (root_to_component[root] == -1) {
+      root_to_component[root] = num_components++;
+    }
+    (*residual_block_component)[i] = root_to_component[root];
+  }
+
+  return num_components;
+}
+
+std::vector<std::unique_ptr<Problem>> CreateIndependentComponentProblems(
+    ProblemImpl* problem_impl,
+    int num_components,
+    const std::vector<int>& residual_block_component) {
+  CHECK_GT(num_components, 0);
+  const std::vector<ResidualBlock*>& residual_blocks =
+      problem_impl->program().residual_blocks();
+  CHECK_EQ(residual_blocks.size(), residual_block_component.size());
+
+  // The user supplied problem owns all the objects that the component
+  // problems refer to, and has already been checked for errors.
+  Problem::Options options;
+  options.cost_function_ownership = DO_NOT_TAKE_OWNERSHIP;
+  options.loss_function_ownership = DO_NOT_TAKE_OWNERSHIP;
+  options.manifold_ownership = DO_NOT_TAKE_OWNERSHIP;
+  options.disable_all_safety_checks = true;
+  options.context = problem_impl->context();
+
+  std::vector<std::unique_ptr<Problem>> problems(num_components);
+  for (auto& problem : problems) {
+    problem = std::make_unique<Problem>(options);
+  }
+
+  std::vector<double*> parameter_blocks;
+  for (int i = 0; i < residual_blocks.size(); ++i) {
+    const ResidualBlock* residual_block = residual_blocks[i];
+    Problem* problem = problems[std::max(residual_block_component[i], 0)].get();
+
+    // Add the parameter blocks that this component has not seen yet, with
+    // the same manifold, constancy and bounds.
+    const int num_parameter_blocks = residual_block->NumParameterBlocks();
+    parameter_blocks.resize(num_parameter_blocks);
+    for (int j = 0; j < num_parameter_blocks; ++j) {
+      ParameterBlock* parameter_block = residual_block->parameter_blocks()[j];
+      double* values = parameter_block->mutable_user_state();
+      parameter_blocks[j] = values;
+      if (problem->HasParameterBlock(values)) {
+        continue;
+      }
+
+      problem->AddParameterBlock(
+          values, parameter_block->Size(), parameter_block->mutable_manifold());
+      if (parameter_block->IsConstant()) {
+        problem->SetParameterBlockConstant(values);
+      }
+
+      for (int k = 0; k < parameter_block->Size(); ++k) {
+        const double upper_bound = parameter_block->UpperBound(k);
+        if (upper_bound < std::numeric_limits<double>::max()) {
+          problem->SetParameterUpperBound(values, k, upper_bound);
+        }
+        const double lower_bound = parameter_block->LowerBound(k);
+        if (lower_bound > -std::numeric_limits<double>::max()) {
+          problem->SetParameterLowerBound(values, k, lower_bound);
+        }
+      }
+    }
+
+    problem->AddResidualBlock(
+        const_cast<CostFunction*>(residual_block->cost_function()),
+        const_cast<LossFunction*>(residual_block->loss_function()),
+        parameter_blocks.data(),
+        num_parameter_blocks);
+  }
+
+  return problems;
+}
+
+std::shared_ptr<ParameterBlockOrdering> CreateIndependentComponentOrdering(
+    const ParameterBlockOrdering& ordering, const Problem& component) {
+  auto component_ordering = std::make_shared<ParameterBlockOrdering>();
+  std::vector<double*> parameter_blocks;
+  component.GetParameterBlocks(&parameter_blocks);
+  for (double* parameter_block : parameter_blocks) {
+    // Parameter blocks missing from the ordering are left out, so that the
+    // preprocessor reports the same error as for the whole problem.
+    const int group = ordering.GroupId(parameter_block);
+    if (group != -1) {
+      component_ordering->AddElementToGroup(parameter_block, group);
+    }
+  }
+  return component_ordering;
+}
+
+}  // namespace ceres::internal
@@ -0,0 +1,86 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_INDEPENDENT_COMPONENTS_H_
+#define CERES_INTERNAL_INDEPENDENT_COMPONENTS_H_
+
+#include <memory>
+#include <vector>
+
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/export.h"
+#include "ceres/ordered_groups.h"
+#include "ceres/problem.h"
+
+namespace ceres::internal {
+
+class Program;
+class ProblemImpl;
+
+// Computes the connected components of the graph whose vertices are the
+// non-constant parameter blocks of the program, and in which two vertices
+// are connected if a residual block depends on both of them. Constant
+// parameter blocks do not connect residual blocks, since they are not
+// changed by the minimizer.
+//
+// On return, residual_block_component[i] is the component of the i-th
+// residual block of the program, or -1 if the residual block only depends
+// on constant parameter blocks. Components are numbered in the order in
+// which they first appear in the residual blocks. Returns the number of
+// components.
+//
+// The parameter blocks of the program are renumbered.
+CERES_NO_EXPORT int ComputeIndependentComponents(
+    Program* program, std::vector<int>* residual_block_component);
+
+// Creates one Problem per component computed by
+// ComputeIndependentComponents. The problems share the parameter values,
+// cost functions, loss functions, manifolds and context of problem_impl and
+// do not take ownership of any of them. Each problem contains the residual
+// blocks of its component, in the order of problem_impl, and the parameter
+// blocks they depend on, including the constant ones with their bounds.
+// Residual blocks which only depend on constant parameter blocks are added
+// to the first problem, where they contribute to the fixed cost.
+CERES_NO_EXPORT std::vector<std::unique_ptr<Problem>>
+CreateIndependentComponentProblems(
+    ProblemImpl* problem_impl,
+    int num_components,
+    const std::vector<int>& residual_block_component);
+
+// Returns the restriction of ordering to the parameter blocks of
+// component. The relative order of the groups is preserved, groups which
+// become empty are dropped.
+CERES_NO_EXPORT std::shared_ptr<ParameterBlockOrdering>
+CreateIndependentComponentOrdering(const ParameterBlockOrdering& ordering,
+                                   const Problem& component);
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_INDEPENDENT_COMPONENTS_H_
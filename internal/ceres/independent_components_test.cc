@@ -0,0 +1,176 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/independent_components.h"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "ceres/manifold.h"
+#include "ceres/ordered_groups.h"
+#include "ceres/problem.h"
+#include "ceres/problem_impl.h"
+#include "ceres/program.h"
+#include "ceres/sized_cost_function.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+template <int... Ns>
+class MockCostFunction : public SizedCostFunction<1, Ns...> {
+ public:
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const final {
+    // Do nothing. This is never called.
+    return true;
+  }
+};
+
+using UnaryCostFunction = MockCostFunction<1>;
+using BinaryCostFunction = MockCostFunction<1, 1>;
+
+TEST(IndependentComponents, ConnectedProblemHasOneComponent) {
+  ProblemImpl problem;
+  double x = 0.0;
+  double y = 0.0;
+  double z = 0.0;
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x, &y);
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &z, &y);
+  problem.AddResidualBlock(new UnaryCostFunction, nullptr, &z);
+
+  std::vector<int> residual_block_component;
+  EXPECT_EQ(ComputeIndependentComponents(problem.mutable_program(),
+                                         &residual_block_component),
+            1);
+  EXPECT_THAT(residual_block_component, ::testing::ElementsAre(0, 0, 0));
+}
+
+TEST(IndependentComponents, ConstantParameterBlocksDoNotConnect) {
+  ProblemImpl problem;
+  double x[5] = {0.0};
+  // x[4] is constant, so the residual blocks connect x[0] and x[2], and
+  // x[1] and x[3].
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x[1], &x[4]);
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x[0], &x[4]);
+  problem.AddResidualBlock(new UnaryCostFunction, nullptr, &x[4]);
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x[2], &x[0]);
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x[3], &x[1]);
+  problem.SetParameterBlockConstant(&x[4]);
+
+  std::vector<int> residual_block_component;
+  EXPECT_EQ(ComputeIndependentComponents(problem.mutable_program(),
+                                         &residual_block_component),
+            2);
+  EXPECT_THAT(residual_block_component,
+              ::testing::ElementsAre(0, 1, -1, 1, 0));
+}
+
+TEST(IndependentComponents, LateResidualBlockMergesComponents) {
+  ProblemImpl problem;
+  double x[4] = {0.0};
+  problem.AddResidualBlock(new UnaryCostFunction, nullptr, &x[0]);
+  problem.AddResidualBlock(new UnaryCostFunction, nullptr, &x[1]);
+  problem.AddResidualBlock(new UnaryCostFunction, nullptr, &x[2]);
+  problem.AddResidualBlock(new UnaryCostFunction, nullptr, &x[3]);
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x[2], &x[0]);
+
+  std::vector<int> residual_block_component;
+  EXPECT_EQ(ComputeIndependentComponents(problem.mutable_program(),
+                                         &residual_block_component),
+            3);
+  EXPECT_THAT(residual_block_component,
+              ::testing::ElementsAre(0, 1, 0, 2, 0));
+}
+
+TEST(IndependentComponents, CreatesComponentProblems) {
+  ProblemImpl problem;
+  double x[2] = {0.0, 0.0};
+  double y[2] = {0.0, 0.0};
+  double c = 0.0;
+  problem.AddParameterBlock(x, 2, new EuclideanManifold<2>);
+  problem.AddResidualBlock(new MockCostFunction<2>, nullptr, x);
+  problem.AddResidualBlock(new MockCostFunction<2, 1>, nullptr, y, &c);
+  problem.AddResidualBlock(new UnaryCostFunction, nullptr, &c);
+  problem.SetParameterBlockConstant(&c);
+  problem.SetParameterUpperBound(y, 1, 2.0);
+
+  std::vector<int> residual_block_component;
+  ASSERT_EQ(ComputeIndependentComponents(problem.mutable_program(),
+                                         &residual_block_component),
+            2);
+  std::vector<std::unique_ptr<Problem>> components =
+      CreateIndependentComponentProblems(&problem, 2, residual_block_component);
+  ASSERT_EQ(components.size(), 2);
+
+  // The residual block which only depends on c goes to the first component.
+  EXPECT_EQ(components[0]->NumResidualBlocks(), 2);
+  EXPECT_EQ(components[0]->NumParameterBlocks(), 2);
+  EXPECT_EQ(components[0]->GetManifold(x), problem.GetManifold(x));
+  EXPECT_TRUE(components[0]->IsParameterBlockConstant(&c));
+
+  EXPECT_EQ(components[1]->NumResidualBlocks(), 1);
+  EXPECT_EQ(components[1]->NumParameterBlocks(), 2);
+  EXPECT_FALSE(components[1]->IsParameterBlockConstant(y));
+  EXPECT_TRUE(components[1]->IsParameterBlockConstant(&c));
+  EXPECT_EQ(components[1]->GetParameterUpperBound(y, 1), 2.0);
+  EXPECT_EQ(components[1]->GetParameterUpperBound(y, 0),
+            std::numeric_limits<double>::max());
+}
+
+TEST(IndependentComponents, RestrictsOrderingToComponent) {
+  ProblemImpl problem;
+  double x[4] = {0.0};
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x[0], &x[1]);
+  problem.AddResidualBlock(new BinaryCostFunction, nullptr, &x[2], &x[3]);
+
+  ParameterBlockOrdering ordering;
+  ordering.AddElementToGroup(&x[0], 0);
+  ordering.AddElementToGroup(&x[2], 1);
+  ordering.AddElementToGroup(&x[1], 2);
+  ordering.AddElementToGroup(&x[3], 2);
+
+  std::vector<int> residual_block_component;
+  ASSERT_EQ(ComputeIndependentComponents(problem.mutable_program(),
+                                         &residual_block_component),
+            2);
+  std::vector<std::unique_ptr<Problem>> components =
+      CreateIndependentComponentProblems(&problem, 2, residual_block_component);
+
+  std::shared_ptr<ParameterBlockOrdering> component_ordering =
+      CreateIndependentComponentOrdering(ordering, *components[1]);
+  EXPECT_EQ(component_ordering->NumElements(), 2);
+  EXPECT_EQ(component_ordering->NumGroups(), 2);
+  EXPECT_EQ(component_ordering->GroupId(&x[2]), 1);
+  EXPECT_EQ(component_ordering->GroupId(&x[3]), 2);
+  EXPECT_EQ(component_ordering->GroupId(&x[0]), -1);
+}
+
+}  // namespace ceres::internal
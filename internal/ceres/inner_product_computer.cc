@@ -32,8 +32,10 @@
 
 #include <algorithm>
 #include <memory>
+#include <numeric>
 
 #include "absl/log/check.h"
+#include "ceres/parallel_for.h"
 #include "ceres/small_blas.h"
 
 namespace ceres::internal {
@@ -175,6 +177,7 @@ void InnerProductComputer::Init(
 
   std::sort(product_terms.begin(), product_terms.end());
   ComputeOffsetsAndCreateResultMatrix(product_storage_type, product_terms);
+  ComputeRowBlockTerms(product_storage_type);
 }
 
 void InnerProductComputer::ComputeOffsetsAndCreateResultMatrix(
@@ -280,58 +283,115 @@ void InnerProductComputer::ComputeOffsetsAndCreateResultMatrix(
   }
 }
 
-// Use the results_offsets_ array to numerically compute the product
-// m' * m and store it in result_.
-//
-// TODO(sameeragarwal): Multithreading support.
-void InnerProductComputer::Compute() {
-  const double* m_values = m_.values();
+void InnerProductComputer::ComputeRowBlockTerms(
+    const CompressedRowSparseMatrix::StorageType product_storage_type) {
   const CompressedRowBlockStructure* bs = m_.block_structure();
+  const int num_col_blocks = bs->cols.size();
 
-  const CompressedRowSparseMatrix::StorageType storage_type =
-      result_->storage_type();
-  result_->SetZero();
-  double* values = result_->mutable_values();
-  const int* rows = result_->rows();
+  // Count the terms contributing to each row block of the result. The row
+  // block of the result is the column block of the first cell of the term.
+  row_block_term_offsets_.assign(num_col_blocks + 1, 0);
+  for (int r = start_row_block_; r < end_row_block_; ++r) {
+    const std::vector<Cell>& cells = bs->rows[r].cells;
+    const int num_cells = cells.size();
+    for (int c1 = 0; c1 < num_cells; ++c1) {
+      row_block_term_offsets_[cells[c1].block_id + 1] +=
+          product_storage_type ==
+                  CompressedRowSparseMatrix::StorageType::LOWER_TRIANGULAR
+              ? c1 + 1
+              : num_cells - c1;
+    }
+  }
+  std::partial_sum(row_block_term_offsets_.begin(),
+                   row_block_term_offsets_.end(),
+                   row_block_term_offsets_.begin());
+
+  // Visit the terms in the same order as Init, which is the order of
+  // result_offsets_, and append each one to its row block of the result.
+  std::vector<int> cursors(row_block_term_offsets_.begin(),
+                           row_block_term_offsets_.end() - 1);
+  row_block_terms_.resize(result_offsets_.size());
   int cursor = 0;
-
-  // Iterate row blocks.
   for (int r = start_row_block_; r < end_row_block_; ++r) {
     const CompressedRow& m_row = bs->rows[r];
-    for (int c1 = 0; c1 < m_row.cells.size(); ++c1) {
+    const int num_cells = m_row.cells.size();
+    for (int c1 = 0; c1 < num_cells; ++c1) {
       const Cell& cell1 = m_row.cells[c1];
-      const int c1_size = bs->cols[cell1.block_id].size;
-      const int row_nnz = rows[bs->cols[cell1.block_id].position + 1] -
-                          rows[bs->cols[cell1.block_id].position];
-
       int c2_begin, c2_end;
-      if (storage_type ==
+      if (product_storage_type ==
           CompressedRowSparseMatrix::StorageType::LOWER_TRIANGULAR) {
         c2_begin = 0;
         c2_end = c1 + 1;
       } else {
         c2_begin = c1;
-        c2_end = m_row.cells.size();
+        c2_end = num_cells;
       }
 
       for (int c2 = c2_begin; c2 < c2_end; ++c2, ++cursor) {
         const Cell& cell2 = m_row.cells[c2];
-        const int c2_size = bs->cols[cell2.block_id].size;
-        // clang-format off
-        MatrixTransposeMatrixMultiply<Eigen::Dynamic, Eigen::Dynamic,
-                                      Eigen::Dynamic, Eigen::Dynamic, 1>(
-                                          m_values + cell1.position,
-                                          m_row.block.size, c1_size,
-                                          m_values + cell2.position,
-                                          m_row.block.size, c2_size,
-                                          values + result_offsets_[cursor],
-                                          0, 0, c1_size, row_nnz);
-        // clang-format on
+        ProductTermOperands& term = row_block_terms_[cursors[cell1.block_id]++];
+        term.row_block_size = m_row.block.size;
+        term.cell1_position = cell1.position;
+        term.cell2_position = cell2.position;
+        term.cell2_size = bs->cols[cell2.block_id].size;
+        term.result_offset = result_offsets_[cursor];
       }
     }
   }
-
   CHECK_EQ(cursor, result_offsets_.size());
+
+  // The cost of a row block of the result is the number of its terms, plus
+  // one for setting the row block to zero.
+  row_block_cumulative_costs_.resize(num_col_blocks);
+  for (int i = 0; i < num_col_blocks; ++i) {
+    row_block_cumulative_costs_[i] = row_block_term_offsets_[i + 1] + i + 1;
+  }
+}
+
+void InnerProductComputer::Compute() { Compute(nullptr, 1); }
+
+// Use the row_block_terms_ array to numerically compute the product
+// m' * m and store it in result_.
+void InnerProductComputer::Compute(ContextImpl* context, int num_threads) {
+  const double* m_values = m_.values();
+  const std::vector<Block>& col_blocks = m_.block_structure()->cols;
+  double* values = result_->mutable_values();
+  const int* rows = result_->rows();
+
+  auto compute_row_block = [&](int row_block) {
+    const Block& block = col_blocks[row_block];
+    const int row_begin = rows[block.position];
+    const int row_end = rows[block.position + block.size];
+    std::fill(values + row_begin, values + row_end, 0.0);
+    if (row_begin == row_end) {
+      return;
+    }
+
+    const int row_nnz = rows[block.position + 1] - row_begin;
+    for (int t = row_block_term_offsets_[row_block];
+         t < row_block_term_offsets_[row_block + 1];
+         ++t) {
+      const ProductTermOperands& term = row_block_terms_[t];
+      // clang-format off
+      MatrixTransposeMatrixMultiply<Eigen::Dynamic, Eigen::Dynamic,
+                                    Eigen::Dynamic, Eigen::Dynamic, 1>(
+                                        m_values + term.cell1_position,
+                                        term.row_block_size, block.size,
+                                        m_values + term.cell2_position,
+                                        term.row_block_size, term.cell2_size,
+                                        values + term.result_offset,
+                                        0, 0, block.size, row_nnz);
+      // clang-format on
+    }
+  };
+
+  ParallelFor(context,
+              0,
+              static_cast<int>(col_blocks.size()),
+              num_threads,
+              compute_row_block,
+              row_block_cumulative_costs_.data(),
+              [](const int cost) { return cost; });
 }
 
 }  // namespace ceres::internal
@@ -36,6 +36,7 @@
 
 #include "ceres/block_sparse_matrix.h"
 #include "ceres/compressed_row_sparse_matrix.h"
+#include "ceres/context_impl.h"
 #include "ceres/internal/disable_warnings.h"
 #include "ceres/internal/export.h"
 
@@ -92,6 +93,11 @@ class CERES_NO_EXPORT InnerProductComputer {
   // Update result_ to be numerically equal to m' * m.
   void Compute();
 
+  // Same as above, but uses up to num_threads threads. The row blocks of the
+  // result are distributed over the threads, and every thread computes all
+  // the terms of the row blocks it owns, so no synchronization is needed.
+  void Compute(ContextImpl* context, int num_threads);
+
   // Accessors for the result containing the inner product.
   //
   // Compute must be called before accessing this result for
@@ -121,6 +127,17 @@ class CERES_NO_EXPORT InnerProductComputer {
     int index;
   };
 
+  // The operands of a term of the inner product of a row block of m, i.e.,
+  // the product of the transposes of two of its cells, and the location in
+  // the values array of result_ where the product is accumulated.
+  struct ProductTermOperands {
+    int row_block_size;
+    int cell1_position;
+    int cell2_position;
+    int cell2_size;
+    int result_offset;
+  };
+
   InnerProductComputer(const BlockSparseMatrix& m,
                        int start_row_block,
                        int end_row_block);
@@ -138,6 +155,11 @@ class CERES_NO_EXPORT InnerProductComputer {
       const CompressedRowSparseMatrix::StorageType storage_type,
       const std::vector<ProductTerm>& product_terms);
 
+  // Group the terms of the inner product by the row block of the result they
+  // contribute to.
+  void ComputeRowBlockTerms(
+      const CompressedRowSparseMatrix::StorageType storage_type);
+
   const BlockSparseMatrix& m_;
   const int start_row_block_;
   const int end_row_block_;
@@ -150,6 +172,17 @@ class CERES_NO_EXPORT InnerProductComputer {
   // This is the principal look up table that allows this class to
   // compute the inner product fast.
   std::vector<int> result_offsets_;
+
+  // The terms contributing to row block i of result_ are
+  // row_block_terms_[row_block_term_offsets_[i], row_block_term_offsets_[i +
+  // 1]), in the order of the row blocks of m they come from. Since every
+  // thread computes whole row blocks of the result, the result is the same for
+  // any number of threads.
+  std::vector<ProductTermOperands> row_block_terms_;
+  std::vector<int> row_block_term_offsets_;
+  // Cumulative cost of computing the row blocks of result_, used to balance
+  // the work between the threads.
+  std::vector<int> row_block_cumulative_costs_;
 };
 
 }  // namespace ceres::internal
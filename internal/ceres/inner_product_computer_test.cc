@@ -37,6 +37,7 @@
 #include "Eigen/SparseCore"
 #include "absl/log/log.h"
 #include "ceres/block_sparse_matrix.h"
+#include "ceres/context_impl.h"
 #include "ceres/internal/eigen.h"
 #include "ceres/triplet_sparse_matrix.h"
 #include "gtest/gtest.h"
@@ -220,6 +221,44 @@ TEST(InnerProductComputer, SubMatrix) {
   }
 }
 
+// The multi-threaded product is computed in the same order as the single
+// threaded one and thus is bitwise identical to it.
+TEST(InnerProductComputer, MultiThreadedMatchesSingleThreaded) {
+  const int kNumThreads = 4;
+  ContextImpl context;
+  context.EnsureMinimumThreads(kNumThreads);
+  std::mt19937 prng;
+
+  BlockSparseMatrix::RandomMatrixOptions options;
+  options.num_row_blocks = 100;
+  options.num_col_blocks = 50;
+  options.min_row_block_size = 1;
+  options.max_row_block_size = 5;
+  options.min_col_block_size = 1;
+  options.max_col_block_size = 10;
+  options.block_density = 0.2;
+  std::unique_ptr<BlockSparseMatrix> random_matrix(
+      BlockSparseMatrix::CreateRandomMatrix(options, prng));
+
+  for (auto storage_type :
+       {CompressedRowSparseMatrix::StorageType::LOWER_TRIANGULAR,
+        CompressedRowSparseMatrix::StorageType::UPPER_TRIANGULAR}) {
+    auto expected = InnerProductComputer::Create(*random_matrix, storage_type);
+    expected->Compute();
+    auto actual = InnerProductComputer::Create(*random_matrix, storage_type);
+    // Computing twice makes sure that the result is reset between calls.
+    actual->Compute(&context, kNumThreads);
+    actual->Compute(&context, kNumThreads);
+
+    const CompressedRowSparseMatrix& expected_result = expected->result();
+    const CompressedRowSparseMatrix& actual_result = actual->result();
+    ASSERT_EQ(expected_result.num_nonzeros(), actual_result.num_nonzeros());
+    for (int i = 0; i < expected_result.num_nonzeros(); ++i) {
+      EXPECT_EQ(expected_result.values()[i], actual_result.values()[i]);
+    }
+  }
+}
+
 #undef COMPUTE_AND_COMPARE
 }  // namespace internal
 }  // namespace ceres
@@ -28,8 +28,13 @@
 //
 // Authors: sameeragarwal@google.com (Sameer Agarwal)
 
+#include <vector>
+
 #include "Eigen/Dense"
 #include "benchmark/benchmark.h"
+#include "ceres/batched_psd_matrix_inverter.h"
+#include "ceres/context_impl.h"
+#include "ceres/internal/eigen.h"
 #include "ceres/invert_psd_matrix.h"
 
 namespace ceres::internal {
@@ -83,6 +88,57 @@ BENCHMARK(BenchmarkDynamicallyInvertPSDMatrix)
       }
     });
 
+// Inverting many small matrices, as done by the block Jacobi and Schur
+// Jacobi preconditioners, one matrix at a time and in batches.
+constexpr int kNumMatrices = 10000;
+
+static std::vector<double> RandomPSDMatrices(const int size) {
+  using MatrixType =
+      typename EigenTypes<Eigen::Dynamic, Eigen::Dynamic>::Matrix;
+  std::vector<double> values(kNumMatrices * size * size);
+  for (int i = 0; i < kNumMatrices; ++i) {
+    MatrixType m = MatrixType::Random(size, size);
+    MatrixRef(values.data() + i * size * size, size, size) =
+        m * m.transpose() + MatrixType::Identity(size, size);
+  }
+  return values;
+}
+
+static void BenchmarkManyInvertPSDMatrix(benchmark::State& state) {
+  const int size = static_cast<int>(state.range(0));
+  const std::vector<double> input = RandomPSDMatrices(size);
+  std::vector<double> output(input.size());
+  for (auto _ : state) {
+    output = input;
+    for (int i = 0; i < kNumMatrices; ++i) {
+      MatrixRef m(output.data() + i * size * size, size, size);
+      m = m.selfadjointView<Eigen::Upper>().llt().solve(
+          Matrix::Identity(size, size));
+    }
+    benchmark::DoNotOptimize(output.data());
+  }
+}
+
+BENCHMARK(BenchmarkManyInvertPSDMatrix)->DenseRange(1, 12);
+
+static void BenchmarkBatchedInvertPSDMatrix(benchmark::State& state) {
+  const int size = static_cast<int>(state.range(0));
+  const std::vector<double> input = RandomPSDMatrices(size);
+  std::vector<double> output(input.size());
+  BatchedPSDMatrixInverter inverter;
+  for (int i = 0; i < kNumMatrices; ++i) {
+    inverter.AddMatrix(size, output.data() + i * size * size);
+  }
+  ContextImpl context;
+  for (auto _ : state) {
+    output = input;
+    inverter.Invert(&context, 1);
+    benchmark::DoNotOptimize(output.data());
+  }
+}
+
+BENCHMARK(BenchmarkBatchedInvertPSDMatrix)->DenseRange(1, 12);
+
 }  // namespace ceres::internal
 
 BENCHMARK_MAIN();
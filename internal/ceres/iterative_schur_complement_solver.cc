@@ -32,6 +32,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -41,9 +42,11 @@
 #include "ceres/block_sparse_matrix.h"
 #include "ceres/block_structure.h"
 #include "ceres/conjugate_gradients_solver.h"
+#include "ceres/deflated_conjugate_gradients_solver.h"
 #include "ceres/detect_structure.h"
 #include "ceres/event_logger.h"
 #include "ceres/implicit_schur_complement.h"
+#include "ceres/incomplete_cholesky_preconditioner.h"
 #include "ceres/internal/eigen.h"
 #include "ceres/linear_solver.h"
 #include "ceres/power_series_expansion_preconditioner.h"
@@ -54,10 +57,55 @@
 #include "ceres/visibility_based_preconditioner.h"
 
 namespace ceres::internal {
+namespace {
+
+// The Schur complement, with the products computed using single
+// precision copies of A and (E'E)^-1.
+class SinglePrecisionSchurComplement final
+    : public ConjugateGradientsLinearOperator<Vector> {
+ public:
+  explicit SinglePrecisionSchurComplement(
+      const ImplicitSchurComplement& schur_complement)
+      : schur_complement_(schur_complement) {}
+
+  void RightMultiplyAndAccumulate(const Vector& x, Vector& y) final {
+    schur_complement_.SinglePrecisionRightMultiplyAndAccumulate(x.data(),
+                                                                y.data());
+  }
+
+ private:
+  const ImplicitSchurComplement& schur_complement_;
+};
+
+// The JACOBI preconditioner, i.e., (F'F)^-1, computed using its single
+// precision copy.
+class SinglePrecisionJacobiPreconditioner final
+    : public ConjugateGradientsLinearOperator<Vector> {
+ public:
+  SinglePrecisionJacobiPreconditioner(const FloatBlockSparseMatrix& m,
+                                      ContextImpl* context,
+                                      int num_threads)
+      : m_(m), context_(context), num_threads_(num_threads) {}
+
+  void RightMultiplyAndAccumulate(const Vector& x, Vector& y) final {
+    m_.RightMultiplyAndAccumulate(x.data(), y.data(), context_, num_threads_);
+  }
+
+ private:
+  const FloatBlockSparseMatrix& m_;
+  ContextImpl* context_;
+  int num_threads_;
+};
+
+}  // namespace
 
 IterativeSchurComplementSolver::IterativeSchurComplementSolver(
     LinearSolver::Options options)
-    : options_(std::move(options)) {}
+    : options_(std::move(options)),
+      preconditioner_refresh_policy_(
+          options_.preconditioner_type,
+          options_.max_num_preconditioner_reuses,
+          options_.preconditioner_refresh_iteration_ratio) {}
 
 IterativeSchurComplementSolver::~IterativeSchurComplementSolver() = default;
 
@@ -111,8 +159,14 @@ LinearSolver::Summary IterativeSchurComplementSolver::SolveImpl(
   }
 
   CreatePreconditioner(A);
+  const bool refresh_preconditioner =
+      preconditioner_refresh_policy_.RefreshNeeded();
   if (preconditioner_ != nullptr) {
-    if (!preconditioner_->Update(*A, per_solve_options.D)) {
+    const bool success =
+        refresh_preconditioner
+            ? preconditioner_->Update(*A, per_solve_options.D)
+            : preconditioner_->UpdateDiagonal(per_solve_options.D);
+    if (!success) {
       LinearSolver::Summary summary;
       summary.num_iterations = 0;
       summary.termination_type = LinearSolverTerminationType::FAILURE;
@@ -127,31 +181,89 @@ LinearSolver::Summary IterativeSchurComplementSolver::SolveImpl(
   cg_options.residual_reset_period = options_.residual_reset_period;
   cg_options.q_tolerance = per_solve_options.q_tolerance;
   cg_options.r_tolerance = per_solve_options.r_tolerance;
+  cg_options.context = options_.context;
+  cg_options.num_threads = options_.num_threads;
 
   LinearOperatorAdapter lhs(*schur_complement_);
   LinearOperatorAdapter preconditioner(*preconditioner_);
 
-  Vector scratch[4];
-  for (int i = 0; i < 4; ++i) {
-    scratch[i].resize(schur_complement_->num_cols());
+  // Mixed precision solves need two more vectors for the refinement, and
+  // pipelined conjugate gradients needs nine vectors.
+  Vector scratch[9];
+  int num_scratch = 4;
+  if (options_.use_mixed_precision_solves) {
+    num_scratch = 6;
+  } else if (options_.use_pipelined_conjugate_gradients) {
+    num_scratch = 9;
+  }
+  Vector* scratch_ptr[9];
+  for (int i = 0; i < 9; ++i) {
+    if (i < num_scratch) {
+      scratch[i].resize(schur_complement_->num_cols());
+    }
+    scratch_ptr[i] = &scratch[i];
   }
-  Vector* scratch_ptr[4] = {&scratch[0], &scratch[1], &scratch[2], &scratch[3]};
 
   event_logger.AddEvent("Setup");
 
-  LinearSolver::Summary summary =
-      ConjugateGradientsSolver(cg_options,
-                               lhs,
-                               schur_complement_->rhs(),
-                               preconditioner,
-                               scratch_ptr,
-                               reduced_linear_system_solution_);
+  LinearSolver::Summary summary;
+  if (options_.use_mixed_precision_solves) {
+    // The conjugate gradients iterations use single precision copies of
+    // the matrices, and iterative refinement recovers the accuracy lost
+    // by doing so.
+    SinglePrecisionSchurComplement low_precision_lhs(*schur_complement_);
+    ConjugateGradientsLinearOperator<Vector>* low_precision_preconditioner =
+        &preconditioner;
+    std::unique_ptr<SinglePrecisionJacobiPreconditioner> jacobi;
+    if (options_.preconditioner_type == JACOBI) {
+      jacobi = std::make_unique<SinglePrecisionJacobiPreconditioner>(
+          *schur_complement_->single_precision_block_diagonal_FtF_inverse(),
+          options_.context,
+          options_.num_threads);
+      low_precision_preconditioner = jacobi.get();
+    }
+    summary = RefinedConjugateGradientsSolver(
+        cg_options,
+        lhs,
+        low_precision_lhs,
+        schur_complement_->rhs(),
+        *low_precision_preconditioner,
+        options_.max_num_cg_refinement_iterations,
+        scratch_ptr,
+        reduced_linear_system_solution_);
+  } else if (options_.use_pipelined_conjugate_gradients) {
+    summary =
+        PipelinedConjugateGradientsSolver(cg_options,
+                                          lhs,
+                                          schur_complement_->rhs(),
+                                          preconditioner,
+                                          scratch_ptr,
+                                          reduced_linear_system_solution_);
+  } else if (options_.num_deflation_vectors > 0) {
+    if (deflated_cg_solver_ == nullptr) {
+      deflated_cg_solver_ = std::make_unique<DeflatedConjugateGradientsSolver>(
+          options_.num_deflation_vectors, 3 * options_.num_deflation_vectors);
+    }
+    summary = deflated_cg_solver_->Solve(cg_options,
+                                         lhs,
+                                         schur_complement_->rhs(),
+                                         preconditioner,
+                                         reduced_linear_system_solution_);
+  } else {
+    summary = ConjugateGradientsSolver(cg_options,
+                                       lhs,
+                                       schur_complement_->rhs(),
+                                       preconditioner,
+                                       scratch_ptr,
+                                       reduced_linear_system_solution_);
+  }
 
   if (summary.termination_type != LinearSolverTerminationType::FAILURE &&
       summary.termination_type != LinearSolverTerminationType::FATAL_ERROR) {
     schur_complement_->BackSubstitute(reduced_linear_system_solution_.data(),
                                       x);
   }
+  preconditioner_refresh_policy_.RecordSolve(refresh_preconditioner, summary);
   event_logger.AddEvent("Solve");
   return summary;
 }
@@ -193,6 +305,10 @@ void IterativeSchurComplementSolver::CreatePreconditioner(
       preconditioner_ = std::make_unique<VisibilityBasedPreconditioner>(
           *A->block_structure(), preconditioner_options);
       break;
+    case INCOMPLETE_CHOLESKY:
+      preconditioner_ = std::make_unique<SchurIncompleteCholeskyPreconditioner>(
+          *A->block_structure(), preconditioner_options);
+      break;
     default:
       LOG(FATAL) << "Unknown Preconditioner Type";
   }
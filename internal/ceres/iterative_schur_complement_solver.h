@@ -37,11 +37,13 @@
 #include "ceres/internal/eigen.h"
 #include "ceres/internal/export.h"
 #include "ceres/linear_solver.h"
+#include "ceres/preconditioner_refresh_policy.h"
 #include "ceres/types.h"
 
 namespace ceres::internal {
 
 class BlockSparseMatrix;
+class DeflatedConjugateGradientsSolver;
 class ImplicitSchurComplement;
 class Preconditioner;
 
@@ -90,6 +92,9 @@ class CERES_NO_EXPORT IterativeSchurComplementSolver final
   LinearSolver::Options options_;
   std::unique_ptr<internal::ImplicitSchurComplement> schur_complement_;
   std::unique_ptr<Preconditioner> preconditioner_;
+  PreconditionerRefreshPolicy preconditioner_refresh_policy_;
+  // Used if options_.num_deflation_vectors > 0.
+  std::unique_ptr<DeflatedConjugateGradientsSolver> deflated_cg_solver_;
   Vector reduced_linear_system_solution_;
 };
 
@@ -56,6 +56,10 @@ namespace internal {
 using testing::AssertionResult;
 
 const double kEpsilon = 1e-14;
+// Iterative refinement stops as soon as the solution satisfies the
+// tolerances of the linear solve, rather than running until conjugate
+// gradients converges.
+const double kMixedPrecisionEpsilon = 1e-12;
 
 class IterativeSchurComplementSolverTest : public ::testing::Test {
  protected:
@@ -75,7 +79,11 @@ class IterativeSchurComplementSolverTest : public ::testing::Test {
 
   AssertionResult TestSolver(double* D,
                              PreconditionerType preconditioner_type,
-                             bool use_spse_initialization) {
+                             bool use_spse_initialization,
+                             bool use_mixed_precision_solves = false,
+                             bool use_pipelined_conjugate_gradients = false,
+                             int num_deflation_vectors = 0,
+                             int max_num_preconditioner_reuses = 0) {
     TripletSparseMatrix triplet_A(
         A_->num_rows(), A_->num_cols(), A_->num_nonzeros());
     A_->ToTripletSparseMatrix(&triplet_A);
@@ -99,21 +107,47 @@ class IterativeSchurComplementSolverTest : public ::testing::Test {
     options.max_num_spse_iterations = 1;
     options.use_spse_initialization = use_spse_initialization;
     options.preconditioner_type = preconditioner_type;
+    options.use_mixed_precision_solves = use_mixed_precision_solves;
+    options.max_num_cg_refinement_iterations =
+        max_num_cg_refinement_iterations_;
+    options.use_pipelined_conjugate_gradients =
+        use_pipelined_conjugate_gradients;
+    options.num_deflation_vectors = num_deflation_vectors;
+    options.max_num_preconditioner_reuses = max_num_preconditioner_reuses;
     IterativeSchurComplementSolver isc(options);
 
     Vector isc_sol(num_cols_);
-    per_solve_options.r_tolerance = 1e-12;
+    per_solve_options.r_tolerance = r_tolerance_;
+    per_solve_options.q_tolerance = q_tolerance_;
+    if (max_num_preconditioner_reuses > 0) {
+      // Compute the preconditioner for a linear system with a different
+      // diagonal, which the next solve reuses.
+      LinearSolver::PerSolveOptions other_per_solve_options =
+          per_solve_options;
+      other_per_solve_options.D = (D == nullptr) ? D_.get() : nullptr;
+      isc.Solve(
+          A_.get(), b_.get(), other_per_solve_options, isc_sol.data());
+    }
     isc.Solve(A_.get(), b_.get(), per_solve_options, isc_sol.data());
+    if (num_deflation_vectors > 0) {
+      // The second solve deflates the subspace computed by the first one.
+      isc.Solve(A_.get(), b_.get(), per_solve_options, isc_sol.data());
+    }
     double diff = (isc_sol - reference_solution).norm();
-    if (diff < kEpsilon) {
+    const double epsilon =
+        use_mixed_precision_solves ? kMixedPrecisionEpsilon : kEpsilon;
+    if (diff < epsilon) {
       return testing::AssertionSuccess();
     } else {
       return testing::AssertionFailure()
              << "The reference solution differs from the ITERATIVE_SCHUR"
-             << " solution by " << diff << " which is more than " << kEpsilon;
+             << " solution by " << diff << " which is more than " << epsilon;
     }
   }
 
+  double r_tolerance_ = 1e-12;
+  double q_tolerance_ = 0.0;
+  int max_num_cg_refinement_iterations_ = 5;
   int num_rows_;
   int num_cols_;
   int num_eliminate_blocks_;
@@ -142,6 +176,70 @@ TEST_F(IterativeSchurComplementSolverTest,
   EXPECT_TRUE(TestSolver(D_.get(), SCHUR_POWER_SERIES_EXPANSION, false));
 }
 
+TEST_F(IterativeSchurComplementSolverTest, MixedPrecisionSchurJacobi) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, SCHUR_JACOBI, false, true));
+  EXPECT_TRUE(TestSolver(D_.get(), SCHUR_JACOBI, false, true));
+}
+
+TEST_F(IterativeSchurComplementSolverTest, MixedPrecisionJacobi) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, JACOBI, false, true));
+  EXPECT_TRUE(TestSolver(D_.get(), JACOBI, false, true));
+}
+
+// LevenbergMarquardtStrategy disables r_tolerance and terminates
+// conjugate gradients using q_tolerance = eta. The refinement has to reach
+// double precision accuracy using the same criterion, which a single
+// precision solve does not.
+TEST_F(IterativeSchurComplementSolverTest,
+       MixedPrecisionWithLevenbergMarquardtTolerances) {
+  SetUpProblem(2);
+  r_tolerance_ = -1.0;
+  q_tolerance_ = 1e-14;
+  EXPECT_TRUE(TestSolver(D_.get(), SCHUR_JACOBI, false, true));
+  EXPECT_TRUE(TestSolver(D_.get(), JACOBI, false, true));
+  max_num_cg_refinement_iterations_ = 0;
+  EXPECT_FALSE(TestSolver(D_.get(), SCHUR_JACOBI, false, true));
+  EXPECT_FALSE(TestSolver(D_.get(), JACOBI, false, true));
+}
+
+TEST_F(IterativeSchurComplementSolverTest, PipelinedSchurJacobi) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, SCHUR_JACOBI, false, false, true));
+  EXPECT_TRUE(TestSolver(D_.get(), SCHUR_JACOBI, false, false, true));
+}
+
+TEST_F(IterativeSchurComplementSolverTest, PipelinedJacobi) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, JACOBI, false, false, true));
+  EXPECT_TRUE(TestSolver(D_.get(), JACOBI, false, false, true));
+}
+
+TEST_F(IterativeSchurComplementSolverTest, DeflatedSchurJacobi) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, SCHUR_JACOBI, false, false, false, 2));
+  EXPECT_TRUE(TestSolver(D_.get(), SCHUR_JACOBI, false, false, false, 2));
+}
+
+TEST_F(IterativeSchurComplementSolverTest, DeflatedJacobi) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, JACOBI, false, false, false, 2));
+  EXPECT_TRUE(TestSolver(D_.get(), JACOBI, false, false, false, 2));
+}
+
+TEST_F(IterativeSchurComplementSolverTest, ReusedSchurJacobi) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, SCHUR_JACOBI, false, false, false, 0, 1));
+  EXPECT_TRUE(TestSolver(D_.get(), SCHUR_JACOBI, false, false, false, 0, 1));
+}
+
+TEST_F(IterativeSchurComplementSolverTest, IncompleteCholesky) {
+  SetUpProblem(2);
+  EXPECT_TRUE(TestSolver(nullptr, INCOMPLETE_CHOLESKY, false));
+  EXPECT_TRUE(TestSolver(D_.get(), INCOMPLETE_CHOLESKY, false));
+}
+
 TEST_F(IterativeSchurComplementSolverTest, ProblemWithNoFBlocks) {
   SetUpProblem(3);
   EXPECT_TRUE(TestSolver(nullptr, SCHUR_JACOBI, false));
@@ -96,6 +96,9 @@ TrustRegionStrategy::Summary LevenbergMarquardtStrategy::ComputeStep(
 
   LinearSolver::PerSolveOptions solve_options;
   solve_options.D = lm_diagonal_.data();
+  // reuse_diagonal_ is only true if the Jacobian and the residuals are
+  // the same as in the last call to ComputeStep.
+  solve_options.A_and_b_unchanged = reuse_diagonal_;
   solve_options.q_tolerance = per_solve_options.eta;
   // Disable r_tolerance checking. Since we only care about
   // termination via the q_tolerance. As Nash and Sofer show,
@@ -75,6 +75,50 @@ class RegularizationCheckingLinearSolver : public DenseSparseMatrixSolver {
   const double* diagonal_;
 };
 
+// Linear solver that records the value of
+// LinearSolver::PerSolveOptions::A_and_b_unchanged.
+class UnchangedAAndBRecordingLinearSolver : public DenseSparseMatrixSolver {
+ public:
+  bool A_and_b_unchanged = false;
+
+ private:
+  LinearSolver::Summary SolveImpl(
+      DenseSparseMatrix* A,
+      const double* b,
+      const LinearSolver::PerSolveOptions& per_solve_options,
+      double* x) final {
+    A_and_b_unchanged = per_solve_options.A_and_b_unchanged;
+    VectorRef(x, A->num_cols()).setZero();
+    LinearSolver::Summary summary;
+    summary.termination_type = LinearSolverTerminationType::SUCCESS;
+    return summary;
+  }
+};
+
+TEST(LevenbergMarquardtStrategy, AAndBUnchangedOnlyAfterRejectedSteps) {
+  DenseSparseMatrix dsm(Matrix::Identity(2, 2));
+  double residuals[2] = {1.0, 2.0};
+  double x[2];
+
+  UnchangedAAndBRecordingLinearSolver linear_solver;
+  TrustRegionStrategy::Options options;
+  options.linear_solver = &linear_solver;
+  LevenbergMarquardtStrategy lms(options);
+  TrustRegionStrategy::PerSolveOptions pso;
+
+  lms.ComputeStep(pso, &dsm, residuals, x);
+  EXPECT_FALSE(linear_solver.A_and_b_unchanged);
+  lms.StepRejected(0.0);
+  lms.ComputeStep(pso, &dsm, residuals, x);
+  EXPECT_TRUE(linear_solver.A_and_b_unchanged);
+  lms.StepRejected(0.0);
+  lms.ComputeStep(pso, &dsm, residuals, x);
+  EXPECT_TRUE(linear_solver.A_and_b_unchanged);
+  lms.StepAccepted(1.0);
+  lms.ComputeStep(pso, &dsm, residuals, x);
+  EXPECT_FALSE(linear_solver.A_and_b_unchanged);
+}
+
 TEST(LevenbergMarquardtStrategy, AcceptRejectStepRadiusScaling) {
   TrustRegionStrategy::Options options;
   options.initial_radius = 2.0;
@@ -34,6 +34,8 @@
 #include <string>
 
 #include "absl/log/check.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ceres/casts.h"
 #include "ceres/context_impl.h"
 #include "ceres/evaluator.h"
@@ -44,12 +46,15 @@
 namespace ceres::internal {
 namespace {
 
-bool IsProgramValid(const Program& program, std::string* error) {
+bool IsProgramValid(const Program& program,
+                    ContextImpl* context,
+                    int num_threads,
+                    std::string* error) {
   if (program.IsBoundsConstrained()) {
     *error = "LINE_SEARCH Minimizer does not support bounds.";
     return false;
   }
-  return program.ParameterBlocksAreFinite(error);
+  return program.ParameterBlocksAreFinite(context, num_threads, error);
 }
 
 bool SetupEvaluator(PreprocessedProblem* pp) {
@@ -62,8 +67,11 @@ bool SetupEvaluator(PreprocessedProblem* pp) {
   pp->evaluator_options.context = pp->problem->context();
   pp->evaluator_options.evaluation_callback =
       pp->reduced_program->mutable_evaluation_callback();
+  const absl::Time evaluator_creation_start_time = absl::Now();
   pp->evaluator = Evaluator::Create(
       pp->evaluator_options, pp->reduced_program.get(), &pp->error);
+  pp->evaluator_creation_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - evaluator_creation_start_time);
   return (pp->evaluator.get() != nullptr);
 }
 
@@ -78,12 +86,27 @@ bool LineSearchPreprocessor::Preprocess(const Solver::Options& options,
 
   pp->problem = problem;
   Program* program = problem->mutable_program();
-  if (!IsProgramValid(*program, &pp->error)) {
+  ContextImpl* context = problem->context();
+  const int num_threads = pp->options.num_threads;
+
+  const absl::Time validation_start_time = absl::Now();
+  const bool is_valid =
+      IsProgramValid(*program, context, num_threads, &pp->error);
+  pp->program_validation_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - validation_start_time);
+  if (!is_valid) {
     return false;
   }
 
-  pp->reduced_program = program->CreateReducedProgram(
-      &pp->removed_parameter_blocks, &pp->fixed_cost, &pp->error);
+  const absl::Time reduction_start_time = absl::Now();
+  pp->reduced_program =
+      program->CreateReducedProgram(context,
+                                    num_threads,
+                                    &pp->removed_parameter_blocks,
+                                    &pp->fixed_cost,
+                                    &pp->error);
+  pp->program_reduction_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - reduction_start_time);
 
   if (pp->reduced_program.get() == nullptr) {
     return false;
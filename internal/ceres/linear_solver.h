@@ -225,6 +225,12 @@ class CERES_NO_EXPORT LinearSolver {
 
     bool use_mixed_precision_solves = false;
     int max_num_refinement_iterations = 0;
+    int max_num_cg_refinement_iterations = 3;
+    bool use_single_precision_jacobian = false;
+    bool use_pipelined_conjugate_gradients = false;
+    int num_deflation_vectors = 0;
+    int max_num_preconditioner_reuses = 0;
+    double preconditioner_refresh_iteration_ratio = 1.5;
     int subset_preconditioner_start_row_block = -1;
     ContextImpl* context = nullptr;
   };
@@ -256,6 +262,20 @@ class CERES_NO_EXPORT LinearSolver {
     // size n.  b is an array of size m and x is an array of size n.
     double* D = nullptr;
 
+    // True if A and b have the same values as in the previous call to
+    // Solve, and only D differs, e.g. when the trust region step
+    // computed in the previous call was rejected. Solvers may use this
+    // to reuse the products of A and b computed in the previous call.
+    //
+    // The Schur complement based solvers do so by keeping E'F, E'E, its
+    // inverse and E'b for every e_block, and F'F for the Schur
+    // complement, between calls, which takes about as much memory as the
+    // values of A and the Schur complement together. With more than one
+    // thread this storage is always used. With a single thread it is
+    // allocated the first time A_and_b_unchanged is true, after which
+    // every elimination stores its products there.
+    bool A_and_b_unchanged = false;
+
     // This option only makes sense for iterative solvers.
     //
     // In general the performance of an iterative linear solver
@@ -0,0 +1,380 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/marginalization.h"
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Eigenvalues"
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "ceres/crs_matrix.h"
+#include "ceres/dense_cholesky.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/linear_solver.h"
+#include "ceres/types.h"
+
+namespace ceres {
+
+MarginalizationPrior::MarginalizationPrior(
+    std::vector<Vector> linearization_points,
+    std::vector<const Manifold*> manifolds,
+    Matrix jacobian,
+    Vector residuals)
+    : linearization_points_(std::move(linearization_points)),
+      manifolds_(std::move(manifolds)),
+      jacobian_(std::move(jacobian)),
+      residuals_(std::move(residuals)) {
+  CHECK(!linearization_points_.empty());
+  CHECK_EQ(linearization_points_.size(), manifolds_.size());
+  CHECK_GT(residuals_.rows(), 0);
+  CHECK_EQ(jacobian_.rows(), residuals_.rows());
+
+  int num_tangent_parameters = 0;
+  tangent_offsets_.reserve(linearization_points_.size());
+  for (int i = 0; i < linearization_points_.size(); ++i) {
+    const int ambient_size = linearization_points_[i].size();
+    CHECK_GT(ambient_size, 0);
+    if (manifolds_[i] != nullptr) {
+      CHECK_EQ(manifolds_[i]->AmbientSize(), ambient_size);
+    }
+    tangent_offsets_.push_back(num_tangent_parameters);
+    num_tangent_parameters +=
+        manifolds_[i] == nullptr ? ambient_size : manifolds_[i]->TangentSize();
+    mutable_parameter_block_sizes()->push_back(ambient_size);
+  }
+  CHECK_EQ(jacobian_.cols(), num_tangent_parameters);
+  set_num_residuals(residuals_.rows());
+}
+
+bool MarginalizationPrior::Evaluate(double const* const* parameters,
+                                    double* residuals,
+                                    double** jacobians) const {
+  VectorRef r(residuals, num_residuals());
+  r = residuals_;
+  for (int i = 0; i < linearization_points_.size(); ++i) {
+    const Vector& x0 = linearization_points_[i];
+    const Manifold* manifold = manifolds_[i];
+    const int ambient_size = x0.size();
+    const int tangent_size =
+        manifold == nullptr ? ambient_size : manifold->TangentSize();
+    const auto J_i = jacobian_.middleCols(tangent_offsets_[i], tangent_size);
+
+    if (manifold == nullptr) {
+      r += J_i * (ConstVectorRef(parameters[i], ambient_size) - x0);
+      if (jacobians != nullptr && jacobians[i] != nullptr) {
+        MatrixRef(jacobians[i], num_residuals(), ambient_size) = J_i;
+      }
+      continue;
+    }
+
+    Vector delta(tangent_size);
+    if (!manifold->Minus(parameters[i], x0.data(), delta.data())) {
+      return false;
+    }
+    r += J_i * delta;
+    if (jacobians != nullptr && jacobians[i] != nullptr) {
+      // The solver maps this Jacobian to the tangent space at x_i using
+      // PlusJacobian(x_i), which MinusJacobian(x_i) is the left inverse of.
+      Matrix minus_jacobian(tangent_size, ambient_size);
+      if (!manifold->MinusJacobian(parameters[i], minus_jacobian.data())) {
+        return false;
+      }
+      MatrixRef(jacobians[i], num_residuals(), ambient_size) =
+          J_i * minus_jacobian;
+    }
+  }
+  return true;
+}
+
+bool ComputeMarginalizationPrior(
+    const MarginalizationOptions& options,
+    const std::vector<double*>& parameter_blocks_to_marginalize,
+    Problem* problem,
+    std::vector<double*>* markov_blanket,
+    std::unique_ptr<MarginalizationPrior>* prior,
+    std::string* error) {
+  CHECK(problem != nullptr);
+  CHECK(markov_blanket != nullptr);
+  CHECK(prior != nullptr);
+  CHECK(error != nullptr);
+  CHECK_GT(options.min_eigenvalue_ratio, 0.0);
+
+  markov_blanket->clear();
+  prior->reset();
+
+  // The parameter blocks that are eliminated, i.e., the non-constant
+  // parameter blocks being marginalized, and the residual blocks that depend
+  // on any of the parameter blocks being marginalized.
+  std::unordered_set<const double*> marginalized;
+  std::vector<double*> eliminated;
+  std::unordered_set<ResidualBlockId> residual_block_set;
+  std::vector<ResidualBlockId> residual_blocks;
+  std::vector<ResidualBlockId> adjacent_residual_blocks;
+  for (double* parameter_block : parameter_blocks_to_marginalize) {
+    if (!problem->HasParameterBlock(parameter_block)) {
+      *error = absl::StrFormat(
+          "Parameter block %p to marginalize is not in the problem.",
+          parameter_block);
+      return false;
+    }
+    if (!marginalized.insert(parameter_block).second) {
+      continue;
+    }
+    if (!problem->IsParameterBlockConstant(parameter_block)) {
+      eliminated.push_back(parameter_block);
+    }
+    problem->GetResidualBlocksForParameterBlock(parameter_block,
+                                                &adjacent_residual_blocks);
+    for (ResidualBlockId residual_block : adjacent_residual_blocks) {
+      if (residual_block_set.insert(residual_block).second) {
+        residual_blocks.push_back(residual_block);
+      }
+    }
+  }
+
+  // The Markov blanket of the parameter blocks being marginalized are the
+  // other non-constant parameter blocks of these residual blocks.
+  std::unordered_set<const double*> markov_blanket_set;
+  std::vector<double*> residual_parameter_blocks;
+  for (ResidualBlockId residual_block : residual_blocks) {
+    problem->GetParameterBlocksForResidualBlock(residual_block,
+                                                &residual_parameter_blocks);
+    for (double* parameter_block : residual_parameter_blocks) {
+      if (marginalized.count(parameter_block) == 0 &&
+          !problem->IsParameterBlockConstant(parameter_block) &&
+          markov_blanket_set.insert(parameter_block).second) {
+        markov_blanket->push_back(parameter_block);
+      }
+    }
+  }
+
+  if (markov_blanket->empty()) {
+    return true;
+  }
+
+  // Linearize the residual blocks with the columns of the eliminated
+  // parameter blocks first, followed by those of the Markov blanket.
+  Problem::EvaluateOptions evaluate_options;
+  evaluate_options.parameter_blocks = eliminated;
+  evaluate_options.parameter_blocks.insert(
+      evaluate_options.parameter_blocks.end(),
+      markov_blanket->begin(),
+      markov_blanket->end());
+  evaluate_options.residual_blocks = residual_blocks;
+  evaluate_options.apply_loss_function = options.apply_loss_function;
+  evaluate_options.num_threads = options.num_threads;
+
+  double cost = 0.0;
+  std::vector<double> residuals;
+  CRSMatrix crs_jacobian;
+  if (!problem->Evaluate(
+          evaluate_options, &cost, &residuals, nullptr, &crs_jacobian)) {
+    *error = "Evaluation of the residual blocks to marginalize failed.";
+    markov_blanket->clear();
+    return false;
+  }
+
+  Matrix jacobian = Matrix::Zero(crs_jacobian.num_rows, crs_jacobian.num_cols);
+  for (int row = 0; row < crs_jacobian.num_rows; ++row) {
+    for (int idx = crs_jacobian.rows[row]; idx < crs_jacobian.rows[row + 1];
+         ++idx) {
+      jacobian(row, crs_jacobian.cols[idx]) = crs_jacobian.values[idx];
+    }
+  }
+
+  int num_eliminated_cols = 0;
+  for (double* parameter_block : eliminated) {
+    num_eliminated_cols += problem->ParameterBlockTangentSize(parameter_block);
+  }
+  const int num_cols = jacobian.cols();
+  const int num_kept_cols = num_cols - num_eliminated_cols;
+
+  // Normal equations of the linearized residual blocks,
+  //
+  //  [H_ee H_ek] [dy_e] = [g_e]
+  //  [H_ke H_kk] [dy_k]   [g_k]
+  //
+  // and the Schur complement of H_ee,
+  //
+  //  S = H_kk - H_ke H_ee^{-1} H_ek,  s = g_k - H_ke H_ee^{-1} g_e.
+  Matrix H = Matrix::Zero(num_cols, num_cols);
+  H.selfadjointView<Eigen::Lower>().rankUpdate(jacobian.transpose());
+  H.triangularView<Eigen::StrictlyUpper>() = H.transpose();
+  const Vector g =
+      jacobian.transpose() * ConstVectorRef(residuals.data(), residuals.size());
+
+  Matrix S = H.bottomRightCorner(num_kept_cols, num_kept_cols);
+  Vector s = g.tail(num_kept_cols);
+  if (num_eliminated_cols > 0) {
+    internal::LinearSolver::Options linear_solver_options;
+    linear_solver_options.dense_linear_algebra_library_type = EIGEN;
+    std::unique_ptr<internal::DenseCholesky> cholesky =
+        internal::DenseCholesky::Create(linear_solver_options);
+
+    Matrix H_ee = H.topLeftCorner(num_eliminated_cols, num_eliminated_cols);
+    std::string message;
+    if (cholesky->Factorize(num_eliminated_cols, H_ee.data(), &message) !=
+        internal::LinearSolverTerminationType::SUCCESS) {
+      *error =
+          "The parameter blocks to marginalize are not fully constrained by "
+          "the residual blocks that depend on them. " +
+          message;
+      markov_blanket->clear();
+      return false;
+    }
+
+    ColMajorMatrix rhs(num_eliminated_cols, num_kept_cols + 1);
+    rhs.leftCols(num_kept_cols) =
+        H.topRightCorner(num_eliminated_cols, num_kept_cols);
+    rhs.col(num_kept_cols) = g.head(num_eliminated_cols);
+    ColMajorMatrix solution(num_eliminated_cols, num_kept_cols + 1);
+    for (int i = 0; i < rhs.cols(); ++i) {
+      if (cholesky->Solve(
+              rhs.col(i).data(), solution.col(i).data(), &message) !=
+          internal::LinearSolverTerminationType::SUCCESS) {
+        *error = "Elimination of the parameter blocks failed. " + message;
+        markov_blanket->clear();
+        return false;
+      }
+    }
+
+    const auto H_ke = H.bottomLeftCorner(num_kept_cols, num_eliminated_cols);
+    S.noalias() -= H_ke * solution.leftCols(num_kept_cols);
+    s.noalias() -= H_ke * solution.col(num_kept_cols);
+  }
+
+  // Factor S = J^T J and s = J^T r0 using the eigendecomposition
+  // S = U D U^T, i.e., J = D^{1/2} U^T and r0 = D^{-1/2} U^T s, dropping the
+  // directions about which S carries no information.
+  Eigen::SelfAdjointEigenSolver<Matrix> eigen_solver(S);
+  if (eigen_solver.info() != Eigen::Success) {
+    *error = "Eigendecomposition of the marginal information matrix failed.";
+    markov_blanket->clear();
+    return false;
+  }
+  const Vector& eigenvalues = eigen_solver.eigenvalues();
+  const double max_eigenvalue = eigenvalues(num_kept_cols - 1);
+  if (max_eigenvalue <= 0.0) {
+    *error =
+        "The marginalized residual blocks carry no information about the "
+        "parameter blocks they depend on.";
+    markov_blanket->clear();
+    return false;
+  }
+  const double min_eigenvalue = options.min_eigenvalue_ratio * max_eigenvalue;
+  int rank = 0;
+  while (rank < num_kept_cols &&
+         eigenvalues(num_kept_cols - 1 - rank) > min_eigenvalue) {
+    ++rank;
+  }
+
+  const Vector sqrt_eigenvalues = eigenvalues.tail(rank).cwiseSqrt();
+  const Matrix U_t = eigen_solver.eigenvectors().rightCols(rank).transpose();
+  Matrix prior_jacobian = sqrt_eigenvalues.asDiagonal() * U_t;
+  Vector prior_residuals =
+      sqrt_eigenvalues.cwiseInverse().asDiagonal() * (U_t * s);
+
+  std::vector<Vector> linearization_points;
+  std::vector<const Manifold*> manifolds;
+  linearization_points.reserve(markov_blanket->size());
+  manifolds.reserve(markov_blanket->size());
+  for (double* parameter_block : *markov_blanket) {
+    linearization_points.emplace_back(ConstVectorRef(
+        parameter_block, problem->ParameterBlockSize(parameter_block)));
+    manifolds.push_back(problem->GetManifold(parameter_block));
+  }
+
+  *prior = std::make_unique<MarginalizationPrior>(
+      std::move(linearization_points),
+      std::move(manifolds),
+      std::move(prior_jacobian),
+      std::move(prior_residuals));
+  return true;
+}
+
+bool MarginalizeOutParameterBlocks(
+    const MarginalizationOptions& options,
+    const std::vector<double*>& parameter_blocks_to_marginalize,
+    Problem* problem,
+    ResidualBlockId* prior_residual_block_id,
+    std::unique_ptr<MarginalizationPrior>* owned_prior,
+    std::string* error) {
+  const bool problem_owns_prior =
+      problem->options().cost_function_ownership == TAKE_OWNERSHIP;
+  if (!problem_owns_prior && owned_prior == nullptr) {
+    *error =
+        "The problem does not take ownership of its cost functions, so "
+        "owned_prior must not be nullptr.";
+    return false;
+  }
+  if (owned_prior != nullptr) {
+    owned_prior->reset();
+  }
+
+  std::vector<double*> markov_blanket;
+  std::unique_ptr<MarginalizationPrior> prior;
+  if (!ComputeMarginalizationPrior(options,
+                                   parameter_blocks_to_marginalize,
+                                   problem,
+                                   &markov_blanket,
+                                   &prior,
+                                   error)) {
+    return false;
+  }
+
+  // Removing a parameter block also removes the residual blocks that depend
+  // on it.
+  std::unordered_set<const double*> removed;
+  for (double* parameter_block : parameter_blocks_to_marginalize) {
+    if (removed.insert(parameter_block).second) {
+      problem->RemoveParameterBlock(parameter_block);
+    }
+  }
+
+  ResidualBlockId residual_block_id = nullptr;
+  if (prior != nullptr) {
+    residual_block_id =
+        problem->AddResidualBlock(prior.get(), nullptr, markov_blanket);
+    if (problem_owns_prior) {
+      prior.release();
+    } else {
+      *owned_prior = std::move(prior);
+    }
+  }
+  if (prior_residual_block_id != nullptr) {
+    *prior_residual_block_id = residual_block_id;
+  }
+  return true;
+}
+
+}  // namespace ceres
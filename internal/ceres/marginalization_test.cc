@@ -0,0 +1,359 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/marginalization.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ceres/internal/eigen.h"
+#include "ceres/manifold.h"
+#include "ceres/normal_prior.h"
+#include "ceres/problem.h"
+#include "ceres/sized_cost_function.h"
+#include "ceres/solver.h"
+#include "gtest/gtest.h"
+
+namespace ceres {
+namespace internal {
+
+namespace {
+
+constexpr int kNumPoses = 4;
+constexpr int kPoseSize = 3;
+
+// r = A1 * x1 + A2 * x2 - b
+class LinearBinaryCostFunction final
+    : public SizedCostFunction<kPoseSize, kPoseSize, kPoseSize> {
+ public:
+  LinearBinaryCostFunction(Matrix A1, Matrix A2, Vector b)
+      : A1_(std::move(A1)), A2_(std::move(A2)), b_(std::move(b)) {}
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const final {
+    VectorRef(residuals, kPoseSize) =
+        A1_ * ConstVectorRef(parameters[0], kPoseSize) +
+        A2_ * ConstVectorRef(parameters[1], kPoseSize) - b_;
+    if (jacobians != nullptr) {
+      if (jacobians[0] != nullptr) {
+        MatrixRef(jacobians[0], kPoseSize, kPoseSize) = A1_;
+      }
+      if (jacobians[1] != nullptr) {
+        MatrixRef(jacobians[1], kPoseSize, kPoseSize) = A2_;
+      }
+    }
+    return true;
+  }
+
+ private:
+  Matrix A1_;
+  Matrix A2_;
+  Vector b_;
+};
+
+}  // namespace
+
+// A linear chain of poses, with a prior on the first one, an absolute
+// measurement of the third one and relative measurements between consecutive
+// poses. Since the problem is linear, marginalizing poses out of it does not
+// change the optimal value of the remaining ones.
+class MarginalizationTest : public ::testing::Test {
+ protected:
+  void SetUp() final {
+    for (int i = 0; i < kNumPoses; ++i) {
+      unary_A_.push_back(Matrix::Random(kPoseSize, kPoseSize) +
+                         2.0 * Matrix::Identity(kPoseSize, kPoseSize));
+      unary_b_.push_back(Vector::Random(kPoseSize));
+      binary_A1_.push_back(Matrix::Random(kPoseSize, kPoseSize) -
+                           2.0 * Matrix::Identity(kPoseSize, kPoseSize));
+      binary_A2_.push_back(Matrix::Random(kPoseSize, kPoseSize) +
+                           2.0 * Matrix::Identity(kPoseSize, kPoseSize));
+      binary_b_.push_back(Vector::Random(kPoseSize));
+    }
+  }
+
+  void BuildProblem(double* poses, Problem* problem) {
+    for (int i = 0; i < kNumPoses; ++i) {
+      problem->AddParameterBlock(poses + kPoseSize * i, kPoseSize);
+    }
+    problem->AddResidualBlock(
+        new NormalPrior(unary_A_[0], unary_b_[0]), nullptr, poses);
+    problem->AddResidualBlock(new NormalPrior(unary_A_[2], unary_b_[2]),
+                              nullptr,
+                              poses + 2 * kPoseSize);
+    for (int i = 0; i + 1 < kNumPoses; ++i) {
+      problem->AddResidualBlock(
+          new LinearBinaryCostFunction(
+              binary_A1_[i], binary_A2_[i], binary_b_[i]),
+          nullptr,
+          poses + kPoseSize * i,
+          poses + kPoseSize * (i + 1));
+    }
+  }
+
+  static void SolveProblem(Problem* problem) {
+    Solver::Options options;
+    options.linear_solver_type = DENSE_QR;
+    options.max_num_iterations = 100;
+    options.function_tolerance = 1e-16;
+    options.gradient_tolerance = 1e-16;
+    options.parameter_tolerance = 1e-16;
+    Solver::Summary summary;
+    Solve(options, problem, &summary);
+    EXPECT_TRUE(summary.IsSolutionUsable()) << summary.FullReport();
+  }
+
+  std::vector<Matrix> unary_A_;
+  std::vector<Vector> unary_b_;
+  std::vector<Matrix> binary_A1_;
+  std::vector<Matrix> binary_A2_;
+  std::vector<Vector> binary_b_;
+};
+
+TEST_F(MarginalizationTest, SlidingWindowMatchesBatchSolution) {
+  Vector batch_poses = Vector::Zero(kNumPoses * kPoseSize);
+  Problem batch_problem;
+  BuildProblem(batch_poses.data(), &batch_problem);
+  SolveProblem(&batch_problem);
+
+  Vector window_poses = Vector::Ones(kNumPoses * kPoseSize);
+  Problem window_problem;
+  BuildProblem(window_poses.data(), &window_problem);
+
+  MarginalizationOptions options;
+  std::string error;
+  for (int i = 0; i < 2; ++i) {
+    double* pose = window_poses.data() + kPoseSize * i;
+    std::vector<double*> markov_blanket;
+    std::unique_ptr<MarginalizationPrior> prior;
+    ASSERT_TRUE(ComputeMarginalizationPrior(
+        options, {pose}, &window_problem, &markov_blanket, &prior, &error))
+        << error;
+    ASSERT_EQ(markov_blanket.size(), 1);
+    EXPECT_EQ(markov_blanket[0], pose + kPoseSize);
+    ASSERT_NE(prior, nullptr);
+    EXPECT_EQ(prior->num_residuals(), kPoseSize);
+
+    ResidualBlockId prior_id = nullptr;
+    ASSERT_TRUE(MarginalizeOutParameterBlocks(
+        options, {pose}, &window_problem, &prior_id, nullptr, &error))
+        << error;
+    EXPECT_NE(prior_id, nullptr);
+    EXPECT_FALSE(window_problem.HasParameterBlock(pose));
+  }
+
+  // The prior on pose 2, the marginalization prior on it and the relative
+  // measurement between poses 2 and 3.
+  EXPECT_EQ(window_problem.NumParameterBlocks(), 2);
+  EXPECT_EQ(window_problem.NumResidualBlocks(), 3);
+
+  SolveProblem(&window_problem);
+  const int num_kept = 2 * kPoseSize;
+  EXPECT_LT((window_poses.tail(num_kept) - batch_poses.tail(num_kept))
+                .lpNorm<Eigen::Infinity>(),
+            1e-8);
+}
+
+TEST_F(MarginalizationTest, MarkovBlanketWithManifold) {
+  std::vector<int> constant_coordinates = {1};
+  Vector batch_poses = Vector::Zero(kNumPoses * kPoseSize);
+  Problem batch_problem;
+  BuildProblem(batch_poses.data(), &batch_problem);
+  batch_problem.SetManifold(
+      batch_poses.data() + kPoseSize,
+      new SubsetManifold(kPoseSize, constant_coordinates));
+  SolveProblem(&batch_problem);
+
+  Vector window_poses = Vector::Zero(kNumPoses * kPoseSize);
+  Problem window_problem;
+  BuildProblem(window_poses.data(), &window_problem);
+  window_problem.SetManifold(
+      window_poses.data() + kPoseSize,
+      new SubsetManifold(kPoseSize, constant_coordinates));
+
+  MarginalizationOptions options;
+  std::string error;
+  ResidualBlockId prior_id = nullptr;
+  ASSERT_TRUE(MarginalizeOutParameterBlocks(options,
+                                            {window_poses.data()},
+                                            &window_problem,
+                                            &prior_id,
+                                            nullptr,
+                                            &error))
+      << error;
+  ASSERT_NE(prior_id, nullptr);
+  const auto* prior = static_cast<const MarginalizationPrior*>(
+      window_problem.GetCostFunctionForResidualBlock(prior_id));
+  EXPECT_EQ(prior->jacobian().cols(), kPoseSize - 1);
+  EXPECT_EQ(prior->num_residuals(), kPoseSize - 1);
+
+  SolveProblem(&window_problem);
+  const int num_kept = (kNumPoses - 1) * kPoseSize;
+  EXPECT_LT((window_poses.tail(num_kept) - batch_poses.tail(num_kept))
+                .lpNorm<Eigen::Infinity>(),
+            1e-8);
+}
+
+TEST(MarginalizationPrior, EvaluateWithManifold) {
+  QuaternionManifold manifold;
+  Vector x0(4);
+  x0 << 0.5, 0.5, -0.5, 0.5;
+  const Matrix J = Matrix::Random(3, 3);
+  const Vector r0 = Vector::Random(3);
+  MarginalizationPrior prior({x0}, {&manifold}, J, r0);
+  ASSERT_EQ(prior.parameter_block_sizes().size(), 1);
+  EXPECT_EQ(prior.parameter_block_sizes()[0], 4);
+  EXPECT_EQ(prior.num_residuals(), 3);
+
+  Vector delta(3);
+  delta << 0.1, -0.2, 0.05;
+  Vector x(4);
+  ASSERT_TRUE(manifold.Plus(x0.data(), delta.data(), x.data()));
+
+  Vector residuals(3);
+  double jacobian[3 * 4];
+  const double* parameters[] = {x.data()};
+  double* jacobians[] = {jacobian};
+  ASSERT_TRUE(prior.Evaluate(parameters, residuals.data(), jacobians));
+  EXPECT_LT((residuals - (r0 + J * delta)).norm(), 1e-12);
+
+  // Mapped to the tangent space at x, the Jacobian is J.
+  double plus_jacobian[4 * 3];
+  ASSERT_TRUE(manifold.PlusJacobian(x.data(), plus_jacobian));
+  const Matrix tangent_jacobian =
+      MatrixRef(jacobian, 3, 4) * MatrixRef(plus_jacobian, 4, 3);
+  EXPECT_LT((tangent_jacobian - J).norm(), 1e-12);
+}
+
+TEST(Marginalization, IsolatedParameterBlock) {
+  double x[2] = {1.0, 2.0};
+  double y[2] = {3.0, 4.0};
+  Problem problem;
+  problem.AddResidualBlock(
+      new NormalPrior(Matrix::Identity(2, 2), Vector::Zero(2)), nullptr, x);
+  ResidualBlockId prior_id = problem.AddResidualBlock(
+      new NormalPrior(Matrix::Identity(2, 2), Vector::Zero(2)), nullptr, y);
+
+  std::string error;
+  ASSERT_TRUE(MarginalizeOutParameterBlocks(
+      MarginalizationOptions(), {x}, &problem, &prior_id, nullptr, &error))
+      << error;
+  EXPECT_EQ(prior_id, nullptr);
+  EXPECT_EQ(problem.NumParameterBlocks(), 1);
+  EXPECT_EQ(problem.NumResidualBlocks(), 1);
+}
+
+TEST(Marginalization, ConstantParameterBlocksAreNotInTheMarkovBlanket) {
+  double x[3] = {1.0, 2.0, 3.0};
+  double y[3] = {4.0, 5.0, 6.0};
+  double z[3] = {7.0, 8.0, 9.0};
+  const Matrix I = Matrix::Identity(3, 3);
+  Problem problem;
+  problem.AddResidualBlock(
+      new LinearBinaryCostFunction(I, -I, Vector::Zero(3)), nullptr, x, y);
+  problem.AddResidualBlock(
+      new LinearBinaryCostFunction(I, -I, Vector::Zero(3)), nullptr, x, z);
+  problem.SetParameterBlockConstant(y);
+
+  std::vector<double*> markov_blanket;
+  std::unique_ptr<MarginalizationPrior> prior;
+  std::string error;
+  ASSERT_TRUE(ComputeMarginalizationPrior(MarginalizationOptions(),
+                                          {x},
+                                          &problem,
+                                          &markov_blanket,
+                                          &prior,
+                                          &error))
+      << error;
+  ASSERT_EQ(markov_blanket.size(), 1);
+  EXPECT_EQ(markov_blanket[0], z);
+  ASSERT_NE(prior, nullptr);
+
+  // x is pinned to y by the first residual, which turns into a prior pulling
+  // z towards y with half of the original stiffness.
+  const Matrix information = prior->jacobian().transpose() * prior->jacobian();
+  EXPECT_LT((information - 0.5 * I).norm(), 1e-12);
+  const Vector gradient = prior->jacobian().transpose() * prior->residuals();
+  EXPECT_LT((gradient - 0.5 * (ConstVectorRef(z, 3) - ConstVectorRef(y, 3)))
+                .norm(),
+            1e-12);
+}
+
+TEST(Marginalization, CallerOwnsPriorIfProblemDoesNotTakeOwnership) {
+  double x[3] = {1.0, 2.0, 3.0};
+  double y[3] = {4.0, 5.0, 6.0};
+  double z[3] = {7.0, 8.0, 9.0};
+  const Matrix I = Matrix::Identity(3, 3);
+  LinearBinaryCostFunction cost_function(I, -I, Vector::Zero(3));
+  // Declared before the problem, so that the prior outlives it.
+  std::unique_ptr<MarginalizationPrior> prior;
+  Problem::Options problem_options;
+  problem_options.cost_function_ownership = DO_NOT_TAKE_OWNERSHIP;
+  Problem problem(problem_options);
+  problem.AddResidualBlock(&cost_function, nullptr, x, y);
+  problem.AddResidualBlock(&cost_function, nullptr, x, z);
+
+  // Without a place to return the prior to, the problem is left untouched.
+  std::string error;
+  EXPECT_FALSE(MarginalizeOutParameterBlocks(
+      MarginalizationOptions(), {x}, &problem, nullptr, nullptr, &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_TRUE(problem.HasParameterBlock(x));
+
+  ResidualBlockId prior_id = nullptr;
+  ASSERT_TRUE(MarginalizeOutParameterBlocks(
+      MarginalizationOptions(), {x}, &problem, &prior_id, &prior, &error))
+      << error;
+  ASSERT_NE(prior, nullptr);
+  ASSERT_NE(prior_id, nullptr);
+  EXPECT_EQ(problem.GetCostFunctionForResidualBlock(prior_id), prior.get());
+  EXPECT_FALSE(problem.HasParameterBlock(x));
+}
+
+TEST(Marginalization, UnderconstrainedParameterBlockFails) {
+  double x[3] = {1.0, 2.0, 3.0};
+  double y[3] = {4.0, 5.0, 6.0};
+  Matrix A = Matrix::Identity(3, 3);
+  A(2, 2) = 0.0;
+  Problem problem;
+  problem.AddResidualBlock(
+      new LinearBinaryCostFunction(A, -A, Vector::Zero(3)), nullptr, x, y);
+
+  std::string error;
+  EXPECT_FALSE(MarginalizeOutParameterBlocks(
+      MarginalizationOptions(), {x}, &problem, nullptr, nullptr, &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_TRUE(problem.HasParameterBlock(x));
+  EXPECT_EQ(problem.NumResidualBlocks(), 1);
+}
+
+}  // namespace internal
+}  // namespace ceres
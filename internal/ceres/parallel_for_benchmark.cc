@@ -50,26 +50,35 @@ static void SchedulerBenchmark(benchmark::State& state) {
   CHECK_EQ(x.squaredNorm(), 0.);
 }
 BENCHMARK(SchedulerBenchmark)
-    ->Args({128, 1})
-    ->Args({128, 2})
-    ->Args({128, 4})
-    ->Args({128, 8})
-    ->Args({128, 16})
-    ->Args({256, 1})
-    ->Args({256, 2})
-    ->Args({256, 4})
-    ->Args({256, 8})
-    ->Args({256, 16})
-    ->Args({1024, 1})
-    ->Args({1024, 2})
-    ->Args({1024, 4})
-    ->Args({1024, 8})
-    ->Args({1024, 16})
-    ->Args({4096, 1})
-    ->Args({4096, 2})
-    ->Args({4096, 4})
-    ->Args({4096, 8})
-    ->Args({4096, 16});
+    ->ArgsProduct({{128, 256, 1024, 4096}, {1, 2, 4, 8, 16, 32, 64, 128}});
+
+// Parallel for with a moderate amount of work per iteration, where the blocks
+// of iterations executed by different threads take different amounts of time.
+// This benchmarks how well the scheduler scales with the number of threads.
+static void SchedulerScalingBenchmark(benchmark::State& state) {
+  const int num_iterations = static_cast<int>(state.range(0));
+  const int num_threads = static_cast<int>(state.range(1));
+  ContextImpl context;
+  context.EnsureMinimumThreads(num_threads);
+
+  Vector x = Vector::Random(num_iterations);
+  for (auto _ : state) {
+    ParallelFor(
+        &context, 0, num_iterations, num_threads, [&x](int id) {
+          // Iteration id does an amount of work proportional to id % 64.
+          double value = x[id];
+          for (int i = 0; i < 16 * (id % 64); ++i) {
+            value = 0.5 * value + 1.0;
+          }
+          x[id] = value;
+        });
+  }
+  benchmark::DoNotOptimize(x.data());
+  state.SetItemsProcessed(state.iterations() * num_iterations);
+}
+BENCHMARK(SchedulerScalingBenchmark)
+    ->ArgsProduct({{1 << 14, 1 << 18}, {1, 2, 4, 8, 16, 32, 64, 128}})
+    ->UseRealTime();
 
 }  // namespace ceres::internal
 
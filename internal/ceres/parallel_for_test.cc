@@ -398,6 +398,62 @@ TEST(GuidedParallelFor, PartitionRangeForParallelFor) {
   }
 }
 
+TEST(GuidedParallelFor, PartitionRangeByCost) {
+  // A few expensive iterations among many cheap ones.
+  std::vector<double> costs(1000, 1e-6);
+  costs[10] = 1e-3;
+  costs[500] = 1e-3;
+  costs[501] = 1e-3;
+  costs[999] = 1e-3;
+
+  const std::vector<int> partition = PartitionRangeByCost(costs, 4);
+  ASSERT_GT(partition.size(), 1);
+  EXPECT_LE(partition.size(), 5);
+  EXPECT_EQ(partition.front(), 0);
+  EXPECT_EQ(partition.back(), costs.size());
+
+  // Each of the expensive iterations ends up in a partition of its own.
+  const int num_partitions = partition.size() - 1;
+  for (int j = 0; j < num_partitions; ++j) {
+    EXPECT_LT(partition[j], partition[j + 1]);
+    int num_expensive = 0;
+    for (int k = partition[j]; k < partition[j + 1]; ++k) {
+      num_expensive += costs[k] > 1e-4;
+    }
+    EXPECT_EQ(num_expensive, 1);
+  }
+
+  // Zero costs degenerate into an approximately even split.
+  const std::vector<int> even_partition =
+      PartitionRangeByCost(std::vector<double>(100, 0.0), 4);
+  EXPECT_THAT(even_partition, ElementsAreArray({0, 25, 50, 75, 100}));
+}
+
+TEST(GuidedParallelFor, PartitionRangeByCostWithManyIndices) {
+  // More indices than the quantization resolution used to have, with the
+  // first quarter of the indices being four times as expensive as the rest.
+  constexpr int kNumIndices = (1 << 20) + (1 << 18);
+  constexpr int kNumPartitions = 4;
+  std::vector<double> costs(kNumIndices, 1e-6);
+  std::fill(costs.begin(), costs.begin() + kNumIndices / 4, 4e-6);
+
+  const std::vector<int> partition =
+      PartitionRangeByCost(costs, kNumPartitions);
+  ASSERT_EQ(partition.size(), kNumPartitions + 1);
+  EXPECT_EQ(partition.front(), 0);
+  EXPECT_EQ(partition.back(), kNumIndices);
+
+  // The partitions are balanced by cost and not by the number of indices.
+  const double total_cost = std::accumulate(costs.begin(), costs.end(), 0.0);
+  for (int j = 0; j < kNumPartitions; ++j) {
+    const double partition_cost =
+        std::accumulate(costs.begin() + partition[j],
+                        costs.begin() + partition[j + 1],
+                        0.0);
+    EXPECT_NEAR(partition_cost, total_cost / kNumPartitions, 1e-3 * total_cost);
+  }
+}
+
 // Recursively try to partition range into segements of total cost
 // less than max_cost
 bool BruteForcePartition(
@@ -30,10 +30,11 @@
 
 #include "ceres/parameter_block_ordering.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <set>
-#include <unordered_set>
 #include <vector>
 
 #include "absl/log/check.h"
@@ -41,84 +42,117 @@
 #include "ceres/graph.h"
 #include "ceres/graph_algorithms.h"
 #include "ceres/map_util.h"
+#include "ceres/parallel_for.h"
 #include "ceres/parameter_block.h"
 #include "ceres/program.h"
 #include "ceres/residual_block.h"
 
 namespace ceres::internal {
 
+namespace {
+
+// Converts an ordering of the vertices of the Hessian graph to an
+// ordering of the parameter blocks, followed by the constant parameter
+// blocks.
+void VertexOrderingToParameterBlockOrdering(
+    const Program& program,
+    const std::vector<ParameterBlock*>& vertices,
+    const std::vector<int>& vertex_ordering,
+    std::vector<ParameterBlock*>* ordering) {
+  ordering->clear();
+  ordering->reserve(program.NumParameterBlocks());
+  for (const int vertex : vertex_ordering) {
+    ordering->push_back(vertices[vertex]);
+  }
+
+  // Add the excluded blocks to back of the ordering vector.
+  for (auto* parameter_block : program.parameter_blocks()) {
+    if (parameter_block->IsConstant()) {
+      ordering->push_back(parameter_block);
+    }
+  }
+}
+
+}  // namespace
+
 int ComputeStableSchurOrdering(const Program& program,
+                               ContextImpl* context,
+                               int num_threads,
                                std::vector<ParameterBlock*>* ordering) {
   CHECK(ordering != nullptr);
   ordering->clear();
   EventLogger event_logger("ComputeStableSchurOrdering");
-  auto graph = CreateHessianGraph(program);
+  std::vector<ParameterBlock*> vertices;
+  auto graph =
+      CreateCompressedHessianGraph(program, context, num_threads, &vertices);
   event_logger.AddEvent("CreateHessianGraph");
 
-  const std::vector<ParameterBlock*>& parameter_blocks =
-      program.parameter_blocks();
-  const std::unordered_set<ParameterBlock*>& vertices = graph->vertices();
-  for (auto* parameter_block : parameter_blocks) {
-    if (vertices.count(parameter_block) > 0) {
-      ordering->push_back(parameter_block);
-    }
-  }
-  event_logger.AddEvent("Preordering");
-
-  int independent_set_size = StableIndependentSetOrdering(*graph, ordering);
+  // The vertices are numbered in the order in which the parameter blocks
+  // occur in the program.
+  std::vector<int> vertex_ordering(vertices.size());
+  std::iota(vertex_ordering.begin(), vertex_ordering.end(), 0);
+  const int independent_set_size = StableIndependentSetOrdering(
+      *graph, context, num_threads, &vertex_ordering);
   event_logger.AddEvent("StableIndependentSet");
 
-  // Add the excluded blocks to back of the ordering vector.
-  for (auto* parameter_block : parameter_blocks) {
-    if (parameter_block->IsConstant()) {
-      ordering->push_back(parameter_block);
-    }
-  }
+  VertexOrderingToParameterBlockOrdering(
+      program, vertices, vertex_ordering, ordering);
   event_logger.AddEvent("ConstantParameterBlocks");
 
   return independent_set_size;
 }
 
 int ComputeSchurOrdering(const Program& program,
+                         ContextImpl* context,
+                         int num_threads,
                          std::vector<ParameterBlock*>* ordering) {
   CHECK(ordering != nullptr);
   ordering->clear();
 
-  auto graph = CreateHessianGraph(program);
-  int independent_set_size = IndependentSetOrdering(*graph, ordering);
-  const std::vector<ParameterBlock*>& parameter_blocks =
-      program.parameter_blocks();
-
-  // Add the excluded blocks to back of the ordering vector.
-  for (auto* parameter_block : parameter_blocks) {
-    if (parameter_block->IsConstant()) {
-      ordering->push_back(parameter_block);
-    }
-  }
-
+  std::vector<ParameterBlock*> vertices;
+  auto graph =
+      CreateCompressedHessianGraph(program, context, num_threads, &vertices);
+  std::vector<int> vertex_ordering;
+  const int independent_set_size =
+      IndependentSetOrdering(*graph, context, num_threads, &vertex_ordering);
+  VertexOrderingToParameterBlockOrdering(
+      program, vertices, vertex_ordering, ordering);
   return independent_set_size;
 }
 
 void ComputeRecursiveIndependentSetOrdering(const Program& program,
+                                            ContextImpl* context,
+                                            int num_threads,
                                             ParameterBlockOrdering* ordering) {
   CHECK(ordering != nullptr);
   ordering->Clear();
-  const std::vector<ParameterBlock*> parameter_blocks =
-      program.parameter_blocks();
-  auto graph = CreateHessianGraph(program);
+  std::vector<ParameterBlock*> vertices;
+  auto graph =
+      CreateCompressedHessianGraph(program, context, num_threads, &vertices);
 
-  int num_covered = 0;
+  // Instead of removing the vertices of each independent set from the
+  // graph, the next independent set is computed on the subgraph induced
+  // by the remaining vertices.
+  std::vector<int> remaining_vertices(vertices.size());
+  std::iota(remaining_vertices.begin(), remaining_vertices.end(), 0);
+  std::vector<char> is_covered(vertices.size(), false);
   int round = 0;
-  while (num_covered < parameter_blocks.size()) {
-    std::vector<ParameterBlock*> independent_set_ordering;
-    const int independent_set_size =
-        IndependentSetOrdering(*graph, &independent_set_ordering);
+  while (!remaining_vertices.empty()) {
+    std::vector<int> independent_set_ordering = remaining_vertices;
+    const int independent_set_size = StableIndependentSetOrdering(
+        *graph, context, num_threads, &independent_set_ordering);
     for (int i = 0; i < independent_set_size; ++i) {
-      ParameterBlock* parameter_block = independent_set_ordering[i];
-      ordering->AddElementToGroup(parameter_block->mutable_user_state(), round);
-      graph->RemoveVertex(parameter_block);
+      const int vertex = independent_set_ordering[i];
+      ordering->AddElementToGroup(vertices[vertex]->mutable_user_state(),
+                                  round);
+      is_covered[vertex] = true;
     }
-    num_covered += independent_set_size;
+    remaining_vertices.erase(
+        std::remove_if(
+            remaining_vertices.begin(),
+            remaining_vertices.end(),
+            [&is_covered](int vertex) { return is_covered[vertex]; }),
+        remaining_vertices.end());
     ++round;
   }
 }
@@ -159,6 +193,67 @@ std::unique_ptr<Graph<ParameterBlock*>> CreateHessianGraph(
   return graph;
 }
 
+std::unique_ptr<CompressedGraph> CreateCompressedHessianGraph(
+    const Program& program,
+    ContextImpl* context,
+    int num_threads,
+    std::vector<ParameterBlock*>* vertices) {
+  CHECK(vertices != nullptr);
+  vertices->clear();
+  const std::vector<ParameterBlock*>& parameter_blocks =
+      program.parameter_blocks();
+  const int num_parameter_blocks = parameter_blocks.size();
+
+  // vertex_ids[i] is the vertex of parameter_blocks[i], or -1 if it is
+  // constant.
+  std::vector<int> vertex_ids(num_parameter_blocks, -1);
+  for (int i = 0; i < num_parameter_blocks; ++i) {
+    if (!parameter_blocks[i]->IsConstant()) {
+      vertex_ids[i] = vertices->size();
+      vertices->push_back(parameter_blocks[i]);
+    }
+  }
+
+  // The non-constant parameter blocks of each residual block form a
+  // clique in the graph.
+  const std::vector<ResidualBlock*>& residual_blocks =
+      program.residual_blocks();
+  const int num_residual_blocks = residual_blocks.size();
+  std::vector<int> clique_offsets(num_residual_blocks + 1, 0);
+  ParallelFor(context, 0, num_residual_blocks, num_threads, [&](int i) {
+    const ResidualBlock* residual_block = residual_blocks[i];
+    int clique_size = 0;
+    for (int j = 0; j < residual_block->NumParameterBlocks(); ++j) {
+      clique_size += !residual_block->parameter_blocks()[j]->IsConstant();
+    }
+    clique_offsets[i + 1] = clique_size;
+  });
+  std::partial_sum(
+      clique_offsets.begin(), clique_offsets.end(), clique_offsets.begin());
+
+  std::vector<int> clique_vertices(clique_offsets.back());
+  ParallelFor(context, 0, num_residual_blocks, num_threads, [&](int i) {
+    const ResidualBlock* residual_block = residual_blocks[i];
+    int* clique = clique_vertices.data() + clique_offsets[i];
+    for (int j = 0; j < residual_block->NumParameterBlocks(); ++j) {
+      const ParameterBlock* parameter_block =
+          residual_block->parameter_blocks()[j];
+      if (parameter_block->IsConstant()) {
+        continue;
+      }
+      const int index = parameter_block->index();
+      CHECK(index >= 0 && index < num_parameter_blocks &&
+            parameter_blocks[index] == parameter_block)
+          << "Did you forget to call Program::SetParameterOffsetsAndIndex()? "
+          << "This is a Ceres bug; please contact the developers!";
+      *clique++ = vertex_ids[index];
+    }
+  });
+
+  return CompressedGraph::FromCliques(
+      vertices->size(), clique_offsets, clique_vertices, context, num_threads);
+}
+
 void OrderingToGroupSizes(const ParameterBlockOrdering* ordering,
                           std::vector<int>* group_sizes) {
   CHECK(group_sizes != nullptr);
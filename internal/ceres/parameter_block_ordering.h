@@ -34,6 +34,8 @@
 #include <memory>
 #include <vector>
 
+#include "ceres/compressed_graph.h"
+#include "ceres/context_impl.h"
 #include "ceres/graph.h"
 #include "ceres/internal/disable_warnings.h"
 #include "ceres/internal/export.h"
@@ -58,21 +60,34 @@ class ParameterBlock;
 // ordering = [independent set,
 //             complement of the independent set,
 //             fixed blocks]
+//
+// The Hessian graph is built and the ordering computed using
+// num_threads threads. The indices of the parameter blocks of the
+// program must be up to date, see Program::SetParameterOffsetsAndIndex.
 CERES_NO_EXPORT int ComputeSchurOrdering(
-    const Program& program, std::vector<ParameterBlock*>* ordering);
+    const Program& program,
+    ContextImpl* context,
+    int num_threads,
+    std::vector<ParameterBlock*>* ordering);
 
 // Same as above, except that ties while computing the independent set
 // ordering are resolved in favour of the order in which the parameter
 // blocks occur in the program.
 CERES_NO_EXPORT int ComputeStableSchurOrdering(
-    const Program& program, std::vector<ParameterBlock*>* ordering);
+    const Program& program,
+    ContextImpl* context,
+    int num_threads,
+    std::vector<ParameterBlock*>* ordering);
 
 // Use an approximate independent set ordering to decompose the
 // parameter blocks of a problem in a sequence of independent
 // sets. The ordering covers all the non-constant parameter blocks in
 // the program.
 CERES_NO_EXPORT void ComputeRecursiveIndependentSetOrdering(
-    const Program& program, ParameterBlockOrdering* ordering);
+    const Program& program,
+    ContextImpl* context,
+    int num_threads,
+    ParameterBlockOrdering* ordering);
 
 // Builds a graph on the parameter blocks of a Problem, whose
 // structure reflects the sparsity structure of the Hessian. Each
@@ -82,6 +97,16 @@ CERES_NO_EXPORT void ComputeRecursiveIndependentSetOrdering(
 CERES_NO_EXPORT std::unique_ptr<Graph<ParameterBlock*>> CreateHessianGraph(
     const Program& program);
 
+// Same as CreateHessianGraph, but returns a CompressedGraph built using
+// num_threads threads. Vertex i of the graph corresponds to
+// vertices[i], which are the non-constant parameter blocks of the
+// program in the order in which they occur in it.
+CERES_NO_EXPORT std::unique_ptr<CompressedGraph> CreateCompressedHessianGraph(
+    const Program& program,
+    ContextImpl* context,
+    int num_threads,
+    std::vector<ParameterBlock*>* vertices);
+
 // Iterate over each of the groups in order of their priority and fill
 // summary with their sizes.
 CERES_NO_EXPORT void OrderingToGroupSizes(
@@ -35,8 +35,10 @@
 #include <unordered_set>
 #include <vector>
 
+#include "ceres/context_impl.h"
 #include "ceres/cost_function.h"
 #include "ceres/graph.h"
+#include "ceres/parameter_block.h"
 #include "ceres/problem_impl.h"
 #include "ceres/program.h"
 #include "ceres/sized_cost_function.h"
@@ -170,8 +172,57 @@ TEST_F(SchurOrderingTest, OneFixed) {
 
   // The constant parameter block is at the end.
   std::vector<ParameterBlock*> ordering;
-  ComputeSchurOrdering(program, &ordering);
+  ContextImpl context;
+  ComputeSchurOrdering(program, &context, 1, &ordering);
   EXPECT_EQ(ordering.back(), parameter_blocks[0]);
 }
 
+TEST_F(SchurOrderingTest, CompressedHessianGraph) {
+  problem_.SetParameterBlockConstant(x_);
+
+  const Program& program = problem_.program();
+  const std::vector<ParameterBlock*>& parameter_blocks =
+      program.parameter_blocks();
+  auto expected = CreateHessianGraph(program);
+
+  ContextImpl context;
+  std::vector<ParameterBlock*> vertices;
+  auto graph = CreateCompressedHessianGraph(program, &context, 1, &vertices);
+  ASSERT_EQ(graph->num_vertices(), 3);
+  EXPECT_EQ(vertices,
+            std::vector<ParameterBlock*>(parameter_blocks.begin() + 1,
+                                         parameter_blocks.end()));
+  for (int i = 0; i < 3; ++i) {
+    const VertexSet& expected_neighbors = expected->Neighbors(vertices[i]);
+    EXPECT_EQ(graph->Degree(i), expected_neighbors.size());
+    for (const int neighbor : graph->Neighbors(i)) {
+      EXPECT_EQ(expected_neighbors.count(vertices[neighbor]), 1);
+    }
+  }
+}
+
+TEST_F(SchurOrderingTest, RecursiveIndependentSetOrdering) {
+  const Program& program = problem_.program();
+  const std::vector<ParameterBlock*>& parameter_blocks =
+      program.parameter_blocks();
+
+  ContextImpl context;
+  ParameterBlockOrdering ordering;
+  ComputeRecursiveIndependentSetOrdering(program, &context, 1, &ordering);
+  EXPECT_EQ(ordering.NumElements(), 4);
+
+  // Every group is an independent set in the Hessian graph.
+  auto graph = CreateHessianGraph(program);
+  for (const auto& [group, elements] : ordering.group_to_elements()) {
+    for (ParameterBlock* parameter_block : parameter_blocks) {
+      if (elements.count(parameter_block->mutable_user_state()) == 0) {
+        continue;
+      }
+      for (ParameterBlock* neighbor : graph->Neighbors(parameter_block)) {
+        EXPECT_EQ(elements.count(neighbor->mutable_user_state()), 0);
+      }
+    }
+  }
+}
+
 }  // namespace ceres::internal
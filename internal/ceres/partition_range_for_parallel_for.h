@@ -33,6 +33,7 @@
 #define CERES_INTERNAL_PARTITION_RANGE_FOR_PARALLEL_FOR_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <vector>
 
 namespace ceres::internal {
@@ -43,27 +44,29 @@ namespace ceres::internal {
 // of all indices (starting from zero) preceding start element. Cumulative costs
 // are returned by cumulative_cost_fun called with a reference to
 // cumulative_cost_data element with index from range[start; end), and should be
-// non-decreasing. Partition of the range is returned via partition argument
+// non-decreasing. Partition of the range is returned via partition argument.
+// Costs are accumulated in int64_t, so cumulative_cost_fun may return either
+// int or int64_t.
 template <typename CumulativeCostData, typename CumulativeCostFun>
 bool MaxPartitionCostIsFeasible(int start,
                                 int end,
                                 int max_num_partitions,
-                                int max_partition_cost,
-                                int cumulative_cost_offset,
+                                int64_t max_partition_cost,
+                                int64_t cumulative_cost_offset,
                                 const CumulativeCostData* cumulative_cost_data,
                                 CumulativeCostFun&& cumulative_cost_fun,
                                 std::vector<int>* partition) {
   partition->clear();
   partition->push_back(start);
   int partition_start = start;
-  int cost_offset = cumulative_cost_offset;
+  int64_t cost_offset = cumulative_cost_offset;
 
   while (partition_start < end) {
     // Already have max_num_partitions
     if (partition->size() > max_num_partitions) {
       return false;
     }
-    const int target = max_partition_cost + cost_offset;
+    const int64_t target = max_partition_cost + cost_offset;
     const int partition_end =
         std::partition_point(
             cumulative_cost_data + partition_start,
@@ -77,7 +80,7 @@ bool MaxPartitionCostIsFeasible(int start,
       return false;
     }
 
-    const int cost_last =
+    const int64_t cost_last =
         cumulative_cost_fun(cumulative_cost_data[partition_end - 1]);
     partition->push_back(partition_end);
     partition_start = partition_end;
@@ -102,18 +105,18 @@ std::vector<int> PartitionRangeForParallelFor(
   // and obtain corresponding partition using MaxPartitionCostIsFeasible
   // function. In order to find the lowest admissible value, a binary search
   // over all potentially optimal cost values is being performed
-  const int cumulative_cost_last =
+  const int64_t cumulative_cost_last =
       cumulative_cost_fun(cumulative_cost_data[end - 1]);
-  const int cumulative_cost_offset =
+  const int64_t cumulative_cost_offset =
       start ? cumulative_cost_fun(cumulative_cost_data[start - 1]) : 0;
-  const int total_cost = cumulative_cost_last - cumulative_cost_offset;
+  const int64_t total_cost = cumulative_cost_last - cumulative_cost_offset;
 
   // Minimal maximal partition cost is not smaller than the average
   // We will use non-inclusive lower bound
-  int partition_cost_lower_bound = total_cost / max_num_partitions - 1;
+  int64_t partition_cost_lower_bound = total_cost / max_num_partitions - 1;
   // Minimal maximal partition cost is not larger than the total cost
   // Upper bound is inclusive
-  int partition_cost_upper_bound = total_cost;
+  int64_t partition_cost_upper_bound = total_cost;
 
   std::vector<int> partition;
   // Range partition corresponding to the latest evaluated upper bound.
@@ -123,7 +126,7 @@ std::vector<int> PartitionRangeForParallelFor(
   // Binary search over partition cost, returning the lowest admissible cost
   while (partition_cost_upper_bound - partition_cost_lower_bound > 1) {
     partition.reserve(max_num_partitions + 1);
-    const int partition_cost =
+    const int64_t partition_cost =
         partition_cost_lower_bound +
         (partition_cost_upper_bound - partition_cost_lower_bound) / 2;
     bool admissible = MaxPartitionCostIsFeasible(
@@ -145,6 +148,51 @@ std::vector<int> PartitionRangeForParallelFor(
 
   return partition_upper_bound;
 }
+
+// Split integer interval [0, costs.size()) into at most max_num_partitions
+// contiguous intervals, minimizing maximal total cost of a single interval.
+// Unlike the function above, the costs of the individual indices are
+// non-negative real numbers, e.g., measured run times. They are quantized into
+// int64_t costs with a resolution of kCostResolutionPerIndex units per index on
+// average, so that the quantization error stays small relative to the cost of
+// an average index irrespective of the number of indices. If all the costs are
+// zero, the range is split evenly.
+inline std::vector<int> PartitionRangeByCost(const std::vector<double>& costs,
+                                             int max_num_partitions) {
+  constexpr double kCostResolutionPerIndex = 1 << 20;
+  const int num_indices = costs.size();
+  if (num_indices == 0) {
+    return {0, 0};
+  }
+
+  double total_cost = 0.0;
+  for (const double cost : costs) {
+    total_cost += std::max(cost, 0.0);
+  }
+
+  // The prefix sums are accumulated in double precision and quantized
+  // afterwards, so that the rounding errors of the individual costs do not
+  // accumulate.
+  std::vector<int64_t> cumulative_costs(num_indices);
+  if (total_cost > 0.0) {
+    const double scale = kCostResolutionPerIndex * num_indices / total_cost;
+    double cumulative_cost = 0.0;
+    for (int i = 0; i < num_indices; ++i) {
+      cumulative_cost += std::max(costs[i], 0.0);
+      cumulative_costs[i] = static_cast<int64_t>(cumulative_cost * scale);
+    }
+  } else {
+    for (int i = 0; i < num_indices; ++i) {
+      cumulative_costs[i] = i + 1;
+    }
+  }
+
+  return PartitionRangeForParallelFor(0,
+                                      num_indices,
+                                      max_num_partitions,
+                                      cumulative_costs.data(),
+                                      [](const int64_t v) { return v; });
+}
 }  // namespace ceres::internal
 
 #endif
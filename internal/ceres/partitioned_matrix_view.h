@@ -52,6 +52,7 @@
 namespace ceres::internal {
 
 class ContextImpl;
+class FloatBlockSparseMatrix;
 
 // Given generalized bi-partite matrix A = [E F], with the same block
 // structure as required by the Schur complement based solver, found
@@ -89,6 +90,29 @@ class CERES_NO_EXPORT PartitionedMatrixViewBase {
   virtual void RightMultiplyAndAccumulateF(const double* x,
                                            double* y) const = 0;
 
+  // y += F'(I - E B E')F x, where B is a block diagonal matrix with
+  // the same block structure as the one returned by
+  // CreateBlockDiagonalEtE. For B = (E'E)^{-1}, this is the product of
+  // x with the Schur complement F'F - F'E(E'E)^{-1}E'F.
+  //
+  // The product is computed one chunk of row blocks sharing an e_block
+  // at a time, so that each row block is read from memory once instead
+  // of the four times needed by computing it using the methods above.
+  virtual void SchurComplementRightMultiplyAndAccumulate(
+      const BlockSparseMatrix& block_diagonal_ete_inverse,
+      const double* x,
+      double* y) const = 0;
+
+  // Same as above, except that the values of the matrix and of B are
+  // read from single precision copies of them, with the products
+  // accumulated in double precision. matrix must be a copy of the
+  // matrix this view was created from.
+  virtual void SchurComplementRightMultiplyAndAccumulate(
+      const FloatBlockSparseMatrix& matrix,
+      const FloatBlockSparseMatrix& block_diagonal_ete_inverse,
+      const double* x,
+      double* y) const = 0;
+
   // Create and return the block diagonal of the matrix E'E.
   virtual std::unique_ptr<BlockSparseMatrix> CreateBlockDiagonalEtE() const = 0;
 
@@ -162,6 +186,17 @@ class CERES_NO_EXPORT PartitionedMatrixView final
   virtual void RightMultiplyAndAccumulateF(const double* x,
                                            double* y) const final;
 
+  // y += F'(I - E B E')F x
+  void SchurComplementRightMultiplyAndAccumulate(
+      const BlockSparseMatrix& block_diagonal_ete_inverse,
+      const double* x,
+      double* y) const final;
+  void SchurComplementRightMultiplyAndAccumulate(
+      const FloatBlockSparseMatrix& matrix,
+      const FloatBlockSparseMatrix& block_diagonal_ete_inverse,
+      const double* x,
+      double* y) const final;
+
   std::unique_ptr<BlockSparseMatrix> CreateBlockDiagonalEtE() const final;
   std::unique_ptr<BlockSparseMatrix> CreateBlockDiagonalFtF() const final;
   void UpdateBlockDiagonalEtE(BlockSparseMatrix* block_diagonal) const final;
@@ -193,6 +228,16 @@ class CERES_NO_EXPORT PartitionedMatrixView final
   std::unique_ptr<BlockSparseMatrix> CreateBlockDiagonalMatrixLayout(
       int start_col_block, int end_col_block) const;
 
+  // Implementation of SchurComplementRightMultiplyAndAccumulate for
+  // double (T = double) and single (T = float) precision values.
+  template <typename T>
+  void SchurComplementRightMultiplyAndAccumulateImpl(
+      const T* values,
+      const CompressedRowBlockStructure* block_diagonal_bs,
+      const T* block_diagonal_values,
+      const double* x,
+      double* y) const;
+
   const LinearSolver::Options options_;
   const BlockSparseMatrix& matrix_;
   int num_row_blocks_e_;
@@ -202,6 +247,19 @@ class CERES_NO_EXPORT PartitionedMatrixView final
   int num_cols_f_;
   std::vector<int> e_cols_partition_;
   std::vector<int> f_cols_partition_;
+
+  // The row blocks of E are grouped into chunks of row blocks with the
+  // same e_block. Chunk i consists of the row blocks
+  // [e_chunk_starts_[i], e_chunk_starts_[i + 1]).
+  std::vector<int> e_chunk_starts_;
+  // Number of rows of the largest chunk.
+  int max_e_chunk_num_rows_;
+
+  // Per thread storage used by SchurComplementRightMultiplyAndAccumulate
+  // for the product of a chunk of row blocks with F x, followed, if
+  // options_.num_threads > 1, by a thread's contribution to y.
+  int schur_product_buffer_size_;
+  std::unique_ptr<double[]> schur_product_buffer_;
 };
 
 }  // namespace ceres::internal
@@ -33,6 +33,7 @@
 #include <memory>
 #include <vector>
 
+#include "absl/container/fixed_array.h"
 #include "absl/log/check.h"
 #include "ceres/block_sparse_matrix.h"
 #include "ceres/block_structure.h"
@@ -84,6 +85,33 @@ PartitionedMatrixView<kRowBlockSize, kEBlockSize, kFBlockSize>::
 
   CHECK_EQ(num_cols_e_ + num_cols_f_, matrix_.num_cols());
 
+  e_chunk_starts_.clear();
+  max_e_chunk_num_rows_ = 0;
+  for (int r = 0; r < num_row_blocks_e_; ++r) {
+    if (r == 0 || bs->rows[r].cells[0].block_id !=
+                      bs->rows[r - 1].cells[0].block_id) {
+      e_chunk_starts_.push_back(r);
+    }
+    const int chunk_start_position =
+        bs->rows[e_chunk_starts_.back()].block.position;
+    max_e_chunk_num_rows_ =
+        std::max(max_e_chunk_num_rows_,
+                 bs->rows[r].block.position + bs->rows[r].block.size -
+                     chunk_start_position);
+  }
+  e_chunk_starts_.push_back(num_row_blocks_e_);
+
+  schur_product_buffer_size_ = max_e_chunk_num_rows_;
+  for (int r = num_row_blocks_e_; r < bs->rows.size(); ++r) {
+    schur_product_buffer_size_ =
+        std::max(schur_product_buffer_size_, bs->rows[r].block.size);
+  }
+  if (options_.num_threads > 1) {
+    schur_product_buffer_size_ += num_cols_f_;
+  }
+  schur_product_buffer_ = std::make_unique<double[]>(
+      schur_product_buffer_size_ * options_.num_threads);
+
   auto transpose_bs = matrix_.transpose_block_structure();
   const int num_threads = options_.num_threads;
   if (transpose_bs != nullptr && num_threads > 1) {
@@ -190,6 +218,188 @@ void PartitionedMatrixView<kRowBlockSize, kEBlockSize, kFBlockSize>::
               });
 }
 
+// For each chunk of row blocks sharing an e_block, compute
+//
+//   t = F x
+//   t -= E B E' t
+//   y += F' t
+//
+// where t is the part of the product with the chunk, so that the row
+// blocks of the chunk stay in cache between the first and the last
+// step. With multiple threads, distinct chunks update the same
+// entries of y, so each thread accumulates its part of y separately,
+// and the parts are summed at the end.
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+void PartitionedMatrixView<kRowBlockSize, kEBlockSize, kFBlockSize>::
+    SchurComplementRightMultiplyAndAccumulate(
+        const BlockSparseMatrix& block_diagonal_ete_inverse,
+        const double* x,
+        double* y) const {
+  SchurComplementRightMultiplyAndAccumulateImpl(
+      matrix_.values(),
+      block_diagonal_ete_inverse.block_structure(),
+      block_diagonal_ete_inverse.values(),
+      x,
+      y);
+}
+
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+void PartitionedMatrixView<kRowBlockSize, kEBlockSize, kFBlockSize>::
+    SchurComplementRightMultiplyAndAccumulate(
+        const FloatBlockSparseMatrix& matrix,
+        const FloatBlockSparseMatrix& block_diagonal_ete_inverse,
+        const double* x,
+        double* y) const {
+  CHECK_EQ(matrix.block_structure(), matrix_.block_structure());
+  SchurComplementRightMultiplyAndAccumulateImpl(
+      matrix.float_values(),
+      block_diagonal_ete_inverse.block_structure(),
+      block_diagonal_ete_inverse.float_values(),
+      x,
+      y);
+}
+
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+template <typename T>
+void PartitionedMatrixView<kRowBlockSize, kEBlockSize, kFBlockSize>::
+    SchurComplementRightMultiplyAndAccumulateImpl(
+        const T* values,
+        const CompressedRowBlockStructure* block_diagonal_bs,
+        const T* block_diagonal_values,
+        const double* x,
+        double* y) const {
+  const CompressedRowBlockStructure* bs = matrix_.block_structure();
+  const int num_threads = options_.num_threads;
+  const int num_cols_e = num_cols_e_;
+  const int num_chunks = e_chunk_starts_.size() - 1;
+  const int num_row_blocks = bs->rows.size();
+
+  const auto thread_y = [this, num_threads, y](int thread_id) {
+    return num_threads == 1 ? y
+                            : schur_product_buffer_.get() +
+                                  (thread_id + 1) * schur_product_buffer_size_ -
+                                  num_cols_f_;
+  };
+  if (num_threads > 1) {
+    ParallelFor(options_.context, 0, num_threads, num_threads, [&](int i) {
+      std::fill_n(thread_y(i), num_cols_f_, 0.0);
+    });
+  }
+
+  ParallelFor(
+      options_.context,
+      0,
+      num_chunks,
+      num_threads,
+      [&](int thread_id, int chunk) {
+        double* t = schur_product_buffer_.get() +
+                    thread_id * schur_product_buffer_size_;
+        double* y_f = thread_y(thread_id);
+        const int chunk_start = e_chunk_starts_[chunk];
+        const int chunk_end = e_chunk_starts_[chunk + 1];
+        const int chunk_position = bs->rows[chunk_start].block.position;
+        const int e_block_id = bs->rows[chunk_start].cells[0].block_id;
+        const int e_block_size = bs->cols[e_block_id].size;
+
+        // t = F x and z = E't
+        absl::FixedArray<double, 8> z(e_block_size, 0.0);
+        for (int r = chunk_start; r < chunk_end; ++r) {
+          const CompressedRow& row = bs->rows[r];
+          double* t_row = t + row.block.position - chunk_position;
+          std::fill_n(t_row, row.block.size, 0.0);
+          for (int c = 1; c < row.cells.size(); ++c) {
+            const Cell& cell = row.cells[c];
+            // clang-format off
+            MatrixVectorMultiply<kRowBlockSize, kFBlockSize, 1>(
+                values + cell.position, row.block.size,
+                bs->cols[cell.block_id].size,
+                x + bs->cols[cell.block_id].position - num_cols_e,
+                t_row);
+            // clang-format on
+          }
+          // clang-format off
+          MatrixTransposeVectorMultiply<kRowBlockSize, kEBlockSize, 1>(
+              values + row.cells[0].position, row.block.size, e_block_size,
+              t_row,
+              z.data());
+          // clang-format on
+        }
+
+        // w = -B z
+        absl::FixedArray<double, 8> w(e_block_size, 0.0);
+        // clang-format off
+        MatrixVectorMultiply<kEBlockSize, kEBlockSize, -1>(
+            block_diagonal_values +
+                block_diagonal_bs->rows[e_block_id].cells[0].position,
+            e_block_size, e_block_size,
+            z.data(),
+            w.data());
+        // clang-format on
+
+        // t += E w and y += F't
+        for (int r = chunk_start; r < chunk_end; ++r) {
+          const CompressedRow& row = bs->rows[r];
+          double* t_row = t + row.block.position - chunk_position;
+          // clang-format off
+          MatrixVectorMultiply<kRowBlockSize, kEBlockSize, 1>(
+              values + row.cells[0].position, row.block.size, e_block_size,
+              w.data(),
+              t_row);
+          // clang-format on
+          for (int c = 1; c < row.cells.size(); ++c) {
+            const Cell& cell = row.cells[c];
+            // clang-format off
+            MatrixTransposeVectorMultiply<kRowBlockSize, kFBlockSize, 1>(
+                values + cell.position, row.block.size,
+                bs->cols[cell.block_id].size,
+                t_row,
+                y_f + bs->cols[cell.block_id].position - num_cols_e);
+            // clang-format on
+          }
+        }
+      });
+
+  // The row blocks without an e_block contribute F'F x.
+  ParallelFor(options_.context,
+              num_row_blocks_e_,
+              num_row_blocks,
+              num_threads,
+              [&](int thread_id, int r) {
+                double* t = schur_product_buffer_.get() +
+                            thread_id * schur_product_buffer_size_;
+                double* y_f = thread_y(thread_id);
+                const CompressedRow& row = bs->rows[r];
+                std::fill_n(t, row.block.size, 0.0);
+                for (const Cell& cell : row.cells) {
+                  // clang-format off
+                  MatrixVectorMultiply<Eigen::Dynamic, Eigen::Dynamic, 1>(
+                      values + cell.position, row.block.size,
+                      bs->cols[cell.block_id].size,
+                      x + bs->cols[cell.block_id].position - num_cols_e,
+                      t);
+                  // clang-format on
+                }
+                for (const Cell& cell : row.cells) {
+                  // clang-format off
+                  MatrixTransposeVectorMultiply<Eigen::Dynamic,
+                                                Eigen::Dynamic, 1>(
+                      values + cell.position, row.block.size,
+                      bs->cols[cell.block_id].size,
+                      t,
+                      y_f + bs->cols[cell.block_id].position - num_cols_e);
+                  // clang-format on
+                }
+              });
+
+  if (num_threads > 1) {
+    ParallelFor(options_.context, 0, num_cols_f_, num_threads, [&](int i) {
+      for (int j = 0; j < num_threads; ++j) {
+        y[i] += thread_y(j)[i];
+      }
+    });
+  }
+}
+
 template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
 void PartitionedMatrixView<kRowBlockSize, kEBlockSize, kFBlockSize>::
     LeftMultiplyAndAccumulateE(const double* x, double* y) const {
@@ -163,6 +163,39 @@ TEST_P(PartitionedMatrixViewTest, LeftMultiplyAndAccumulate) {
   }
 }
 
+TEST_P(PartitionedMatrixViewTest, SchurComplementRightMultiplyAndAccumulate) {
+  // Any matrix with the block structure of E'E will do for B.
+  std::unique_ptr<BlockSparseMatrix> block_diagonal(
+      pmv_->CreateBlockDiagonalEtE());
+  Matrix B;
+  block_diagonal->ToDenseMatrix(&B);
+
+  Matrix EF;
+  A_->ToDenseMatrix(&EF);
+  const int num_rows = pmv_->num_rows();
+  const int num_cols_e = pmv_->num_cols_e();
+  const int num_cols_f = pmv_->num_cols_f();
+  const Matrix E = EF.topLeftCorner(num_rows, num_cols_e);
+  const Matrix F = EF.topRightCorner(num_rows, num_cols_f);
+
+  Vector x(num_cols_f);
+  Vector y(num_cols_f);
+  for (int i = 0; i < num_cols_f; ++i) {
+    x(i) = RandDouble();
+    y(i) = RandDouble();
+  }
+
+  const Vector Fx = F * x;
+  const Vector expected =
+      y + F.transpose() * (Fx - E * (B * (E.transpose() * Fx)));
+  pmv_->SchurComplementRightMultiplyAndAccumulate(
+      *block_diagonal, x.data(), y.data());
+
+  for (int i = 0; i < num_cols_f; ++i) {
+    EXPECT_NEAR(y(i), expected(i), kEpsilon * expected.norm());
+  }
+}
+
 TEST_P(PartitionedMatrixViewTest, BlockDiagonalFtF) {
   std::unique_ptr<BlockSparseMatrix> block_diagonal_ff(
       pmv_->CreateBlockDiagonalFtF());
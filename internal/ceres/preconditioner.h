@@ -143,6 +143,14 @@ class CERES_NO_EXPORT Preconditioner : public LinearOperator {
   // of size zero.
   virtual bool Update(const LinearOperator& A, const double* D) = 0;
 
+  // Update the preconditioner for a new diagonal matrix D, keeping the
+  // contribution of A from the last call to Update. This is used when a
+  // preconditioner is reused for a later linear system, see
+  // PreconditionerRefreshPolicy. Preconditioners for which this is
+  // expensive are free to ignore D, which the default implementation
+  // does, since a stale preconditioner is still a valid one.
+  virtual bool UpdateDiagonal(const double* /*D*/) { return true; }
+
   // LinearOperator interface. Since the operator is symmetric,
   // LeftMultiplyAndAccumulate and num_cols are just calls to
   // RightMultiplyAndAccumulate and num_rows respectively. Update() must be
@@ -0,0 +1,81 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/preconditioner_refresh_policy.h"
+
+#include <algorithm>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+
+namespace ceres::internal {
+
+PreconditionerRefreshPolicy::PreconditionerRefreshPolicy(
+    PreconditionerType type, int max_num_reuses, double max_iteration_ratio)
+    : max_num_reuses_(IsReusable(type) ? max_num_reuses : 0),
+      max_iteration_ratio_(max_iteration_ratio) {
+  CHECK_GE(max_num_reuses, 0);
+  CHECK_GE(max_iteration_ratio, 1.0);
+}
+
+bool PreconditionerRefreshPolicy::IsReusable(PreconditionerType type) {
+  return type == SCHUR_JACOBI || type == CLUSTER_JACOBI ||
+         type == CLUSTER_TRIDIAGONAL || type == SUBSET ||
+         type == INCOMPLETE_CHOLESKY;
+}
+
+void PreconditionerRefreshPolicy::RecordSolve(
+    bool refreshed, const LinearSolver::Summary& summary) {
+  if (summary.termination_type == LinearSolverTerminationType::FAILURE ||
+      summary.termination_type == LinearSolverTerminationType::FATAL_ERROR) {
+    refresh_needed_ = true;
+    return;
+  }
+
+  if (refreshed) {
+    num_reuses_ = 0;
+    num_iterations_after_refresh_ = std::max(summary.num_iterations, 1);
+    refresh_needed_ = (max_num_reuses_ == 0);
+    return;
+  }
+
+  CHECK(!refresh_needed_) << "The preconditioner was reused when it should "
+                          << "have been refreshed.";
+  ++num_reuses_;
+  const bool too_many_iterations =
+      summary.num_iterations >
+      max_iteration_ratio_ * num_iterations_after_refresh_;
+  if (too_many_iterations) {
+    VLOG(2) << "Preconditioner refresh needed. Linear solver iterations: "
+            << summary.num_iterations << " vs "
+            << num_iterations_after_refresh_ << " after the last refresh.";
+  }
+  refresh_needed_ = (num_reuses_ >= max_num_reuses_ || too_many_iterations);
+}
+
+}  // namespace ceres::internal
@@ -0,0 +1,81 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CERES_INTERNAL_PRECONDITIONER_REFRESH_POLICY_H_
+#define CERES_INTERNAL_PRECONDITIONER_REFRESH_POLICY_H_
+
+#include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/export.h"
+#include "ceres/linear_solver.h"
+#include "ceres/types.h"
+
+namespace ceres::internal {
+
+// Decides whether an iterative linear solver has to update its
+// preconditioner before a linear solve, or can reuse the one it computed
+// for an earlier linear system.
+//
+// The preconditioner is reused for up to max_num_reuses solves after the
+// one it was computed for. It is updated earlier if a solve fails, or if a
+// solve needs more than max_iteration_ratio times the number of iterations
+// of the solve it was computed for, which indicates that the linear system
+// has drifted away from the one the preconditioner approximates.
+//
+// Only the preconditioners which are expensive to update are reused, the
+// others, e.g., JACOBI, are updated before every solve.
+class CERES_NO_EXPORT PreconditionerRefreshPolicy {
+ public:
+  PreconditionerRefreshPolicy(PreconditionerType type,
+                              int max_num_reuses,
+                              double max_iteration_ratio);
+
+  // Returns true if the preconditioner has to be updated before the next
+  // linear solve.
+  bool RefreshNeeded() const { return refresh_needed_; }
+
+  // Records the outcome of a linear solve. refreshed is true if the
+  // preconditioner was updated for it.
+  void RecordSolve(bool refreshed, const LinearSolver::Summary& summary);
+
+  // Returns true if preconditioners of this type are worth reusing.
+  static bool IsReusable(PreconditionerType type);
+
+ private:
+  const int max_num_reuses_;
+  const double max_iteration_ratio_;
+  bool refresh_needed_ = true;
+  int num_reuses_ = 0;
+  // Number of iterations of the solve the preconditioner was computed for.
+  int num_iterations_after_refresh_ = 0;
+};
+
+}  // namespace ceres::internal
+
+#include "ceres/internal/reenable_warnings.h"
+
+#endif  // CERES_INTERNAL_PRECONDITIONER_REFRESH_POLICY_H_
@@ -0,0 +1,94 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/preconditioner_refresh_policy.h"
+
+#include "ceres/linear_solver.h"
+#include "ceres/types.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+static LinearSolver::Summary MakeSummary(
+    int num_iterations,
+    LinearSolverTerminationType termination_type =
+        LinearSolverTerminationType::SUCCESS) {
+  LinearSolver::Summary summary;
+  summary.num_iterations = num_iterations;
+  summary.termination_type = termination_type;
+  return summary;
+}
+
+TEST(PreconditionerRefreshPolicy, RefreshesEverySolveByDefault) {
+  PreconditionerRefreshPolicy policy(SCHUR_JACOBI, 0, 1.5);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(policy.RefreshNeeded());
+    policy.RecordSolve(true, MakeSummary(10));
+  }
+}
+
+TEST(PreconditionerRefreshPolicy, CheapPreconditionersAreNotReused) {
+  PreconditionerRefreshPolicy policy(JACOBI, 5, 1.5);
+  EXPECT_TRUE(policy.RefreshNeeded());
+  policy.RecordSolve(true, MakeSummary(10));
+  EXPECT_TRUE(policy.RefreshNeeded());
+}
+
+TEST(PreconditionerRefreshPolicy, ReusesUpToMaxNumReuses) {
+  PreconditionerRefreshPolicy policy(CLUSTER_JACOBI, 2, 1.5);
+  EXPECT_TRUE(policy.RefreshNeeded());
+  policy.RecordSolve(true, MakeSummary(10));
+  EXPECT_FALSE(policy.RefreshNeeded());
+  policy.RecordSolve(false, MakeSummary(10));
+  EXPECT_FALSE(policy.RefreshNeeded());
+  policy.RecordSolve(false, MakeSummary(10));
+  EXPECT_TRUE(policy.RefreshNeeded());
+  policy.RecordSolve(true, MakeSummary(10));
+  EXPECT_FALSE(policy.RefreshNeeded());
+}
+
+TEST(PreconditionerRefreshPolicy, RefreshesWhenIterationsGrow) {
+  PreconditionerRefreshPolicy policy(SUBSET, 10, 1.5);
+  policy.RecordSolve(true, MakeSummary(10));
+  EXPECT_FALSE(policy.RefreshNeeded());
+  policy.RecordSolve(false, MakeSummary(15));
+  EXPECT_FALSE(policy.RefreshNeeded());
+  policy.RecordSolve(false, MakeSummary(16));
+  EXPECT_TRUE(policy.RefreshNeeded());
+}
+
+TEST(PreconditionerRefreshPolicy, RefreshesAfterFailure) {
+  PreconditionerRefreshPolicy policy(CLUSTER_TRIDIAGONAL, 10, 1.5);
+  policy.RecordSolve(true, MakeSummary(10));
+  EXPECT_FALSE(policy.RefreshNeeded());
+  policy.RecordSolve(false,
+                     MakeSummary(1, LinearSolverTerminationType::FAILURE));
+  EXPECT_TRUE(policy.RefreshNeeded());
+}
+
+}  // namespace ceres::internal
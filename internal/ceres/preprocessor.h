@@ -46,6 +46,7 @@
 #include "ceres/problem_impl.h"
 #include "ceres/program.h"
 #include "ceres/solver.h"
+#include "ceres/trust_region_strategy.h"
 
 namespace ceres::internal {
 
@@ -87,6 +88,9 @@ struct CERES_NO_EXPORT PreprocessedProblem {
   LinearSolver::Options linear_solver_options;
   Evaluator::Options evaluator_options;
   Minimizer::Options minimizer_options;
+  // Used to create a fresh trust region strategy when the preprocessed
+  // problem is solved more than once.
+  TrustRegionStrategy::Options trust_region_strategy_options;
 
   ProblemImpl* problem;
   std::unique_ptr<ProblemImpl> gradient_checking_problem;
@@ -101,6 +105,13 @@ struct CERES_NO_EXPORT PreprocessedProblem {
   std::vector<double*> removed_parameter_blocks;
   Vector reduced_parameters;
   double fixed_cost{0.0};
+
+  // Wall time spent in the stages of the preprocessor, see
+  // Solver::Summary. Stages that were not run are reported as -1.
+  double program_validation_time_in_seconds{-1.0};
+  double program_reduction_time_in_seconds{-1.0};
+  double program_reordering_time_in_seconds{-1.0};
+  double evaluator_creation_time_in_seconds{-1.0};
 };
 
 // Common functions used by various preprocessors.
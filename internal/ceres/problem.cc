@@ -65,10 +65,28 @@ ResidualBlockId Problem::AddResidualBlock(CostFunction* cost_function,
       cost_function, loss_function, parameter_blocks, num_parameter_blocks);
 }
 
+void Problem::AddResidualBlocks(int num_residual_blocks,
+                                CostFunction* const* cost_functions,
+                                LossFunction* const* loss_functions,
+                                double* const* parameter_blocks,
+                                ResidualBlockId* residual_block_ids) {
+  impl_->AddResidualBlocks(num_residual_blocks,
+                           cost_functions,
+                           loss_functions,
+                           parameter_blocks,
+                           residual_block_ids);
+}
+
 void Problem::AddParameterBlock(double* values, int size) {
   impl_->AddParameterBlock(values, size);
 }
 
+void Problem::AddParameterBlocks(int num_parameter_blocks,
+                                 double* const* values,
+                                 const int* sizes) {
+  impl_->AddParameterBlocks(num_parameter_blocks, values, sizes);
+}
+
 void Problem::AddParameterBlock(double* values, int size, Manifold* manifold) {
   impl_->AddParameterBlock(values, size, manifold);
 }
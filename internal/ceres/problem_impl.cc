@@ -36,6 +36,8 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <new>
+#include <numeric>
 #include <set>
 #include <string>
 #include <utility>
@@ -85,9 +87,8 @@ void CheckForNoAliasing(double* existing_block,
       << "size " << new_block_size << ".";
 }
 
-template <typename KeyType>
-void DecrementValueOrDeleteKey(const KeyType key,
-                               std::map<KeyType, int>* container) {
+template <typename KeyType, typename RefCount>
+void DecrementValueOrDeleteKey(const KeyType key, RefCount* container) {
   auto it = container->find(key);
   if (it->second == 1) {
     delete key;
@@ -141,22 +142,7 @@ ParameterBlock* ProblemImpl::InternalAddParameterBlock(double* values,
   if (!options_.disable_all_safety_checks) {
     // Before adding the parameter block, also check that it doesn't alias any
     // other parameter blocks.
-    if (!parameter_block_map_.empty()) {
-      auto lb = parameter_block_map_.lower_bound(values);
-
-      // If lb is not the first block, check the previous block for aliasing.
-      if (lb != parameter_block_map_.begin()) {
-        auto previous = lb;
-        --previous;
-        CheckForNoAliasing(
-            previous->first, previous->second->Size(), values, size);
-      }
-
-      // If lb is not off the end, check lb for aliasing.
-      if (lb != parameter_block_map_.end()) {
-        CheckForNoAliasing(lb->first, lb->second->Size(), values, size);
-      }
-    }
+    AddParameterBlockExtent(values, size);
   }
 
   // Pass the index of the new parameter block as well to keep the index in
@@ -164,34 +150,161 @@ ParameterBlock* ProblemImpl::InternalAddParameterBlock(double* values,
   auto* new_parameter_block =
       new ParameterBlock(values, size, program_->parameter_blocks_.size());
 
-  // For dynamic problems, add the list of dependent residual blocks, which is
-  // empty to start.
-  if (options_.enable_fast_removal) {
-    new_parameter_block->EnableResidualBlockDependencies();
-  }
+  // Add the list of dependent residual blocks, which is empty to start.
+  new_parameter_block->EnableResidualBlockDependencies();
   parameter_block_map_[values] = new_parameter_block;
   program_->parameter_blocks_.push_back(new_parameter_block);
+  ++structure_version_;
   return new_parameter_block;
 }
 
+void ProblemImpl::AddParameterBlockExtent(double* values, int size) {
+  auto lb = parameter_block_extents_.lower_bound(values);
+
+  // If lb is not the first block, check the previous block for aliasing.
+  if (lb != parameter_block_extents_.begin()) {
+    auto previous = lb;
+    --previous;
+    CheckForNoAliasing(previous->first, previous->second, values, size);
+  }
+
+  // If lb is not off the end, check lb for aliasing.
+  if (lb != parameter_block_extents_.end()) {
+    CheckForNoAliasing(lb->first, lb->second, values, size);
+  }
+
+  parameter_block_extents_.emplace_hint(lb, values, size);
+}
+
+void ProblemImpl::InternalAddParameterBlocks(
+    int num_parameter_blocks,
+    double* const* values,
+    const int* sizes,
+    ParameterBlock** parameter_blocks) {
+  if (num_parameter_blocks == 0) {
+    return;
+  }
+
+  for (int i = 0; i < num_parameter_blocks; ++i) {
+    CHECK(values[i] != nullptr) << "Null pointer passed to AddParameterBlocks "
+                                << "for a parameter with size " << sizes[i];
+  }
+
+  // Sort the positions by pointer so that repeated pointers are adjacent,
+  // and the new parameter blocks can be checked for aliasing in order. The
+  // sort is stable, so the first position of each group is where the
+  // pointer first occurs.
+  std::vector<int> positions(num_parameter_blocks);
+  std::iota(positions.begin(), positions.end(), 0);
+  std::stable_sort(positions.begin(), positions.end(), [values](int a, int b) {
+    return values[a] < values[b];
+  });
+
+  // For each distinct pointer, its parameter block if it is in the problem
+  // already.
+  std::vector<int> group_of_position(num_parameter_blocks);
+  std::vector<ParameterBlock*> group_parameter_blocks;
+  std::vector<int> group_first_position;
+  int num_new_parameter_blocks = 0;
+  for (int i = 0; i < num_parameter_blocks; ++i) {
+    const int position = positions[i];
+    double* const value = values[position];
+    const int size = sizes[position];
+    if (i > 0 && value == values[positions[i - 1]]) {
+      if (!options_.disable_all_safety_checks) {
+        const int existing_size =
+            sizes[group_first_position[group_parameter_blocks.size() - 1]];
+        CHECK(size == existing_size)
+            << "Tried adding a parameter block with the same double pointer, "
+            << value << ", twice, but with different block sizes. Original "
+            << "size was " << existing_size << " but new size is " << size;
+      }
+      group_of_position[position] = group_parameter_blocks.size() - 1;
+      continue;
+    }
+
+    group_of_position[position] = group_parameter_blocks.size();
+    group_first_position.push_back(position);
+    auto it = parameter_block_map_.find(value);
+    if (it != parameter_block_map_.end()) {
+      if (!options_.disable_all_safety_checks) {
+        const int existing_size = it->second->Size();
+        CHECK(size == existing_size)
+            << "Tried adding a parameter block with the same double pointer, "
+            << value << ", twice, but with different block sizes. Original "
+            << "size was " << existing_size << " but new size is " << size;
+      }
+      group_parameter_blocks.push_back(it->second);
+      continue;
+    }
+
+    if (!options_.disable_all_safety_checks) {
+      AddParameterBlockExtent(value, size);
+    }
+    group_parameter_blocks.push_back(nullptr);
+    ++num_new_parameter_blocks;
+  }
+
+  if (num_new_parameter_blocks > 0) {
+    // Create the new parameter blocks in the order in which they first
+    // occur, which is the order in which AddParameterBlock would add them.
+    auto* storage =
+        block_arena_.Allocate<ParameterBlock>(num_new_parameter_blocks);
+    std::vector<ParameterBlock*>& program_parameter_blocks =
+        program_->parameter_blocks_;
+    program_parameter_blocks.reserve(program_parameter_blocks.size() +
+                                     num_new_parameter_blocks);
+    parameter_block_map_.reserve(parameter_block_map_.size() +
+                                 num_new_parameter_blocks);
+    for (int i = 0; i < num_parameter_blocks; ++i) {
+      const int group = group_of_position[i];
+      if (group_parameter_blocks[group] != nullptr ||
+          group_first_position[group] != i) {
+        continue;
+      }
+      auto* new_parameter_block = new (storage++) ParameterBlock(
+          values[i], sizes[i], program_parameter_blocks.size());
+      new_parameter_block->EnableResidualBlockDependencies();
+      program_parameter_blocks.push_back(new_parameter_block);
+      parameter_block_map_.emplace(values[i], new_parameter_block);
+      group_parameter_blocks[group] = new_parameter_block;
+    }
+    ++structure_version_;
+  }
+
+  if (parameter_blocks != nullptr) {
+    for (int i = 0; i < num_parameter_blocks; ++i) {
+      parameter_blocks[i] = group_parameter_blocks[group_of_position[i]];
+    }
+  }
+}
+
 void ProblemImpl::InternalRemoveResidualBlock(ResidualBlock* residual_block) {
   CHECK(residual_block != nullptr);
   // Perform no check on the validity of residual_block, that is handled in
   // the public method: RemoveResidualBlock().
 
-  // If needed, remove the parameter dependencies on this residual block.
-  if (options_.enable_fast_removal) {
-    const int num_parameter_blocks_for_residual =
-        residual_block->NumParameterBlocks();
-    for (int i = 0; i < num_parameter_blocks_for_residual; ++i) {
-      residual_block->parameter_blocks()[i]->RemoveResidualBlock(
-          residual_block);
-    }
+  // Remove the parameter dependencies on this residual block.
+  const int num_parameter_blocks_for_residual =
+      residual_block->NumParameterBlocks();
+  for (int i = 0; i < num_parameter_blocks_for_residual; ++i) {
+    residual_block->parameter_blocks()[i]->RemoveResidualBlock(residual_block);
+  }
 
-    auto it = residual_block_set_.find(residual_block);
-    residual_block_set_.erase(it);
+  if (options_.enable_fast_removal) {
+    residual_block_set_.erase(residual_block);
   }
   DeleteBlockInVector(program_->mutable_residual_blocks(), residual_block);
+  ++structure_version_;
+}
+
+template <typename Block>
+void ProblemImpl::DestroyBlock(Block* block) {
+  if (block_arena_.Contains(block)) {
+    block->~Block();
+  } else {
+    delete block;
+  }
 }
 
 // Deletes the residual block in question, assuming there are no other
@@ -216,14 +329,17 @@ void ProblemImpl::DeleteBlock(ResidualBlock* residual_block) {
     DecrementValueOrDeleteKey(loss_function, &loss_function_ref_count_);
   }
 
-  delete residual_block;
+  DestroyBlock(residual_block);
 }
 
 // Deletes the parameter block in question, assuming there are no other
 // references to it inside the problem (e.g. by any residual blocks).
 void ProblemImpl::DeleteBlock(ParameterBlock* parameter_block) {
   parameter_block_map_.erase(parameter_block->mutable_user_state());
-  delete parameter_block;
+  if (!options_.disable_all_safety_checks) {
+    parameter_block_extents_.erase(parameter_block->mutable_user_state());
+  }
+  DestroyBlock(parameter_block);
 }
 
 ProblemImpl::ProblemImpl()
@@ -238,8 +354,9 @@ ProblemImpl::ProblemImpl(const Problem::Options& options)
 }
 
 ProblemImpl::~ProblemImpl() {
-  STLDeleteContainerPointers(program_->residual_blocks_.begin(),
-                             program_->residual_blocks_.end());
+  for (auto* residual_block : program_->residual_blocks_) {
+    DestroyBlock(residual_block);
+  }
 
   if (options_.cost_function_ownership == TAKE_OWNERSHIP) {
     STLDeleteContainerPairFirstPointers(cost_function_ref_count_.begin(),
@@ -329,13 +446,12 @@ ResidualBlockId ProblemImpl::AddResidualBlock(
                         program_->residual_blocks_.size());
 
   // Add dependencies on the residual to the parameter blocks.
-  if (options_.enable_fast_removal) {
-    for (int i = 0; i < num_parameter_blocks; ++i) {
-      parameter_block_ptrs[i]->AddResidualBlock(new_residual_block);
-    }
+  for (int i = 0; i < num_parameter_blocks; ++i) {
+    parameter_block_ptrs[i]->AddResidualBlock(new_residual_block);
   }
 
   program_->residual_blocks_.push_back(new_residual_block);
+  ++structure_version_;
 
   if (options_.enable_fast_removal) {
     residual_block_set_.insert(new_residual_block);
@@ -356,10 +472,146 @@ ResidualBlockId ProblemImpl::AddResidualBlock(
   return new_residual_block;
 }
 
+void ProblemImpl::AddResidualBlocks(int num_residual_blocks,
+                                    CostFunction* const* cost_functions,
+                                    LossFunction* const* loss_functions,
+                                    double* const* parameter_blocks,
+                                    ResidualBlockId* residual_block_ids) {
+  CHECK_GE(num_residual_blocks, 0);
+  if (num_residual_blocks == 0) {
+    return;
+  }
+  CHECK(cost_functions != nullptr);
+  CHECK(parameter_blocks != nullptr);
+
+  // offsets[i] is the position of the first parameter block of residual
+  // block i in parameter_blocks.
+  std::vector<int> offsets(num_residual_blocks + 1);
+  offsets[0] = 0;
+  for (int i = 0; i < num_residual_blocks; ++i) {
+    CHECK(cost_functions[i] != nullptr);
+    offsets[i + 1] =
+        offsets[i] + cost_functions[i]->parameter_block_sizes().size();
+  }
+  const int num_parameter_block_ptrs = offsets.back();
+
+  std::vector<int> parameter_block_sizes(num_parameter_block_ptrs);
+  for (int i = 0; i < num_residual_blocks; ++i) {
+    const std::vector<int32_t>& sizes =
+        cost_functions[i]->parameter_block_sizes();
+    std::copy(sizes.begin(), sizes.end(), &parameter_block_sizes[offsets[i]]);
+  }
+
+  if (!options_.disable_all_safety_checks) {
+    // Check for duplicate parameter blocks.
+    std::vector<double*> sorted_parameter_blocks;
+    for (int i = 0; i < num_residual_blocks; ++i) {
+      double* const* residual_parameter_blocks = parameter_blocks + offsets[i];
+      const int num_residual_parameter_blocks = offsets[i + 1] - offsets[i];
+      sorted_parameter_blocks.assign(
+          residual_parameter_blocks,
+          residual_parameter_blocks + num_residual_parameter_blocks);
+      std::sort(sorted_parameter_blocks.begin(), sorted_parameter_blocks.end());
+      if (std::adjacent_find(sorted_parameter_blocks.begin(),
+                             sorted_parameter_blocks.end()) !=
+          sorted_parameter_blocks.end()) {
+        std::string blocks;
+        for (int j = 0; j < num_residual_parameter_blocks; ++j) {
+          absl::StrAppendFormat(&blocks, " %p ", residual_parameter_blocks[j]);
+        }
+
+        LOG(FATAL) << "Duplicate parameter blocks in a residual parameter "
+                   << "are not allowed. Residual block: " << i
+                   << " Parameter block pointers: [" << blocks << "]";
+      }
+    }
+  }
+
+  // Add the parameter blocks and convert the double*'s to parameter blocks.
+  // This also checks that the sizes of the parameter blocks match the sizes
+  // expected by the cost functions.
+  std::vector<ParameterBlock*> parameter_block_ptrs(num_parameter_block_ptrs);
+  InternalAddParameterBlocks(num_parameter_block_ptrs,
+                             parameter_blocks,
+                             parameter_block_sizes.data(),
+                             parameter_block_ptrs.data());
+
+  auto* residual_block_storage =
+      block_arena_.Allocate<ResidualBlock>(num_residual_blocks);
+  auto* parameter_block_storage =
+      block_arena_.Allocate<ParameterBlock*>(num_parameter_block_ptrs);
+
+  std::vector<ResidualBlock*>& residual_blocks = program_->residual_blocks_;
+  residual_blocks.reserve(residual_blocks.size() + num_residual_blocks);
+  if (options_.enable_fast_removal) {
+    residual_block_set_.reserve(residual_block_set_.size() +
+                                num_residual_blocks);
+  }
+
+  for (int i = 0; i < num_residual_blocks; ++i) {
+    auto* new_residual_block = new (residual_block_storage + i)
+        ResidualBlock(cost_functions[i],
+                      loss_functions != nullptr ? loss_functions[i] : nullptr,
+                      parameter_block_ptrs.data() + offsets[i],
+                      parameter_block_storage + offsets[i],
+                      residual_blocks.size());
+
+    // Add dependencies on the residual to the parameter blocks.
+    for (int j = offsets[i]; j < offsets[i + 1]; ++j) {
+      parameter_block_ptrs[j]->AddResidualBlock(new_residual_block);
+    }
+    if (options_.enable_fast_removal) {
+      residual_block_set_.insert(new_residual_block);
+    }
+
+    residual_blocks.push_back(new_residual_block);
+    if (residual_block_ids != nullptr) {
+      residual_block_ids[i] = new_residual_block;
+    }
+  }
+  ++structure_version_;
+
+  // Update the reference counts once per run of residual blocks sharing a
+  // cost or loss function, which is the common case for large problems.
+  if (options_.cost_function_ownership == TAKE_OWNERSHIP) {
+    for (int i = 0; i < num_residual_blocks;) {
+      int j = i + 1;
+      while (j < num_residual_blocks &&
+             cost_functions[j] == cost_functions[i]) {
+        ++j;
+      }
+      cost_function_ref_count_[cost_functions[i]] += j - i;
+      i = j;
+    }
+  }
+
+  if (options_.loss_function_ownership == TAKE_OWNERSHIP &&
+      loss_functions != nullptr) {
+    for (int i = 0; i < num_residual_blocks;) {
+      int j = i + 1;
+      while (j < num_residual_blocks &&
+             loss_functions[j] == loss_functions[i]) {
+        ++j;
+      }
+      if (loss_functions[i] != nullptr) {
+        loss_function_ref_count_[loss_functions[i]] += j - i;
+      }
+      i = j;
+    }
+  }
+}
+
 void ProblemImpl::AddParameterBlock(double* values, int size) {
   InternalAddParameterBlock(values, size);
 }
 
+void ProblemImpl::AddParameterBlocks(int num_parameter_blocks,
+                                     double* const* values,
+                                     const int* sizes) {
+  CHECK_GE(num_parameter_blocks, 0);
+  InternalAddParameterBlocks(num_parameter_blocks, values, sizes, nullptr);
+}
+
 void ProblemImpl::InternalSetManifold(double* /*values*/,
                                       ParameterBlock* parameter_block,
                                       Manifold* manifold) {
@@ -367,6 +619,7 @@ void ProblemImpl::InternalSetManifold(double* /*values*/,
     manifolds_to_delete_.push_back(manifold);
   }
   parameter_block->SetManifold(manifold);
+  ++structure_version_;
 }
 
 void ProblemImpl::AddParameterBlock(double* values,
@@ -442,33 +695,16 @@ void ProblemImpl::RemoveParameterBlock(const double* values) {
                << "it can be removed.";
   }
 
-  if (options_.enable_fast_removal) {
-    // Copy the dependent residuals from the parameter block because the set of
-    // dependents will change after each call to RemoveResidualBlock().
-    std::vector<ResidualBlock*> residual_blocks_to_remove(
-        parameter_block->mutable_residual_blocks()->begin(),
-        parameter_block->mutable_residual_blocks()->end());
-    for (auto* residual_block : residual_blocks_to_remove) {
-      InternalRemoveResidualBlock(residual_block);
-    }
-  } else {
-    // Scan all the residual blocks to remove ones that depend on the parameter
-    // block. Do the scan backwards since the vector changes while iterating.
-    const int num_residual_blocks = NumResidualBlocks();
-    for (int i = num_residual_blocks - 1; i >= 0; --i) {
-      ResidualBlock* residual_block =
-          (*(program_->mutable_residual_blocks()))[i];
-      const int num_parameter_blocks = residual_block->NumParameterBlocks();
-      for (int j = 0; j < num_parameter_blocks; ++j) {
-        if (residual_block->parameter_blocks()[j] == parameter_block) {
-          InternalRemoveResidualBlock(residual_block);
-          // The parameter blocks are guaranteed unique.
-          break;
-        }
-      }
-    }
+  // Copy the dependent residuals from the parameter block because the set of
+  // dependents will change after each call to RemoveResidualBlock().
+  std::vector<ResidualBlock*> residual_blocks_to_remove(
+      parameter_block->mutable_residual_blocks()->begin(),
+      parameter_block->mutable_residual_blocks()->end());
+  for (auto* residual_block : residual_blocks_to_remove) {
+    InternalRemoveResidualBlock(residual_block);
   }
   DeleteBlockInVector(program_->mutable_parameter_blocks(), parameter_block);
+  ++structure_version_;
 }
 
 void ProblemImpl::SetParameterBlockConstant(const double* values) {
@@ -480,7 +716,10 @@ void ProblemImpl::SetParameterBlockConstant(const double* values) {
                << "it can be set constant.";
   }
 
-  parameter_block->SetConstant();
+  if (!parameter_block->IsConstant()) {
+    parameter_block->SetConstant();
+    ++structure_version_;
+  }
 }
 
 bool ProblemImpl::IsParameterBlockConstant(const double* values) const {
@@ -501,7 +740,10 @@ void ProblemImpl::SetParameterBlockVariable(double* values) {
                << "it can be set varying.";
   }
 
-  parameter_block->SetVarying();
+  if (parameter_block->IsConstant()) {
+    parameter_block->SetVarying();
+    ++structure_version_;
+  }
 }
 
 void ProblemImpl::SetManifold(double* values, Manifold* manifold) {
@@ -830,9 +1072,9 @@ void ProblemImpl::GetParameterBlocks(
     std::vector<double*>* parameter_blocks) const {
   CHECK(parameter_blocks != nullptr);
   parameter_blocks->resize(0);
-  parameter_blocks->reserve(parameter_block_map_.size());
-  for (const auto& entry : parameter_block_map_) {
-    parameter_blocks->push_back(entry.first);
+  parameter_blocks->reserve(program_->NumParameterBlocks());
+  for (auto* parameter_block : program_->parameter_blocks()) {
+    parameter_blocks->push_back(parameter_block->mutable_user_state());
   }
 }
 
@@ -874,32 +1116,13 @@ void ProblemImpl::GetResidualBlocksForParameterBlock(
                << "you can get the residual blocks that depend on it.";
   }
 
-  if (options_.enable_fast_removal) {
-    // In this case the residual blocks that depend on the parameter block are
-    // stored in the parameter block already, so just copy them out.
-    CHECK(residual_blocks != nullptr);
-    residual_blocks->resize(parameter_block->mutable_residual_blocks()->size());
-    std::copy(parameter_block->mutable_residual_blocks()->begin(),
-              parameter_block->mutable_residual_blocks()->end(),
-              residual_blocks->begin());
-    return;
-  }
-
-  // Find residual blocks that depend on the parameter block.
+  // The residual blocks that depend on the parameter block are stored in the
+  // parameter block, so just copy them out.
   CHECK(residual_blocks != nullptr);
-  residual_blocks->clear();
-  const int num_residual_blocks = NumResidualBlocks();
-  for (int i = 0; i < num_residual_blocks; ++i) {
-    ResidualBlock* residual_block = (*(program_->mutable_residual_blocks()))[i];
-    const int num_parameter_blocks = residual_block->NumParameterBlocks();
-    for (int j = 0; j < num_parameter_blocks; ++j) {
-      if (residual_block->parameter_blocks()[j] == parameter_block) {
-        residual_blocks->push_back(residual_block);
-        // The parameter blocks are guaranteed unique.
-        break;
-      }
-    }
-  }
+  residual_blocks->resize(parameter_block->mutable_residual_blocks()->size());
+  std::copy(parameter_block->mutable_residual_blocks()->begin(),
+            parameter_block->mutable_residual_blocks()->end(),
+            residual_blocks->begin());
 }
 
 }  // namespace ceres::internal
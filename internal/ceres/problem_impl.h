@@ -40,13 +40,15 @@
 #define CERES_PUBLIC_PROBLEM_IMPL_H_
 
 #include <array>
+#include <cstdint>
 #include <map>
 #include <memory>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "ceres/block_arena.h"
 #include "ceres/context_impl.h"
 #include "ceres/internal/disable_warnings.h"
 #include "ceres/internal/export.h"
@@ -69,10 +71,10 @@ class ResidualBlock;
 
 class CERES_NO_EXPORT ProblemImpl {
  public:
-  using ParameterMap = std::map<double*, ParameterBlock*>;
-  using ResidualBlockSet = std::unordered_set<ResidualBlock*>;
-  using CostFunctionRefCount = std::map<CostFunction*, int>;
-  using LossFunctionRefCount = std::map<LossFunction*, int>;
+  using ParameterMap = absl::flat_hash_map<double*, ParameterBlock*>;
+  using ResidualBlockSet = absl::flat_hash_set<ResidualBlock*>;
+  using CostFunctionRefCount = absl::flat_hash_map<CostFunction*, int>;
+  using LossFunctionRefCount = absl::flat_hash_map<LossFunction*, int>;
 
   ProblemImpl();
   explicit ProblemImpl(const Problem::Options& options);
@@ -99,8 +101,17 @@ class CERES_NO_EXPORT ProblemImpl {
                             static_cast<int>(parameter_blocks.size()));
   }
 
+  void AddResidualBlocks(int num_residual_blocks,
+                         CostFunction* const* cost_functions,
+                         LossFunction* const* loss_functions,
+                         double* const* parameter_blocks,
+                         ResidualBlockId* residual_block_ids);
+
   void AddParameterBlock(double* values, int size);
   void AddParameterBlock(double* values, int size, Manifold* manifold);
+  void AddParameterBlocks(int num_parameter_blocks,
+                          double* const* values,
+                          const int* sizes);
 
   void RemoveResidualBlock(ResidualBlock* residual_block);
   void RemoveParameterBlock(const double* values);
@@ -171,8 +182,29 @@ class CERES_NO_EXPORT ProblemImpl {
 
   ContextImpl* context() { return context_impl_; }
 
+  // A counter which is incremented every time the structure of the problem
+  // changes, i.e., when residual or parameter blocks are added or removed,
+  // parameter blocks are made constant or variable, or their manifolds are
+  // changed. Changes to the values or bounds of parameter blocks do not
+  // change the structure of the problem.
+  int64_t structure_version() const { return structure_version_; }
+
  private:
   ParameterBlock* InternalAddParameterBlock(double* values, int size);
+
+  // Adds the parameter blocks values[i] of size sizes[i] that are not in the
+  // problem yet, allocating them from block_arena_. If parameter_blocks is
+  // not null, the parameter block for values[i] is stored in
+  // parameter_blocks[i]. values may contain the same pointer more than once.
+  void InternalAddParameterBlocks(int num_parameter_blocks,
+                                  double* const* values,
+                                  const int* sizes,
+                                  ParameterBlock** parameter_blocks);
+
+  // Checks that the new parameter block [values, values + size) does not
+  // overlap any of the parameter blocks in the problem, and records it in
+  // parameter_block_extents_.
+  void AddParameterBlockExtent(double* values, int size);
   void InternalSetManifold(double* values,
                            ParameterBlock* parameter_block,
                            Manifold* manifold);
@@ -188,6 +220,11 @@ class CERES_NO_EXPORT ProblemImpl {
   void DeleteBlock(ResidualBlock* residual_block);
   void DeleteBlock(ParameterBlock* parameter_block);
 
+  // Destroys a block and releases its memory, unless it lives in
+  // block_arena_, whose memory is released with the problem.
+  template <typename Block>
+  void DestroyBlock(Block* block);
+
   const Problem::Options options_;
 
   bool context_impl_owned_;
@@ -196,12 +233,27 @@ class CERES_NO_EXPORT ProblemImpl {
   // The mapping from user pointers to parameter blocks.
   ParameterMap parameter_block_map_;
 
+  // Iff safety checks are enabled, contains the size of each parameter block
+  // keyed by its user pointer. Unlike parameter_block_map_ it is ordered,
+  // which is needed to detect aliasing between parameter blocks.
+  std::map<double*, int> parameter_block_extents_;
+
   // Iff enable_fast_removal is enabled, contains the current residual blocks.
+  // Only used to check that a residual block is in the problem before removing
+  // it; the residual blocks that depend on a parameter block are always
+  // tracked by the parameter block itself.
   ResidualBlockSet residual_block_set_;
 
   // The actual parameter and residual blocks.
   std::unique_ptr<internal::Program> program_;
 
+  // Storage for the parameter and residual blocks added by
+  // AddParameterBlocks and AddResidualBlocks. Blocks added one at a time
+  // are allocated individually.
+  BlockArena block_arena_;
+
+  int64_t structure_version_ = 0;
+
   // TODO(sameeragarwal): Unify the shared object handling across object types.
   // Right now we are using vectors for Manifold objects and reference counting
   // for CostFunctions and LossFunctions. Ideally this should be done uniformly.
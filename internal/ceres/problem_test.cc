@@ -31,6 +31,7 @@
 
 #include "ceres/problem.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -47,6 +48,7 @@
 #include "ceres/parameter_block.h"
 #include "ceres/problem_impl.h"
 #include "ceres/program.h"
+#include "ceres/residual_block.h"
 #include "ceres/sized_cost_function.h"
 #include "ceres/sparse_matrix.h"
 #include "ceres/types.h"
@@ -266,6 +268,39 @@ TEST(Problem, AddParameterWithAliasedParametersDies) {
   ASSERT_EQ(5, problem.NumParameterBlocks());
 }
 
+TEST(Problem, AddParameterAfterRemovingAliasedParameter) {
+  Problem problem;
+  problem.AddParameterBlock(IntToPtr(5), 5);
+  problem.AddParameterBlock(IntToPtr(13), 3);
+
+  // Once the parameter block is removed, its memory may be reused by a new
+  // parameter block of a different size.
+  problem.RemoveParameterBlock(IntToPtr(5));
+  problem.AddParameterBlock(IntToPtr(4), 9);
+  EXPECT_DEATH_IF_SUPPORTED(problem.AddParameterBlock(IntToPtr(12), 2),
+                            "Aliasing detected");
+  ASSERT_EQ(2, problem.NumParameterBlocks());
+  EXPECT_EQ(9, problem.ParameterBlockSize(IntToPtr(4)));
+}
+
+TEST(Problem, GetParameterBlocksReturnsBlocksInProgramOrder) {
+  double x[3], y[4], z[5];
+
+  Problem problem;
+  problem.AddParameterBlock(z, 5);
+  problem.AddParameterBlock(x, 3);
+  problem.AddParameterBlock(y, 4);
+
+  std::vector<double*> parameter_blocks;
+  problem.GetParameterBlocks(&parameter_blocks);
+  EXPECT_EQ(parameter_blocks, std::vector<double*>({z, x, y}));
+
+  // Removing a parameter block moves the last one into its place.
+  problem.RemoveParameterBlock(z);
+  problem.GetParameterBlocks(&parameter_blocks);
+  EXPECT_EQ(parameter_blocks, std::vector<double*>({y, x}));
+}
+
 TEST(Problem, AddParameterIgnoresDuplicateCalls) {
   double x[3], y[4];
 
@@ -328,6 +363,167 @@ TEST(Problem, ReusedCostFunctionsAreOnlyDeletedOnce) {
   ASSERT_EQ(num_destructions, 1);
 }
 
+TEST(Problem, AddResidualBlocksMatchesAddResidualBlock) {
+  double x[3], y[4], z[5];
+
+  Problem problem;
+  Problem bulk_problem;
+
+  problem.AddParameterBlock(z, 5);
+  problem.AddResidualBlock(new UnaryCostFunction(2, 3), nullptr, x);
+  problem.AddResidualBlock(new BinaryCostFunction(2, 4, 3), nullptr, y, x);
+  problem.AddResidualBlock(new BinaryCostFunction(2, 3, 5), nullptr, x, z);
+
+  bulk_problem.AddParameterBlock(z, 5);
+  CostFunction* cost_functions[] = {new UnaryCostFunction(2, 3),
+                                    new BinaryCostFunction(2, 4, 3),
+                                    new BinaryCostFunction(2, 3, 5)};
+  double* parameter_blocks[] = {x, y, x, x, z};
+  ResidualBlockId residual_block_ids[3];
+  bulk_problem.AddResidualBlocks(
+      3, cost_functions, nullptr, parameter_blocks, residual_block_ids);
+
+  EXPECT_EQ(bulk_problem.NumParameterBlocks(), problem.NumParameterBlocks());
+  EXPECT_EQ(bulk_problem.NumParameters(), problem.NumParameters());
+  EXPECT_EQ(bulk_problem.NumResidualBlocks(), problem.NumResidualBlocks());
+  EXPECT_EQ(bulk_problem.NumResiduals(), problem.NumResiduals());
+
+  // The parameter blocks are added in the same order.
+  const Program& program = problem.mutable_impl()->program();
+  const Program& bulk_program = bulk_problem.mutable_impl()->program();
+  for (int i = 0; i < program.NumParameterBlocks(); ++i) {
+    EXPECT_EQ(bulk_program.parameter_blocks()[i]->user_state(),
+              program.parameter_blocks()[i]->user_state());
+    EXPECT_EQ(bulk_program.parameter_blocks()[i]->index(), i);
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(bulk_program.residual_blocks()[i], residual_block_ids[i]);
+    EXPECT_EQ(residual_block_ids[i]->index(), i);
+    EXPECT_EQ(bulk_problem.GetCostFunctionForResidualBlock(
+                  residual_block_ids[i]),
+              cost_functions[i]);
+    EXPECT_EQ(bulk_problem.GetLossFunctionForResidualBlock(
+                  residual_block_ids[i]),
+              nullptr);
+  }
+
+  std::vector<double*> residual_parameter_blocks;
+  bulk_problem.GetParameterBlocksForResidualBlock(residual_block_ids[1],
+                                                  &residual_parameter_blocks);
+  EXPECT_EQ(residual_parameter_blocks, std::vector<double*>({y, x}));
+
+  std::vector<ResidualBlockId> residual_blocks;
+  bulk_problem.GetResidualBlocksForParameterBlock(x, &residual_blocks);
+  EXPECT_EQ(residual_blocks.size(), 3);
+
+  double cost = 0.0;
+  double bulk_cost = 0.0;
+  std::vector<double> residuals;
+  std::vector<double> bulk_residuals;
+  EXPECT_TRUE(problem.Evaluate(
+      Problem::EvaluateOptions(), &cost, &residuals, nullptr, nullptr));
+  EXPECT_TRUE(bulk_problem.Evaluate(Problem::EvaluateOptions(),
+                                    &bulk_cost,
+                                    &bulk_residuals,
+                                    nullptr,
+                                    nullptr));
+  EXPECT_EQ(bulk_cost, cost);
+  EXPECT_EQ(bulk_residuals, residuals);
+}
+
+TEST(Problem, AddResidualBlocksWithLossFunctions) {
+  double x[3], y[4];
+
+  Problem problem;
+  LossFunction* loss_function = new TrivialLoss;
+  CostFunction* cost_functions[] = {new UnaryCostFunction(2, 3),
+                                    new UnaryCostFunction(2, 4)};
+  LossFunction* loss_functions[] = {loss_function, nullptr};
+  double* parameter_blocks[] = {x, y};
+  ResidualBlockId residual_block_ids[2];
+  problem.AddResidualBlocks(
+      2, cost_functions, loss_functions, parameter_blocks, residual_block_ids);
+
+  EXPECT_EQ(problem.GetLossFunctionForResidualBlock(residual_block_ids[0]),
+            loss_function);
+  EXPECT_EQ(problem.GetLossFunctionForResidualBlock(residual_block_ids[1]),
+            nullptr);
+}
+
+TEST(Problem, AddResidualBlocksWithDuplicateParametersDies) {
+  double x[3], z[5];
+
+  Problem problem;
+  CostFunction* cost_functions[] = {new BinaryCostFunction(2, 3, 5),
+                                    new BinaryCostFunction(2, 3, 3)};
+  double* parameter_blocks[] = {x, z, x, x};
+  EXPECT_DEATH_IF_SUPPORTED(
+      problem.AddResidualBlocks(
+          2, cost_functions, nullptr, parameter_blocks, nullptr),
+      "Duplicate parameter blocks");
+}
+
+TEST(Problem, AddResidualBlocksWithDifferentSizesOnTheSameVariableDies) {
+  double x[3], z[5];
+
+  Problem problem;
+  CostFunction* cost_functions[] = {new UnaryCostFunction(2, 3),
+                                    new BinaryCostFunction(2, 4, 5)};
+  double* parameter_blocks[] = {x, x, z};
+  EXPECT_DEATH_IF_SUPPORTED(
+      problem.AddResidualBlocks(
+          2, cost_functions, nullptr, parameter_blocks, nullptr),
+      "different block sizes");
+}
+
+TEST(Problem, AddParameterBlocksWithAliasedParametersDies) {
+  Problem problem;
+  problem.AddParameterBlock(IntToPtr(5), 5);
+
+  {
+    // Aliases the existing block.
+    double* values[] = {IntToPtr(10), IntToPtr(8)};
+    int sizes[] = {3, 3};
+    EXPECT_DEATH_IF_SUPPORTED(problem.AddParameterBlocks(2, values, sizes),
+                              "Aliasing detected");
+  }
+
+  {
+    // The new blocks alias each other.
+    double* values[] = {IntToPtr(12), IntToPtr(10)};
+    int sizes[] = {2, 3};
+    EXPECT_DEATH_IF_SUPPORTED(problem.AddParameterBlocks(2, values, sizes),
+                              "Aliasing detected");
+  }
+
+  // These ones should work, including the repeated and existing blocks.
+  double* values[] = {IntToPtr(13), IntToPtr(10), IntToPtr(2), IntToPtr(5),
+                      IntToPtr(10)};
+  int sizes[] = {3, 3, 3, 5, 3};
+  problem.AddParameterBlocks(5, values, sizes);
+  ASSERT_EQ(4, problem.NumParameterBlocks());
+  EXPECT_EQ(problem.ParameterBlockSize(IntToPtr(13)), 3);
+}
+
+TEST(Problem, CostFunctionsAddedInBulkAreOnlyDeletedOnce) {
+  double y[4], z[5];
+  int num_destructions = 0;
+
+  {
+    Problem problem;
+    CostFunction* cost = new DestructorCountingCostFunction(&num_destructions);
+    CostFunction* cost_functions[] = {cost, cost, cost};
+    double* parameter_blocks[] = {y, z, y, z, y, z};
+    problem.AddResidualBlocks(
+        3, cost_functions, nullptr, parameter_blocks, nullptr);
+    problem.AddResidualBlock(cost, nullptr, y, z);
+    EXPECT_EQ(4, problem.NumResidualBlocks());
+  }
+
+  ASSERT_EQ(num_destructions, 1);
+}
+
 TEST(Problem, GetCostFunctionForResidualBlock) {
   double x[3];
   Problem problem;
@@ -823,18 +1019,11 @@ TEST_P(DynamicProblem, RemoveResidualBlock) {
   ResidualBlock* r_z   = problem->AddResidualBlock(cost_z,   nullptr, z);
   ResidualBlock* r_w   = problem->AddResidualBlock(cost_w,   nullptr, w);
 
-  if (GetParam()) {
-    // In this test parameterization, there should be back-pointers from the
-    // parameter blocks to the residual blocks.
-    ExpectParameterBlockContains(y, r_yzw, r_yz, r_yw, r_y);
-    ExpectParameterBlockContains(z, r_yzw, r_yz, r_zw, r_z);
-    ExpectParameterBlockContains(w, r_yzw, r_yw, r_zw, r_w);
-  } else {
-    // Otherwise, nothing.
-    EXPECT_TRUE(GetParameterBlock(0)->mutable_residual_blocks() == nullptr);
-    EXPECT_TRUE(GetParameterBlock(1)->mutable_residual_blocks() == nullptr);
-    EXPECT_TRUE(GetParameterBlock(2)->mutable_residual_blocks() == nullptr);
-  }
+  // There should always be back-pointers from the parameter blocks to the
+  // residual blocks.
+  ExpectParameterBlockContains(y, r_yzw, r_yz, r_yw, r_y);
+  ExpectParameterBlockContains(z, r_yzw, r_yz, r_zw, r_z);
+  ExpectParameterBlockContains(w, r_yzw, r_yw, r_zw, r_w);
   EXPECT_EQ(3, problem->NumParameterBlocks());
   EXPECT_EQ(7, NumResidualBlocks());
 
@@ -844,11 +1033,9 @@ TEST_P(DynamicProblem, RemoveResidualBlock) {
   problem->RemoveResidualBlock(r_yzw);
   ASSERT_EQ(3, problem->NumParameterBlocks());
   ASSERT_EQ(6, NumResidualBlocks());
-  if (GetParam()) {
-    ExpectParameterBlockContains(y, r_yz, r_yw, r_y);
-    ExpectParameterBlockContains(z, r_yz, r_zw, r_z);
-    ExpectParameterBlockContains(w, r_yw, r_zw, r_w);
-  }
+  ExpectParameterBlockContains(y, r_yz, r_yw, r_y);
+  ExpectParameterBlockContains(z, r_yz, r_zw, r_z);
+  ExpectParameterBlockContains(w, r_yw, r_zw, r_w);
   ASSERT_TRUE (HasResidualBlock(r_yz ));
   ASSERT_TRUE (HasResidualBlock(r_yw ));
   ASSERT_TRUE (HasResidualBlock(r_zw ));
@@ -860,11 +1047,9 @@ TEST_P(DynamicProblem, RemoveResidualBlock) {
   problem->RemoveResidualBlock(r_yw);
   ASSERT_EQ(3, problem->NumParameterBlocks());
   ASSERT_EQ(5, NumResidualBlocks());
-  if (GetParam()) {
-    ExpectParameterBlockContains(y, r_yz, r_y);
-    ExpectParameterBlockContains(z, r_yz, r_zw, r_z);
-    ExpectParameterBlockContains(w, r_zw, r_w);
-  }
+  ExpectParameterBlockContains(y, r_yz, r_y);
+  ExpectParameterBlockContains(z, r_yz, r_zw, r_z);
+  ExpectParameterBlockContains(w, r_zw, r_w);
   ASSERT_TRUE (HasResidualBlock(r_yz ));
   ASSERT_TRUE (HasResidualBlock(r_zw ));
   ASSERT_TRUE (HasResidualBlock(r_y  ));
@@ -875,11 +1060,9 @@ TEST_P(DynamicProblem, RemoveResidualBlock) {
   problem->RemoveResidualBlock(r_zw);
   ASSERT_EQ(3, problem->NumParameterBlocks());
   ASSERT_EQ(4, NumResidualBlocks());
-  if (GetParam()) {
-    ExpectParameterBlockContains(y, r_yz, r_y);
-    ExpectParameterBlockContains(z, r_yz, r_z);
-    ExpectParameterBlockContains(w, r_w);
-  }
+  ExpectParameterBlockContains(y, r_yz, r_y);
+  ExpectParameterBlockContains(z, r_yz, r_z);
+  ExpectParameterBlockContains(w, r_w);
   ASSERT_TRUE (HasResidualBlock(r_yz ));
   ASSERT_TRUE (HasResidualBlock(r_y  ));
   ASSERT_TRUE (HasResidualBlock(r_z  ));
@@ -889,11 +1072,9 @@ TEST_P(DynamicProblem, RemoveResidualBlock) {
   problem->RemoveResidualBlock(r_w);
   ASSERT_EQ(3, problem->NumParameterBlocks());
   ASSERT_EQ(3, NumResidualBlocks());
-  if (GetParam()) {
-    ExpectParameterBlockContains(y, r_yz, r_y);
-    ExpectParameterBlockContains(z, r_yz, r_z);
-    ExpectParameterBlockContains(w);
-  }
+  ExpectParameterBlockContains(y, r_yz, r_y);
+  ExpectParameterBlockContains(z, r_yz, r_z);
+  ExpectParameterBlockContains(w);
   ASSERT_TRUE (HasResidualBlock(r_yz ));
   ASSERT_TRUE (HasResidualBlock(r_y  ));
   ASSERT_TRUE (HasResidualBlock(r_z  ));
@@ -902,11 +1083,9 @@ TEST_P(DynamicProblem, RemoveResidualBlock) {
   problem->RemoveResidualBlock(r_yz);
   ASSERT_EQ(3, problem->NumParameterBlocks());
   ASSERT_EQ(2, NumResidualBlocks());
-  if (GetParam()) {
-    ExpectParameterBlockContains(y, r_y);
-    ExpectParameterBlockContains(z, r_z);
-    ExpectParameterBlockContains(w);
-  }
+  ExpectParameterBlockContains(y, r_y);
+  ExpectParameterBlockContains(z, r_z);
+  ExpectParameterBlockContains(w);
   ASSERT_TRUE (HasResidualBlock(r_y  ));
   ASSERT_TRUE (HasResidualBlock(r_z  ));
 
@@ -915,15 +1094,96 @@ TEST_P(DynamicProblem, RemoveResidualBlock) {
   problem->RemoveResidualBlock(r_y);
   ASSERT_EQ(3, problem->NumParameterBlocks());
   ASSERT_EQ(0, NumResidualBlocks());
-  if (GetParam()) {
-    ExpectParameterBlockContains(y);
-    ExpectParameterBlockContains(z);
-    ExpectParameterBlockContains(w);
-  }
+  ExpectParameterBlockContains(y);
+  ExpectParameterBlockContains(z);
+  ExpectParameterBlockContains(w);
 
   // clang-format on
 }
 
+TEST_P(DynamicProblem, RemoveBlocksAddedInBulk) {
+  problem->AddParameterBlock(y, 4);
+
+  CostFunction* cost_functions[] = {new BinaryCostFunction(1, 4, 5),
+                                    new BinaryCostFunction(1, 4, 3),
+                                    new BinaryCostFunction(1, 5, 3),
+                                    new UnaryCostFunction(1, 3)};
+  double* parameter_blocks[] = {y, z, y, w, z, w, w};
+  ResidualBlockId r[4];
+  problem->AddResidualBlocks(4, cost_functions, nullptr, parameter_blocks, r);
+  ASSERT_EQ(3, problem->NumParameterBlocks());
+  ASSERT_EQ(4, NumResidualBlocks());
+  EXPECT_EQ(y, GetParameterBlock(0)->user_state());
+  EXPECT_EQ(z, GetParameterBlock(1)->user_state());
+  EXPECT_EQ(w, GetParameterBlock(2)->user_state());
+
+  ExpectParameterBlockContains(y, r[0], r[1]);
+  ExpectParameterBlockContains(z, r[0], r[2]);
+  ExpectParameterBlockContains(w, r[1], r[2], r[3]);
+
+  problem->RemoveResidualBlock(r[1]);
+  ASSERT_EQ(3, NumResidualBlocks());
+  EXPECT_FALSE(HasResidualBlock(r[1]));
+
+  problem->RemoveParameterBlock(z);
+  ASSERT_EQ(2, problem->NumParameterBlocks());
+  ASSERT_EQ(1, NumResidualBlocks());
+  EXPECT_TRUE(HasResidualBlock(r[3]));
+
+  // Mix blocks added one at a time with blocks added in bulk.
+  problem->AddResidualBlock(new BinaryCostFunction(1, 4, 5), nullptr, y, z);
+  ASSERT_EQ(3, problem->NumParameterBlocks());
+  ASSERT_EQ(2, NumResidualBlocks());
+
+  problem->RemoveParameterBlock(w);
+  problem->RemoveParameterBlock(y);
+  EXPECT_EQ(1, problem->NumParameterBlocks());
+  EXPECT_EQ(0, NumResidualBlocks());
+}
+
+// Adds and removes blocks like a sliding window smoother, keeping the
+// program indices consistent.
+TEST_P(DynamicProblem, SlidingWindow) {
+  constexpr int kNumStates = 20;
+  constexpr int kWindowSize = 4;
+  double states[kNumStates][3];
+
+  std::vector<ResidualBlockId> priors;
+  for (int i = 0; i < kNumStates; ++i) {
+    priors.push_back(problem->AddResidualBlock(
+        new UnaryCostFunction(1, 3), nullptr, states[i]));
+    if (i > 0) {
+      problem->AddResidualBlock(
+          new BinaryCostFunction(1, 3, 3), nullptr, states[i - 1], states[i]);
+    }
+    if (i >= kWindowSize) {
+      problem->RemoveResidualBlock(priors[i - kWindowSize]);
+      problem->RemoveParameterBlock(states[i - kWindowSize]);
+      EXPECT_FALSE(problem->HasParameterBlock(states[i - kWindowSize]));
+    }
+
+    const int num_states = std::min(i + 1, kWindowSize);
+    ASSERT_EQ(num_states, problem->NumParameterBlocks());
+    ASSERT_EQ(2 * num_states - 1, NumResidualBlocks());
+    for (int j = 0; j < problem->NumParameterBlocks(); ++j) {
+      EXPECT_EQ(j, GetParameterBlock(j)->index());
+      EXPECT_EQ(GetParameterBlock(j),
+                FindOrDie(problem->parameter_map(),
+                          GetParameterBlock(j)->mutable_user_state()));
+    }
+    for (int j = 0; j < NumResidualBlocks(); ++j) {
+      EXPECT_EQ(j, GetResidualBlock(j)->index());
+      EXPECT_TRUE(HasResidualBlock(GetResidualBlock(j)));
+    }
+  }
+
+  // The oldest state in the window lost its connection to the state
+  // before it.
+  ExpectSize(states[kNumStates - kWindowSize], 2);
+  ExpectSize(states[kNumStates - 1], 2);
+  ExpectSize(states[kNumStates - 2], 3);
+}
+
 TEST_P(DynamicProblem, RemoveInvalidResidualBlockDies) {
   problem->AddParameterBlock(y, 4);
   problem->AddParameterBlock(z, 5);
@@ -31,8 +31,10 @@
 #include "ceres/program.h"
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -58,6 +60,96 @@
 
 namespace ceres::internal {
 
+namespace {
+
+// Returns the smallest index i in [0, num_items) for which
+// is_invalid(thread_id, i) is true, or num_items if there is no such
+// index. The items are checked in parallel, but the result is the same
+// as that of a serial scan, so that the errors reported to the user do
+// not depend on the number of threads.
+template <typename IsInvalid>
+int FindFirstInvalidItem(ContextImpl* context,
+                         int num_threads,
+                         int num_items,
+                         IsInvalid&& is_invalid) {
+  std::atomic<int> first_invalid(num_items);
+  ParallelFor(context, 0, num_items, num_threads, [&](int thread_id, int i) {
+    int current = first_invalid.load(std::memory_order_relaxed);
+    if (i >= current || !is_invalid(thread_id, i)) {
+      return;
+    }
+    while (i < current && !first_invalid.compare_exchange_weak(current, i)) {
+    }
+  });
+  return first_invalid;
+}
+
+// Returns false if the parameter block is not feasible, i.e., it is
+// constant and its value violates its bounds, or it is variable and
+// its bounds define an empty feasible region. If message is not
+// nullptr, it is set to a human readable description of the problem.
+bool IsParameterBlockFeasible(const ParameterBlock* parameter_block,
+                              std::string* message) {
+  const double* parameters = parameter_block->user_state();
+  const int size = parameter_block->Size();
+  if (parameter_block->IsConstant()) {
+    // Constant parameter blocks must start in the feasible region
+    // to ultimately produce a feasible solution, since Ceres cannot
+    // change them.
+    for (int j = 0; j < size; ++j) {
+      const double lower_bound = parameter_block->LowerBoundForParameter(j);
+      const double upper_bound = parameter_block->UpperBoundForParameter(j);
+      if (parameters[j] < lower_bound || parameters[j] > upper_bound) {
+        if (message != nullptr) {
+          *message = absl::StrFormat(
+              "ParameterBlock: %p with size %d has at least one infeasible "
+              "value."
+              "\nFirst infeasible value is at index: %d."
+              "\nLower bound: %e, value: %e, upper bound: %e"
+              "\nParameter block values: ",
+              parameters,
+              size,
+              j,
+              lower_bound,
+              parameters[j],
+              upper_bound);
+          AppendArrayToString(size, parameters, message);
+        }
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Variable parameter blocks must have non-empty feasible
+  // regions, otherwise there is no way to produce a feasible
+  // solution.
+  for (int j = 0; j < size; ++j) {
+    const double lower_bound = parameter_block->LowerBoundForParameter(j);
+    const double upper_bound = parameter_block->UpperBoundForParameter(j);
+    if (lower_bound >= upper_bound) {
+      if (message != nullptr) {
+        *message = absl::StrFormat(
+            "ParameterBlock: %p with size %d has at least one infeasible "
+            "bound."
+            "\nFirst infeasible bound is at index: %d."
+            "\nLower bound: %e, upper bound: %e"
+            "\nParameter block values: ",
+            parameters,
+            size,
+            j,
+            lower_bound,
+            upper_bound);
+        AppendArrayToString(size, parameters, message);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 const std::vector<ParameterBlock*>& Program::parameter_blocks() const {
   return parameter_blocks_;
 }
@@ -191,25 +283,31 @@ bool Program::IsValid() const {
   return true;
 }
 
-bool Program::ParameterBlocksAreFinite(std::string* message) const {
+bool Program::ParameterBlocksAreFinite(ContextImpl* context,
+                                       int num_threads,
+                                       std::string* message) const {
   CHECK(message != nullptr);
-  for (auto* parameter_block : parameter_blocks_) {
-    const double* array = parameter_block->user_state();
-    const int size = parameter_block->Size();
-    const int invalid_index = FindInvalidValue(size, array);
-    if (invalid_index != size) {
-      *message = absl::StrFormat(
-          "ParameterBlock: %p with size %d has at least one invalid value.\n"
-          "First invalid value is at index: %d.\n"
-          "Parameter block values: ",
-          array,
-          size,
-          invalid_index);
-      AppendArrayToString(size, array, message);
-      return false;
-    }
+  const int invalid_block = FindFirstInvalidItem(
+      context, num_threads, parameter_blocks_.size(), [this](int, int i) {
+        const ParameterBlock* parameter_block = parameter_blocks_[i];
+        const int size = parameter_block->Size();
+        return FindInvalidValue(size, parameter_block->user_state()) != size;
+      });
+  if (invalid_block == parameter_blocks_.size()) {
+    return true;
   }
-  return true;
+
+  const double* array = parameter_blocks_[invalid_block]->user_state();
+  const int size = parameter_blocks_[invalid_block]->Size();
+  *message = absl::StrFormat(
+      "ParameterBlock: %p with size %d has at least one invalid value.\n"
+      "First invalid value is at index: %d.\n"
+      "Parameter block values: ",
+      array,
+      size,
+      FindInvalidValue(size, array));
+  AppendArrayToString(size, array, message);
+  return false;
 }
 
 bool Program::IsBoundsConstrained() const {
@@ -230,65 +328,25 @@ bool Program::IsBoundsConstrained() const {
   return false;
 }
 
-bool Program::IsFeasible(std::string* message) const {
+bool Program::IsFeasible(ContextImpl* context,
+                         int num_threads,
+                         std::string* message) const {
   CHECK(message != nullptr);
-  for (auto* parameter_block : parameter_blocks_) {
-    const double* parameters = parameter_block->user_state();
-    const int size = parameter_block->Size();
-    if (parameter_block->IsConstant()) {
-      // Constant parameter blocks must start in the feasible region
-      // to ultimately produce a feasible solution, since Ceres cannot
-      // change them.
-      for (int j = 0; j < size; ++j) {
-        const double lower_bound = parameter_block->LowerBoundForParameter(j);
-        const double upper_bound = parameter_block->UpperBoundForParameter(j);
-        if (parameters[j] < lower_bound || parameters[j] > upper_bound) {
-          *message = absl::StrFormat(
-              "ParameterBlock: %p with size %d has at least one infeasible "
-              "value."
-              "\nFirst infeasible value is at index: %d."
-              "\nLower bound: %e, value: %e, upper bound: %e"
-              "\nParameter block values: ",
-              parameters,
-              size,
-              j,
-              lower_bound,
-              parameters[j],
-              upper_bound);
-          AppendArrayToString(size, parameters, message);
-          return false;
-        }
-      }
-    } else {
-      // Variable parameter blocks must have non-empty feasible
-      // regions, otherwise there is no way to produce a feasible
-      // solution.
-      for (int j = 0; j < size; ++j) {
-        const double lower_bound = parameter_block->LowerBoundForParameter(j);
-        const double upper_bound = parameter_block->UpperBoundForParameter(j);
-        if (lower_bound >= upper_bound) {
-          *message = absl::StrFormat(
-              "ParameterBlock: %p with size %d has at least one infeasible "
-              "bound."
-              "\nFirst infeasible bound is at index: %d."
-              "\nLower bound: %e, upper bound: %e"
-              "\nParameter block values: ",
-              parameters,
-              size,
-              j,
-              lower_bound,
-              upper_bound);
-          AppendArrayToString(size, parameters, message);
-          return false;
-        }
-      }
-    }
+  const int infeasible_block = FindFirstInvalidItem(
+      context, num_threads, parameter_blocks_.size(), [this](int, int i) {
+        return !IsParameterBlockFeasible(parameter_blocks_[i], nullptr);
+      });
+  if (infeasible_block == parameter_blocks_.size()) {
+    return true;
   }
 
-  return true;
+  return IsParameterBlockFeasible(parameter_blocks_[infeasible_block],
+                                  message);
 }
 
 std::unique_ptr<Program> Program::CreateReducedProgram(
+    ContextImpl* context,
+    int num_threads,
     std::vector<double*>* removed_parameter_blocks,
     double* fixed_cost,
     std::string* error) const {
@@ -298,7 +356,7 @@ std::unique_ptr<Program> Program::CreateReducedProgram(
 
   std::unique_ptr<Program> reduced_program = std::make_unique<Program>(*this);
   if (!reduced_program->RemoveFixedBlocks(
-          removed_parameter_blocks, fixed_cost, error)) {
+          context, num_threads, removed_parameter_blocks, fixed_cost, error)) {
     return nullptr;
   }
 
@@ -306,49 +364,62 @@ std::unique_ptr<Program> Program::CreateReducedProgram(
   return reduced_program;
 }
 
-bool Program::RemoveFixedBlocks(std::vector<double*>* removed_parameter_blocks,
+bool Program::RemoveFixedBlocks(ContextImpl* context,
+                                int num_threads,
+                                std::vector<double*>* removed_parameter_blocks,
                                 double* fixed_cost,
                                 std::string* error) {
   CHECK(removed_parameter_blocks != nullptr);
   CHECK(fixed_cost != nullptr);
   CHECK(error != nullptr);
 
-  std::unique_ptr<double[]> residual_block_evaluate_scratch;
-  residual_block_evaluate_scratch =
-      std::make_unique<double[]>(MaxScratchDoublesNeededForEvaluate());
+  const int num_parameter_blocks = parameter_blocks_.size();
+  const int num_residual_blocks = residual_blocks_.size();
   *fixed_cost = 0.0;
 
-  bool need_to_call_prepare_for_evaluation = evaluation_callback_ != nullptr;
-
-  // Mark all the parameters as unused. Abuse the index member of the
-  // parameter blocks for the marking.
-  for (auto* parameter_block : parameter_blocks_) {
-    parameter_block->set_index(-1);
-  }
-
-  // Filter out residual that have all-constant parameters, and mark
-  // all the parameter blocks that appear in residuals.
-  int num_active_residual_blocks = 0;
-  for (int i = 0; i < residual_blocks_.size(); ++i) {
-    ResidualBlock* residual_block = residual_blocks_[i];
-    int num_parameter_blocks = residual_block->NumParameterBlocks();
-
-    // Determine if the residual block is fixed, and also mark varying
-    // parameters that appear in the residual block.
-    bool all_constant = true;
-    for (int k = 0; k < num_parameter_blocks; k++) {
-      ParameterBlock* parameter_block = residual_block->parameter_blocks()[k];
-      if (!parameter_block->IsConstant()) {
-        all_constant = false;
-        parameter_block->set_index(1);
-      }
-    }
+  // Number the parameter blocks, so that the parameter blocks that
+  // appear in residuals can be marked in the is_used array below. Abuse
+  // the index member of the parameter blocks for the numbering.
+  ParallelFor(context, 0, num_parameter_blocks, num_threads, [this](int i) {
+    parameter_blocks_[i]->set_index(i);
+  });
+
+  // A parameter block can appear in residual blocks processed by
+  // different threads, so the marks are atomic. Since every thread only
+  // ever sets them, relaxed stores are sufficient.
+  auto is_used = std::make_unique<std::atomic<bool>[]>(num_parameter_blocks);
+  ParallelFor(context, 0, num_parameter_blocks, num_threads, [&is_used](int i) {
+    is_used[i].store(false, std::memory_order_relaxed);
+  });
+
+  // Determine the residual blocks that have all-constant parameters,
+  // and mark all the varying parameter blocks that appear in residuals.
+  std::vector<char> is_fixed(num_residual_blocks);
+  ParallelFor(
+      context, 0, num_residual_blocks, num_threads, [&](int i) {
+        const ResidualBlock* residual_block = residual_blocks_[i];
+        ParameterBlock* const* parameter_blocks =
+            residual_block->parameter_blocks();
+        bool all_constant = true;
+        for (int k = 0; k < residual_block->NumParameterBlocks(); ++k) {
+          ParameterBlock* parameter_block = parameter_blocks[k];
+          if (!parameter_block->IsConstant()) {
+            all_constant = false;
+            is_used[parameter_block->index()].store(
+                true, std::memory_order_relaxed);
+          }
+        }
+        is_fixed[i] = all_constant;
+      });
 
-    if (!all_constant) {
-      residual_blocks_[num_active_residual_blocks++] = residual_block;
-      continue;
+  std::vector<int> fixed_residual_blocks;
+  for (int i = 0; i < num_residual_blocks; ++i) {
+    if (is_fixed[i]) {
+      fixed_residual_blocks.push_back(i);
     }
+  }
 
+  if (!fixed_residual_blocks.empty()) {
     // This is an exceedingly rare case, where the user has residual
     // blocks which are effectively constant but they are also
     // performance sensitive enough to add an EvaluationCallback.
@@ -365,42 +436,64 @@ bool Program::RemoveFixedBlocks(std::vector<double*>* removed_parameter_blocks,
     // evaluate_jacobians = true. We could try and optimize this here,
     // but given the rarity of this case, the additional complexity
     // and long range dependency is not worth it.
-    if (need_to_call_prepare_for_evaluation) {
+    if (evaluation_callback_ != nullptr) {
       constexpr bool kNewPoint = true;
       constexpr bool kDoNotEvaluateJacobians = false;
       evaluation_callback_->PrepareForEvaluation(kDoNotEvaluateJacobians,
                                                  kNewPoint);
-      need_to_call_prepare_for_evaluation = false;
     }
 
-    // The residual is constant and will be removed, so its cost is
-    // added to the variable fixed_cost.
-    double cost = 0.0;
-    if (!residual_block->Evaluate(true,
-                                  &cost,
-                                  nullptr,
-                                  nullptr,
-                                  residual_block_evaluate_scratch.get())) {
+    // The fixed residual blocks will be removed, so their costs are
+    // added to fixed_cost. The costs are evaluated in parallel, but
+    // summed in order so that fixed_cost does not depend on the number
+    // of threads.
+    const int num_fixed_residual_blocks = fixed_residual_blocks.size();
+    const int num_scratch_doubles = MaxScratchDoublesNeededForEvaluate();
+    std::vector<std::unique_ptr<double[]>> scratch(num_threads);
+    for (auto& thread_scratch : scratch) {
+      thread_scratch = std::make_unique<double[]>(num_scratch_doubles);
+    }
+    std::vector<double> costs(num_fixed_residual_blocks, 0.0);
+    const int failed_residual_block = FindFirstInvalidItem(
+        context,
+        num_threads,
+        num_fixed_residual_blocks,
+        [&](int thread_id, int i) {
+          return !residual_blocks_[fixed_residual_blocks[i]]->Evaluate(
+              true, &costs[i], nullptr, nullptr, scratch[thread_id].get());
+        });
+    if (failed_residual_block != num_fixed_residual_blocks) {
       *error = absl::StrFormat(
           "Evaluation of the residual %d failed during "
           "removal of fixed residual blocks.",
-          i);
+          fixed_residual_blocks[failed_residual_block]);
       return false;
     }
 
-    *fixed_cost += cost;
+    for (const double cost : costs) {
+      *fixed_cost += cost;
+    }
+  }
+
+  // Filter out the fixed residual blocks.
+  int num_active_residual_blocks = 0;
+  for (int i = 0; i < num_residual_blocks; ++i) {
+    if (!is_fixed[i]) {
+      residual_blocks_[num_active_residual_blocks++] = residual_blocks_[i];
+    }
   }
   residual_blocks_.resize(num_active_residual_blocks);
 
   // Filter out unused or fixed parameter blocks.
   int num_active_parameter_blocks = 0;
   removed_parameter_blocks->clear();
-  for (auto* parameter_block : parameter_blocks_) {
-    if (parameter_block->index() == -1) {
+  for (int i = 0; i < num_parameter_blocks; ++i) {
+    ParameterBlock* parameter_block = parameter_blocks_[i];
+    if (is_used[i].load(std::memory_order_relaxed)) {
+      parameter_blocks_[num_active_parameter_blocks++] = parameter_block;
+    } else {
       removed_parameter_blocks->push_back(
           parameter_block->mutable_user_state());
-    } else {
-      parameter_blocks_[num_active_parameter_blocks++] = parameter_block;
     }
   }
   parameter_blocks_.resize(num_active_parameter_blocks);
@@ -436,45 +529,57 @@ bool Program::IsParameterBlockSetIndependent(
 }
 
 std::unique_ptr<TripletSparseMatrix>
-Program::CreateJacobianBlockSparsityTranspose(int start_residual_block) const {
+Program::CreateJacobianBlockSparsityTranspose(int start_residual_block,
+                                              ContextImpl* context,
+                                              int num_threads) const {
   // Matrix to store the block sparsity structure of the Jacobian.
   const int num_rows = NumParameterBlocks();
   const int num_cols = NumResidualBlocks() - start_residual_block;
 
-  std::unique_ptr<TripletSparseMatrix> tsm(
-      new TripletSparseMatrix(num_rows, num_cols, 10 * num_cols));
-  int num_nonzeros = 0;
+  // Count the number of non-constant parameter blocks in each residual
+  // block, so that each residual block can write its entries in
+  // parallel starting at a known offset.
+  std::vector<int> offsets(num_cols + 1, 0);
+  ParallelFor(context, 0, num_cols, num_threads, [&](int c) {
+    const ResidualBlock* residual_block =
+        residual_blocks_[start_residual_block + c];
+    const int num_parameter_blocks = residual_block->NumParameterBlocks();
+    ParameterBlock* const* parameter_blocks =
+        residual_block->parameter_blocks();
+    int num_active_parameter_blocks = 0;
+    for (int j = 0; j < num_parameter_blocks; ++j) {
+      if (!parameter_blocks[j]->IsConstant()) {
+        ++num_active_parameter_blocks;
+      }
+    }
+    offsets[c + 1] = num_active_parameter_blocks;
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  const int num_nonzeros = offsets.back();
+  auto tsm =
+      std::make_unique<TripletSparseMatrix>(num_rows, num_cols, num_nonzeros);
   int* rows = tsm->mutable_rows();
   int* cols = tsm->mutable_cols();
   double* values = tsm->mutable_values();
 
-  for (int c = start_residual_block; c < residual_blocks_.size(); ++c) {
-    const ResidualBlock* residual_block = residual_blocks_[c];
+  ParallelFor(context, 0, num_cols, num_threads, [&](int c) {
+    const ResidualBlock* residual_block =
+        residual_blocks_[start_residual_block + c];
     const int num_parameter_blocks = residual_block->NumParameterBlocks();
     ParameterBlock* const* parameter_blocks =
         residual_block->parameter_blocks();
-
+    int nnz = offsets[c];
     for (int j = 0; j < num_parameter_blocks; ++j) {
       if (parameter_blocks[j]->IsConstant()) {
         continue;
       }
-
-      // Re-size the matrix if needed.
-      if (num_nonzeros >= tsm->max_num_nonzeros()) {
-        tsm->set_num_nonzeros(num_nonzeros);
-        tsm->Reserve(2 * num_nonzeros);
-        rows = tsm->mutable_rows();
-        cols = tsm->mutable_cols();
-        values = tsm->mutable_values();
-      }
-
-      const int r = parameter_blocks[j]->index();
-      rows[num_nonzeros] = r;
-      cols[num_nonzeros] = c - start_residual_block;
-      values[num_nonzeros] = 1.0;
-      ++num_nonzeros;
+      rows[nnz] = parameter_blocks[j]->index();
+      cols[nnz] = c;
+      values[nnz] = 1.0;
+      ++nnz;
     }
-  }
+  });
 
   tsm->set_num_nonzeros(num_nonzeros);
   return tsm;
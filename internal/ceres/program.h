@@ -109,7 +109,13 @@ class CERES_NO_EXPORT Program {
   // offsets) are correct.
   bool IsValid() const;
 
-  bool ParameterBlocksAreFinite(std::string* message) const;
+  // Returns false if any of the parameter blocks has a non-finite
+  // value, in which case message contains a description of the first
+  // such parameter block. The parameter blocks are checked in parallel
+  // using num_threads threads from context.
+  bool ParameterBlocksAreFinite(ContextImpl* context,
+                                int num_threads,
+                                std::string* message) const;
 
   // Returns true if the program has any non-constant parameter blocks
   // which have non-trivial bounds constraints.
@@ -117,8 +123,12 @@ class CERES_NO_EXPORT Program {
 
   // Returns false, if the program has any constant parameter blocks
   // which are not feasible, or any variable parameter blocks which
-  // have a lower bound greater than or equal to the upper bound.
-  bool IsFeasible(std::string* message) const;
+  // have a lower bound greater than or equal to the upper bound. The
+  // parameter blocks are checked in parallel using num_threads threads
+  // from context.
+  bool IsFeasible(ContextImpl* context,
+                  int num_threads,
+                  std::string* message) const;
 
   // Loop over each residual block and ensure that no two parameter
   // blocks in the same residual block are part of
@@ -133,8 +143,11 @@ class CERES_NO_EXPORT Program {
   //
   // start_residual_block which allows the user to ignore the first
   // start_residual_block residuals.
+  //
+  // The matrix is constructed in parallel using num_threads threads
+  // from context.
   std::unique_ptr<TripletSparseMatrix> CreateJacobianBlockSparsityTranspose(
-      int start_residual_block = 0) const;
+      int start_residual_block, ContextImpl* context, int num_threads) const;
 
   // Create a copy of this program and removes constant parameter
   // blocks and residual blocks with no varying parameter blocks while
@@ -149,7 +162,13 @@ class CERES_NO_EXPORT Program {
   // If there was a problem, then the function will return a nullptr
   // pointer and error will contain a human readable description of
   // the problem.
+  //
+  // The residual and parameter blocks are classified, and the costs of
+  // the removed residual blocks are evaluated, in parallel using
+  // num_threads threads from context.
   std::unique_ptr<Program> CreateReducedProgram(
+      ContextImpl* context,
+      int num_threads,
       std::vector<double*>* removed_parameter_blocks,
       double* fixed_cost,
       std::string* error) const;
@@ -182,7 +201,9 @@ class CERES_NO_EXPORT Program {
   //
   // If there was a problem, then the function will return false and
   // error will contain a human readable description of the problem.
-  bool RemoveFixedBlocks(std::vector<double*>* removed_parameter_blocks,
+  bool RemoveFixedBlocks(ContextImpl* context,
+                         int num_threads,
+                         std::vector<double*>* removed_parameter_blocks,
                          double* fixed_cost,
                          std::string* message);
 
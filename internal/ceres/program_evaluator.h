@@ -43,7 +43,14 @@
 // residual jacobians are written directly into their final position in the
 // block sparse matrix by the user's CostFunction; there is no copying.
 //
-// The evaluation is threaded with C++ threads.
+// The evaluation is threaded with C++ threads. When num_threads > 1, the
+// residual blocks are split between the threads using their measured
+// evaluation times, so that problems mixing cheap and expensive residual
+// blocks are balanced. The times are measured during the first evaluation and
+// then once every kNumEvaluationsPerCostMeasurement (16) evaluations, which
+// costs one clock read per residual block. Residual and jacobian evaluations
+// are measured and balanced separately. With a single thread, no times are
+// measured.
 //
 // The EvaluatePreparer and JacobianWriter interfaces are as follows:
 //
@@ -87,9 +94,11 @@
 // clang-format on
 
 #include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "absl/log/log.h"
@@ -100,6 +109,7 @@
 #include "ceres/parallel_for.h"
 #include "ceres/parallel_vector_ops.h"
 #include "ceres/parameter_block.h"
+#include "ceres/partition_range_for_parallel_for.h"
 #include "ceres/program.h"
 #include "ceres/residual_block.h"
 #include "ceres/small_blas.h"
@@ -182,82 +192,81 @@ class ProgramEvaluator final : public Evaluator {
     }
 
     const int num_residual_blocks = program_->NumResidualBlocks();
+    auto evaluate_residual_block = [&](int thread_id, int i) {
+      return EvaluateResidualBlock(thread_id,
+                                   i,
+                                   evaluate_options,
+                                   residuals,
+                                   gradient,
+                                   jacobian);
+    };
+
+    // The cost of evaluating a residual block can vary by orders of magnitude
+    // between residual blocks, so the residual blocks are not split evenly
+    // between the threads. Instead, the time taken by each residual block is
+    // measured periodically and the residual blocks are partitioned into
+    // contiguous ranges of approximately equal cost for the subsequent
+    // evaluations. Residual and jacobian evaluations have very different costs
+    // and are profiled separately.
+    WorkloadProfile& profile =
+        (gradient == nullptr && jacobian == nullptr) ? residual_profile_
+                                                     : jacobian_profile_;
+    const bool measure_costs =
+        options_.num_threads > 1 &&
+        profile.num_evaluations++ % kNumEvaluationsPerCostMeasurement == 0;
+    if (measure_costs) {
+      profile.costs.resize(num_residual_blocks);
+    }
+
     // This bool is used to disable the loop if an error is encountered without
     // breaking out of it. The remaining loop iterations are still run, but with
     // an empty body, and so will finish quickly.
     std::atomic_bool abort(false);
-    ParallelFor(
-        options_.context,
-        0,
-        num_residual_blocks,
-        options_.num_threads,
-        [&](int thread_id, int i) {
-          if (abort) {
-            return;
-          }
-
-          EvaluatePreparer* preparer = &evaluate_preparers_[thread_id];
-          EvaluateScratch* scratch = &evaluate_scratch_[thread_id];
-
-          // Prepare block residuals if requested.
-          const ResidualBlock* residual_block = program_->residual_blocks()[i];
-          double* block_residuals = nullptr;
-          if (residuals != nullptr) {
-            block_residuals = residuals + residual_layout_[i];
-          } else if (gradient != nullptr) {
-            block_residuals = scratch->residual_block_residuals.get();
-          }
-
-          // Prepare block jacobians if requested.
-          double** block_jacobians = nullptr;
-          if (jacobian != nullptr || gradient != nullptr) {
-            preparer->Prepare(residual_block,
-                              i,
-                              jacobian,
-                              scratch->jacobian_block_ptrs.get());
-            block_jacobians = scratch->jacobian_block_ptrs.get();
-          }
-
-          // Evaluate the cost, residuals, and jacobians.
-          double block_cost;
-          if (!residual_block->Evaluate(
-                  evaluate_options.apply_loss_function,
-                  &block_cost,
-                  block_residuals,
-                  block_jacobians,
-                  scratch->residual_block_evaluate_scratch.get())) {
+    auto evaluate_residual_blocks = [&](int thread_id,
+                                        std::tuple<int, int> range) {
+      const auto [start, end] = range;
+      if (!measure_costs) {
+        for (int i = start; i < end && !abort; ++i) {
+          if (!evaluate_residual_block(thread_id, i)) {
             abort = true;
-            return;
           }
+        }
+        return;
+      }
 
-          scratch->cost += block_cost;
-
-          // Store the jacobians, if they were requested.
-          if (jacobian != nullptr) {
-            jacobian_writer_.Write(
-                i, residual_layout_[i], block_jacobians, jacobian);
-          }
+      // Measuring the time between the ends of consecutive residual blocks
+      // requires one clock read per residual block.
+      auto previous_end = std::chrono::steady_clock::now();
+      for (int i = start; i < end && !abort; ++i) {
+        if (!evaluate_residual_block(thread_id, i)) {
+          abort = true;
+        }
+        const auto current_end = std::chrono::steady_clock::now();
+        profile.costs[i] =
+            std::chrono::duration<double>(current_end - previous_end).count();
+        previous_end = current_end;
+      }
+    };
+
+    if (profile.partitions.empty()) {
+      ParallelFor(options_.context,
+                  0,
+                  num_residual_blocks,
+                  options_.num_threads,
+                  evaluate_residual_blocks);
+    } else {
+      ParallelFor(options_.context,
+                  0,
+                  num_residual_blocks,
+                  options_.num_threads,
+                  evaluate_residual_blocks,
+                  profile.partitions);
+    }
 
-          // Compute and store the gradient, if it was requested.
-          if (gradient != nullptr) {
-            int num_residuals = residual_block->NumResiduals();
-            int num_parameter_blocks = residual_block->NumParameterBlocks();
-            for (int j = 0; j < num_parameter_blocks; ++j) {
-              const ParameterBlock* parameter_block =
-                  residual_block->parameter_blocks()[j];
-              if (parameter_block->IsConstant()) {
-                continue;
-              }
-
-              MatrixTransposeVectorMultiply<Eigen::Dynamic, Eigen::Dynamic, 1>(
-                  block_jacobians[j],
-                  num_residuals,
-                  parameter_block->TangentSize(),
-                  block_residuals,
-                  scratch->gradient.get() + parameter_block->delta_offset());
-            }
-          }
-        });
+    if (measure_costs && !abort) {
+      profile.partitions = PartitionRangeByCost(
+          profile.costs, options_.num_threads * kNumPartitionsPerThread);
+    }
 
     if (abort) {
       return false;
@@ -321,7 +330,38 @@ class ProgramEvaluator final : public Evaluator {
     return execution_summary_.statistics();
   }
 
+  // Boundaries of the cost balanced ranges of residual blocks used by
+  // evaluations with and without jacobians or gradients respectively. Empty
+  // until the costs of the residual blocks have been measured. Exposed for
+  // testing.
+  const std::vector<int>& jacobian_partitions() const {
+    return jacobian_profile_.partitions;
+  }
+  const std::vector<int>& residual_partitions() const {
+    return residual_profile_.partitions;
+  }
+
  private:
+  // Number of evaluations of each kind between two measurements of the cost of
+  // the residual blocks.
+  static constexpr int kNumEvaluationsPerCostMeasurement = 16;
+
+  // Number of cost balanced partitions of the residual blocks per thread.
+  // Using more than one partition per thread allows the dynamic scheduling in
+  // ParallelFor to absorb changes in the costs between two measurements.
+  static constexpr int kNumPartitionsPerThread = 4;
+
+  // Measured cost of the residual blocks and the resulting partition of the
+  // residual blocks, for one kind (residual or jacobian) of evaluation.
+  struct WorkloadProfile {
+    // Wall time in seconds spent on each residual block when last measured.
+    std::vector<double> costs;
+    // Boundaries of contiguous ranges of residual blocks of approximately equal
+    // cost. Empty until the costs have been measured.
+    std::vector<int> partitions;
+    int num_evaluations = 0;
+  };
+
   // Per-thread scratch space needed to evaluate and store each residual block.
   struct EvaluateScratch {
     void Init(int max_parameters_per_residual_block,
@@ -347,6 +387,74 @@ class ProgramEvaluator final : public Evaluator {
     std::unique_ptr<double*[]> jacobian_block_ptrs;
   };
 
+  // Evaluates the i-th residual block and accumulates its cost and gradient
+  // into the scratch space of thread_id.
+  bool EvaluateResidualBlock(int thread_id,
+                             int i,
+                             const Evaluator::EvaluateOptions& evaluate_options,
+                             double* residuals,
+                             double* gradient,
+                             SparseMatrix* jacobian) {
+    EvaluatePreparer* preparer = &evaluate_preparers_[thread_id];
+    EvaluateScratch* scratch = &evaluate_scratch_[thread_id];
+
+    // Prepare block residuals if requested.
+    const ResidualBlock* residual_block = program_->residual_blocks()[i];
+    double* block_residuals = nullptr;
+    if (residuals != nullptr) {
+      block_residuals = residuals + residual_layout_[i];
+    } else if (gradient != nullptr) {
+      block_residuals = scratch->residual_block_residuals.get();
+    }
+
+    // Prepare block jacobians if requested.
+    double** block_jacobians = nullptr;
+    if (jacobian != nullptr || gradient != nullptr) {
+      preparer->Prepare(
+          residual_block, i, jacobian, scratch->jacobian_block_ptrs.get());
+      block_jacobians = scratch->jacobian_block_ptrs.get();
+    }
+
+    // Evaluate the cost, residuals, and jacobians.
+    double block_cost;
+    if (!residual_block->Evaluate(
+            evaluate_options.apply_loss_function,
+            &block_cost,
+            block_residuals,
+            block_jacobians,
+            scratch->residual_block_evaluate_scratch.get())) {
+      return false;
+    }
+
+    scratch->cost += block_cost;
+
+    // Store the jacobians, if they were requested.
+    if (jacobian != nullptr) {
+      jacobian_writer_.Write(i, residual_layout_[i], block_jacobians, jacobian);
+    }
+
+    // Compute and store the gradient, if it was requested.
+    if (gradient != nullptr) {
+      int num_residuals = residual_block->NumResiduals();
+      int num_parameter_blocks = residual_block->NumParameterBlocks();
+      for (int j = 0; j < num_parameter_blocks; ++j) {
+        const ParameterBlock* parameter_block =
+            residual_block->parameter_blocks()[j];
+        if (parameter_block->IsConstant()) {
+          continue;
+        }
+
+        MatrixTransposeVectorMultiply<Eigen::Dynamic, Eigen::Dynamic, 1>(
+            block_jacobians[j],
+            num_residuals,
+            parameter_block->TangentSize(),
+            block_residuals,
+            scratch->gradient.get() + parameter_block->delta_offset());
+      }
+    }
+    return true;
+  }
+
   static void BuildResidualLayout(const Program& program,
                                   std::vector<int>* residual_layout) {
     const std::vector<ResidualBlock*>& residual_blocks =
@@ -387,6 +495,8 @@ class ProgramEvaluator final : public Evaluator {
   std::unique_ptr<EvaluatePreparer[]> evaluate_preparers_;
   std::unique_ptr<EvaluateScratch[]> evaluate_scratch_;
   std::vector<int> residual_layout_;
+  WorkloadProfile residual_profile_;
+  WorkloadProfile jacobian_profile_;
   int num_parameters_;
   ::ceres::internal::ExecutionSummary execution_summary_;
 };
@@ -37,6 +37,7 @@
 #include <utility>
 #include <vector>
 
+#include "ceres/context_impl.h"
 #include "ceres/internal/integer_sequence_algorithm.h"
 #include "ceres/problem_impl.h"
 #include "ceres/residual_block.h"
@@ -98,8 +99,11 @@ TEST(Program, RemoveFixedBlocksNothingConstant) {
   double fixed_cost = 0.0;
   std::string message;
   std::unique_ptr<Program> reduced_program(
-      problem.program().CreateReducedProgram(
-          &removed_parameter_blocks, &fixed_cost, &message));
+      problem.program().CreateReducedProgram(problem.context(),
+                                             1,
+                                             &removed_parameter_blocks,
+                                             &fixed_cost,
+                                             &message));
 
   EXPECT_EQ(reduced_program->NumParameterBlocks(), 3);
   EXPECT_EQ(reduced_program->NumResidualBlocks(), 3);
@@ -119,8 +123,11 @@ TEST(Program, RemoveFixedBlocksAllParameterBlocksConstant) {
   double fixed_cost = 0.0;
   std::string message;
   std::unique_ptr<Program> reduced_program(
-      problem.program().CreateReducedProgram(
-          &removed_parameter_blocks, &fixed_cost, &message));
+      problem.program().CreateReducedProgram(problem.context(),
+                                             1,
+                                             &removed_parameter_blocks,
+                                             &fixed_cost,
+                                             &message));
 
   EXPECT_EQ(reduced_program->NumParameterBlocks(), 0);
   EXPECT_EQ(reduced_program->NumResidualBlocks(), 0);
@@ -143,8 +150,11 @@ TEST(Program, RemoveFixedBlocksNoResidualBlocks) {
   double fixed_cost = 0.0;
   std::string message;
   std::unique_ptr<Program> reduced_program(
-      problem.program().CreateReducedProgram(
-          &removed_parameter_blocks, &fixed_cost, &message));
+      problem.program().CreateReducedProgram(problem.context(),
+                                             1,
+                                             &removed_parameter_blocks,
+                                             &fixed_cost,
+                                             &message));
   EXPECT_EQ(reduced_program->NumParameterBlocks(), 0);
   EXPECT_EQ(reduced_program->NumResidualBlocks(), 0);
   EXPECT_EQ(removed_parameter_blocks.size(), 3);
@@ -169,8 +179,11 @@ TEST(Program, RemoveFixedBlocksOneParameterBlockConstant) {
   double fixed_cost = 0.0;
   std::string message;
   std::unique_ptr<Program> reduced_program(
-      problem.program().CreateReducedProgram(
-          &removed_parameter_blocks, &fixed_cost, &message));
+      problem.program().CreateReducedProgram(problem.context(),
+                                             1,
+                                             &removed_parameter_blocks,
+                                             &fixed_cost,
+                                             &message));
   EXPECT_EQ(reduced_program->NumParameterBlocks(), 1);
   EXPECT_EQ(reduced_program->NumResidualBlocks(), 1);
 }
@@ -193,8 +206,11 @@ TEST(Program, RemoveFixedBlocksNumEliminateBlocks) {
   double fixed_cost = 0.0;
   std::string message;
   std::unique_ptr<Program> reduced_program(
-      problem.program().CreateReducedProgram(
-          &removed_parameter_blocks, &fixed_cost, &message));
+      problem.program().CreateReducedProgram(problem.context(),
+                                             1,
+                                             &removed_parameter_blocks,
+                                             &fixed_cost,
+                                             &message));
   EXPECT_EQ(reduced_program->NumParameterBlocks(), 2);
   EXPECT_EQ(reduced_program->NumResidualBlocks(), 2);
 }
@@ -225,8 +241,11 @@ TEST(Program, RemoveFixedBlocksFixedCost) {
   double fixed_cost = 0.0;
   std::string message;
   std::unique_ptr<Program> reduced_program(
-      problem.program().CreateReducedProgram(
-          &removed_parameter_blocks, &fixed_cost, &message));
+      problem.program().CreateReducedProgram(problem.context(),
+                                             1,
+                                             &removed_parameter_blocks,
+                                             &fixed_cost,
+                                             &message));
 
   EXPECT_EQ(reduced_program->NumParameterBlocks(), 2);
   EXPECT_EQ(reduced_program->NumResidualBlocks(), 2);
@@ -303,7 +322,8 @@ TEST_P(BlockJacobianTest, CreateJacobianBlockSparsityTranspose) {
 
   const int start_row_block = GetParam();
   std::unique_ptr<TripletSparseMatrix> actual_block_sparse_jacobian(
-      program->CreateJacobianBlockSparsityTranspose(start_row_block));
+      program->CreateJacobianBlockSparsityTranspose(
+          start_row_block, problem.context(), 1));
 
   Matrix expected_full_dense_jacobian;
   expected_block_sparse_jacobian.ToDenseMatrix(&expected_full_dense_jacobian);
@@ -336,11 +356,12 @@ class NumParameterBlocksCostFunction : public CostFunction {
   }
 };
 
-TEST(Program, ReallocationInCreateJacobianBlockSparsityTranspose) {
-  // CreateJacobianBlockSparsityTranspose starts with a conservative
-  // estimate of the size of the sparsity pattern. This test ensures
-  // that when those estimates are violated, the reallocation/resizing
-  // logic works correctly.
+TEST(Program, CreateJacobianBlockSparsityTransposeOfWideResidualBlock) {
+  // CreateJacobianBlockSparsityTranspose counts the entries in each
+  // column of the transpose, i.e., the parameter blocks of each residual
+  // block, and allocates exactly that many entries before filling them
+  // in. This test ensures that the counts and the fill agree when a
+  // single residual block depends on many parameter blocks.
 
   ProblemImpl problem;
   double x[20];
@@ -374,7 +395,7 @@ TEST(Program, ReallocationInCreateJacobianBlockSparsityTranspose) {
   program->SetParameterOffsetsAndIndex();
 
   std::unique_ptr<TripletSparseMatrix> actual_block_sparse_jacobian(
-      program->CreateJacobianBlockSparsityTranspose());
+      program->CreateJacobianBlockSparsityTranspose(0, problem.context(), 1));
 
   Matrix expected_dense_jacobian;
   expected_block_sparse_jacobian.ToDenseMatrix(&expected_dense_jacobian);
@@ -391,7 +412,8 @@ TEST(Program, ProblemHasNanParameterBlocks) {
   x[1] = std::numeric_limits<double>::quiet_NaN();
   problem.AddResidualBlock(new MockCostFunctionBase<1, 2>(), nullptr, x);
   std::string error;
-  EXPECT_FALSE(problem.program().ParameterBlocksAreFinite(&error));
+  EXPECT_FALSE(
+      problem.program().ParameterBlocksAreFinite(problem.context(), 1, &error));
   EXPECT_NE(error.find("has at least one invalid value"), std::string::npos)
       << error;
 }
@@ -403,7 +425,7 @@ TEST(Program, InfeasibleParameterBlock) {
   problem.SetParameterLowerBound(x, 0, 2.0);
   problem.SetParameterUpperBound(x, 0, 1.0);
   std::string error;
-  EXPECT_FALSE(problem.program().IsFeasible(&error));
+  EXPECT_FALSE(problem.program().IsFeasible(problem.context(), 1, &error));
   EXPECT_NE(error.find("infeasible bound"), std::string::npos) << error;
 }
 
@@ -415,9 +437,117 @@ TEST(Program, InfeasibleConstantParameterBlock) {
   problem.SetParameterUpperBound(x, 0, 2.0);
   problem.SetParameterBlockConstant(x);
   std::string error;
-  EXPECT_FALSE(problem.program().IsFeasible(&error));
+  EXPECT_FALSE(problem.program().IsFeasible(problem.context(), 1, &error));
   EXPECT_NE(error.find("infeasible value"), std::string::npos) << error;
 }
 
+// Creates a chain of parameter blocks, every kConstantStride-th of
+// which is constant, connected by unary and binary residual blocks.
+// Some of the residual blocks only depend on constant parameter blocks.
+constexpr int kNumParameterBlocks = 200;
+constexpr int kConstantStride = 7;
+
+void CreateChainProblem(std::vector<double>* x, ProblemImpl* problem) {
+  x->resize(kNumParameterBlocks);
+  for (int i = 0; i < kNumParameterBlocks; ++i) {
+    (*x)[i] = i + 1.0;
+    problem->AddResidualBlock(
+        new UnaryIdentityCostFunction(), nullptr, &(*x)[i]);
+    if (i > 0) {
+      problem->AddResidualBlock(
+          new BinaryCostFunction(), nullptr, &(*x)[i - 1], &(*x)[i]);
+    }
+  }
+  for (int i = 0; i < kNumParameterBlocks; i += kConstantStride) {
+    problem->SetParameterBlockConstant(&(*x)[i]);
+  }
+}
+
+TEST(Program, CreateReducedProgramInParallel) {
+  constexpr int kNumThreads = 4;
+  ProblemImpl problem;
+  std::vector<double> x;
+  CreateChainProblem(&x, &problem);
+  problem.context()->EnsureMinimumThreads(kNumThreads - 1);
+
+  std::vector<double*> expected_removed_parameter_blocks;
+  double expected_fixed_cost = 0.0;
+  std::string message;
+  std::unique_ptr<Program> expected_program(
+      problem.program().CreateReducedProgram(problem.context(),
+                                             1,
+                                             &expected_removed_parameter_blocks,
+                                             &expected_fixed_cost,
+                                             &message));
+  ASSERT_NE(expected_program, nullptr) << message;
+  const std::vector<ParameterBlock*> expected_parameter_blocks =
+      expected_program->parameter_blocks();
+  EXPECT_EQ(expected_program->NumParameterBlocks(),
+            kNumParameterBlocks -
+                (kNumParameterBlocks + kConstantStride - 1) / kConstantStride);
+  EXPECT_GT(expected_fixed_cost, 0.0);
+
+  std::vector<double*> removed_parameter_blocks;
+  double fixed_cost = 0.0;
+  std::unique_ptr<Program> reduced_program(
+      problem.program().CreateReducedProgram(problem.context(),
+                                             kNumThreads,
+                                             &removed_parameter_blocks,
+                                             &fixed_cost,
+                                             &message));
+  ASSERT_NE(reduced_program, nullptr) << message;
+  EXPECT_EQ(reduced_program->parameter_blocks(), expected_parameter_blocks);
+  EXPECT_EQ(reduced_program->residual_blocks(),
+            expected_program->residual_blocks());
+  EXPECT_EQ(removed_parameter_blocks, expected_removed_parameter_blocks);
+  // The costs of the fixed residual blocks are summed in the same order
+  // irrespective of the number of threads.
+  EXPECT_EQ(fixed_cost, expected_fixed_cost);
+}
+
+TEST(Program, CreateJacobianBlockSparsityTransposeInParallel) {
+  constexpr int kNumThreads = 4;
+  ProblemImpl problem;
+  std::vector<double> x;
+  CreateChainProblem(&x, &problem);
+  problem.context()->EnsureMinimumThreads(kNumThreads - 1);
+
+  Program* program = problem.mutable_program();
+  program->SetParameterOffsetsAndIndex();
+  for (int start_residual_block : {0, 5}) {
+    std::unique_ptr<TripletSparseMatrix> expected =
+        program->CreateJacobianBlockSparsityTranspose(
+            start_residual_block, problem.context(), 1);
+    std::unique_ptr<TripletSparseMatrix> actual =
+        program->CreateJacobianBlockSparsityTranspose(
+            start_residual_block, problem.context(), kNumThreads);
+    ASSERT_EQ(actual->num_nonzeros(), expected->num_nonzeros());
+    for (int i = 0; i < expected->num_nonzeros(); ++i) {
+      EXPECT_EQ(actual->rows()[i], expected->rows()[i]);
+      EXPECT_EQ(actual->cols()[i], expected->cols()[i]);
+      EXPECT_EQ(actual->values()[i], 1.0);
+    }
+  }
+}
+
+TEST(Program, ParameterBlocksAreFiniteInParallelReportsFirstInvalidBlock) {
+  constexpr int kNumThreads = 4;
+  ProblemImpl problem;
+  std::vector<double> x;
+  CreateChainProblem(&x, &problem);
+  problem.context()->EnsureMinimumThreads(kNumThreads - 1);
+  x[150] = std::numeric_limits<double>::quiet_NaN();
+  x[50] = std::numeric_limits<double>::infinity();
+
+  std::string expected_error;
+  EXPECT_FALSE(problem.program().ParameterBlocksAreFinite(
+      problem.context(), 1, &expected_error));
+  std::string error;
+  EXPECT_FALSE(problem.program().ParameterBlocksAreFinite(
+      problem.context(), kNumThreads, &error));
+  EXPECT_EQ(error, expected_error);
+  EXPECT_NE(error.find("inf"), std::string::npos) << error;
+}
+
 }  // namespace internal
 }  // namespace ceres
@@ -339,10 +339,15 @@ bool LexicographicallyOrderResidualBlocks(
 // Pre-order the columns corresponding to the Schur complement if
 // possible.
 static void ReorderSchurComplementColumnsUsingSuiteSparse(
-    const ParameterBlockOrdering& parameter_block_ordering, Program* program) {
+    const ParameterBlockOrdering& parameter_block_ordering,
+    ContextImpl* context,
+    int num_threads,
+    Program* program) {
 #ifdef CERES_NO_SUITESPARSE
   // "Void"ing values to avoid compiler warnings about unused parameters
   (void)parameter_block_ordering;
+  (void)context;
+  (void)num_threads;
   (void)program;
 #else
   SuiteSparse ss;
@@ -362,7 +367,7 @@ static void ReorderSchurComplementColumnsUsingSuiteSparse(
 
   // Compute a block sparse presentation of J'.
   std::unique_ptr<TripletSparseMatrix> tsm_block_jacobian_transpose(
-      program->CreateJacobianBlockSparsityTranspose());
+      program->CreateJacobianBlockSparsityTranspose(0, context, num_threads));
 
   cholmod_sparse* block_jacobian_transpose =
       ss.CreateSparseMatrix(tsm_block_jacobian_transpose.get());
@@ -385,10 +390,12 @@ static void ReorderSchurComplementColumnsUsingEigen(
     LinearSolverOrderingType ordering_type,
     const int size_of_first_elimination_group,
     const ProblemImpl::ParameterMap& /*parameter_map*/,
+    ContextImpl* context,
+    int num_threads,
     Program* program) {
 #if defined(CERES_USE_EIGEN_SPARSE)
   std::unique_ptr<TripletSparseMatrix> tsm_block_jacobian_transpose(
-      program->CreateJacobianBlockSparsityTranspose());
+      program->CreateJacobianBlockSparsityTranspose(0, context, num_threads));
   using SparseMatrix = Eigen::SparseMatrix<int>;
   const SparseMatrix block_jacobian =
       CreateBlockJacobian(*tsm_block_jacobian_transpose);
@@ -448,6 +455,8 @@ bool ReorderProgramForSchurTypeLinearSolver(
     const SparseLinearAlgebraLibraryType sparse_linear_algebra_library_type,
     const LinearSolverOrderingType linear_solver_ordering_type,
     const ProblemImpl::ParameterMap& parameter_map,
+    ContextImpl* context,
+    const int num_threads,
     ParameterBlockOrdering* parameter_block_ordering,
     Program* program,
     std::string* error) {
@@ -469,8 +478,9 @@ bool ReorderProgramForSchurTypeLinearSolver(
     // this means that the user wishes for Ceres to identify the
     // e_blocks, which we do by computing a maximal independent set.
     std::vector<ParameterBlock*> schur_ordering;
-    const int size_of_first_elimination_group =
-        ComputeStableSchurOrdering(*program, &schur_ordering);
+    program->SetParameterOffsetsAndIndex();
+    const int size_of_first_elimination_group = ComputeStableSchurOrdering(
+        *program, context, num_threads, &schur_ordering);
 
     CHECK_EQ(schur_ordering.size(), program->NumParameterBlocks())
         << "Congratulations, you found a Ceres bug! Please report this error "
@@ -523,12 +533,14 @@ bool ReorderProgramForSchurTypeLinearSolver(
       //
       // TODO(sameeragarwal): It maybe worth adding pre-ordering support for
       // nested dissection too.
-      ReorderSchurComplementColumnsUsingSuiteSparse(*parameter_block_ordering,
-                                                    program);
+      ReorderSchurComplementColumnsUsingSuiteSparse(
+          *parameter_block_ordering, context, num_threads, program);
     } else if (sparse_linear_algebra_library_type == EIGEN_SPARSE) {
       ReorderSchurComplementColumnsUsingEigen(linear_solver_ordering_type,
                                               size_of_first_elimination_group,
                                               parameter_map,
+                                              context,
+                                              num_threads,
                                               program);
     }
   }
@@ -544,6 +556,8 @@ bool ReorderProgramForSparseCholesky(
     const LinearSolverOrderingType linear_solver_ordering_type,
     const ParameterBlockOrdering& parameter_block_ordering,
     int start_row_block,
+    ContextImpl* context,
+    int num_threads,
     Program* program,
     std::string* error) {
   if (parameter_block_ordering.NumElements() != program->NumParameterBlocks()) {
@@ -557,7 +571,8 @@ bool ReorderProgramForSparseCholesky(
 
   // Compute a block sparse presentation of J'.
   std::unique_ptr<TripletSparseMatrix> tsm_block_jacobian_transpose(
-      program->CreateJacobianBlockSparsityTranspose(start_row_block));
+      program->CreateJacobianBlockSparsityTranspose(
+          start_row_block, context, num_threads));
 
   std::vector<int> ordering(program->NumParameterBlocks(), 0);
   std::vector<ParameterBlock*>& parameter_blocks =
@@ -73,11 +73,15 @@ CERES_NO_EXPORT bool LexicographicallyOrderResidualBlocks(
 //
 // Upon return, ordering contains the parameter block ordering that
 // was used to order the program.
+//
+// The maximal independent set is computed using num_threads threads.
 CERES_NO_EXPORT bool ReorderProgramForSchurTypeLinearSolver(
     LinearSolverType linear_solver_type,
     SparseLinearAlgebraLibraryType sparse_linear_algebra_library_type,
     LinearSolverOrderingType linear_solver_ordering_type,
     const ProblemImpl::ParameterMap& parameter_map,
+    ContextImpl* context,
+    int num_threads,
     ParameterBlockOrdering* parameter_block_ordering,
     Program* program,
     std::string* error);
@@ -92,11 +96,16 @@ CERES_NO_EXPORT bool ReorderProgramForSchurTypeLinearSolver(
 // fill-reducing ordering is available in the sparse linear algebra
 // library (SuiteSparse version >= 4.2.0) then the fill reducing
 // ordering will take it into account, otherwise it will be ignored.
+//
+// The sparsity structure of the Jacobian is computed using num_threads
+// threads.
 CERES_NO_EXPORT bool ReorderProgramForSparseCholesky(
     SparseLinearAlgebraLibraryType sparse_linear_algebra_library_type,
     LinearSolverOrderingType linear_solver_ordering_type,
     const ParameterBlockOrdering& parameter_block_ordering,
     int start_row_block,
+    ContextImpl* context,
+    int num_threads,
     Program* program,
     std::string* error);
 
@@ -195,6 +195,8 @@ class ReorderProgramForSparseCholeskyUsingSuiteSparseTest
                                                 ceres::AMD,
                                                 linear_solver_ordering,
                                                 0, /* use all rows */
+                                                problem_.context(),
+                                                1,
                                                 program,
                                                 &error));
     const std::vector<ParameterBlock*>& ordered_parameter_blocks =
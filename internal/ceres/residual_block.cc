@@ -58,13 +58,28 @@ ResidualBlock::ResidualBlock(
     int index)
     : cost_function_(cost_function),
       loss_function_(loss_function),
-      parameter_blocks_(
+      owned_parameter_blocks_(
           new ParameterBlock*[cost_function->parameter_block_sizes().size()]),
+      parameter_blocks_(owned_parameter_blocks_.get()),
       index_(index) {
   CHECK(cost_function_ != nullptr);
-  std::copy(parameter_blocks.begin(),
-            parameter_blocks.end(),
-            parameter_blocks_.get());
+  std::copy(
+      parameter_blocks.begin(), parameter_blocks.end(), parameter_blocks_);
+}
+
+ResidualBlock::ResidualBlock(const CostFunction* cost_function,
+                             const LossFunction* loss_function,
+                             ParameterBlock* const* parameter_blocks,
+                             ParameterBlock** parameter_block_storage,
+                             int index)
+    : cost_function_(cost_function),
+      loss_function_(loss_function),
+      parameter_blocks_(parameter_block_storage),
+      index_(index) {
+  CHECK(cost_function_ != nullptr);
+  std::copy(parameter_blocks,
+            parameter_blocks + cost_function->parameter_block_sizes().size(),
+            parameter_blocks_);
 }
 
 bool ResidualBlock::Evaluate(const bool apply_loss_function,
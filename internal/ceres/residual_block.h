@@ -76,6 +76,17 @@ class CERES_NO_EXPORT ResidualBlock {
                 const std::vector<ParameterBlock*>& parameter_blocks,
                 int index);
 
+  // Same as above, except that the parameter block pointers are copied into
+  // parameter_block_storage instead of an array owned by the residual block.
+  // parameter_block_storage must have room for NumParameterBlocks() pointers
+  // and outlive the residual block. This lets ProblemImpl::AddResidualBlocks
+  // allocate the storage for many residual blocks at once.
+  ResidualBlock(const CostFunction* cost_function,
+                const LossFunction* loss_function,
+                ParameterBlock* const* parameter_blocks,
+                ParameterBlock** parameter_block_storage,
+                int index);
+
   // Evaluates the residual term, storing the scalar cost in *cost, the residual
   // components in *residuals, and the jacobians between the parameters and
   // residuals in jacobians[i], in row-major order. If residuals is nullptr, the
@@ -112,7 +123,7 @@ class CERES_NO_EXPORT ResidualBlock {
   // Access the parameter blocks for this residual. The array has size
   // NumParameterBlocks().
   ParameterBlock* const* parameter_blocks() const {
-    return parameter_blocks_.get();
+    return parameter_blocks_;
   }
 
   // Number of variable blocks that this residual term depends on.
@@ -137,7 +148,10 @@ class CERES_NO_EXPORT ResidualBlock {
  private:
   const CostFunction* cost_function_;
   const LossFunction* loss_function_;
-  std::unique_ptr<ParameterBlock*[]> parameter_blocks_;
+  // Null if the parameter block pointers are stored outside of the residual
+  // block.
+  std::unique_ptr<ParameterBlock*[]> owned_parameter_blocks_;
+  ParameterBlock** parameter_blocks_;
 
   // The index of the residual, typically in a Program. This is only to permit
   // switching from a ResidualBlock* to an index in the Program's array, needed
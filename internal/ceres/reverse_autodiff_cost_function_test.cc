@@ -0,0 +1,321 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2024 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/reverse_autodiff_cost_function.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Eigen/Core"
+#include "ceres/dynamic_autodiff_cost_function.h"
+#include "ceres/internal/eigen.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+// Exercises the arithmetic operators and the mathematical functions
+// supported by ReverseScalar. Takes 3 parameter blocks of sizes 4, 3 and 2,
+// with all the parameters in (0.1, 0.9), and emits 5 residuals.
+struct MathFunctor {
+  template <typename T>
+  bool operator()(T const* const* parameters, T* residuals) const {
+    const T* x = parameters[0];
+    const T* y = parameters[1];
+    const T* z = parameters[2];
+    using std::abs;
+    using std::acos;
+    using std::asin;
+    using std::atan;
+    using std::atan2;
+    using std::cbrt;
+    using std::cos;
+    using std::cosh;
+    using std::exp;
+    using std::expm1;
+    using std::fmax;
+    using std::fmin;
+    using std::hypot;
+    using std::log;
+    using std::log10;
+    using std::log1p;
+    using std::log2;
+    using std::pow;
+    using std::sin;
+    using std::sinh;
+    using std::sqrt;
+    using std::tan;
+    using std::tanh;
+    residuals[0] = x[0] * y[0] - x[1] / y[1] + 2.0 * x[2] - x[3] / 3.0 +
+                   1.0 / z[0] - (-z[1]);
+    residuals[1] = sin(x[0]) * cos(y[0]) + exp(x[1]) * log(y[1]) +
+                   sqrt(x[2]) + tan(z[0]) + abs(x[3] - 0.5);
+    residuals[2] = atan2(x[0], y[2]) + hypot(x[1], z[1]) + pow(x[2], 2.5) +
+                   pow(2.0, y[0]) + pow(x[3], z[0]);
+    residuals[3] = asin(x[0]) + acos(y[1]) + atan(z[1]) + sinh(x[1]) +
+                   cosh(y[2]) + tanh(z[0]) + cbrt(x[2]) + log1p(y[0]) +
+                   expm1(x[3]) + log10(z[1]) + log2(y[2]);
+    T w = x[0];
+    w += y[0];
+    w *= z[0];
+    w -= x[1];
+    w /= y[1];
+    w += 1.0;
+    w *= 2.0;
+    if (w > x[2]) {
+      w = w - x[2];
+    }
+    residuals[4] = fmax(w, x[3]) + fmin(y[2], z[1]);
+    return true;
+  }
+};
+
+// Wide input, few output functor. Takes a single parameter block of size
+// 200 and emits two residuals.
+struct WideFunctor {
+  template <typename T>
+  bool operator()(T const* const* parameters, T* residuals) const {
+    const T* x = parameters[0];
+    residuals[0] = T(0.0);
+    residuals[1] = T(1.0);
+    for (int i = 0; i < 200; ++i) {
+      residuals[0] += x[i] * x[(i + 1) % 200];
+      residuals[1] *= (1.0 + 0.01 * x[i]);
+    }
+    return true;
+  }
+};
+
+// Checks that the residuals and Jacobians computed by
+// ReverseAutoDiffCostFunction match the ones computed by
+// DynamicAutoDiffCostFunction, for all the combinations of constant
+// parameter blocks.
+template <typename Functor>
+void ExpectMatchesForwardMode(const std::vector<int>& block_sizes,
+                              int num_residuals) {
+  ReverseAutoDiffCostFunction<Functor> reverse(new Functor);
+  DynamicAutoDiffCostFunction<Functor> forward(new Functor);
+  for (const int size : block_sizes) {
+    reverse.AddParameterBlock(size);
+    forward.AddParameterBlock(size);
+  }
+  reverse.SetNumResiduals(num_residuals);
+  forward.SetNumResiduals(num_residuals);
+
+  std::mt19937 prng;
+  std::uniform_real_distribution<double> distribution(0.1, 0.9);
+  const int num_blocks = block_sizes.size();
+  std::vector<std::vector<double>> parameters(num_blocks);
+  std::vector<double*> parameter_ptrs(num_blocks);
+  std::vector<std::vector<double>> reverse_jacobians(num_blocks);
+  std::vector<std::vector<double>> forward_jacobians(num_blocks);
+  for (int i = 0; i < num_blocks; ++i) {
+    parameters[i].resize(block_sizes[i]);
+    for (double& p : parameters[i]) {
+      p = distribution(prng);
+    }
+    parameter_ptrs[i] = parameters[i].data();
+    reverse_jacobians[i].resize(num_residuals * block_sizes[i]);
+    forward_jacobians[i].resize(num_residuals * block_sizes[i]);
+  }
+
+  for (int mask = 0; mask < (1 << num_blocks); ++mask) {
+    std::vector<double*> reverse_jacobian_ptrs(num_blocks, nullptr);
+    std::vector<double*> forward_jacobian_ptrs(num_blocks, nullptr);
+    for (int i = 0; i < num_blocks; ++i) {
+      if (mask & (1 << i)) {
+        reverse_jacobian_ptrs[i] = reverse_jacobians[i].data();
+        forward_jacobian_ptrs[i] = forward_jacobians[i].data();
+      }
+    }
+
+    Vector reverse_residuals(num_residuals);
+    Vector forward_residuals(num_residuals);
+    ASSERT_TRUE(reverse.Evaluate(parameter_ptrs.data(),
+                                 reverse_residuals.data(),
+                                 reverse_jacobian_ptrs.data()));
+    ASSERT_TRUE(forward.Evaluate(parameter_ptrs.data(),
+                                 forward_residuals.data(),
+                                 forward_jacobian_ptrs.data()));
+    EXPECT_LT((reverse_residuals - forward_residuals).norm(),
+              1e-14 * forward_residuals.norm());
+    for (int i = 0; i < num_blocks; ++i) {
+      if ((mask & (1 << i)) == 0) {
+        continue;
+      }
+      const ConstVectorRef reverse_jacobian(reverse_jacobians[i].data(),
+                                            reverse_jacobians[i].size());
+      const ConstVectorRef forward_jacobian(forward_jacobians[i].data(),
+                                            forward_jacobians[i].size());
+      EXPECT_LT((reverse_jacobian - forward_jacobian).norm(),
+                1e-13 * forward_jacobian.norm())
+          << "block " << i << " mask " << mask;
+    }
+  }
+}
+
+TEST(ReverseAutoDiffCostFunction, MathFunctionsMatchForwardMode) {
+  ExpectMatchesForwardMode<MathFunctor>({4, 3, 2}, 5);
+}
+
+TEST(ReverseAutoDiffCostFunction, WideFunctorMatchesForwardMode) {
+  ExpectMatchesForwardMode<WideFunctor>({200}, 2);
+}
+
+// Residuals which are constant or equal to a parameter.
+struct ConstantAndIdentityFunctor {
+  template <typename T>
+  bool operator()(T const* const* parameters, T* residuals) const {
+    residuals[0] = T(5.0);
+    residuals[1] = parameters[0][1];
+    residuals[2] = parameters[1][0] * 3.0;
+    return true;
+  }
+};
+
+TEST(ReverseAutoDiffCostFunction, ConstantAndIdentityResiduals) {
+  ReverseAutoDiffCostFunction<ConstantAndIdentityFunctor> cost_function;
+  cost_function.AddParameterBlock(2);
+  cost_function.AddParameterBlock(1);
+  cost_function.SetNumResiduals(3);
+
+  double x[2] = {1.0, 2.0};
+  double y[1] = {3.0};
+  double* parameters[2] = {x, y};
+  double residuals[3];
+  double jacobian_x[6];
+  double jacobian_y[3];
+  double* jacobians[2] = {jacobian_x, jacobian_y};
+  std::fill_n(jacobian_x, 6, -1.0);
+  std::fill_n(jacobian_y, 3, -1.0);
+  ASSERT_TRUE(cost_function.Evaluate(parameters, residuals, jacobians));
+
+  EXPECT_EQ(residuals[0], 5.0);
+  EXPECT_EQ(residuals[1], 2.0);
+  EXPECT_EQ(residuals[2], 9.0);
+  const double expected_jacobian_x[6] = {0.0, 0.0, 0.0, 1.0, 0.0, 0.0};
+  const double expected_jacobian_y[3] = {0.0, 0.0, 3.0};
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(jacobian_x[i], expected_jacobian_x[i]);
+  }
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(jacobian_y[i], expected_jacobian_y[i]);
+  }
+}
+
+// Uses ReverseScalar as the scalar type of Eigen matrices.
+struct EigenFunctor {
+  template <typename T>
+  bool operator()(T const* const* parameters, T* residuals) const {
+    Eigen::Map<const Eigen::Matrix<T, 3, 3>> m(parameters[0]);
+    Eigen::Map<const Eigen::Matrix<T, 3, 1>> v(parameters[1]);
+    Eigen::Map<Eigen::Matrix<T, 3, 1>> r(residuals);
+    r = m * v;
+    r(2) += v.norm();
+    return true;
+  }
+};
+
+TEST(ReverseAutoDiffCostFunction, EigenMatchesForwardMode) {
+  ExpectMatchesForwardMode<EigenFunctor>({9, 3}, 3);
+}
+
+struct FailingFunctor {
+  template <typename T>
+  bool operator()(T const* const* parameters, T* residuals) const {
+    residuals[0] = parameters[0][0];
+    return false;
+  }
+};
+
+TEST(ReverseAutoDiffCostFunction, FailingFunctor) {
+  ReverseAutoDiffCostFunction<FailingFunctor> cost_function;
+  cost_function.AddParameterBlock(1);
+  cost_function.SetNumResiduals(1);
+  double x = 1.0;
+  double* parameters[1] = {&x};
+  double residual;
+  double jacobian;
+  double* jacobians[1] = {&jacobian};
+  EXPECT_FALSE(cost_function.Evaluate(parameters, &residual, nullptr));
+  EXPECT_FALSE(cost_function.Evaluate(parameters, &residual, jacobians));
+  // The tape is released after a failed evaluation.
+  EXPECT_FALSE(cost_function.Evaluate(parameters, &residual, jacobians));
+}
+
+struct SquareFunctor {
+  template <typename T>
+  bool operator()(T const* const* parameters, T* residuals) const {
+    residuals[0] = parameters[0][0] * parameters[0][0];
+    return true;
+  }
+};
+
+// A functor which evaluates another ReverseAutoDiffCostFunction while its
+// own tape is being recorded.
+struct NestedFunctor {
+  NestedFunctor() {
+    square.AddParameterBlock(1);
+    square.SetNumResiduals(1);
+  }
+
+  template <typename T>
+  bool operator()(T const* const* parameters, T* residuals) const {
+    double value = 2.0;
+    double* square_parameters[1] = {&value};
+    double square_residual;
+    double square_jacobian;
+    double* square_jacobians[1] = {&square_jacobian};
+    if (!square.Evaluate(
+            square_parameters, &square_residual, square_jacobians)) {
+      return false;
+    }
+    residuals[0] = parameters[0][0] * square_jacobian;
+    return true;
+  }
+
+  ReverseAutoDiffCostFunction<SquareFunctor> square;
+};
+
+TEST(ReverseAutoDiffCostFunction, NestedEvaluation) {
+  ReverseAutoDiffCostFunction<NestedFunctor> cost_function;
+  cost_function.AddParameterBlock(1);
+  cost_function.SetNumResiduals(1);
+  double x = 3.0;
+  double* parameters[1] = {&x};
+  double residual;
+  double jacobian;
+  double* jacobians[1] = {&jacobian};
+  ASSERT_TRUE(cost_function.Evaluate(parameters, &residual, jacobians));
+  // The derivative of the inner cost function at 2 is 4.
+  EXPECT_EQ(residual, 12.0);
+  EXPECT_EQ(jacobian, 4.0);
+}
+
+}  // namespace ceres::internal
@@ -191,6 +191,14 @@ class CERES_NO_EXPORT SparseSchurComplementSolver final
   Vector* scratch_[4] = {nullptr, nullptr, nullptr, nullptr};
 };
 
+// Returns the pairs (i, j), i <= j, for which block (i, j) of the Schur
+// complement of the matrix with block structure bs is structurally
+// non-zero when its first num_eliminate_blocks column blocks are
+// eliminated. The blocks of the Schur complement are numbered from zero,
+// i.e., block i corresponds to column block num_eliminate_blocks + i of bs.
+CERES_NO_EXPORT std::set<std::pair<int, int>> SchurComplementBlockPairs(
+    const CompressedRowBlockStructure& bs, int num_eliminate_blocks);
+
 }  // namespace ceres::internal
 
 #include "ceres/internal/reenable_warnings.h"
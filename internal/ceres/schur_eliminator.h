@@ -31,9 +31,9 @@
 #ifndef CERES_INTERNAL_SCHUR_ELIMINATOR_H_
 #define CERES_INTERNAL_SCHUR_ELIMINATOR_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
-#include <mutex>
 #include <vector>
 
 #include "Eigen/Dense"
@@ -202,6 +202,23 @@ class CERES_NO_EXPORT SchurEliminatorBase {
                          BlockRandomAccessMatrix* lhs,
                          double* rhs) = 0;
 
+  // Same as Eliminate, except that if A_and_b_unchanged is true, the
+  // caller guarantees that A and b have the same values as in the
+  // previous call to this method, and only D differs. The
+  // eliminator may then reuse the products E'E, E'F, E'b and F'F it
+  // computed in that call, and only recompute the quantities which
+  // depend on D. The default implementation ignores A_and_b_unchanged.
+  // SchurEliminator stores these products when it uses more than one
+  // thread. With a single thread, it starts storing them once this
+  // method has been called with A_and_b_unchanged set to true, so the
+  // first such call recomputes them and later ones reuse them.
+  virtual void EliminateReusingProducts(const BlockSparseMatrixData& A,
+                                        const double* b,
+                                        const double* D,
+                                        bool A_and_b_unchanged,
+                                        BlockRandomAccessMatrix* lhs,
+                                        double* rhs);
+
   // Given values for the variables z in the F block of A, solve for
   // the optimal values of the variables y corresponding to the E
   // block in A.
@@ -242,6 +259,12 @@ class CERES_NO_EXPORT SchurEliminator final : public SchurEliminatorBase {
                  const double* D,
                  BlockRandomAccessMatrix* lhs,
                  double* rhs) final;
+  void EliminateReusingProducts(const BlockSparseMatrixData& A,
+                                const double* b,
+                                const double* D,
+                                bool A_and_b_unchanged,
+                                BlockRandomAccessMatrix* lhs,
+                                double* rhs) final;
   void BackSubstitute(const BlockSparseMatrixData& A,
                       const double* b,
                       const double* D,
@@ -319,6 +342,31 @@ class CERES_NO_EXPORT SchurEliminator final : public SchurEliminatorBase {
                                int row_block_index,
                                BlockRandomAccessMatrix* lhs);
 
+  // Zero lhs and rhs and add the f_block part of D'D to lhs.
+  void InitializeReducedSystem(const CompressedRowBlockStructure* bs,
+                               const double* D,
+                               BlockRandomAccessMatrix* lhs,
+                               double* rhs);
+
+  // Multi-threaded elimination. See the comment in the implementation
+  // of Eliminate for details. If reuse_products is true, the products
+  // of A and b stored by the previous call are used instead of being
+  // recomputed.
+  void InitParallelElimination(const CompressedRowBlockStructure* bs);
+  void EliminateInParallel(const BlockSparseMatrixData& A,
+                           const double* b,
+                           const double* D,
+                           bool reuse_products,
+                           BlockRandomAccessMatrix* lhs,
+                           double* rhs);
+  void FBlockUpdate(const BlockSparseMatrixData& A,
+                    const double* b,
+                    int thread_id,
+                    int f_block,
+                    bool reuse_products,
+                    BlockRandomAccessMatrix* lhs,
+                    double* rhs);
+
   int num_threads_;
   ContextImpl* context_;
   int num_eliminate_blocks_;
@@ -357,9 +405,59 @@ class CERES_NO_EXPORT SchurEliminator final : public SchurEliminatorBase {
   int buffer_size_;
   int uneliminated_row_begins_;
 
-  // Locks for the blocks in the right hand side of the reduced linear
-  // system.
-  std::vector<std::mutex*> rhs_locks_;
+  // The following are only used when num_threads_ > 1, or once
+  // EliminateReusingProducts has been asked to reuse the products.
+  //
+  // The storage for chunk i begins at chunk_storage_offsets_[i] in
+  // chunk_storage_, and holds E'F (laid out as described by
+  // chunk.buffer_layout), followed by (E'E + D'D)^{-1}, E'E and E'b,
+  // where D is restricted to the e_block of the chunk. The second phase
+  // of the elimination reads the E'F of every chunk, so the storage
+  // cannot be bounded by the number of threads. In total it is about as
+  // large as the values of A, and is kept until the next call to Init.
+  std::vector<int64_t> chunk_storage_offsets_;
+  std::unique_ptr<double[]> chunk_storage_;
+
+  // For each f_block, the blocks F'F of the Schur complement in its
+  // row, stored in compressed row format. The values of the block in
+  // column block2 begin at f_block_ftf_[i].offset in ftf_values_.
+  struct FTFBlock {
+    int block2;
+    int64_t offset;
+  };
+  std::vector<int> f_block_ftf_offsets_;
+  std::vector<FTFBlock> f_block_ftf_;
+  std::unique_ptr<double[]> ftf_values_;
+
+  // True if chunk_storage_ and ftf_values_ hold the products of the A
+  // and b passed to the last call to EliminateInParallel.
+  bool products_are_valid_ = false;
+  // True if EliminateReusingProducts has been called with
+  // A_and_b_unchanged set to true since the last call to Init.
+  bool reuse_requested_ = false;
+  // True if InitParallelElimination has been called since the last
+  // call to Init.
+  bool parallel_elimination_initialized_ = false;
+
+  // b - E(E'E)^{-1}E'b for the row blocks of A with an e_block,
+  // indexed by the row position of the row block.
+  std::unique_ptr<double[]> row_rhs_;
+
+  // For each f_block, the (row block, cell) pairs of A it occurs in
+  // and the chunks whose E'F it occurs in, stored in compressed row
+  // format.
+  struct FBlockCell {
+    int row_block;
+    int cell;
+  };
+  std::vector<int> f_block_cell_offsets_;
+  std::vector<FBlockCell> f_block_cells_;
+  std::vector<int> f_block_chunk_offsets_;
+  std::vector<int> f_block_chunks_;
+
+  // Cumulative cost of the updates to the first i f_blocks. Used to
+  // balance the work among the threads.
+  std::vector<int> f_block_cumulative_costs_;
 };
 
 // SchurEliminatorForOneFBlock specializes the SchurEliminatorBase interface for
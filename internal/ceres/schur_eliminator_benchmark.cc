@@ -159,6 +159,38 @@ static void BM_SchurEliminatorEliminate(benchmark::State& state) {
   }
 }
 
+static void BM_SchurEliminatorEliminateReusingProducts(
+    benchmark::State& state) {
+  const int num_e_blocks = state.range(0);
+  BenchmarkData data(num_e_blocks);
+
+  LinearSolver::Options linear_solver_options;
+  linear_solver_options.e_block_size = kEBlockSize;
+  linear_solver_options.row_block_size = kRowBlockSize;
+  linear_solver_options.f_block_size = kFBlockSize;
+  linear_solver_options.context = data.context();
+  linear_solver_options.num_threads = static_cast<int>(state.range(1));
+  data.context()->EnsureMinimumThreads(linear_solver_options.num_threads);
+  std::unique_ptr<SchurEliminatorBase> eliminator(
+      SchurEliminatorBase::Create(linear_solver_options));
+
+  eliminator->Init(num_e_blocks, true, data.matrix().block_structure());
+  eliminator->EliminateReusingProducts(BlockSparseMatrixData(data.matrix()),
+                                       data.b().data(),
+                                       data.diagonal().data(),
+                                       false,
+                                       data.mutable_lhs(),
+                                       data.mutable_rhs()->data());
+  for (auto _ : state) {
+    eliminator->EliminateReusingProducts(BlockSparseMatrixData(data.matrix()),
+                                         data.b().data(),
+                                         data.diagonal().data(),
+                                         true,
+                                         data.mutable_lhs(),
+                                         data.mutable_rhs()->data());
+  }
+}
+
 static void BM_SchurEliminatorBackSubstitute(benchmark::State& state) {
   const int num_e_blocks = state.range(0);
   BenchmarkData data(num_e_blocks);
@@ -221,6 +253,8 @@ static void BM_SchurEliminatorForOneFBlockBackSubstitute(
 }
 
 BENCHMARK(BM_SchurEliminatorEliminate)->Range(10, 10000);
+BENCHMARK(BM_SchurEliminatorEliminateReusingProducts)
+    ->Ranges({{10, 10000}, {1, 4}});
 BENCHMARK(BM_SchurEliminatorForOneFBlockEliminate)->Range(10, 10000);
 BENCHMARK(BM_SchurEliminatorBackSubstitute)->Range(10, 10000);
 BENCHMARK(BM_SchurEliminatorForOneFBlockBackSubstitute)->Range(10, 10000);
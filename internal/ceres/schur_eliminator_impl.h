@@ -51,7 +51,9 @@
 // clang-format on
 
 #include <algorithm>
+#include <iterator>
 #include <map>
+#include <numeric>
 
 #include "Eigen/Dense"
 #include "absl/container/fixed_array.h"
@@ -72,9 +74,8 @@
 namespace ceres::internal {
 
 template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
-SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::~SchurEliminator() {
-  STLDeleteElements(&rhs_locks_);
-}
+SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::~SchurEliminator() =
+    default;
 
 template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
 void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::Init(
@@ -166,20 +167,138 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::Init(
   chunk_outer_product_buffer_ =
       std::make_unique<double[]>(buffer_size_ * num_threads_);
 
-  STLDeleteElements(&rhs_locks_);
-  rhs_locks_.resize(num_col_blocks - num_eliminate_blocks_);
-  for (int i = 0; i < num_col_blocks - num_eliminate_blocks_; ++i) {
-    rhs_locks_[i] = new std::mutex;
+  products_are_valid_ = false;
+  reuse_requested_ = false;
+  parallel_elimination_initialized_ = false;
+  if (num_threads_ > 1) {
+    InitParallelElimination(bs);
   }
 }
 
 template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
-void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::Eliminate(
-    const BlockSparseMatrixData& A,
-    const double* b,
-    const double* D,
-    BlockRandomAccessMatrix* lhs,
-    double* rhs) {
+void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
+    InitParallelElimination(const CompressedRowBlockStructure* bs) {
+  const int num_col_blocks = bs->cols.size();
+  const int num_row_blocks = bs->rows.size();
+  const int num_f_blocks = num_col_blocks - num_eliminate_blocks_;
+  const int num_chunks = chunks_.size();
+
+  // Storage for E'F, (E'E + D'D)^{-1}, E'E and E'b of every chunk.
+  chunk_storage_offsets_.resize(num_chunks + 1);
+  chunk_storage_offsets_[0] = 0;
+  for (int i = 0; i < num_chunks; ++i) {
+    const Chunk& chunk = chunks_[i];
+    const int e_block_id = bs->rows[chunk.start].cells.front().block_id;
+    const int e_block_size = bs->cols[e_block_id].size;
+    int buffer_size = 0;
+    for (const auto& [f_block_id, offset] : chunk.buffer_layout) {
+      buffer_size = std::max(
+          buffer_size, offset + e_block_size * bs->cols[f_block_id].size);
+    }
+    chunk_storage_offsets_[i + 1] = chunk_storage_offsets_[i] + buffer_size +
+                                    2 * e_block_size * e_block_size +
+                                    e_block_size;
+  }
+  chunk_storage_ = std::make_unique<double[]>(chunk_storage_offsets_.back());
+
+  const CompressedRow& last_eliminated_row =
+      bs->rows[uneliminated_row_begins_ - 1];
+  row_rhs_ = std::make_unique<double[]>(last_eliminated_row.block.position +
+                                        last_eliminated_row.block.size);
+
+  // Invert the row block -> f_block and chunk -> f_block relations.
+  f_block_cell_offsets_.assign(num_f_blocks + 1, 0);
+  for (int r = 0; r < num_row_blocks; ++r) {
+    const std::vector<Cell>& cells = bs->rows[r].cells;
+    for (int c = (r < uneliminated_row_begins_) ? 1 : 0; c < cells.size();
+         ++c) {
+      ++f_block_cell_offsets_[cells[c].block_id - num_eliminate_blocks_ + 1];
+    }
+  }
+  std::partial_sum(f_block_cell_offsets_.begin(),
+                   f_block_cell_offsets_.end(),
+                   f_block_cell_offsets_.begin());
+
+  f_block_chunk_offsets_.assign(num_f_blocks + 1, 0);
+  for (const Chunk& chunk : chunks_) {
+    for (const auto& f_block : chunk.buffer_layout) {
+      ++f_block_chunk_offsets_[f_block.first - num_eliminate_blocks_ + 1];
+    }
+  }
+  std::partial_sum(f_block_chunk_offsets_.begin(),
+                   f_block_chunk_offsets_.end(),
+                   f_block_chunk_offsets_.begin());
+
+  // The cost of an f_block is estimated by the number of block
+  // products FBlockUpdate computes for it.
+  std::vector<int> f_block_costs(num_f_blocks, 1);
+  std::vector<int> next(f_block_cell_offsets_.begin(),
+                        f_block_cell_offsets_.end() - 1);
+  f_block_cells_.resize(f_block_cell_offsets_.back());
+  for (int r = 0; r < num_row_blocks; ++r) {
+    const std::vector<Cell>& cells = bs->rows[r].cells;
+    for (int c = (r < uneliminated_row_begins_) ? 1 : 0; c < cells.size();
+         ++c) {
+      const int f_block = cells[c].block_id - num_eliminate_blocks_;
+      f_block_cells_[next[f_block]++] = {r, c};
+      f_block_costs[f_block] += cells.size() - c;
+    }
+  }
+
+  next.assign(f_block_chunk_offsets_.begin(), f_block_chunk_offsets_.end() - 1);
+  f_block_chunks_.resize(f_block_chunk_offsets_.back());
+  for (int i = 0; i < num_chunks; ++i) {
+    const BufferLayoutType& buffer_layout = chunks_[i].buffer_layout;
+    for (auto it = buffer_layout.begin(); it != buffer_layout.end(); ++it) {
+      const int f_block = it->first - num_eliminate_blocks_;
+      f_block_chunks_[next[f_block]++] = i;
+      f_block_costs[f_block] += std::distance(it, buffer_layout.end()) + 1;
+    }
+  }
+
+  f_block_cumulative_costs_.resize(num_f_blocks);
+  std::partial_sum(f_block_costs.begin(),
+                   f_block_costs.end(),
+                   f_block_cumulative_costs_.begin());
+
+  // The distinct blocks of F'F in the row of each f_block.
+  f_block_ftf_offsets_.resize(num_f_blocks + 1);
+  f_block_ftf_offsets_[0] = 0;
+  f_block_ftf_.clear();
+  int64_t ftf_values_size = 0;
+  std::vector<int> blocks2;
+  for (int f_block = 0; f_block < num_f_blocks; ++f_block) {
+    blocks2.clear();
+    for (int k = f_block_cell_offsets_[f_block];
+         k < f_block_cell_offsets_[f_block + 1];
+         ++k) {
+      const std::vector<Cell>& cells =
+          bs->rows[f_block_cells_[k].row_block].cells;
+      for (int j = f_block_cells_[k].cell; j < cells.size(); ++j) {
+        blocks2.push_back(cells[j].block_id - num_eliminate_blocks_);
+      }
+    }
+    std::sort(blocks2.begin(), blocks2.end());
+    blocks2.erase(std::unique(blocks2.begin(), blocks2.end()), blocks2.end());
+
+    const int f_block_size = bs->cols[f_block + num_eliminate_blocks_].size;
+    for (const int block2 : blocks2) {
+      f_block_ftf_.push_back({block2, ftf_values_size});
+      ftf_values_size +=
+          f_block_size * bs->cols[block2 + num_eliminate_blocks_].size;
+    }
+    f_block_ftf_offsets_[f_block + 1] = f_block_ftf_.size();
+  }
+  ftf_values_ = std::make_unique<double[]>(ftf_values_size);
+  parallel_elimination_initialized_ = true;
+}
+
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
+    InitializeReducedSystem(const CompressedRowBlockStructure* bs,
+                            const double* D,
+                            BlockRandomAccessMatrix* lhs,
+                            double* rhs) {
   if (lhs->num_rows() > 0) {
     lhs->SetZero();
     if (rhs) {
@@ -187,7 +306,6 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::Eliminate(
     }
   }
 
-  const CompressedRowBlockStructure* bs = A.block_structure();
   const int num_col_blocks = bs->cols.size();
 
   // Add the diagonal to the schur complement.
@@ -211,6 +329,30 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::Eliminate(
                   }
                 });
   }
+}
+
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::Eliminate(
+    const BlockSparseMatrixData& A,
+    const double* b,
+    const double* D,
+    BlockRandomAccessMatrix* lhs,
+    double* rhs) {
+  const CompressedRowBlockStructure* bs = A.block_structure();
+  InitializeReducedSystem(bs, D, lhs, rhs);
+
+  // With multiple threads, distinct chunks may update the same blocks
+  // of the Schur complement, as do the rows without an e_block. So the
+  // multi-threaded elimination partitions the work by the row blocks
+  // of the Schur complement instead, with every update to a row block
+  // computed by the thread which owns it, and no locking is needed.
+  if (num_threads_ > 1) {
+    EliminateInParallel(A, b, D, /*reuse_products=*/false, lhs, rhs);
+    // E'b is only computed if b is not null.
+    products_are_valid_ = (b != nullptr);
+    return;
+  }
+  products_are_valid_ = false;
 
   // Eliminate y blocks one chunk at a time.  For each chunk, compute
   // the entries of the normal equations and the gradient vector block
@@ -303,6 +445,286 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::Eliminate(
   NoEBlockRowsUpdate(A, b, uneliminated_row_begins_, lhs, rhs);
 }
 
+// When A and b do not change between calls, e.g. when a trust region
+// step is rejected, the products E'E, E'F, E'b and F'F do not change
+// either. The two phase elimination stores them in its per chunk and
+// per f_block storage, so reusing them leaves the inversion of the
+// damped E'E blocks, the products with these inverses and the rhs to be
+// computed. The single threaded elimination does not store them. So
+// with num_threads_ == 1, once the caller has asked for the products to
+// be reused, this method switches to the two phase elimination, which
+// allocates its storage on first use, and stores the products from
+// then on. Callers which never ask for reuse do not pay for it.
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
+    EliminateReusingProducts(const BlockSparseMatrixData& A,
+                             const double* b,
+                             const double* D,
+                             bool A_and_b_unchanged,
+                             BlockRandomAccessMatrix* lhs,
+                             double* rhs) {
+  reuse_requested_ = reuse_requested_ || A_and_b_unchanged;
+  if (num_threads_ == 1 && !reuse_requested_) {
+    Eliminate(A, b, D, lhs, rhs);
+    return;
+  }
+
+  const CompressedRowBlockStructure* bs = A.block_structure();
+  if (!parallel_elimination_initialized_) {
+    InitParallelElimination(bs);
+  }
+  const bool reuse_products = A_and_b_unchanged && products_are_valid_;
+  InitializeReducedSystem(bs, D, lhs, rhs);
+  EliminateInParallel(A, b, D, reuse_products, lhs, rhs);
+  // E'b is only computed if b is not null.
+  products_are_valid_ = (b != nullptr);
+}
+
+// The multi-threaded elimination proceeds in two phases. The first
+// phase computes E'E, E'b, E'F, the inverse of E'E + D'D and
+// b - E(E'E + D'D)^{-1}E'b for each chunk into storage private to the
+// chunk. The second phase computes the row blocks of the Schur
+// complement and the rhs, one f_block at a time, reading the results
+// of the first phase.
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
+    EliminateInParallel(const BlockSparseMatrixData& A,
+                        const double* b,
+                        const double* D,
+                        bool reuse_products,
+                        BlockRandomAccessMatrix* lhs,
+                        double* rhs) {
+  const CompressedRowBlockStructure* bs = A.block_structure();
+  const double* values = A.values();
+
+  ParallelFor(context_, 0, int(chunks_.size()), num_threads_, [&](int i) {
+    const Chunk& chunk = chunks_[i];
+    const int e_block_id = bs->rows[chunk.start].cells.front().block_id;
+    const int e_block_size = bs->cols[e_block_id].size;
+    double* buffer = chunk_storage_.get() + chunk_storage_offsets_[i];
+    double* g =
+        chunk_storage_.get() + chunk_storage_offsets_[i + 1] - e_block_size;
+    double* undamped_ete = g - e_block_size * e_block_size;
+    double* inverse_ete = undamped_ete - e_block_size * e_block_size;
+
+    if (!reuse_products) {
+      std::fill(buffer, inverse_ete, 0.0);
+      std::fill(g, g + e_block_size, 0.0);
+      typename EigenTypes<kEBlockSize, kEBlockSize>::Matrix ete(e_block_size,
+                                                                e_block_size);
+      ete.setZero();
+      ChunkDiagonalBlockAndGradient(
+          chunk, A, b, chunk.start, &ete, g, buffer, nullptr);
+      typename EigenTypes<kEBlockSize, kEBlockSize>::MatrixRef(
+          undamped_ete, e_block_size, e_block_size) = ete;
+    }
+
+    typename EigenTypes<kEBlockSize, kEBlockSize>::Matrix ete =
+        typename EigenTypes<kEBlockSize, kEBlockSize>::ConstMatrixRef(
+            undamped_ete, e_block_size, e_block_size);
+    if (D != nullptr) {
+      const typename EigenTypes<kEBlockSize>::ConstVectorRef diag(
+          D + bs->cols[e_block_id].position, e_block_size);
+      ete.diagonal() += diag.array().square().matrix();
+    }
+    typename EigenTypes<kEBlockSize, kEBlockSize>::MatrixRef(
+        inverse_ete, e_block_size, e_block_size) =
+        InvertPSDMatrix<kEBlockSize>(assume_full_rank_ete_, ete);
+
+    if (rhs) {
+      absl::FixedArray<double> inverse_ete_g(e_block_size);
+      MatrixVectorMultiply<kEBlockSize, kEBlockSize, 0>(
+          inverse_ete, e_block_size, e_block_size, g, inverse_ete_g.data());
+      for (int j = 0; j < chunk.size; ++j) {
+        const CompressedRow& row = bs->rows[chunk.start + j];
+        double* sj = row_rhs_.get() + row.block.position;
+        typename EigenTypes<kRowBlockSize>::VectorRef(sj, row.block.size) =
+            typename EigenTypes<kRowBlockSize>::ConstVectorRef(
+                b + row.block.position, row.block.size);
+        // clang-format off
+        MatrixVectorMultiply<kRowBlockSize, kEBlockSize, -1>(
+            values + row.cells.front().position, row.block.size, e_block_size,
+            inverse_ete_g.data(), sj);
+        // clang-format on
+      }
+    }
+  });
+
+  ParallelFor(
+      context_,
+      0,
+      int(f_block_cumulative_costs_.size()),
+      num_threads_,
+      [&](int thread_id, int f_block) {
+        FBlockUpdate(A, b, thread_id, f_block, reuse_products, lhs, rhs);
+      },
+      f_block_cumulative_costs_.data(),
+      [](const int cost) { return cost; });
+}
+
+// Compute row block f_block of the Schur complement
+//
+//   S = F'F - F'E(E'E)^{-1}E'F
+//
+// and the rhs
+//
+//   F'b - F'E(E'E)^{-1}E'b
+//
+// using the per chunk quantities computed by EliminateInParallel.
+template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
+void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::FBlockUpdate(
+    const BlockSparseMatrixData& A,
+    const double* b,
+    int thread_id,
+    int f_block,
+    bool reuse_products,
+    BlockRandomAccessMatrix* lhs,
+    double* rhs) {
+  const CompressedRowBlockStructure* bs = A.block_structure();
+  const double* values = A.values();
+  const int f_block_id = f_block + num_eliminate_blocks_;
+  const int f_block_size = bs->cols[f_block_id].size;
+  const auto ftf_begin = f_block_ftf_.begin() + f_block_ftf_offsets_[f_block];
+  const auto ftf_end = f_block_ftf_.begin() + f_block_ftf_offsets_[f_block + 1];
+
+  // Compute F'F into ftf_values_. Rows with an e_block use the
+  // template parameters, see NoEBlockRowOuterProduct for why the other
+  // rows do not.
+  if (!reuse_products) {
+    for (auto it = ftf_begin; it != ftf_end; ++it) {
+      const int block2_size = bs->cols[it->block2 + num_eliminate_blocks_].size;
+      std::fill_n(
+          ftf_values_.get() + it->offset, f_block_size * block2_size, 0.0);
+    }
+
+    for (int k = f_block_cell_offsets_[f_block];
+         k < f_block_cell_offsets_[f_block + 1];
+         ++k) {
+      const FBlockCell& f_block_cell = f_block_cells_[k];
+      const bool has_e_block =
+          f_block_cell.row_block < uneliminated_row_begins_;
+      const CompressedRow& row = bs->rows[f_block_cell.row_block];
+      const double* f_values = values + row.cells[f_block_cell.cell].position;
+      for (int j = f_block_cell.cell; j < row.cells.size(); ++j) {
+        const int block2 = row.cells[j].block_id - num_eliminate_blocks_;
+        int r, c, row_stride, col_stride;
+        if (lhs->GetCell(f_block, block2, &r, &c, &row_stride, &col_stride) ==
+            nullptr) {
+          continue;
+        }
+        const int block2_size = bs->cols[row.cells[j].block_id].size;
+        auto it = std::lower_bound(
+            ftf_begin, ftf_end, block2, [](const FTFBlock& ftf, int block2) {
+              return ftf.block2 < block2;
+            });
+        DCHECK(it != ftf_end && it->block2 == block2);
+        double* ftf = ftf_values_.get() + it->offset;
+        // clang-format off
+        if (has_e_block) {
+          MatrixTransposeMatrixMultiply
+              <kRowBlockSize, kFBlockSize, kRowBlockSize, kFBlockSize, 1>(
+                  f_values, row.block.size, f_block_size,
+                  values + row.cells[j].position, row.block.size, block2_size,
+                  ftf, 0, 0, f_block_size, block2_size);
+        } else {
+          MatrixTransposeMatrixMultiply
+              <Eigen::Dynamic, Eigen::Dynamic, Eigen::Dynamic, Eigen::Dynamic,
+               1>(
+                  f_values, row.block.size, f_block_size,
+                  values + row.cells[j].position, row.block.size, block2_size,
+                  ftf, 0, 0, f_block_size, block2_size);
+        }
+        // clang-format on
+      }
+    }
+  }
+
+  // S += F'F
+  for (auto it = ftf_begin; it != ftf_end; ++it) {
+    int r, c, row_stride, col_stride;
+    CellInfo* cell_info =
+        lhs->GetCell(f_block, it->block2, &r, &c, &row_stride, &col_stride);
+    if (cell_info == nullptr) {
+      continue;
+    }
+    const int block2_size = bs->cols[it->block2 + num_eliminate_blocks_].size;
+    MatrixRef(cell_info->values, row_stride, col_stride)
+        .block(r, c, f_block_size, block2_size) +=
+        ConstMatrixRef(ftf_values_.get() + it->offset, f_block_size,
+                       block2_size);
+  }
+
+  // rhs += F'(b - E(E'E)^{-1}E'b)
+  if (rhs != nullptr) {
+    for (int k = f_block_cell_offsets_[f_block];
+         k < f_block_cell_offsets_[f_block + 1];
+         ++k) {
+      const FBlockCell& f_block_cell = f_block_cells_[k];
+      const bool has_e_block =
+          f_block_cell.row_block < uneliminated_row_begins_;
+      const CompressedRow& row = bs->rows[f_block_cell.row_block];
+      const double* f_values = values + row.cells[f_block_cell.cell].position;
+      // clang-format off
+      if (has_e_block) {
+        MatrixTransposeVectorMultiply<kRowBlockSize, kFBlockSize, 1>(
+            f_values, row.block.size, f_block_size,
+            row_rhs_.get() + row.block.position,
+            rhs + lhs_row_layout_[f_block]);
+      } else {
+        MatrixTransposeVectorMultiply<Eigen::Dynamic, Eigen::Dynamic, 1>(
+            f_values, row.block.size, f_block_size,
+            b + row.block.position,
+            rhs + lhs_row_layout_[f_block]);
+      }
+      // clang-format on
+    }
+  }
+
+  // S -= F'E(E'E)^{-1}E'F
+  double* b1_transpose_inverse_ete =
+      chunk_outer_product_buffer_.get() + thread_id * buffer_size_;
+  for (int k = f_block_chunk_offsets_[f_block];
+       k < f_block_chunk_offsets_[f_block + 1];
+       ++k) {
+    const int chunk_id = f_block_chunks_[k];
+    const Chunk& chunk = chunks_[chunk_id];
+    const int e_block_id = bs->rows[chunk.start].cells.front().block_id;
+    const int e_block_size = bs->cols[e_block_id].size;
+    const double* buffer =
+        chunk_storage_.get() + chunk_storage_offsets_[chunk_id];
+    const double* inverse_ete =
+        chunk_storage_.get() + chunk_storage_offsets_[chunk_id + 1] -
+        2 * e_block_size * e_block_size - e_block_size;
+
+    auto it1 = chunk.buffer_layout.find(f_block_id);
+    DCHECK(it1 != chunk.buffer_layout.end());
+    // clang-format off
+    MatrixTransposeMatrixMultiply
+        <kEBlockSize, kFBlockSize, kEBlockSize, kEBlockSize, 0>(
+        buffer + it1->second, e_block_size, f_block_size,
+        inverse_ete, e_block_size, e_block_size,
+        b1_transpose_inverse_ete, 0, 0, f_block_size, e_block_size);
+    // clang-format on
+
+    for (auto it2 = it1; it2 != chunk.buffer_layout.end(); ++it2) {
+      const int block2 = it2->first - num_eliminate_blocks_;
+      int r, c, row_stride, col_stride;
+      CellInfo* cell_info =
+          lhs->GetCell(f_block, block2, &r, &c, &row_stride, &col_stride);
+      if (cell_info != nullptr) {
+        const int block2_size = bs->cols[it2->first].size;
+        // clang-format off
+        MatrixMatrixMultiply
+            <kFBlockSize, kEBlockSize, kEBlockSize, kFBlockSize, -1>(
+                b1_transpose_inverse_ete, f_block_size, e_block_size,
+                buffer + it2->second, e_block_size, block2_size,
+                cell_info->values, r, c, row_stride, col_stride);
+        // clang-format on
+      }
+    }
+  }
+}
+
 template <int kRowBlockSize, int kEBlockSize, int kFBlockSize>
 void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::BackSubstitute(
     const BlockSparseMatrixData& A,
@@ -407,7 +829,6 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::UpdateRhs(
       const int block_id = row.cells[c].block_id;
       const int block_size = bs->cols[block_id].size;
       const int block = block_id - num_eliminate_blocks_;
-      auto lock = MakeConditionalLock(num_threads_, *rhs_locks_[block]);
       // clang-format off
       MatrixTransposeVectorMultiply<kRowBlockSize, kFBlockSize, 1>(
           values + row.cells[c].position,
@@ -462,7 +883,7 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
   for (int j = 0; j < chunk.size; ++j) {
     const CompressedRow& row = bs->rows[row_block_counter + j];
 
-    if (row.cells.size() > 1) {
+    if (lhs != nullptr && row.cells.size() > 1) {
       EBlockRowOuterProduct(A, row_block_counter + j, lhs);
     }
 
@@ -547,7 +968,6 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
           lhs->GetCell(block1, block2, &r, &c, &row_stride, &col_stride);
       if (cell_info != nullptr) {
         const int block2_size = bs->cols[it2->first].size;
-        auto lock = MakeConditionalLock(num_threads_, cell_info->m);
         // clang-format off
         MatrixMatrixMultiply
             <kFBlockSize, kEBlockSize, kEBlockSize, kFBlockSize, -1>(
@@ -624,7 +1044,6 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
     CellInfo* cell_info =
         lhs->GetCell(block1, block1, &r, &c, &row_stride, &col_stride);
     if (cell_info != nullptr) {
-      auto lock = MakeConditionalLock(num_threads_, cell_info->m);
       // This multiply currently ignores the fact that this is a
       // symmetric outer product.
       // clang-format off
@@ -645,7 +1064,6 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
           lhs->GetCell(block1, block2, &r, &c, &row_stride, &col_stride);
       if (cell_info != nullptr) {
         const int block2_size = bs->cols[row.cells[j].block_id].size;
-        auto lock = MakeConditionalLock(num_threads_, cell_info->m);
         // clang-format off
         MatrixTransposeMatrixMultiply
             <Eigen::Dynamic, Eigen::Dynamic, Eigen::Dynamic, Eigen::Dynamic, 1>(
@@ -679,7 +1097,6 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
     CellInfo* cell_info =
         lhs->GetCell(block1, block1, &r, &c, &row_stride, &col_stride);
     if (cell_info != nullptr) {
-      auto lock = MakeConditionalLock(num_threads_, cell_info->m);
       // block += b1.transpose() * b1;
       // clang-format off
       MatrixTransposeMatrixMultiply
@@ -700,7 +1117,6 @@ void SchurEliminator<kRowBlockSize, kEBlockSize, kFBlockSize>::
           lhs->GetCell(block1, block2, &r, &c, &row_stride, &col_stride);
       if (cell_info != nullptr) {
         // block += b1.transpose() * b2;
-        auto lock = MakeConditionalLock(num_threads_, cell_info->m);
         // clang-format off
         MatrixTransposeMatrixMultiply
             <kRowBlockSize, kFBlockSize, kRowBlockSize, kFBlockSize, 1>(
@@ -130,6 +130,16 @@ namespace ceres::internal {
 
 SchurEliminatorBase::~SchurEliminatorBase() = default;
 
+void SchurEliminatorBase::EliminateReusingProducts(
+    const BlockSparseMatrixData& A,
+    const double* b,
+    const double* D,
+    bool /*A_and_b_unchanged*/,
+    BlockRandomAccessMatrix* lhs,
+    double* rhs) {
+  Eliminate(A, b, D, lhs, rhs);
+}
+
 std::unique_ptr<SchurEliminatorBase> SchurEliminatorBase::Create(
     const LinearSolver::Options& options) {
 #ifndef CERES_RESTRICT_SCHUR_SPECIALIZATION
@@ -120,9 +120,16 @@ class SchurEliminatorTest : public ::testing::Test {
     sol_expected = H.llt().solve(g);
   }
 
+  // If previous_diagonal is not null, the reduced linear system is
+  // first computed twice using it, the second time asking for the
+  // products of A and b to be reused, which a single threaded
+  // eliminator only starts storing then, and then recomputed for
+  // diagonal reusing the products.
   void EliminateSolveAndCompare(const VectorRef& diagonal,
                                 bool use_static_structure,
-                                const double relative_tolerance) {
+                                const double relative_tolerance,
+                                int num_threads = 1,
+                                const double* previous_diagonal = nullptr) {
     const CompressedRowBlockStructure* bs = A->block_structure();
     const int num_col_blocks = bs->cols.size();
     auto blocks = Tail(bs->cols, num_col_blocks - num_eliminate_blocks);
@@ -135,7 +142,9 @@ class SchurEliminatorTest : public ::testing::Test {
 
     LinearSolver::Options options;
     options.context = &context_;
+    options.num_threads = num_threads;
     options.elimination_groups.push_back(num_eliminate_blocks);
+    context_.EnsureMinimumThreads(num_threads);
     if (use_static_structure) {
       DetectStructure(*bs,
                       num_eliminate_blocks,
@@ -148,8 +157,32 @@ class SchurEliminatorTest : public ::testing::Test {
         SchurEliminatorBase::Create(options);
     const bool kFullRankETE = true;
     eliminator->Init(num_eliminate_blocks, kFullRankETE, A->block_structure());
-    eliminator->Eliminate(
-        BlockSparseMatrixData(*A), b.get(), diagonal.data(), &lhs, rhs.data());
+    if (previous_diagonal == nullptr) {
+      eliminator->Eliminate(BlockSparseMatrixData(*A),
+                            b.get(),
+                            diagonal.data(),
+                            &lhs,
+                            rhs.data());
+    } else {
+      eliminator->EliminateReusingProducts(BlockSparseMatrixData(*A),
+                                           b.get(),
+                                           previous_diagonal,
+                                           false,
+                                           &lhs,
+                                           rhs.data());
+      eliminator->EliminateReusingProducts(BlockSparseMatrixData(*A),
+                                           b.get(),
+                                           previous_diagonal,
+                                           true,
+                                           &lhs,
+                                           rhs.data());
+      eliminator->EliminateReusingProducts(BlockSparseMatrixData(*A),
+                                           b.get(),
+                                           diagonal.data(),
+                                           true,
+                                           &lhs,
+                                           rhs.data());
+    }
 
     MatrixRef lhs_ref(lhs.mutable_values(), lhs.num_rows(), lhs.num_cols());
     Vector reduced_sol =
@@ -218,6 +251,38 @@ TEST_F(SchurEliminatorTest, VaryingFBlockSizeWithoutStaticStructure) {
   EliminateSolveAndCompare(VectorRef(D.get(), A->num_cols()), false, 1e-14);
 }
 
+TEST_F(SchurEliminatorTest, ScalarProblemWithRegularizationMultiThreaded) {
+  SetUpFromId(2);
+  ComputeReferenceSolution(VectorRef(D.get(), A->num_cols()));
+  EliminateSolveAndCompare(VectorRef(D.get(), A->num_cols()), true, 1e-14, 4);
+  EliminateSolveAndCompare(VectorRef(D.get(), A->num_cols()), false, 1e-14, 4);
+}
+
+TEST_F(SchurEliminatorTest, VaryingFBlockSizeMultiThreaded) {
+  SetUpFromId(4);
+  ComputeReferenceSolution(VectorRef(D.get(), A->num_cols()));
+  EliminateSolveAndCompare(VectorRef(D.get(), A->num_cols()), true, 1e-14, 4);
+  EliminateSolveAndCompare(VectorRef(D.get(), A->num_cols()), false, 1e-14, 4);
+}
+
+TEST_F(SchurEliminatorTest, ReusingProductsWithNewDiagonal) {
+  for (int id : {2, 4}) {
+    SetUpFromId(id);
+    const int num_cols = A->num_cols();
+    Vector diagonal = 3.0 * VectorRef(D.get(), num_cols);
+    ComputeReferenceSolution(diagonal);
+    for (int num_threads : {1, 4}) {
+      for (bool use_static_structure : {true, false}) {
+        EliminateSolveAndCompare(VectorRef(diagonal.data(), num_cols),
+                                 use_static_structure,
+                                 1e-14,
+                                 num_threads,
+                                 D.get());
+      }
+    }
+  }
+}
+
 TEST(SchurEliminatorForOneFBlock, MatchesSchurEliminator) {
   constexpr int kRowBlockSize = 2;
   constexpr int kEBlockSize = 3;
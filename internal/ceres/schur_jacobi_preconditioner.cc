@@ -37,6 +37,8 @@
 #include "absl/log/check.h"
 #include "ceres/block_random_access_diagonal_matrix.h"
 #include "ceres/block_sparse_matrix.h"
+#include "ceres/compressed_row_sparse_matrix.h"
+#include "ceres/internal/eigen.h"
 #include "ceres/linear_solver.h"
 #include "ceres/schur_eliminator.h"
 
@@ -62,6 +64,7 @@ SchurJacobiPreconditioner::SchurJacobiPreconditioner(
 
   m_ = std::make_unique<BlockRandomAccessDiagonalMatrix>(
       blocks, options_.context, options_.num_threads);
+  f_block_position_ = bs.cols[options_.elimination_groups[0]].position;
   InitEliminator(bs);
 }
 
@@ -92,6 +95,37 @@ bool SchurJacobiPreconditioner::UpdateImpl(const BlockSparseMatrix& A,
   // Compute a subset of the entries of the Schur complement.
   eliminator_->Eliminate(
       BlockSparseMatrixData(A), nullptr, D, m_.get(), nullptr);
+
+  // Save the Schur complement for UpdateDiagonal.
+  const CompressedRowSparseMatrix* m = m_->matrix();
+  schur_complement_values_ = ConstVectorRef(m->values(), m->num_nonzeros());
+  if (D == nullptr) {
+    f_block_diagonal_squared_.setZero(num_rows);
+  } else {
+    f_block_diagonal_squared_ =
+        ConstVectorRef(D + f_block_position_, num_rows).array().square();
+  }
+
+  m_->Invert();
+  return true;
+}
+
+bool SchurJacobiPreconditioner::UpdateDiagonal(const double* D) {
+  CHECK_EQ(schur_complement_values_.size(), m_->matrix()->num_nonzeros())
+      << "UpdateDiagonal called before Update.";
+
+  CompressedRowSparseMatrix* m = m_->mutable_matrix();
+  VectorRef(m->mutable_values(), m->num_nonzeros()) = schur_complement_values_;
+  double* values = m->mutable_values();
+  for (const Block& block : m->row_blocks()) {
+    for (int i = 0; i < block.size; ++i) {
+      const int row = block.position + i;
+      const double d = (D == nullptr) ? 0.0 : D[f_block_position_ + row];
+      values[i * (block.size + 1)] += d * d - f_block_diagonal_squared_[row];
+    }
+    values += block.size * block.size;
+  }
+
   m_->Invert();
   return true;
 }
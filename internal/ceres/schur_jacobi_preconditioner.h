@@ -44,6 +44,7 @@
 #include <vector>
 
 #include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/eigen.h"
 #include "ceres/internal/export.h"
 #include "ceres/preconditioner.h"
 
@@ -92,6 +93,13 @@ class CERES_NO_EXPORT SchurJacobiPreconditioner
   ~SchurJacobiPreconditioner() override;
 
   // Preconditioner interface.
+  //
+  // UpdateDiagonal adds the change in the squares of the entries of D
+  // corresponding to the f-blocks to the diagonal of the Schur complement
+  // computed by the last call to Update, and inverts its diagonal blocks
+  // again. The contribution of the e-blocks of D to the Schur complement is
+  // not updated, which would require eliminating the e-blocks again.
+  bool UpdateDiagonal(const double* D) final;
   void RightMultiplyAndAccumulate(const double* x, double* y) const final;
   int num_rows() const final;
 
@@ -103,6 +111,12 @@ class CERES_NO_EXPORT SchurJacobiPreconditioner
   std::unique_ptr<SchurEliminatorBase> eliminator_;
   // Preconditioner matrix.
   std::unique_ptr<BlockRandomAccessDiagonalMatrix> m_;
+  // Position of the first f-block column in the linear system.
+  int f_block_position_ = 0;
+  // The values of m_ before inversion, and the squares of the entries of D
+  // corresponding to the f-blocks, as of the last call to Update.
+  Vector schur_complement_values_;
+  Vector f_block_diagonal_squared_;
 };
 
 }  // namespace ceres::internal
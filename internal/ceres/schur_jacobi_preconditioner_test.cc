@@ -0,0 +1,87 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ceres/schur_jacobi_preconditioner.h"
+
+#include <memory>
+
+#include "ceres/block_sparse_matrix.h"
+#include "ceres/block_structure.h"
+#include "ceres/casts.h"
+#include "ceres/context_impl.h"
+#include "ceres/internal/eigen.h"
+#include "ceres/linear_least_squares_problems.h"
+#include "ceres/preconditioner.h"
+#include "ceres/test_util.h"
+#include "gtest/gtest.h"
+
+namespace ceres::internal {
+
+// Updating the diagonal of the linear system is exact if only the entries
+// corresponding to the f-blocks change.
+TEST(SchurJacobiPreconditioner, UpdateDiagonalMatchesUpdate) {
+  std::unique_ptr<LinearLeastSquaresProblem> problem =
+      CreateLinearLeastSquaresProblemFromId(2);
+  ASSERT_TRUE(problem != nullptr);
+  std::unique_ptr<BlockSparseMatrix> A(
+      down_cast<BlockSparseMatrix*>(problem->A.release()));
+  const CompressedRowBlockStructure& bs = *A->block_structure();
+
+  ContextImpl context;
+  Preconditioner::Options options;
+  options.type = SCHUR_JACOBI;
+  options.elimination_groups.push_back(problem->num_eliminate_blocks);
+  options.elimination_groups.push_back(0);
+  options.context = &context;
+
+  const int num_cols = A->num_cols();
+  const int f_block_position = bs.cols[problem->num_eliminate_blocks].position;
+  const Vector D = ConstVectorRef(problem->D.get(), num_cols);
+  Vector other_D = D;
+  other_D.tail(num_cols - f_block_position) *= 3.0;
+
+  SchurJacobiPreconditioner preconditioner(bs, options);
+  ASSERT_TRUE(preconditioner.Update(*A, D.data()));
+  const Matrix expected = PreconditionerToDenseMatrix(preconditioner);
+
+  SchurJacobiPreconditioner other_preconditioner(bs, options);
+  ASSERT_TRUE(other_preconditioner.Update(*A, other_D.data()));
+  const Matrix other_expected =
+      PreconditionerToDenseMatrix(other_preconditioner);
+
+  ASSERT_TRUE(preconditioner.UpdateDiagonal(other_D.data()));
+  EXPECT_LE((PreconditionerToDenseMatrix(preconditioner) - other_expected)
+                .norm(),
+            1e-12 * other_expected.norm());
+
+  ASSERT_TRUE(preconditioner.UpdateDiagonal(D.data()));
+  EXPECT_LE((PreconditionerToDenseMatrix(preconditioner) - expected).norm(),
+            1e-12 * expected.norm());
+}
+
+}  // namespace ceres::internal
@@ -35,10 +35,13 @@
 #ifndef CERES_INTERNAL_SMALL_BLAS_H_
 #define CERES_INTERNAL_SMALL_BLAS_H_
 
+#include <algorithm>
+
 #include "Eigen/Core"
 #include "absl/log/check.h"
 #include "ceres/internal/eigen.h"
 #include "ceres/internal/export.h"
+#include "ceres/small_blas_avx2.h"
 #include "small_blas_generic.h"
 
 namespace ceres::internal {
@@ -123,6 +126,10 @@ namespace ceres::internal {
 // constants. FooNaive is called otherwise. This leads to the best
 // performance currently.
 //
+// If the template arguments match one of the block sizes for which
+// small_blas_avx2.h has a kernel and the CPU supports AVX2, Foo calls
+// that kernel instead.
+//
 // The MatrixMatrixMultiply variants compute:
 //
 //   C op A * B;
@@ -252,6 +259,21 @@ CERES_GEMM_BEGIN(MatrixMatrixMultiply) {
 
 #else
 
+#ifdef CERES_USE_AVX2_SMALL_BLAS
+  if constexpr (kHasAvx2MatrixMatrixMultiply<kRowA, kColA, kRowB, kColB>) {
+    if (CpuSupportsAvx2()) {
+      DCHECK_EQ(num_row_a, kRowA);
+      DCHECK_EQ(num_col_a, kColA);
+      DCHECK_EQ(num_col_b, kColB);
+      DCHECK_LE(start_row_c + kRowA, row_stride_c);
+      DCHECK_LE(start_col_c + kColB, col_stride_c);
+      MatrixMatrixMultiplyAvx2<kRowA, kColA, kColB, kOperation>(
+          A, B, C + start_row_c * col_stride_c + start_col_c, col_stride_c);
+      return;
+    }
+  }
+#endif
+
   if (kRowA != Eigen::Dynamic && kColA != Eigen::Dynamic &&
       kRowB != Eigen::Dynamic && kColB != Eigen::Dynamic) {
     CERES_CALL_GEMM(MatrixMatrixMultiplyEigen)
@@ -359,6 +381,24 @@ CERES_GEMM_BEGIN(MatrixTransposeMatrixMultiply) {
 
 #else
 
+#ifdef CERES_USE_AVX2_SMALL_BLAS
+  if constexpr (kHasAvx2MatrixTransposeMatrixMultiply<kRowA,
+                                                      kColA,
+                                                      kRowB,
+                                                      kColB>) {
+    if (CpuSupportsAvx2()) {
+      DCHECK_EQ(num_row_a, kRowA);
+      DCHECK_EQ(num_col_a, kColA);
+      DCHECK_EQ(num_col_b, kColB);
+      DCHECK_LE(start_row_c + kColA, row_stride_c);
+      DCHECK_LE(start_col_c + kColB, col_stride_c);
+      MatrixTransposeMatrixMultiplyAvx2<kRowA, kColA, kColB, kOperation>(
+          A, B, C + start_row_c * col_stride_c + start_col_c, col_stride_c);
+      return;
+    }
+  }
+#endif
+
   if (kRowA != Eigen::Dynamic && kColA != Eigen::Dynamic &&
       kRowB != Eigen::Dynamic && kColB != Eigen::Dynamic) {
     CERES_CALL_GEMM(MatrixTransposeMatrixMultiplyEigen)
@@ -410,6 +450,15 @@ inline void MatrixVectorMultiply(const double* A,
   DCHECK((kRowA == Eigen::Dynamic) || (kRowA == num_row_a));
   DCHECK((kColA == Eigen::Dynamic) || (kColA == num_col_a));
 
+#ifdef CERES_USE_AVX2_SMALL_BLAS
+  if constexpr (kHasAvx2MatrixVectorMultiply<kRowA, kColA>) {
+    if (CpuSupportsAvx2()) {
+      MatrixVectorMultiplyAvx2<kRowA, kColA, kOperation>(A, b, c);
+      return;
+    }
+  }
+#endif
+
   const int NUM_ROW_A = (kRowA != Eigen::Dynamic ? kRowA : num_row_a);
   const int NUM_COL_A = (kColA != Eigen::Dynamic ? kColA : num_col_a);
   const int span = 4;
@@ -496,6 +545,15 @@ inline void MatrixTransposeVectorMultiply(const double* A,
   DCHECK((kRowA == Eigen::Dynamic) || (kRowA == num_row_a));
   DCHECK((kColA == Eigen::Dynamic) || (kColA == num_col_a));
 
+#ifdef CERES_USE_AVX2_SMALL_BLAS
+  if constexpr (kHasAvx2MatrixTransposeVectorMultiply<kRowA, kColA>) {
+    if (CpuSupportsAvx2()) {
+      MatrixTransposeVectorMultiplyAvx2<kRowA, kColA, kOperation>(A, b, c);
+      return;
+    }
+  }
+#endif
+
   const int NUM_ROW_A = (kRowA != Eigen::Dynamic ? kRowA : num_row_a);
   const int NUM_COL_A = (kColA != Eigen::Dynamic ? kColA : num_col_a);
   const int span = 4;
@@ -554,6 +612,52 @@ inline void MatrixTransposeVectorMultiply(const double* A,
 #endif  // CERES_NO_CUSTOM_BLAS
 }
 
+// Versions of MatrixVectorMultiply and MatrixTransposeVectorMultiply for
+// a single precision matrix A. The entries of A are converted to double
+// precision as they are read, and the products are accumulated in double
+// precision.
+template <int kRowA, int kColA, int kOperation>
+inline void MatrixVectorMultiply(const float* A,
+                                 const int num_row_a,
+                                 const int num_col_a,
+                                 const double* b,
+                                 double* c) {
+  DCHECK((kRowA == Eigen::Dynamic) || (kRowA == num_row_a));
+  DCHECK((kColA == Eigen::Dynamic) || (kColA == num_col_a));
+  const int NUM_ROW_A = (kRowA != Eigen::Dynamic ? kRowA : num_row_a);
+  const int NUM_COL_A = (kColA != Eigen::Dynamic ? kColA : num_col_a);
+  for (int row = 0; row < NUM_ROW_A; ++row) {
+    const float* pa = &A[row * NUM_COL_A];
+    double tmp = 0.0;
+    for (int col = 0; col < NUM_COL_A; ++col) {
+      tmp += static_cast<double>(pa[col]) * b[col];
+    }
+    CERES_GEMM_STORE_SINGLE(c, row, tmp);
+  }
+}
+
+template <int kRowA, int kColA, int kOperation>
+inline void MatrixTransposeVectorMultiply(const float* A,
+                                          const int num_row_a,
+                                          const int num_col_a,
+                                          const double* b,
+                                          double* c) {
+  DCHECK((kRowA == Eigen::Dynamic) || (kRowA == num_row_a));
+  DCHECK((kColA == Eigen::Dynamic) || (kColA == num_col_a));
+  const int NUM_ROW_A = (kRowA != Eigen::Dynamic ? kRowA : num_row_a);
+  const int NUM_COL_A = (kColA != Eigen::Dynamic ? kColA : num_col_a);
+  if (kOperation == 0) {
+    std::fill_n(c, NUM_COL_A, 0.0);
+  }
+  for (int row = 0; row < NUM_ROW_A; ++row) {
+    const float* pa = &A[row * NUM_COL_A];
+    const double bv = kOperation < 0 ? -b[row] : b[row];
+    for (int col = 0; col < NUM_COL_A; ++col) {
+      c[col] += static_cast<double>(pa[col]) * bv;
+    }
+  }
+}
+
 #undef CERES_GEMM_BEGIN
 #undef CERES_GEMM_EIGEN_HEADER
 #undef CERES_GEMM_NAIVE_HEADER
@@ -0,0 +1,347 @@
+// Ceres Solver - A fast non-linear least squares minimizer
+// Copyright 2023 Google Inc. All rights reserved.
+// http://ceres-solver.org/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of Google Inc. nor the names of its contributors may be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// AVX2 versions of the small_blas routines for the block sizes that
+// occur in bundle adjustment problems. The kernels are compiled for
+// AVX2 and FMA irrespective of the flags used for the rest of Ceres,
+// and small_blas.h only calls them if the CPU supports these
+// instruction sets, so the same binary runs on all x86-64 CPUs.
+//
+// The kernels are defined here rather than in a separate translation
+// unit so that the compiler can inline them. If Ceres itself is
+// compiled with AVX2 and FMA enabled, they are inlined into their
+// callers in small_blas.h. Otherwise the callers cannot inline code
+// compiled for a different target, and call them directly.
+
+#ifndef CERES_INTERNAL_SMALL_BLAS_AVX2_H_
+#define CERES_INTERNAL_SMALL_BLAS_AVX2_H_
+
+#include "ceres/internal/config.h"
+
+#if !defined(CERES_NO_CUSTOM_BLAS) && defined(__x86_64__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define CERES_USE_AVX2_SMALL_BLAS
+#endif
+
+#ifdef CERES_USE_AVX2_SMALL_BLAS
+
+#include <immintrin.h>
+
+namespace ceres::internal {
+
+// The CPU is only queried once, since this is called for every small
+// matrix product.
+inline bool CpuSupportsAvx2() {
+#if defined(__AVX2__) && defined(__FMA__)
+  return true;
+#else
+  static const bool supports_avx2 =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  return supports_avx2;
+#endif
+}
+
+// The matrix-matrix kernels are instantiated for inner dimensions of 2
+// and 3 (the residual and point block sizes) and 9 (the camera block
+// size), and for blocks of 3, 6 and 9 rows and columns. For an inner
+// dimension of 6 Eigen is as fast, so the 6x6 camera block products are
+// left to it.
+constexpr bool IsAvx2KernelInnerSize(int size) {
+  return size == 2 || size == 3 || size == 9;
+}
+
+constexpr bool IsAvx2KernelBlockSize(int size) {
+  return size == 3 || size == 6 || size == 9;
+}
+
+// C op A * B
+template <int kRowA, int kColA, int kRowB, int kColB>
+constexpr bool kHasAvx2MatrixMatrixMultiply =
+    IsAvx2KernelBlockSize(kRowA) && IsAvx2KernelInnerSize(kColA) &&
+    kRowB == kColA && IsAvx2KernelBlockSize(kColB);
+
+// C op A' * B
+template <int kRowA, int kColA, int kRowB, int kColB>
+constexpr bool kHasAvx2MatrixTransposeMatrixMultiply =
+    IsAvx2KernelInnerSize(kRowA) && IsAvx2KernelBlockSize(kColA) &&
+    kRowB == kRowA && IsAvx2KernelBlockSize(kColB);
+
+// c op A * b, including the 6x6 and 9x9 camera blocks. For three
+// columns the loop in small_blas.h is faster.
+template <int kRowA, int kColA>
+constexpr bool kHasAvx2MatrixVectorMultiply =
+    (IsAvx2KernelInnerSize(kRowA) || kRowA == 6) &&
+    (kColA == 6 || kColA == 9);
+
+// c op A' * b. For three rows the loop in small_blas.h is as fast.
+template <int kRowA, int kColA>
+constexpr bool kHasAvx2MatrixTransposeVectorMultiply =
+    kRowA == 2 && IsAvx2KernelBlockSize(kColA);
+
+// Only the functions with this attribute use AVX2 instructions. The
+// kernels below are only called by small_blas.h after checking
+// CpuSupportsAvx2().
+#define CERES_AVX2_TARGET __attribute__((target("avx2,fma")))
+
+namespace avx2 {
+
+// A row of kSize doubles, held in registers of four doubles each.
+template <int kSize>
+struct Row {
+  static constexpr int kNumFull = kSize / 4;
+  static constexpr int kTail = kSize % 4;
+  static constexpr int kNumRegisters = kNumFull + (kTail != 0 ? 1 : 0);
+  __m256d v[kNumRegisters];
+};
+
+// The last kSize % 4 entries of a row are loaded and stored with SSE
+// instructions. Masked AVX loads and stores would touch the following
+// entries, which defeats store forwarding when the rows of C are
+// adjacent in memory. The remaining entries of the register are zero.
+template <int kTail>
+CERES_AVX2_TARGET inline __m256d LoadTail(const double* p) {
+  if constexpr (kTail == 1) {
+    return _mm256_set_m128d(_mm_setzero_pd(), _mm_load_sd(p));
+  } else if constexpr (kTail == 2) {
+    return _mm256_set_m128d(_mm_setzero_pd(), _mm_loadu_pd(p));
+  } else {
+    return _mm256_set_m128d(_mm_load_sd(p + 2), _mm_loadu_pd(p));
+  }
+}
+
+template <int kTail>
+CERES_AVX2_TARGET inline void StoreTail(__m256d value, double* p) {
+  const __m128d low = _mm256_castpd256_pd128(value);
+  if constexpr (kTail == 1) {
+    _mm_store_sd(p, low);
+  } else {
+    _mm_storeu_pd(p, low);
+    if constexpr (kTail == 3) {
+      _mm_store_sd(p + 2, _mm256_extractf128_pd(value, 1));
+    }
+  }
+}
+
+template <int kSize>
+CERES_AVX2_TARGET inline void LoadRow(const double* p, Row<kSize>* row) {
+  for (int i = 0; i < Row<kSize>::kNumFull; ++i) {
+    row->v[i] = _mm256_loadu_pd(p + 4 * i);
+  }
+  if constexpr (Row<kSize>::kTail != 0) {
+    row->v[Row<kSize>::kNumFull] =
+        LoadTail<Row<kSize>::kTail>(p + 4 * Row<kSize>::kNumFull);
+  }
+}
+
+template <int kOperation>
+CERES_AVX2_TARGET inline __m256d Apply(__m256d c, __m256d value) {
+  if constexpr (kOperation > 0) {
+    return _mm256_add_pd(c, value);
+  } else {
+    return _mm256_sub_pd(c, value);
+  }
+}
+
+// p op row
+template <int kSize, int kOperation>
+CERES_AVX2_TARGET inline void StoreRow(const Row<kSize>& row, double* p) {
+  for (int i = 0; i < Row<kSize>::kNumFull; ++i) {
+    __m256d c = row.v[i];
+    if constexpr (kOperation != 0) {
+      c = Apply<kOperation>(_mm256_loadu_pd(p + 4 * i), c);
+    }
+    _mm256_storeu_pd(p + 4 * i, c);
+  }
+  if constexpr (Row<kSize>::kTail != 0) {
+    double* q = p + 4 * Row<kSize>::kNumFull;
+    __m256d c = row.v[Row<kSize>::kNumFull];
+    if constexpr (kOperation != 0) {
+      c = Apply<kOperation>(LoadTail<Row<kSize>::kTail>(q), c);
+    }
+    StoreTail<Row<kSize>::kTail>(c, q);
+  }
+}
+
+// Register j of a row of kSize doubles starting at p.
+template <int kSize>
+CERES_AVX2_TARGET inline __m256d LoadRegister(const double* p, int j) {
+  if (j < Row<kSize>::kNumFull) {
+    return _mm256_loadu_pd(p + 4 * j);
+  }
+  return LoadTail<Row<kSize>::kTail>(p + 4 * j);
+}
+
+// p[4 * j, 4 * j + 4) op value, or fewer entries for the last register of
+// a row of kSize doubles.
+template <int kSize, int kOperation>
+CERES_AVX2_TARGET inline void StoreRegister(__m256d value, double* p, int j) {
+  double* q = p + 4 * j;
+  if (j < Row<kSize>::kNumFull) {
+    if constexpr (kOperation != 0) {
+      value = Apply<kOperation>(_mm256_loadu_pd(q), value);
+    }
+    _mm256_storeu_pd(q, value);
+    return;
+  }
+  if constexpr (Row<kSize>::kTail != 0) {
+    if constexpr (kOperation != 0) {
+      value = Apply<kOperation>(LoadTail<Row<kSize>::kTail>(q), value);
+    }
+    StoreTail<Row<kSize>::kTail>(value, q);
+  }
+}
+
+// A(i, k) in all four entries of a register, where A is kM x kK, or
+// kK x kM and transposed.
+template <int kM, int kK, bool kTransposeA>
+CERES_AVX2_TARGET inline __m256d BroadcastA(const double* A, int i, int k) {
+  return _mm256_broadcast_sd(kTransposeA ? A + k * kM + i : A + i * kK + k);
+}
+
+// C op A * B, where A is kM x kK (or kK x kM and transposed), B is
+// kK x kN and row i of C starts at C + i * col_stride_c. Each row of C
+// is computed as a linear combination of the kK rows of B.
+//
+// If the kK rows of B fit in registers, they are loaded once for all the
+// rows of C. Otherwise, e.g., for the 9x9 camera blocks, B is
+// processed one column panel of four doubles at a time, and the kK
+// entries of the panel stay in registers while the corresponding column
+// panel of C is computed.
+template <int kM, int kK, int kN, int kOperation, bool kTransposeA>
+CERES_AVX2_TARGET inline void Gemm(const double* A,
+                                   const double* B,
+                                   double* C,
+                                   int col_stride_c) {
+  // Leave some of the 16 registers for the row of C and the broadcasts.
+  if constexpr (kK * Row<kN>::kNumRegisters <= 12) {
+    Row<kN> b[kK];
+    for (int k = 0; k < kK; ++k) {
+      LoadRow<kN>(B + k * kN, &b[k]);
+    }
+
+    for (int i = 0; i < kM; ++i) {
+      Row<kN> c;
+      for (int k = 0; k < kK; ++k) {
+        const __m256d a_ik = BroadcastA<kM, kK, kTransposeA>(A, i, k);
+        for (int j = 0; j < Row<kN>::kNumRegisters; ++j) {
+          c.v[j] = (k == 0) ? _mm256_mul_pd(a_ik, b[k].v[j])
+                            : _mm256_fmadd_pd(a_ik, b[k].v[j], c.v[j]);
+        }
+      }
+      StoreRow<kN, kOperation>(c, C + i * col_stride_c);
+    }
+  } else {
+    for (int j = 0; j < Row<kN>::kNumRegisters; ++j) {
+      __m256d b[kK];
+      for (int k = 0; k < kK; ++k) {
+        b[k] = LoadRegister<kN>(B + k * kN, j);
+      }
+
+      for (int i = 0; i < kM; ++i) {
+        __m256d c =
+            _mm256_mul_pd(BroadcastA<kM, kK, kTransposeA>(A, i, 0), b[0]);
+        for (int k = 1; k < kK; ++k) {
+          c = _mm256_fmadd_pd(
+              BroadcastA<kM, kK, kTransposeA>(A, i, k), b[k], c);
+        }
+        StoreRegister<kN, kOperation>(c, C + i * col_stride_c, j);
+      }
+    }
+  }
+}
+
+// c op A * b, where A is kM x kN.
+template <int kM, int kN, int kOperation>
+CERES_AVX2_TARGET inline void Gemv(const double* A,
+                                   const double* b,
+                                   double* c) {
+  Row<kN> x;
+  LoadRow<kN>(b, &x);
+
+  for (int i = 0; i < kM; ++i) {
+    Row<kN> a;
+    LoadRow<kN>(A + i * kN, &a);
+    __m256d sum = _mm256_mul_pd(a.v[0], x.v[0]);
+    for (int j = 1; j < Row<kN>::kNumRegisters; ++j) {
+      sum = _mm256_fmadd_pd(a.v[j], x.v[j], sum);
+    }
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum),
+                              _mm256_extractf128_pd(sum, 1));
+    half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+    const double value = _mm_cvtsd_f64(half);
+    if constexpr (kOperation > 0) {
+      c[i] += value;
+    } else if constexpr (kOperation < 0) {
+      c[i] -= value;
+    } else {
+      c[i] = value;
+    }
+  }
+}
+
+}  // namespace avx2
+
+// The semantics of these functions are the same as those of the
+// corresponding functions in small_blas.h, except that C points to
+// the first entry of the block of C being written to and only the
+// column stride of C is needed.
+template <int kRowA, int kColA, int kColB, int kOperation>
+CERES_AVX2_TARGET inline void MatrixMatrixMultiplyAvx2(const double* A,
+                                                       const double* B,
+                                                       double* C,
+                                                       int col_stride_c) {
+  avx2::Gemm<kRowA, kColA, kColB, kOperation, false>(A, B, C, col_stride_c);
+}
+
+template <int kRowA, int kColA, int kColB, int kOperation>
+CERES_AVX2_TARGET inline void MatrixTransposeMatrixMultiplyAvx2(
+    const double* A, const double* B, double* C, int col_stride_c) {
+  avx2::Gemm<kColA, kRowA, kColB, kOperation, true>(A, B, C, col_stride_c);
+}
+
+template <int kRowA, int kColA, int kOperation>
+CERES_AVX2_TARGET inline void MatrixVectorMultiplyAvx2(const double* A,
+                                                       const double* b,
+                                                       double* c) {
+  avx2::Gemv<kRowA, kColA, kOperation>(A, b, c);
+}
+
+// c' op b' * A
+template <int kRowA, int kColA, int kOperation>
+CERES_AVX2_TARGET inline void MatrixTransposeVectorMultiplyAvx2(
+    const double* A, const double* b, double* c) {
+  avx2::Gemm<1, kRowA, kColA, kOperation, false>(b, A, c, 0);
+}
+
+#undef CERES_AVX2_TARGET
+
+}  // namespace ceres::internal
+
+#endif  // CERES_USE_AVX2_SMALL_BLAS
+
+#endif  // CERES_INTERNAL_SMALL_BLAS_AVX2_H_
@@ -202,6 +202,80 @@ BENCHMARK_DYNAMIC_MMT_FN(MatrixTransposeMatrixMultiplyNaive, 9, 9, 3)
 BENCHMARK_DYNAMIC_MMT_FN(MatrixTransposeMatrixMultiplyNaive, 9, 3, 3)
 BENCHMARK_DYNAMIC_MMT_FN(MatrixTransposeMatrixMultiplyNaive, 3, 9, 9)
 
+// Products of the block sizes which occur in bundle adjustment, using
+// the dispatching functions and Eigen. On CPUs with AVX2 the former
+// call the kernels in small_blas_avx2.h.
+template <int kRowA, int kColA, int kColB, bool kUseEigen>
+static void BM_MatrixMatrixMultiplyBlock(benchmark::State& state) {
+  MatrixMatrixMultiplyData data(kRowA, kColA, kColA, kColB, kRowA, kColB);
+  const int num_elements = data.num_elements();
+  int iter = 0;
+  for (auto _ : state) {
+    // clang-format off
+    if constexpr (kUseEigen) {
+      MatrixMatrixMultiplyEigen<kRowA, kColA, kColA, kColB, GEMM_KIND_ADD>(
+          data.GetA(iter), kRowA, kColA,
+          data.GetB(iter), kColA, kColB,
+          data.GetC(iter), 0, 0, kRowA, kColB);
+    } else {
+      MatrixMatrixMultiply<kRowA, kColA, kColA, kColB, GEMM_KIND_ADD>(
+          data.GetA(iter), kRowA, kColA,
+          data.GetB(iter), kColA, kColB,
+          data.GetC(iter), 0, 0, kRowA, kColB);
+    }
+    // clang-format on
+    iter = (iter + 1) % num_elements;
+  }
+}
+
+template <int kRowA, int kColA, int kColB, bool kUseEigen>
+static void BM_MatrixTransposeMatrixMultiplyBlock(benchmark::State& state) {
+  MatrixMatrixMultiplyData data(kRowA, kColA, kRowA, kColB, kColA, kColB);
+  const int num_elements = data.num_elements();
+  int iter = 0;
+  for (auto _ : state) {
+    // clang-format off
+    if constexpr (kUseEigen) {
+      MatrixTransposeMatrixMultiplyEigen
+          <kRowA, kColA, kRowA, kColB, GEMM_KIND_ADD>(
+          data.GetA(iter), kRowA, kColA,
+          data.GetB(iter), kRowA, kColB,
+          data.GetC(iter), 0, 0, kColA, kColB);
+    } else {
+      MatrixTransposeMatrixMultiply
+          <kRowA, kColA, kRowA, kColB, GEMM_KIND_ADD>(
+          data.GetA(iter), kRowA, kColA,
+          data.GetB(iter), kRowA, kColB,
+          data.GetC(iter), 0, 0, kColA, kColB);
+    }
+    // clang-format on
+    iter = (iter + 1) % num_elements;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 3, 3, 3, true);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 3, 3, 3, false);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 6, 3, 6, true);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 6, 3, 6, false);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 9, 3, 9, true);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 9, 3, 9, false);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 9, 9, 3, true);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 9, 9, 3, false);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 9, 9, 9, true);
+BENCHMARK_TEMPLATE(BM_MatrixMatrixMultiplyBlock, 9, 9, 9, false);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 3, 3, true);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 3, 3, false);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 3, 9, true);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 3, 9, false);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 6, 6, true);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 6, 6, false);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 9, 9, true);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 2, 9, 9, false);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 3, 9, 3, true);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 3, 9, 3, false);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 9, 9, 9, true);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeMatrixMultiplyBlock, 9, 9, 9, false);
+
 #undef GEMM_KIND_EQ
 #undef GEMM_KIND_ADD
 #undef GEMM_KIND_SUB
@@ -109,6 +109,41 @@ static void BM_MatrixTransposeVectorMultiply(benchmark::State& state) {
 
 BENCHMARK(BM_MatrixTransposeVectorMultiply)->Apply(MatrixSizeArguments);
 
+// The block sizes which occur in bundle adjustment, known at compile
+// time. On CPUs with AVX2 these call the kernels in small_blas_avx2.h.
+template <int kRows, int kCols>
+static void BM_MatrixVectorMultiplyBlock(benchmark::State& state) {
+  MatrixVectorMultiplyData data(kRows, kCols);
+  const int num_elements = data.num_elements();
+  int iter = 0;
+  for (auto _ : state) {
+    internal::MatrixVectorMultiply<kRows, kCols, 1>(
+        data.GetB(iter), kRows, kCols, data.GetC(iter), data.GetA(iter));
+    iter = (iter + 1) % num_elements;
+  }
+}
+
+template <int kRows, int kCols>
+static void BM_MatrixTransposeVectorMultiplyBlock(benchmark::State& state) {
+  MatrixVectorMultiplyData data(kCols, kRows);
+  const int num_elements = data.num_elements();
+  int iter = 0;
+  for (auto _ : state) {
+    internal::MatrixTransposeVectorMultiply<kRows, kCols, 1>(
+        data.GetB(iter), kRows, kCols, data.GetC(iter), data.GetA(iter));
+    iter = (iter + 1) % num_elements;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_MatrixVectorMultiplyBlock, 2, 3);
+BENCHMARK_TEMPLATE(BM_MatrixVectorMultiplyBlock, 2, 6);
+BENCHMARK_TEMPLATE(BM_MatrixVectorMultiplyBlock, 2, 9);
+BENCHMARK_TEMPLATE(BM_MatrixVectorMultiplyBlock, 3, 9);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeVectorMultiplyBlock, 2, 3);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeVectorMultiplyBlock, 2, 6);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeVectorMultiplyBlock, 2, 9);
+BENCHMARK_TEMPLATE(BM_MatrixTransposeVectorMultiplyBlock, 3, 9);
+
 }  // namespace ceres
 
 BENCHMARK_MAIN();
@@ -364,6 +364,19 @@ TEST(BLAS, MatrixMatrixMultiply_9_9_9_Dynamic) {
   TestMatrixFunctions<9, 9, 9, DimType::Dynamic, MatrixMatrixMultiplyTy>()();
 }
 
+// Block sizes with specialized kernels, see small_blas_avx2.h.
+TEST(BLAS, MatrixMatrixMultiply_9_3_9) {
+  TestMatrixFunctions<9, 3, 9, DimType::Static, MatrixMatrixMultiplyTy>()();
+}
+
+TEST(BLAS, MatrixMatrixMultiply_6_2_3) {
+  TestMatrixFunctions<6, 2, 3, DimType::Static, MatrixMatrixMultiplyTy>()();
+}
+
+TEST(BLAS, MatrixMatrixMultiply_3_9_6) {
+  TestMatrixFunctions<3, 9, 6, DimType::Static, MatrixMatrixMultiplyTy>()();
+}
+
 TEST(BLAS, MatrixMatrixMultiplyNaive_5_3_7) {
   TestMatrixFunctions<5,
                       3,
@@ -460,6 +473,39 @@ TEST(BLAS, MatrixTransposeMatrixMultiply_9_9_9_Dynamic) {
                                MatrixTransposeMatrixMultiplyTy>()();
 }
 
+// Block sizes with specialized kernels, see small_blas_avx2.h.
+TEST(BLAS, MatrixTransposeMatrixMultiply_2_9_9) {
+  TestMatrixTransposeFunctions<2,
+                               9,
+                               9,
+                               DimType::Static,
+                               MatrixTransposeMatrixMultiplyTy>()();
+}
+
+TEST(BLAS, MatrixTransposeMatrixMultiply_2_3_6) {
+  TestMatrixTransposeFunctions<2,
+                               3,
+                               6,
+                               DimType::Static,
+                               MatrixTransposeMatrixMultiplyTy>()();
+}
+
+TEST(BLAS, MatrixTransposeMatrixMultiply_3_9_3) {
+  TestMatrixTransposeFunctions<3,
+                               9,
+                               3,
+                               DimType::Static,
+                               MatrixTransposeMatrixMultiplyTy>()();
+}
+
+TEST(BLAS, MatrixTransposeMatrixMultiply_9_6_9) {
+  TestMatrixTransposeFunctions<9,
+                               6,
+                               9,
+                               DimType::Static,
+                               MatrixTransposeMatrixMultiplyTy>()();
+}
+
 TEST(BLAS, MatrixTransposeMatrixMultiplyNaive_5_3_7) {
   TestMatrixTransposeFunctions<5,
                                3,
@@ -618,5 +664,57 @@ TEST(BLAS, MatrixTransposeVectorMultiply) {
   }
 }
 
+template <int kRowA, int kColA>
+void TestStaticMatrixVectorMultiply() {
+  Matrix A(kRowA, kColA);
+  A.setRandom();
+  Vector b(kColA);
+  b.setRandom();
+  Vector bt(kRowA);
+  bt.setRandom();
+
+  Vector c = Vector::Ones(kRowA);
+  Vector c_ref = c;
+  c_ref += A * b;
+  MatrixVectorMultiply<kRowA, kColA, 1>(A.data(), kRowA, kColA, b.data(),
+                                        c.data());
+  EXPECT_NEAR((c_ref - c).norm(), 0.0, kTolerance);
+  c_ref -= A * b;
+  MatrixVectorMultiply<kRowA, kColA, -1>(A.data(), kRowA, kColA, b.data(),
+                                         c.data());
+  EXPECT_NEAR((c_ref - c).norm(), 0.0, kTolerance);
+  c_ref = A * b;
+  MatrixVectorMultiply<kRowA, kColA, 0>(A.data(), kRowA, kColA, b.data(),
+                                        c.data());
+  EXPECT_NEAR((c_ref - c).norm(), 0.0, kTolerance);
+
+  Vector ct = Vector::Ones(kColA);
+  Vector ct_ref = ct;
+  ct_ref += A.transpose() * bt;
+  MatrixTransposeVectorMultiply<kRowA, kColA, 1>(
+      A.data(), kRowA, kColA, bt.data(), ct.data());
+  EXPECT_NEAR((ct_ref - ct).norm(), 0.0, kTolerance);
+  ct_ref -= A.transpose() * bt;
+  MatrixTransposeVectorMultiply<kRowA, kColA, -1>(
+      A.data(), kRowA, kColA, bt.data(), ct.data());
+  EXPECT_NEAR((ct_ref - ct).norm(), 0.0, kTolerance);
+  ct_ref = A.transpose() * bt;
+  MatrixTransposeVectorMultiply<kRowA, kColA, 0>(
+      A.data(), kRowA, kColA, bt.data(), ct.data());
+  EXPECT_NEAR((ct_ref - ct).norm(), 0.0, kTolerance);
+}
+
+// Block sizes with specialized kernels, see small_blas_avx2.h.
+TEST(BLAS, MatrixVectorMultiplyStatic) {
+  TestStaticMatrixVectorMultiply<2, 3>();
+  TestStaticMatrixVectorMultiply<2, 6>();
+  TestStaticMatrixVectorMultiply<2, 9>();
+  TestStaticMatrixVectorMultiply<3, 3>();
+  TestStaticMatrixVectorMultiply<3, 9>();
+  TestStaticMatrixVectorMultiply<6, 6>();
+  TestStaticMatrixVectorMultiply<9, 9>();
+  TestStaticMatrixVectorMultiply<4, 4>();
+}
+
 }  // namespace internal
 }  // namespace ceres
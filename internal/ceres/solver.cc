@@ -32,6 +32,8 @@
 #include "ceres/solver.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <sstream>  // NOLINT
@@ -51,18 +53,47 @@
 #include "ceres/detect_structure.h"
 #include "ceres/eigensparse.h"
 #include "ceres/gradient_checking_cost_function.h"
+#include "ceres/independent_components.h"
 #include "ceres/internal/export.h"
+#include "ceres/parameter_block.h"
+#include "ceres/parallel_for.h"
 #include "ceres/parameter_block_ordering.h"
 #include "ceres/preprocessor.h"
 #include "ceres/problem.h"
 #include "ceres/problem_impl.h"
 #include "ceres/program.h"
+#include "ceres/residual_block.h"
 #include "ceres/schur_templates.h"
 #include "ceres/solver_utils.h"
 #include "ceres/suitesparse.h"
+#include "ceres/trust_region_strategy.h"
 #include "ceres/types.h"
 
 namespace ceres {
+namespace internal {
+
+// The state of a Solver::PreparedProblem.
+struct PreparedProblemImpl {
+  Problem* problem = nullptr;
+  // The structure version of the problem when it was prepared.
+  int64_t structure_version = 0;
+  // The options as given by the user. The options used by the solver,
+  // which may differ, are in pp.options.
+  Solver::Options options;
+  PreprocessedProblem pp;
+
+  // The residual blocks which only depend on constant parameter blocks and
+  // were removed from the reduced program. They are evaluated before every
+  // solve to compute the fixed cost.
+  std::vector<ResidualBlock*> fixed_residual_blocks;
+  std::vector<double> fixed_residual_block_scratch;
+
+  std::string schur_structure_given;
+  std::string schur_structure_used;
+};
+
+}  // namespace internal
+
 namespace {
 
 #define OPTION_OP(x, y, OP)                                               \
@@ -287,6 +318,12 @@ bool OptionsAreValidForIterativeSchur(const Solver::Options& options,
           "use_spse_initialization.";
       return false;
     }
+    if (options.use_mixed_precision_solves) {
+      *error =
+          "use_explicit_schur_complement does not support "
+          "use_mixed_precision_solves.";
+      return false;
+    }
   }
 
   if (options.use_spse_initialization ||
@@ -295,11 +332,6 @@ bool OptionsAreValidForIterativeSchur(const Solver::Options& options,
     OPTION_GE(spse_tolerance, 0.0)
   }
 
-  if (options.use_mixed_precision_solves) {
-    *error = "Can't use use_mixed_precision_solves with ITERATIVE_SCHUR";
-    return false;
-  }
-
   if (options.dynamic_sparsity) {
     *error = "Dynamic sparsity is only supported with SPARSE_NORMAL_CHOLESKY.";
     return false;
@@ -326,15 +358,19 @@ bool OptionsAreValidForCgnr(const Solver::Options& options,
 
   if (options.preconditioner_type != IDENTITY &&
       options.preconditioner_type != JACOBI &&
-      options.preconditioner_type != SUBSET) {
+      options.preconditioner_type != SUBSET &&
+      options.preconditioner_type != INCOMPLETE_CHOLESKY) {
     *error = absl::StrFormat(
         "Can't use CGNR with preconditioner_type = %s.",
         PreconditionerTypeToString(options.preconditioner_type));
     return false;
   }
 
-  if (options.use_mixed_precision_solves) {
-    *error = "use_mixed_precision_solves cannot be used with CGNR";
+  if (options.use_mixed_precision_solves &&
+      options.sparse_linear_algebra_library_type == CUDA_SPARSE) {
+    *error =
+        "use_mixed_precision_solves cannot be used with CGNR when "
+        "sparse_linear_algebra_library_type = CUDA_SPARSE.";
     return false;
   }
 
@@ -364,6 +400,14 @@ bool OptionsAreValidForCgnr(const Solver::Options& options,
     }
   }
 
+  if (options.preconditioner_type == INCOMPLETE_CHOLESKY &&
+      options.sparse_linear_algebra_library_type == CUDA_SPARSE) {
+    *error =
+        "Can't use CGNR with preconditioner_type = INCOMPLETE_CHOLESKY when "
+        "sparse_linear_algebra_library_type = CUDA_SPARSE.";
+    return false;
+  }
+
   // Check options for CGNR with CUDA_SPARSE.
   if (options.sparse_linear_algebra_library_type == CUDA_SPARSE) {
     if (!IsSparseLinearAlgebraLibraryTypeAvailable(CUDA_SPARSE)) {
@@ -441,6 +485,75 @@ bool TrustRegionOptionsAreValid(const Solver::Options& options,
     return false;
   }
 
+  if (options.use_single_precision_jacobian) {
+    if (options.linear_solver_type != CGNR ||
+        options.sparse_linear_algebra_library_type == CUDA_SPARSE) {
+      *error =
+          "use_single_precision_jacobian is only supported with CGNR when "
+          "sparse_linear_algebra_library_type is not CUDA_SPARSE. It is not "
+          "supported with ITERATIVE_SCHUR.";
+      return false;
+    }
+    if (options.preconditioner_type != IDENTITY &&
+        options.preconditioner_type != JACOBI) {
+      *error = absl::StrFormat(
+          "use_single_precision_jacobian requires preconditioner_type to be "
+          "IDENTITY or JACOBI, not %s.",
+          PreconditionerTypeToString(options.preconditioner_type));
+      return false;
+    }
+    if (options.use_mixed_precision_solves) {
+      *error =
+          "use_single_precision_jacobian cannot be combined with "
+          "use_mixed_precision_solves.";
+      return false;
+    }
+  }
+
+  if (options.use_pipelined_conjugate_gradients) {
+    if (!((options.linear_solver_type == CGNR &&
+           options.sparse_linear_algebra_library_type != CUDA_SPARSE) ||
+          (options.linear_solver_type == ITERATIVE_SCHUR &&
+           !options.use_explicit_schur_complement))) {
+      *error =
+          "use_pipelined_conjugate_gradients is only supported with CGNR "
+          "when sparse_linear_algebra_library_type is not CUDA_SPARSE, and "
+          "with ITERATIVE_SCHUR when use_explicit_schur_complement is false.";
+      return false;
+    }
+    if (options.use_mixed_precision_solves) {
+      *error =
+          "use_pipelined_conjugate_gradients cannot be used with "
+          "use_mixed_precision_solves.";
+      return false;
+    }
+  }
+
+  OPTION_GE(max_num_cg_refinement_iterations, 0);
+  OPTION_GE(max_num_preconditioner_reuses, 0);
+  OPTION_GE(preconditioner_refresh_iteration_ratio, 1.0);
+
+  OPTION_GE(num_deflation_vectors, 0);
+  if (options.num_deflation_vectors > 0) {
+    if (!((options.linear_solver_type == CGNR &&
+           options.sparse_linear_algebra_library_type != CUDA_SPARSE) ||
+          (options.linear_solver_type == ITERATIVE_SCHUR &&
+           !options.use_explicit_schur_complement))) {
+      *error =
+          "num_deflation_vectors > 0 is only supported with CGNR when "
+          "sparse_linear_algebra_library_type is not CUDA_SPARSE, and with "
+          "ITERATIVE_SCHUR when use_explicit_schur_complement is false.";
+      return false;
+    }
+    if (options.use_mixed_precision_solves ||
+        options.use_pipelined_conjugate_gradients) {
+      *error =
+          "num_deflation_vectors > 0 cannot be used with "
+          "use_mixed_precision_solves or use_pipelined_conjugate_gradients.";
+      return false;
+    }
+  }
+
   if (!options.trust_region_minimizer_iterations_to_dump.empty() &&
       options.trust_region_problem_dump_format_type != CONSOLE &&
       options.trust_region_problem_dump_directory.empty()) {
@@ -570,6 +683,7 @@ void PreSolveSummarize(const Solver::Options& options,
   summary->minimizer_type                     = options.minimizer_type;
   summary->nonlinear_conjugate_gradient_type  = options.nonlinear_conjugate_gradient_type;
   summary->num_threads_given                  = options.num_threads;
+  summary->num_independent_components         = 1;
   summary->preconditioner_type_given          = options.preconditioner_type;
   summary->sparse_linear_algebra_library_type = options.sparse_linear_algebra_library_type;
   summary->linear_solver_ordering_type        = options.linear_solver_ordering_type;
@@ -578,6 +692,9 @@ void PreSolveSummarize(const Solver::Options& options,
   // clang-format on
 }
 
+void SummarizeStatistics(const internal::PreprocessedProblem& pp,
+                         Solver::Summary* summary);
+
 void PostSolveSummarize(const internal::PreprocessedProblem& pp,
                         Solver::Summary* summary) {
   internal::OrderingToGroupSizes(pp.options.linear_solver_ordering.get(),
@@ -602,6 +719,11 @@ void PostSolveSummarize(const internal::PreprocessedProblem& pp,
     SummarizeReducedProgram(*pp.reduced_program, summary);
   }
 
+  SummarizeStatistics(pp, summary);
+}
+
+void SummarizeStatistics(const internal::PreprocessedProblem& pp,
+                         Solver::Summary* summary) {
   using internal::CallStatistics;
 
   // It is possible that no evaluator was created. This would be the
@@ -690,6 +812,121 @@ std::string SchurStructureToString(const int row_block_size,
   return absl::StrFormat("%s,%s,%s", row, e, f);
 }
 
+// The evaluator and the linear solver of a prepared problem accumulate their
+// statistics over all solves. Subtract the statistics accumulated before the
+// current solve, so that the summary only reports the current solve.
+void SubtractStatistics(const Solver::Summary& before,
+                        Solver::Summary* summary) {
+  summary->residual_evaluation_time_in_seconds -=
+      before.residual_evaluation_time_in_seconds;
+  summary->num_residual_evaluations -= before.num_residual_evaluations;
+  summary->jacobian_evaluation_time_in_seconds -=
+      before.jacobian_evaluation_time_in_seconds;
+  summary->num_jacobian_evaluations -= before.num_jacobian_evaluations;
+  summary->linear_solver_time_in_seconds -=
+      before.linear_solver_time_in_seconds;
+  summary->num_linear_solves -= before.num_linear_solves;
+}
+
+void SummarizeSchurStructure(const internal::PreprocessedProblem& pp,
+                             Solver::Summary* summary) {
+  // We check the linear_solver_options.type rather than
+  // pp.options.linear_solver_type because, depending on the lack of a Schur
+  // structure, the preprocessor may change the linear solver type.
+  if (!IsSchurType(pp.linear_solver_options.type)) {
+    return;
+  }
+
+  // TODO(sameeragarwal): We can likely eliminate the duplicate call
+  // to DetectStructure here and inside the linear solver, by
+  // calling this in the preprocessor.
+  int row_block_size;
+  int e_block_size;
+  int f_block_size;
+  DetectStructure(*static_cast<internal::BlockSparseMatrix*>(
+                       pp.minimizer_options.jacobian.get())
+                       ->block_structure(),
+                  pp.linear_solver_options.elimination_groups[0],
+                  &row_block_size,
+                  &e_block_size,
+                  &f_block_size);
+  summary->schur_structure_given =
+      SchurStructureToString(row_block_size, e_block_size, f_block_size);
+  internal::GetBestSchurTemplateSpecialization(
+      &row_block_size, &e_block_size, &f_block_size);
+  summary->schur_structure_used =
+      SchurStructureToString(row_block_size, e_block_size, f_block_size);
+}
+
+// Brings a prepared problem up to date with the current values and bounds of
+// the parameter blocks of the problem.
+bool UpdatePreparedProblem(internal::PreparedProblemImpl* prepared) {
+  using internal::Program;
+  using internal::ResidualBlock;
+
+  internal::PreprocessedProblem* pp = &prepared->pp;
+  const Program& program = prepared->problem->mutable_impl()->program();
+  pp->error.clear();
+
+  internal::ContextImpl* context = pp->problem->context();
+  const int num_threads = pp->options.num_threads;
+  if (!program.ParameterBlocksAreFinite(context, num_threads, &pp->error)) {
+    return false;
+  }
+  if (pp->options.minimizer_type == TRUST_REGION) {
+    if (!program.IsFeasible(context, num_threads, &pp->error)) {
+      return false;
+    }
+  } else if (program.IsBoundsConstrained()) {
+    pp->error = "LINE_SEARCH Minimizer does not support bounds.";
+    return false;
+  }
+
+  pp->fixed_cost = 0.0;
+  EvaluationCallback* evaluation_callback =
+      pp->reduced_program->mutable_evaluation_callback();
+  if (!prepared->fixed_residual_blocks.empty() &&
+      evaluation_callback != nullptr) {
+    constexpr bool kNewPoint = true;
+    constexpr bool kDoNotEvaluateJacobians = false;
+    evaluation_callback->PrepareForEvaluation(kDoNotEvaluateJacobians,
+                                              kNewPoint);
+  }
+  double* scratch = prepared->fixed_residual_block_scratch.data();
+  for (ResidualBlock* residual_block : prepared->fixed_residual_blocks) {
+    double cost = 0.0;
+    if (!residual_block->Evaluate(true, &cost, nullptr, nullptr, scratch)) {
+      pp->error = absl::StrFormat(
+          "Evaluation of the residual %d failed during "
+          "evaluation of the fixed residual blocks.",
+          residual_block->index());
+      return false;
+    }
+    pp->fixed_cost += cost;
+  }
+
+  Program* reduced_program = pp->reduced_program.get();
+  if (reduced_program->NumParameterBlocks() == 0) {
+    return true;
+  }
+
+  // Solving the problem or evaluating it renumbers the parameter blocks of
+  // the problem, so restore the numbering of the reduced program.
+  reduced_program->SetParameterOffsetsAndIndex();
+  reduced_program->ParameterBlocksToStateVector(pp->reduced_parameters.data());
+
+  if (pp->options.minimizer_type == TRUST_REGION) {
+    pp->minimizer_options.is_constrained =
+        reduced_program->IsBoundsConstrained();
+    // The trust region strategy carries the trust region radius over from the
+    // previous solve, start afresh instead.
+    pp->minimizer_options.trust_region_strategy =
+        internal::TrustRegionStrategy::Create(
+            pp->trust_region_strategy_options);
+  }
+  return true;
+}
+
 #ifndef CERES_NO_CUDA
 bool IsCudaRequired(const Solver::Options& options) {
   if (options.linear_solver_type == DENSE_NORMAL_CHOLESKY ||
@@ -709,6 +946,293 @@ bool IsCudaRequired(const Solver::Options& options) {
 }
 #endif
 
+// Ranks the termination types from the best to the worst outcome.
+int TerminationTypeRank(TerminationType type) {
+  switch (type) {
+    case CONVERGENCE:
+      return 0;
+    case USER_SUCCESS:
+      return 1;
+    case NO_CONVERGENCE:
+      return 2;
+    case USER_FAILURE:
+      return 3;
+    case FAILURE:
+      return 4;
+  }
+  return 4;
+}
+
+// Iteration i of the merged summary combines iteration i of every
+// component, a component which has terminated contributes its last
+// iteration. Quantities which are local to a trust region or a line search,
+// i.e., relative_decrease, trust_region_radius, eta and step_size, do not
+// combine and are left at zero.
+void MergeIndependentComponentIterations(
+    const std::vector<Solver::Summary>& component_summaries,
+    std::vector<IterationSummary>* iterations) {
+  size_t num_iterations = 0;
+  for (const Solver::Summary& component_summary : component_summaries) {
+    num_iterations =
+        std::max(num_iterations, component_summary.iterations.size());
+  }
+
+  iterations->clear();
+  iterations->resize(num_iterations);
+  for (int i = 0; i < num_iterations; ++i) {
+    IterationSummary& merged = (*iterations)[i];
+    merged.iteration = i;
+    double squared_gradient_norm = 0.0;
+    double squared_step_norm = 0.0;
+    for (const Solver::Summary& component_summary : component_summaries) {
+      const std::vector<IterationSummary>& component_iterations =
+          component_summary.iterations;
+      if (component_iterations.empty()) {
+        continue;
+      }
+
+      const bool is_active = i < component_iterations.size();
+      const IterationSummary& iteration =
+          component_iterations[is_active ? i : component_iterations.size() - 1];
+      merged.cost += iteration.cost;
+      merged.gradient_max_norm =
+          std::max(merged.gradient_max_norm, iteration.gradient_max_norm);
+      squared_gradient_norm +=
+          iteration.gradient_norm * iteration.gradient_norm;
+      // The components run concurrently, so their times overlap.
+      merged.cumulative_time_in_seconds = std::max(
+          merged.cumulative_time_in_seconds,
+          iteration.cumulative_time_in_seconds);
+      if (!is_active) {
+        continue;
+      }
+
+      merged.step_is_valid |= iteration.step_is_valid;
+      merged.step_is_nonmonotonic |= iteration.step_is_nonmonotonic;
+      merged.step_is_successful |= iteration.step_is_successful;
+      merged.cost_change += iteration.cost_change;
+      merged.line_search_function_evaluations +=
+          iteration.line_search_function_evaluations;
+      merged.line_search_gradient_evaluations +=
+          iteration.line_search_gradient_evaluations;
+      merged.line_search_iterations += iteration.line_search_iterations;
+      merged.linear_solver_iterations += iteration.linear_solver_iterations;
+      merged.iteration_time_in_seconds = std::max(
+          merged.iteration_time_in_seconds,
+          iteration.iteration_time_in_seconds);
+      merged.step_solver_time_in_seconds = std::max(
+          merged.step_solver_time_in_seconds,
+          iteration.step_solver_time_in_seconds);
+      squared_step_norm += iteration.step_norm * iteration.step_norm;
+    }
+    merged.gradient_norm = std::sqrt(squared_gradient_norm);
+    merged.step_norm = std::sqrt(squared_step_norm);
+  }
+}
+
+// Merges the summaries of the independently solved components into
+// summary, which has already been filled in by PreSolveSummarize for the
+// whole problem.
+void MergeIndependentComponentSummaries(
+    const std::vector<Solver::Summary>& component_summaries,
+    Solver::Summary* summary) {
+  const int num_components = component_summaries.size();
+  int worst_component = 0;
+  for (int i = 1; i < num_components; ++i) {
+    if (TerminationTypeRank(component_summaries[i].termination_type) >
+        TerminationTypeRank(
+            component_summaries[worst_component].termination_type)) {
+      worst_component = i;
+    }
+  }
+  summary->termination_type =
+      component_summaries[worst_component].termination_type;
+  summary->message =
+      absl::StrFormat("Independent component %d of %d: %s",
+                      worst_component + 1,
+                      num_components,
+                      component_summaries[worst_component].message);
+
+  // Options which the preprocessor may change are reported as used by the
+  // first component.
+  const Solver::Summary& first = component_summaries[0];
+  // clang-format off
+  summary->linear_solver_type_used     = first.linear_solver_type_used;
+  summary->preconditioner_type_used    = first.preconditioner_type_used;
+  summary->mixed_precision_solves_used = first.mixed_precision_solves_used;
+  summary->schur_structure_given       = first.schur_structure_given;
+  summary->schur_structure_used        = first.schur_structure_used;
+  // clang-format on
+
+  // The components are solved concurrently, so the time spent in a stage
+  // is the longest time any component spent in it. Counts add up. Times
+  // and counts which a component did not compute are -1, and are skipped,
+  // so that the merged value is -1 if no component computed it.
+  auto merge_time = [](double component_time, double* time) {
+    if (component_time >= 0.0) {
+      *time = std::max(*time, component_time);
+    }
+  };
+  auto merge_count = [](int component_count, int* count) {
+    if (component_count >= 0) {
+      *count = std::max(*count, 0) + component_count;
+    }
+  };
+
+  // Group sizes are added group by group, so that, e.g., the sizes of the
+  // Schur elimination groups of the components add up.
+  auto add_group_sizes = [](const std::vector<int>& group_sizes,
+                            std::vector<int>* sum) {
+    if (sum->size() < group_sizes.size()) {
+      sum->resize(group_sizes.size(), 0);
+    }
+    for (int i = 0; i < group_sizes.size(); ++i) {
+      (*sum)[i] += group_sizes[i];
+    }
+  };
+
+  using Summary = Solver::Summary;
+  static constexpr double Summary::*kTimes[] = {
+      &Summary::preprocessor_time_in_seconds,
+      &Summary::program_validation_time_in_seconds,
+      &Summary::program_reduction_time_in_seconds,
+      &Summary::program_reordering_time_in_seconds,
+      &Summary::evaluator_creation_time_in_seconds,
+      &Summary::minimizer_time_in_seconds,
+      &Summary::postprocessor_time_in_seconds,
+      &Summary::linear_solver_time_in_seconds,
+      &Summary::residual_evaluation_time_in_seconds,
+      &Summary::jacobian_evaluation_time_in_seconds,
+      &Summary::inner_iteration_time_in_seconds,
+      &Summary::line_search_cost_evaluation_time_in_seconds,
+      &Summary::line_search_gradient_evaluation_time_in_seconds,
+      &Summary::line_search_polynomial_minimization_time_in_seconds,
+      &Summary::line_search_total_time_in_seconds,
+  };
+  static constexpr int Summary::*kCounts[] = {
+      &Summary::num_successful_steps,
+      &Summary::num_unsuccessful_steps,
+      &Summary::num_inner_iteration_steps,
+      &Summary::num_line_search_steps,
+      &Summary::num_linear_solves,
+      &Summary::num_residual_evaluations,
+      &Summary::num_jacobian_evaluations,
+      &Summary::num_parameter_blocks_reduced,
+      &Summary::num_parameters_reduced,
+      &Summary::num_effective_parameters_reduced,
+      &Summary::num_residual_blocks_reduced,
+      &Summary::num_residuals_reduced,
+  };
+  for (double Summary::*time : kTimes) {
+    summary->*time = -1.0;
+  }
+  for (int Summary::*count : kCounts) {
+    summary->*count = -1;
+  }
+  summary->initial_cost = 0.0;
+  summary->final_cost = 0.0;
+  summary->fixed_cost = 0.0;
+  summary->linear_solver_ordering_used.clear();
+  summary->inner_iteration_ordering_used.clear();
+
+  for (const Summary& s : component_summaries) {
+    for (double Summary::*time : kTimes) {
+      merge_time(s.*time, &(summary->*time));
+    }
+    for (int Summary::*count : kCounts) {
+      merge_count(s.*count, &(summary->*count));
+    }
+
+    summary->initial_cost += s.initial_cost;
+    summary->final_cost += s.final_cost;
+    summary->fixed_cost += s.fixed_cost;
+    summary->is_constrained |= s.is_constrained;
+    summary->inner_iterations_used |= s.inner_iterations_used;
+    add_group_sizes(s.linear_solver_ordering_used,
+                    &summary->linear_solver_ordering_used);
+    add_group_sizes(s.inner_iteration_ordering_used,
+                    &summary->inner_iteration_ordering_used);
+  }
+
+  MergeIndependentComponentIterations(component_summaries,
+                                      &summary->iterations);
+}
+
+// Solves the connected components of the problem as independent problems,
+// concurrently on the thread pool of the context. Returns false without
+// touching summary if the problem should be solved as a whole.
+bool SolveIndependentComponents(const Solver::Options& options,
+                                internal::ProblemImpl* problem_impl,
+                                Solver::Summary* summary) {
+  const absl::Time start_time = absl::Now();
+  // Callbacks observe the state of the whole problem after every iteration
+  // and the gradient checker reports through a callback. An evaluation
+  // callback is told about every evaluation of the whole problem, and the
+  // CUDA state of the context can not be shared by concurrent solves.
+  if (!options.callbacks.empty() || options.check_gradients ||
+      problem_impl->options().evaluation_callback != nullptr) {
+    return false;
+  }
+#ifndef CERES_NO_CUDA
+  if (IsCudaRequired(options)) {
+    return false;
+  }
+#endif  // CERES_NO_CUDA
+
+  std::vector<int> residual_block_component;
+  const int num_components = internal::ComputeIndependentComponents(
+      problem_impl->mutable_program(), &residual_block_component);
+  if (num_components < 2) {
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Problem>> component_problems =
+      internal::CreateIndependentComponentProblems(
+          problem_impl, num_components, residual_block_component);
+
+  // The threads are divided evenly among the components which are solved
+  // concurrently.
+  const int num_concurrent_components =
+      std::min(options.num_threads, num_components);
+  Solver::Options component_options = options;
+  component_options.solve_independent_components = false;
+  component_options.num_threads =
+      std::max(1, options.num_threads / num_concurrent_components);
+  // The progress of concurrent components would be interleaved.
+  component_options.minimizer_progress_to_stdout = false;
+
+  internal::ContextImpl* context = problem_impl->context();
+  context->EnsureMinimumThreads(options.num_threads - 1);
+  const double component_creation_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - start_time);
+
+  std::vector<Solver::Summary> component_summaries(num_components);
+  internal::ParallelFor(
+      context, 0, num_components, num_concurrent_components, [&](int i) {
+        Solver::Options options_i = component_options;
+        if (options.linear_solver_ordering != nullptr) {
+          options_i.linear_solver_ordering =
+              internal::CreateIndependentComponentOrdering(
+                  *options.linear_solver_ordering, *component_problems[i]);
+        }
+        if (options.inner_iteration_ordering != nullptr) {
+          options_i.inner_iteration_ordering =
+              internal::CreateIndependentComponentOrdering(
+                  *options.inner_iteration_ordering, *component_problems[i]);
+        }
+        Solve(options_i, component_problems[i].get(), &component_summaries[i]);
+      });
+
+  MergeIndependentComponentSummaries(component_summaries, summary);
+  summary->num_independent_components = num_components;
+  summary->num_threads_used =
+      num_concurrent_components * component_options.num_threads;
+  summary->preprocessor_time_in_seconds =
+      std::max(summary->preprocessor_time_in_seconds, 0.0) +
+      component_creation_time_in_seconds;
+  return true;
+}
+
 }  // namespace
 
 bool Solver::Options::IsValid(std::string* error) const {
@@ -753,6 +1277,13 @@ void Solver::Solve(const Solver::Options& options,
   Program* program = problem_impl->mutable_program();
   PreSolveSummarize(options, problem_impl, summary);
 
+  if (options.solve_independent_components &&
+      SolveIndependentComponents(options, problem_impl, summary)) {
+    summary->total_time_in_seconds =
+        absl::ToDoubleSeconds(absl::Now() - start_time);
+    return;
+  }
+
 #ifndef CERES_NO_CUDA
   if (IsCudaRequired(options)) {
     if (!problem_impl->context()->InitCuda(&summary->message)) {
@@ -792,35 +1323,21 @@ void Solver::Solve(const Solver::Options& options,
   const bool status =
       preprocessor->Preprocess(modified_options, problem_impl, &pp);
 
-  // We check the linear_solver_options.type rather than
-  // modified_options.linear_solver_type because, depending on the
-  // lack of a Schur structure, the preprocessor may change the linear
-  // solver type.
-  if (status && IsSchurType(pp.linear_solver_options.type)) {
-    // TODO(sameeragarwal): We can likely eliminate the duplicate call
-    // to DetectStructure here and inside the linear solver, by
-    // calling this in the preprocessor.
-    int row_block_size;
-    int e_block_size;
-    int f_block_size;
-    DetectStructure(*static_cast<internal::BlockSparseMatrix*>(
-                         pp.minimizer_options.jacobian.get())
-                         ->block_structure(),
-                    pp.linear_solver_options.elimination_groups[0],
-                    &row_block_size,
-                    &e_block_size,
-                    &f_block_size);
-    summary->schur_structure_given =
-        SchurStructureToString(row_block_size, e_block_size, f_block_size);
-    internal::GetBestSchurTemplateSpecialization(
-        &row_block_size, &e_block_size, &f_block_size);
-    summary->schur_structure_used =
-        SchurStructureToString(row_block_size, e_block_size, f_block_size);
+  if (status) {
+    SummarizeSchurStructure(pp, summary);
   }
 
   summary->fixed_cost = pp.fixed_cost;
   summary->preprocessor_time_in_seconds =
       absl::ToDoubleSeconds(absl::Now() - start_time);
+  summary->program_validation_time_in_seconds =
+      pp.program_validation_time_in_seconds;
+  summary->program_reduction_time_in_seconds =
+      pp.program_reduction_time_in_seconds;
+  summary->program_reordering_time_in_seconds =
+      pp.program_reordering_time_in_seconds;
+  summary->evaluator_creation_time_in_seconds =
+      pp.evaluator_creation_time_in_seconds;
 
   if (status) {
     const absl::Time minimizer_start_time = absl::Now();
@@ -854,6 +1371,166 @@ void Solver::Solve(const Solver::Options& options,
       absl::ToDoubleSeconds(absl::Now() - start_time);
 }
 
+Solver::PreparedProblem::PreparedProblem() = default;
+
+Solver::PreparedProblem::~PreparedProblem() = default;
+
+bool Solver::PreparedProblem::IsValid() const {
+  return impl_ != nullptr &&
+         impl_->problem->mutable_impl()->structure_version() ==
+             impl_->structure_version;
+}
+
+bool Solver::Prepare(const Solver::Options& options,
+                     Problem* problem,
+                     Solver::PreparedProblem* prepared_problem,
+                     std::string* message) {
+  using internal::PreparedProblemImpl;
+  using internal::Preprocessor;
+  using internal::ProblemImpl;
+  using internal::Program;
+
+  CHECK(problem != nullptr);
+  CHECK(prepared_problem != nullptr);
+  CHECK(message != nullptr);
+
+  prepared_problem->impl_.reset();
+  if (!options.IsValid(message)) {
+    return false;
+  }
+
+  if (options.check_gradients) {
+    *message = "Gradient checking is not supported for prepared problems.";
+    return false;
+  }
+
+  ProblemImpl* problem_impl = problem->mutable_impl();
+  Program* program = problem_impl->mutable_program();
+
+#ifndef CERES_NO_CUDA
+  if (IsCudaRequired(options)) {
+    if (!problem_impl->context()->InitCuda(message)) {
+      return false;
+    }
+  }
+#endif  // CERES_NO_CUDA
+
+  program->SetParameterBlockStatePtrsToUserStatePtrs();
+
+  // The main thread also does work so we only need to launch num_threads - 1.
+  problem_impl->context()->EnsureMinimumThreads(options.num_threads - 1);
+
+  auto prepared = std::make_unique<PreparedProblemImpl>();
+  prepared->problem = problem;
+  prepared->structure_version = problem_impl->structure_version();
+  prepared->options = options;
+
+  // Find the residual blocks which the preprocessor removes from the program
+  // because all of their parameter blocks are constant.
+  int max_scratch_doubles_needed = 0;
+  for (auto* residual_block : program->residual_blocks()) {
+    const int num_parameter_blocks = residual_block->NumParameterBlocks();
+    bool all_constant = true;
+    for (int i = 0; i < num_parameter_blocks && all_constant; ++i) {
+      all_constant = residual_block->parameter_blocks()[i]->IsConstant();
+    }
+    if (all_constant) {
+      prepared->fixed_residual_blocks.push_back(residual_block);
+      max_scratch_doubles_needed =
+          std::max(max_scratch_doubles_needed,
+                   residual_block->NumScratchDoublesForEvaluate());
+    }
+  }
+  prepared->fixed_residual_block_scratch.resize(max_scratch_doubles_needed);
+
+  auto preprocessor = Preprocessor::Create(options.minimizer_type);
+  const bool status =
+      preprocessor->Preprocess(options, problem_impl, &prepared->pp);
+
+  // Restore the numbering of the parameter blocks of the problem.
+  program->SetParameterBlockStatePtrsToUserStatePtrs();
+  program->SetParameterOffsetsAndIndex();
+
+  if (!status) {
+    *message = prepared->pp.error;
+    return false;
+  }
+
+  Solver::Summary summary;
+  SummarizeSchurStructure(prepared->pp, &summary);
+  prepared->schur_structure_given = summary.schur_structure_given;
+  prepared->schur_structure_used = summary.schur_structure_used;
+
+  prepared_problem->impl_ = std::move(prepared);
+  return true;
+}
+
+void Solver::Solve(Solver::PreparedProblem* prepared_problem,
+                   Solver::Summary* summary) {
+  using internal::PreprocessedProblem;
+  using internal::ProblemImpl;
+  using internal::Program;
+
+  CHECK(prepared_problem != nullptr);
+  CHECK(summary != nullptr);
+
+  const absl::Time start_time = absl::Now();
+  *summary = Summary();
+  if (prepared_problem->impl_ == nullptr) {
+    summary->message = "The problem has not been prepared.";
+    LOG(ERROR) << "Terminating: " << summary->message;
+    return;
+  }
+
+  if (!prepared_problem->IsValid()) {
+    summary->message =
+        "The structure of the problem has changed since it was prepared. "
+        "It must be prepared again.";
+    LOG(ERROR) << "Terminating: " << summary->message;
+    return;
+  }
+
+  internal::PreparedProblemImpl* prepared = prepared_problem->impl_.get();
+  PreprocessedProblem& pp = prepared->pp;
+  ProblemImpl* problem_impl = prepared->problem->mutable_impl();
+  Program* program = problem_impl->mutable_program();
+  PreSolveSummarize(prepared->options, problem_impl, summary);
+
+  // Make sure that all the parameter blocks states are set to the
+  // values provided by the user.
+  program->SetParameterBlockStatePtrsToUserStatePtrs();
+
+  const bool status = UpdatePreparedProblem(prepared);
+  summary->schur_structure_given = prepared->schur_structure_given;
+  summary->schur_structure_used = prepared->schur_structure_used;
+  summary->fixed_cost = pp.fixed_cost;
+  summary->preprocessor_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - start_time);
+
+  Solver::Summary statistics_before_solve;
+  SummarizeStatistics(pp, &statistics_before_solve);
+
+  if (status) {
+    const absl::Time minimizer_start_time = absl::Now();
+    Minimize(&pp, summary);
+    summary->minimizer_time_in_seconds =
+        absl::ToDoubleSeconds(absl::Now() - minimizer_start_time);
+  } else {
+    summary->message = pp.error;
+  }
+
+  const absl::Time postprocessor_start_time = absl::Now();
+  program->SetParameterBlockStatePtrsToUserStatePtrs();
+  program->SetParameterOffsetsAndIndex();
+  PostSolveSummarize(pp, summary);
+  SubtractStatistics(statistics_before_solve, summary);
+  summary->postprocessor_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - postprocessor_start_time);
+
+  summary->total_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - start_time);
+}
+
 void Solve(const Solver::Options& options,
            Problem* problem,
            Solver::Summary* summary) {
@@ -861,6 +1538,20 @@ void Solve(const Solver::Options& options,
   solver.Solve(options, problem, summary);
 }
 
+bool Prepare(const Solver::Options& options,
+             Problem* problem,
+             Solver::PreparedProblem* prepared_problem,
+             std::string* message) {
+  Solver solver;
+  return solver.Prepare(options, problem, prepared_problem, message);
+}
+
+void Solve(Solver::PreparedProblem* prepared_problem,
+           Solver::Summary* summary) {
+  Solver solver;
+  solver.Solve(prepared_problem, summary);
+}
+
 std::string Solver::Summary::BriefReport() const {
   return absl::StrFormat(
       "Ceres Solver Report: "
@@ -904,6 +1595,11 @@ std::string Solver::Summary::FullReport() const {
                         "Residuals           % 25d% 25d\n",
                         num_residuals,
                         num_residuals_reduced);
+  if (num_independent_components > 1) {
+    absl::StrAppendFormat(&report,
+                          "Independent components% 48d\n",
+                          num_independent_components);
+  }
 
   if (minimizer_type == TRUST_REGION) {
     // TRUST_SEARCH HEADER
@@ -1103,6 +1799,26 @@ std::string Solver::Summary::FullReport() const {
   absl::StrAppendFormat(&report, "\nTime (in seconds):\n");
   absl::StrAppendFormat(
       &report, "Preprocessor        %25.6f\n", preprocessor_time_in_seconds);
+  if (program_validation_time_in_seconds >= 0.0) {
+    absl::StrAppendFormat(&report,
+                          "  Validation          %23.6f\n",
+                          program_validation_time_in_seconds);
+  }
+  if (program_reduction_time_in_seconds >= 0.0) {
+    absl::StrAppendFormat(&report,
+                          "  Reduction           %23.6f\n",
+                          program_reduction_time_in_seconds);
+  }
+  if (program_reordering_time_in_seconds >= 0.0) {
+    absl::StrAppendFormat(&report,
+                          "  Reordering          %23.6f\n",
+                          program_reordering_time_in_seconds);
+  }
+  if (evaluator_creation_time_in_seconds >= 0.0) {
+    absl::StrAppendFormat(&report,
+                          "  Evaluator creation  %23.6f\n",
+                          evaluator_creation_time_in_seconds);
+  }
 
   absl::StrAppendFormat(&report,
                         "\n  Residual only evaluation %18.6f (%d)\n",
@@ -375,6 +375,229 @@ TEST(Solver, ZeroSizedManifoldHoldsParameterBlockConstant) {
   EXPECT_EQ(y, 1.0);
 }
 
+TEST(Solver, ReportsPreprocessorStageTimes) {
+  double x = 0.0;
+  double y = 1.0;
+  Problem problem;
+  problem.AddResidualBlock(LinearCostFunction::Create(), nullptr, &x, &y);
+
+  Solver::Options options;
+  options.linear_solver_type = DENSE_QR;
+  options.num_threads = 2;
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_EQ(summary.termination_type, CONVERGENCE);
+  EXPECT_GE(summary.program_validation_time_in_seconds, 0.0);
+  EXPECT_GE(summary.program_reduction_time_in_seconds, 0.0);
+  EXPECT_GE(summary.program_reordering_time_in_seconds, 0.0);
+  EXPECT_GE(summary.evaluator_creation_time_in_seconds, 0.0);
+  EXPECT_LE(summary.program_validation_time_in_seconds +
+                summary.program_reduction_time_in_seconds +
+                summary.program_reordering_time_in_seconds +
+                summary.evaluator_creation_time_in_seconds,
+            summary.preprocessor_time_in_seconds);
+
+  options.minimizer_type = LINE_SEARCH;
+  Solve(options, &problem, &summary);
+  EXPECT_GE(summary.program_validation_time_in_seconds, 0.0);
+  EXPECT_GE(summary.program_reduction_time_in_seconds, 0.0);
+  EXPECT_EQ(summary.program_reordering_time_in_seconds, -1.0);
+  EXPECT_GE(summary.evaluator_creation_time_in_seconds, 0.0);
+}
+
+TEST(Solver, SolvesIndependentComponents) {
+  // Four components, two of which share the constant parameter block c,
+  // and one residual block which only depends on c.
+  double x[4] = {0.0, 1.0, 2.0, 3.0};
+  double c = 1.0;
+  Problem problem;
+  for (double& x_i : x) {
+    problem.AddResidualBlock(QuadraticCostFunctor::Create(), nullptr, &x_i);
+  }
+  problem.AddResidualBlock(LinearCostFunction::Create(), nullptr, &x[0], &c);
+  problem.AddResidualBlock(LinearCostFunction::Create(), nullptr, &x[1], &c);
+  problem.AddResidualBlock(QuadraticCostFunctor::Create(), nullptr, &c);
+  problem.SetParameterBlockConstant(&c);
+
+  Solver::Options options;
+  options.linear_solver_type = DENSE_QR;
+  options.num_threads = 4;
+  options.function_tolerance = 0.0;
+  options.gradient_tolerance = 0.0;
+  options.parameter_tolerance = 0.0;
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_EQ(summary.num_independent_components, 1);
+  const double initial_cost = summary.initial_cost;
+  const double final_cost = summary.final_cost;
+  const double fixed_cost = summary.fixed_cost;
+
+  x[0] = 0.0;
+  x[1] = 1.0;
+  x[2] = 2.0;
+  x[3] = 3.0;
+  options.solve_independent_components = true;
+  Solve(options, &problem, &summary);
+  EXPECT_EQ(summary.termination_type, CONVERGENCE);
+  EXPECT_EQ(summary.num_independent_components, 4);
+  EXPECT_EQ(summary.num_parameter_blocks, 5);
+  EXPECT_EQ(summary.num_parameter_blocks_reduced, 4);
+  EXPECT_EQ(summary.num_residual_blocks_reduced, 6);
+  EXPECT_NEAR(summary.initial_cost, initial_cost, 1e-12);
+  EXPECT_NEAR(summary.final_cost, final_cost, 1e-6);
+  EXPECT_NEAR(summary.fixed_cost, fixed_cost, 1e-12);
+  ASSERT_FALSE(summary.iterations.empty());
+  EXPECT_NEAR(summary.iterations.front().cost, summary.initial_cost, 1e-12);
+  EXPECT_NEAR(summary.iterations.back().cost, summary.final_cost, 1e-12);
+  EXPECT_NEAR(x[0], 7.5, 1e-7);
+  EXPECT_NEAR(x[1], 7.5, 1e-7);
+  EXPECT_NEAR(x[2], 5.0, 1e-7);
+  EXPECT_NEAR(x[3], 5.0, 1e-7);
+  EXPECT_EQ(c, 1.0);
+
+  // The components are solved concurrently, so no stage takes longer than
+  // the whole solve.
+  for (const double time : {summary.preprocessor_time_in_seconds,
+                            summary.minimizer_time_in_seconds,
+                            summary.postprocessor_time_in_seconds,
+                            summary.linear_solver_time_in_seconds,
+                            summary.residual_evaluation_time_in_seconds,
+                            summary.jacobian_evaluation_time_in_seconds}) {
+    EXPECT_GE(time, 0.0);
+    EXPECT_LE(time, summary.total_time_in_seconds);
+  }
+  EXPECT_LE(summary.iterations.back().cumulative_time_in_seconds,
+            summary.total_time_in_seconds);
+
+  // Times which no component computed are not computed for the whole
+  // problem either.
+  options.minimizer_type = LINE_SEARCH;
+  Solve(options, &problem, &summary);
+  EXPECT_EQ(summary.num_independent_components, 4);
+  EXPECT_EQ(summary.program_reordering_time_in_seconds, -1.0);
+  EXPECT_GE(summary.num_line_search_steps, 0);
+}
+
+TEST(Solver, SolvesProblemWithCallbacksAsAWhole) {
+  double x[2] = {0.0, 1.0};
+  Problem problem;
+  problem.AddResidualBlock(QuadraticCostFunctor::Create(), nullptr, &x[0]);
+  problem.AddResidualBlock(QuadraticCostFunctor::Create(), nullptr, &x[1]);
+
+  RememberingCallback callback(&x[0]);
+  Solver::Options options;
+  options.linear_solver_type = DENSE_QR;
+  options.solve_independent_components = true;
+  options.callbacks.push_back(&callback);
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_EQ(summary.termination_type, CONVERGENCE);
+  EXPECT_EQ(summary.num_independent_components, 1);
+  EXPECT_FALSE(callback.x_values.empty());
+  EXPECT_NEAR(x[0], 5.0, 1e-7);
+  EXPECT_NEAR(x[1], 5.0, 1e-7);
+}
+
+TEST(Solver, PreparedProblemSolvesWithNewParameterValues) {
+  double x = 0.0;
+  double y = 1.0;
+  double z = 3.0;
+  Problem problem;
+  problem.AddResidualBlock(LinearCostFunction::Create(), nullptr, &x, &y);
+  problem.AddResidualBlock(QuadraticCostFunctor::Create(), nullptr, &z);
+  problem.SetParameterBlockConstant(&z);
+
+  Solver::Options options;
+  options.linear_solver_type = DENSE_QR;
+  Solver::PreparedProblem prepared_problem;
+  std::string message;
+  ASSERT_TRUE(Prepare(options, &problem, &prepared_problem, &message))
+      << message;
+  EXPECT_TRUE(prepared_problem.IsValid());
+
+  Solver::Summary summary;
+  Solve(&prepared_problem, &summary);
+  EXPECT_EQ(summary.termination_type, CONVERGENCE);
+  EXPECT_NEAR(x, 10.0, 1e-7);
+  EXPECT_NEAR(y, 5.0, 1e-7);
+  EXPECT_EQ(z, 3.0);
+  EXPECT_EQ(summary.fixed_cost, 2.0);
+  const int num_jacobian_evaluations = summary.num_jacobian_evaluations;
+  EXPECT_GT(num_jacobian_evaluations, 0);
+
+  // Change the values of all the parameter blocks, including the constant
+  // one, and solve again.
+  x = -4.0;
+  y = 7.0;
+  z = 1.0;
+  problem.SetParameterBlockConstant(&z);
+  EXPECT_TRUE(prepared_problem.IsValid());
+  Solve(&prepared_problem, &summary);
+  EXPECT_EQ(summary.termination_type, CONVERGENCE);
+  EXPECT_NEAR(x, 10.0, 1e-7);
+  EXPECT_NEAR(y, 5.0, 1e-7);
+  EXPECT_EQ(z, 1.0);
+  EXPECT_EQ(summary.fixed_cost, 8.0);
+  EXPECT_EQ(summary.initial_cost, 8.0 + 0.5 * (14.0 * 14.0 + 2.0 * 2.0));
+  // The statistics only cover the latest solve.
+  EXPECT_EQ(summary.num_jacobian_evaluations, num_jacobian_evaluations);
+
+  // The result matches solving the problem from scratch.
+  x = -4.0;
+  y = 7.0;
+  Solver::Summary expected_summary;
+  Solve(options, &problem, &expected_summary);
+  EXPECT_EQ(summary.initial_cost, expected_summary.initial_cost);
+  EXPECT_EQ(summary.final_cost, expected_summary.final_cost);
+  EXPECT_EQ(summary.iterations.size(), expected_summary.iterations.size());
+}
+
+TEST(Solver, PreparedProblemIsInvalidatedByStructuralChanges) {
+  double x = 0.0;
+  double y = 1.0;
+  Problem problem;
+  problem.AddResidualBlock(LinearCostFunction::Create(), nullptr, &x, &y);
+
+  Solver::Options options;
+  Solver::PreparedProblem prepared_problem;
+  std::string message;
+  ASSERT_TRUE(Prepare(options, &problem, &prepared_problem, &message))
+      << message;
+
+  // Bounds do not change the structure of the problem.
+  problem.SetParameterUpperBound(&x, 0, 8.0);
+  EXPECT_TRUE(prepared_problem.IsValid());
+  Solver::Summary summary;
+  Solve(&prepared_problem, &summary);
+  EXPECT_TRUE(summary.IsSolutionUsable());
+  EXPECT_NEAR(x, 8.0, 1e-7);
+
+  problem.SetParameterBlockConstant(&y);
+  EXPECT_FALSE(prepared_problem.IsValid());
+  x = 0.0;
+  Solve(&prepared_problem, &summary);
+  EXPECT_EQ(summary.termination_type, FAILURE);
+  EXPECT_EQ(x, 0.0);
+
+  ASSERT_TRUE(Prepare(options, &problem, &prepared_problem, &message))
+      << message;
+  EXPECT_TRUE(prepared_problem.IsValid());
+  problem.AddResidualBlock(QuadraticCostFunctor::Create(), nullptr, &x);
+  EXPECT_FALSE(prepared_problem.IsValid());
+}
+
+TEST(Solver, PreparedProblemDoesNotSupportGradientChecking) {
+  double x = 0.0;
+  Problem problem;
+  problem.AddResidualBlock(QuadraticCostFunctor::Create(), nullptr, &x);
+  Solver::Options options;
+  options.check_gradients = true;
+  Solver::PreparedProblem prepared_problem;
+  std::string message;
+  EXPECT_FALSE(Prepare(options, &problem, &prepared_problem, &message));
+  EXPECT_FALSE(prepared_problem.IsValid());
+}
+
 TEST(Solver, DenseNormalCholeskyOptions) {
   std::string message;
   Solver::Options options;
@@ -861,7 +1084,7 @@ TEST(Solver, CgnrOptionsIdentityPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = EIGEN_SPARSE;
   options.dynamic_sparsity = false;
@@ -874,7 +1097,7 @@ TEST(Solver, CgnrOptionsIdentityPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = SUITE_SPARSE;
   options.dynamic_sparsity = false;
@@ -887,7 +1110,7 @@ TEST(Solver, CgnrOptionsIdentityPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = ACCELERATE_SPARSE;
   options.dynamic_sparsity = false;
@@ -900,7 +1123,7 @@ TEST(Solver, CgnrOptionsIdentityPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = CUDA_SPARSE;
   options.dynamic_sparsity = false;
@@ -934,7 +1157,7 @@ TEST(Solver, CgnrOptionsJacobiPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = EIGEN_SPARSE;
 
@@ -948,7 +1171,7 @@ TEST(Solver, CgnrOptionsJacobiPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = SUITE_SPARSE;
 
@@ -962,7 +1185,7 @@ TEST(Solver, CgnrOptionsJacobiPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = ACCELERATE_SPARSE;
 
@@ -976,7 +1199,7 @@ TEST(Solver, CgnrOptionsJacobiPreconditioner) {
 
   options.dynamic_sparsity = false;
   options.use_mixed_precision_solves = true;
-  EXPECT_FALSE(options.IsValid(&message));
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.sparse_linear_algebra_library_type = CUDA_SPARSE;
 
@@ -1030,7 +1253,7 @@ TEST(Solver, CgnrOptionsSubsetPreconditioner) {
 
     options.dynamic_sparsity = false;
     options.use_mixed_precision_solves = true;
-    EXPECT_FALSE(options.IsValid(&message));
+    EXPECT_TRUE(options.IsValid(&message));
   }
 
   options.sparse_linear_algebra_library_type = SUITE_SPARSE;
@@ -1046,7 +1269,11 @@ TEST(Solver, CgnrOptionsSubsetPreconditioner) {
 
     options.dynamic_sparsity = false;
     options.use_mixed_precision_solves = true;
+#ifdef CERES_NO_CHOLMOD_FLOAT
     EXPECT_FALSE(options.IsValid(&message));
+#else
+    EXPECT_TRUE(options.IsValid(&message));
+#endif
   }
 
   options.sparse_linear_algebra_library_type = ACCELERATE_SPARSE;
@@ -1062,7 +1289,7 @@ TEST(Solver, CgnrOptionsSubsetPreconditioner) {
 
     options.dynamic_sparsity = false;
     options.use_mixed_precision_solves = true;
-    EXPECT_FALSE(options.IsValid(&message));
+    EXPECT_TRUE(options.IsValid(&message));
   }
 
   options.sparse_linear_algebra_library_type = CUDA_SPARSE;
@@ -1079,6 +1306,25 @@ TEST(Solver, CgnrOptionsSubsetPreconditioner) {
   EXPECT_FALSE(options.IsValid(&message));
 }
 
+TEST(Solver, CgnrOptionsIncompleteCholeskyPreconditioner) {
+  std::string message;
+  Solver::Options options;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = INCOMPLETE_CHOLESKY;
+
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.use_mixed_precision_solves = true;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.use_mixed_precision_solves = false;
+  options.dynamic_sparsity = true;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.dynamic_sparsity = false;
+
+  options.sparse_linear_algebra_library_type = CUDA_SPARSE;
+  EXPECT_FALSE(options.IsValid(&message));
+}
+
 TEST(Solver, CgnrOptionsSchurPreconditioners) {
   std::string message;
   Solver::Options options;
@@ -1091,6 +1337,239 @@ TEST(Solver, CgnrOptionsSchurPreconditioners) {
   EXPECT_FALSE(options.IsValid(&message));
 }
 
+TEST(Solver, SinglePrecisionJacobianOptions) {
+  std::string message;
+  Solver::Options options;
+  options.use_single_precision_jacobian = true;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = JACOBI;
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.sparse_linear_algebra_library_type = CUDA_SPARSE;
+  EXPECT_FALSE(options.IsValid(&message));
+
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  options.linear_solver_type = DENSE_QR;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.linear_solver_type = ITERATIVE_SCHUR;
+  options.preconditioner_type = SCHUR_JACOBI;
+  EXPECT_FALSE(options.IsValid(&message));
+
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = IDENTITY;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.preconditioner_type = SUBSET;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.preconditioner_type = JACOBI;
+  options.use_mixed_precision_solves = true;
+  EXPECT_FALSE(options.IsValid(&message));
+}
+
+TEST(Solver, CgnrWithSinglePrecisionJacobian) {
+  double x = 1.0;
+  double y = 2.0;
+  double z = 3.0;
+  double w = 4.0;
+  Problem problem;
+  problem.AddResidualBlock(Quadratic4DCostFunction::Create(),
+                           nullptr,
+                           &x,
+                           &y,
+                           &z,
+                           &w);
+
+  Solver::Options options;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = JACOBI;
+  options.use_single_precision_jacobian = true;
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_TRUE(summary.IsSolutionUsable()) << summary.FullReport();
+  EXPECT_NEAR(summary.final_cost, 0.0, 1e-12);
+}
+
+TEST(Solver, CgnrWithMixedPrecisionSolves) {
+  double x = 1.0;
+  double y = 2.0;
+  double z = 3.0;
+  double w = 4.0;
+  Problem problem;
+  problem.AddResidualBlock(Quadratic4DCostFunction::Create(),
+                           nullptr,
+                           &x,
+                           &y,
+                           &z,
+                           &w);
+
+  Solver::Options options;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = JACOBI;
+  options.use_mixed_precision_solves = true;
+  options.max_num_cg_refinement_iterations = 2;
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_TRUE(summary.IsSolutionUsable()) << summary.FullReport();
+  EXPECT_NEAR(summary.final_cost, 0.0, 1e-12);
+}
+
+TEST(Solver, IterativeSchurOptionsMixedPrecision) {
+  std::string message;
+  Solver::Options options;
+  options.linear_solver_type = ITERATIVE_SCHUR;
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  options.use_mixed_precision_solves = true;
+  options.preconditioner_type = IDENTITY;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.preconditioner_type = JACOBI;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.preconditioner_type = SCHUR_JACOBI;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.use_explicit_schur_complement = true;
+  EXPECT_FALSE(options.IsValid(&message));
+}
+
+TEST(Solver, PipelinedConjugateGradientsOptions) {
+  std::string message;
+  Solver::Options options;
+  options.use_pipelined_conjugate_gradients = true;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = JACOBI;
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.use_mixed_precision_solves = true;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.use_mixed_precision_solves = false;
+  options.sparse_linear_algebra_library_type = CUDA_SPARSE;
+  EXPECT_FALSE(options.IsValid(&message));
+
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  options.linear_solver_type = ITERATIVE_SCHUR;
+  options.preconditioner_type = SCHUR_JACOBI;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.use_explicit_schur_complement = true;
+  EXPECT_FALSE(options.IsValid(&message));
+
+  options.use_explicit_schur_complement = false;
+  options.linear_solver_type = DENSE_QR;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.linear_solver_type = SPARSE_NORMAL_CHOLESKY;
+  EXPECT_FALSE(options.IsValid(&message));
+}
+
+TEST(Solver, CgnrWithPipelinedConjugateGradients) {
+  double x = 1.0;
+  double y = 2.0;
+  double z = 3.0;
+  double w = 4.0;
+  Problem problem;
+  problem.AddResidualBlock(Quadratic4DCostFunction::Create(),
+                           nullptr,
+                           &x,
+                           &y,
+                           &z,
+                           &w);
+
+  Solver::Options options;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = JACOBI;
+  options.use_pipelined_conjugate_gradients = true;
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_TRUE(summary.IsSolutionUsable()) << summary.FullReport();
+  EXPECT_NEAR(summary.final_cost, 0.0, 1e-12);
+}
+
+TEST(Solver, DeflatedConjugateGradientsOptions) {
+  std::string message;
+  Solver::Options options;
+  options.num_deflation_vectors = -1;
+  EXPECT_FALSE(options.IsValid(&message));
+
+  options.num_deflation_vectors = 4;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = JACOBI;
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.use_mixed_precision_solves = true;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.use_mixed_precision_solves = false;
+  options.use_pipelined_conjugate_gradients = true;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.use_pipelined_conjugate_gradients = false;
+  options.sparse_linear_algebra_library_type = CUDA_SPARSE;
+  EXPECT_FALSE(options.IsValid(&message));
+
+  options.sparse_linear_algebra_library_type = NO_SPARSE;
+  options.linear_solver_type = ITERATIVE_SCHUR;
+  options.preconditioner_type = SCHUR_JACOBI;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.use_explicit_schur_complement = true;
+  EXPECT_FALSE(options.IsValid(&message));
+
+  options.use_explicit_schur_complement = false;
+  options.linear_solver_type = DENSE_QR;
+  EXPECT_FALSE(options.IsValid(&message));
+}
+
+TEST(Solver, CgnrWithDeflatedConjugateGradients) {
+  double x = 1.0;
+  double y = 2.0;
+  double z = 3.0;
+  double w = 4.0;
+  Problem problem;
+  problem.AddResidualBlock(Quadratic4DCostFunction::Create(),
+                           nullptr,
+                           &x,
+                           &y,
+                           &z,
+                           &w);
+
+  Solver::Options options;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = JACOBI;
+  options.num_deflation_vectors = 1;
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_TRUE(summary.IsSolutionUsable()) << summary.FullReport();
+  EXPECT_NEAR(summary.final_cost, 0.0, 1e-12);
+}
+
+TEST(Solver, CgnrWithIncompleteCholeskyPreconditioner) {
+  double x = 1.0;
+  double y = 2.0;
+  double z = 3.0;
+  double w = 4.0;
+  Problem problem;
+  problem.AddResidualBlock(Quadratic4DCostFunction::Create(),
+                           nullptr,
+                           &x,
+                           &y,
+                           &z,
+                           &w);
+
+  Solver::Options options;
+  options.linear_solver_type = CGNR;
+  options.preconditioner_type = INCOMPLETE_CHOLESKY;
+  Solver::Summary summary;
+  Solve(options, &problem, &summary);
+  EXPECT_TRUE(summary.IsSolutionUsable()) << summary.FullReport();
+  EXPECT_NEAR(summary.final_cost, 0.0, 1e-12);
+}
+
+TEST(Solver, PreconditionerReuseOptions) {
+  std::string message;
+  Solver::Options options;
+  options.linear_solver_type = ITERATIVE_SCHUR;
+  options.preconditioner_type = SCHUR_JACOBI;
+  options.max_num_preconditioner_reuses = 3;
+  EXPECT_TRUE(options.IsValid(&message));
+  options.max_num_preconditioner_reuses = -1;
+  EXPECT_FALSE(options.IsValid(&message));
+  options.max_num_preconditioner_reuses = 3;
+  options.preconditioner_refresh_iteration_ratio = 0.5;
+  EXPECT_FALSE(options.IsValid(&message));
+}
+
 TEST(Solver, IterativeSchurOptionsNoSparse) {
   std::string message;
   Solver::Options options;
@@ -1108,6 +1587,8 @@ TEST(Solver, IterativeSchurOptionsNoSparse) {
   EXPECT_FALSE(options.IsValid(&message));
   options.preconditioner_type = SUBSET;
   EXPECT_FALSE(options.IsValid(&message));
+  options.preconditioner_type = INCOMPLETE_CHOLESKY;
+  EXPECT_TRUE(options.IsValid(&message));
 
   options.use_explicit_schur_complement = true;
   options.preconditioner_type = IDENTITY;
@@ -1120,6 +1601,8 @@ TEST(Solver, IterativeSchurOptionsNoSparse) {
   EXPECT_FALSE(options.IsValid(&message));
   options.preconditioner_type = CLUSTER_TRIDIAGONAL;
   EXPECT_FALSE(options.IsValid(&message));
+  options.preconditioner_type = INCOMPLETE_CHOLESKY;
+  EXPECT_FALSE(options.IsValid(&message));
 }
 
 TEST(Solver, IterativeSchurOptionsEigenSparse) {
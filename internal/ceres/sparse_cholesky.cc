@@ -120,6 +120,16 @@ std::unique_ptr<SparseCholesky> SparseCholesky::Create(
 
 SparseCholesky::~SparseCholesky() = default;
 
+LinearSolverTerminationType SparseCholesky::UpdateFactorization(
+    const CompressedRowSparseMatrix& /* W */,
+    bool /* downdate */,
+    std::string* message) {
+  *message =
+      "Updating the factorization is not supported by this sparse linear "
+      "algebra library.";
+  return LinearSolverTerminationType::FATAL_ERROR;
+}
+
 LinearSolverTerminationType SparseCholesky::FactorAndSolve(
     CompressedRowSparseMatrix* lhs,
     const double* rhs,
@@ -102,6 +102,30 @@ class CERES_NO_EXPORT SparseCholesky {
                                             double* solution,
                                             std::string* message) = 0;
 
+  // Updates the numeric factorization computed by the last call to
+  // Factorize, so that it becomes the factorization of
+  //
+  //   lhs + W' * W, or lhs - W' * W if downdate is true,
+  //
+  // where W is an UNSYMMETRIC matrix with as many columns as
+  // lhs. The rows of W are typically the Jacobian rows of residual
+  // blocks added to or removed from a problem. The cost of the update
+  // is proportional to the number of entries of the factorization it
+  // modifies, rather than to the cost of refactorizing lhs.
+  //
+  // An update is only possible if it does not change the sparsity of
+  // the factorization, i.e., if every row of W only couples columns
+  // that are already coupled in the factorization. If this is not the
+  // case, or if the implementation does not support updates, FATAL_ERROR
+  // is returned and the factorization is left unchanged; the caller
+  // should form the modified lhs and factorize it from scratch using a
+  // new SparseCholesky object, as the symbolic factorization has to be
+  // recomputed. If a downdate results in a matrix that is not positive
+  // definite, FAILURE is returned and the factorization is no longer
+  // valid.
+  virtual LinearSolverTerminationType UpdateFactorization(
+      const CompressedRowSparseMatrix& W, bool downdate, std::string* message);
+
   // Convenience method which combines a call to Factorize and
   // Solve. Solve is only called if Factorize returns
   // LinearSolverTerminationType::SUCCESS.
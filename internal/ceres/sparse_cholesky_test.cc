@@ -50,6 +50,7 @@
 #include "ceres/internal/eigen.h"
 #include "ceres/iterative_refiner.h"
 #include "ceres/linear_solver.h"
+#include "ceres/triplet_sparse_matrix.h"
 #include "ceres/types.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -221,6 +222,130 @@ TEST_P(SparseCholeskyTest, FactorAndSolve) {
   }
 }
 
+TEST_P(SparseCholeskyTest, UpdateFactorization) {
+  constexpr int kNumBlocks = 8;
+  constexpr int kMinBlockSize = 1;
+  constexpr int kMaxBlockSize = 4;
+  constexpr double kBlockDensity = 0.3;
+
+  Param param = GetParam();
+  if (::testing::get<0>(param) != EIGEN_SPARSE) {
+    GTEST_SKIP() << "Factorization updates are only implemented for Eigen.";
+  }
+
+  LinearSolver::Options sparse_cholesky_options;
+  sparse_cholesky_options.sparse_linear_algebra_library_type =
+      ::testing::get<0>(param);
+  sparse_cholesky_options.use_mixed_precision_solves = ::testing::get<1>(param);
+  sparse_cholesky_options.ordering_type = ::testing::get<2>(param);
+  sparse_cholesky_options.max_num_refinement_iterations = 0;
+  const double kTolerance = (::testing::get<1>(param)
+                                 ? std::numeric_limits<float>::epsilon()
+                                 : std::numeric_limits<double>::epsilon()) *
+                            200;
+
+  // Factorizes J'J from scratch and solves J'J x = rhs.
+  const auto solve_from_scratch = [&](const BlockSparseMatrix& jacobian,
+                                      const Vector& rhs) {
+    auto sparse_cholesky = SparseCholesky::Create(sparse_cholesky_options);
+    auto inner_product_computer = InnerProductComputer::Create(
+        jacobian, sparse_cholesky->StorageType());
+    inner_product_computer->Compute();
+    CompressedRowSparseMatrix* lhs = inner_product_computer->mutable_result();
+    if (!::testing::get<3>(param)) {
+      lhs->mutable_row_blocks()->clear();
+      lhs->mutable_col_blocks()->clear();
+    }
+    Vector solution(lhs->num_rows());
+    std::string message;
+    EXPECT_EQ(sparse_cholesky->FactorAndSolve(
+                  lhs, rhs.data(), solution.data(), &message),
+              LinearSolverTerminationType::SUCCESS)
+        << message;
+    return solution;
+  };
+
+  std::mt19937 prng;
+  for (int trial = 0; trial < 10; ++trial) {
+    auto sparse_cholesky = SparseCholesky::Create(sparse_cholesky_options);
+    auto m = CreateRandomFullRankMatrix(
+        kNumBlocks, kMinBlockSize, kMaxBlockSize, kBlockDensity, prng);
+    auto inner_product_computer =
+        InnerProductComputer::Create(*m, sparse_cholesky->StorageType());
+    inner_product_computer->Compute();
+    CompressedRowSparseMatrix* lhs = inner_product_computer->mutable_result();
+    if (!::testing::get<3>(param)) {
+      lhs->mutable_row_blocks()->clear();
+      lhs->mutable_col_blocks()->clear();
+    }
+
+    // W has the sparsity of the Jacobian, so W' W does not change the
+    // sparsity of lhs.
+    BlockSparseMatrix w(new CompressedRowBlockStructure(*m->block_structure()));
+    VectorRef(w.mutable_values(), w.num_nonzeros()).setRandom();
+    auto W = w.ToCompressedRowSparseMatrix();
+
+    // [m; w] is the Jacobian whose normal equations are lhs + W' W.
+    BlockSparseMatrix m_and_w(
+        new CompressedRowBlockStructure(*m->block_structure()));
+    VectorRef(m_and_w.mutable_values(), m_and_w.num_nonzeros()) =
+        ConstVectorRef(m->values(), m->num_nonzeros());
+    m_and_w.AppendRows(w);
+
+    std::string message;
+    ASSERT_EQ(sparse_cholesky->Factorize(lhs, &message),
+              LinearSolverTerminationType::SUCCESS)
+        << message;
+
+    const Vector rhs = Vector::Random(lhs->num_rows());
+    Vector actual(lhs->num_rows());
+    ASSERT_EQ(sparse_cholesky->UpdateFactorization(*W, false, &message),
+              LinearSolverTerminationType::SUCCESS)
+        << message;
+    ASSERT_EQ(sparse_cholesky->Solve(rhs.data(), actual.data(), &message),
+              LinearSolverTerminationType::SUCCESS);
+    Vector expected = solve_from_scratch(m_and_w, rhs);
+    EXPECT_NEAR((actual - expected).norm() / expected.norm(), 0.0, kTolerance);
+
+    ASSERT_EQ(sparse_cholesky->UpdateFactorization(*W, true, &message),
+              LinearSolverTerminationType::SUCCESS)
+        << message;
+    ASSERT_EQ(sparse_cholesky->Solve(rhs.data(), actual.data(), &message),
+              LinearSolverTerminationType::SUCCESS);
+    expected = solve_from_scratch(*m, rhs);
+    EXPECT_NEAR((actual - expected).norm() / expected.norm(), 0.0, kTolerance);
+  }
+
+  // An update that couples two columns of a diagonal matrix would add a
+  // non-zero to its factorization and is rejected without modifying it.
+  auto sparse_cholesky = SparseCholesky::Create(sparse_cholesky_options);
+  const Vector diagonal = Vector::Constant(3, 2.0);
+  auto diagonal_lhs = CompressedRowSparseMatrix::FromTripletSparseMatrix(
+      *TripletSparseMatrix::CreateSparseDiagonalMatrix(diagonal.data(), 3));
+  diagonal_lhs->set_storage_type(sparse_cholesky->StorageType());
+  std::string message;
+  ASSERT_EQ(sparse_cholesky->Factorize(diagonal_lhs.get(), &message),
+            LinearSolverTerminationType::SUCCESS);
+
+  TripletSparseMatrix coupling(1, 3, 2);
+  coupling.mutable_rows()[0] = 0;
+  coupling.mutable_cols()[0] = 0;
+  coupling.mutable_values()[0] = 1.0;
+  coupling.mutable_rows()[1] = 0;
+  coupling.mutable_cols()[1] = 2;
+  coupling.mutable_values()[1] = 1.0;
+  coupling.set_num_nonzeros(2);
+  auto W = CompressedRowSparseMatrix::FromTripletSparseMatrix(coupling);
+  EXPECT_EQ(sparse_cholesky->UpdateFactorization(*W, false, &message),
+            LinearSolverTerminationType::FATAL_ERROR);
+
+  const Vector rhs = Vector::Ones(3);
+  Vector actual(3);
+  ASSERT_EQ(sparse_cholesky->Solve(rhs.data(), actual.data(), &message),
+            LinearSolverTerminationType::SUCCESS);
+  EXPECT_NEAR((actual - Vector::Constant(3, 0.5)).norm(), 0.0, kTolerance);
+}
+
 namespace {
 
 #ifndef CERES_NO_SUITESPARSE
@@ -93,7 +93,7 @@ LinearSolver::Summary SparseNormalCholeskySolver::SolveImpl(
     event_logger.AddEvent("InnerProductComputer::Create");
   }
 
-  inner_product_computer_->Compute();
+  inner_product_computer_->Compute(options_.context, options_.num_threads);
   event_logger.AddEvent("InnerProductComputer::Compute");
 
   if (per_solve_options.D != nullptr) {
@@ -94,7 +94,7 @@ bool SubsetPreconditioner::UpdateImpl(const BlockSparseMatrix& A,
   }
 
   // Compute inner_product = [Q'*Q + D'*D]
-  inner_product_computer_->Compute();
+  inner_product_computer_->Compute(options_.context, options_.num_threads);
 
   // Unappend D if needed.
   if (D != nullptr) {
@@ -40,6 +40,7 @@
 #include "absl/strings/str_format.h"
 #include "ceres/file.h"
 #include "ceres/internal/port.h"
+#include "ceres/preconditioner.h"
 #include "ceres/types.h"
 #include "gtest/gtest.h"
 
@@ -147,5 +148,17 @@ std::string ToString(const Solver::Options& options) {
       options.num_threads);
 }
 
+Matrix PreconditionerToDenseMatrix(const Preconditioner& preconditioner) {
+  const int num_rows = preconditioner.num_rows();
+  Matrix dense = Matrix::Zero(num_rows, num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    const Vector x = Vector::Unit(num_rows, i);
+    Vector y = Vector::Zero(num_rows);
+    preconditioner.RightMultiplyAndAccumulate(x.data(), y.data());
+    dense.col(i) = y;
+  }
+  return dense;
+}
+
 }  // namespace internal
 }  // namespace ceres
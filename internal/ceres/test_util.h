@@ -35,6 +35,7 @@
 
 #include "absl/log/check.h"
 #include "ceres/internal/disable_warnings.h"
+#include "ceres/internal/eigen.h"
 #include "ceres/internal/export.h"
 #include "ceres/problem.h"
 #include "ceres/solver.h"
@@ -43,6 +44,8 @@
 namespace ceres {
 namespace internal {
 
+class Preconditioner;
+
 // Expects that x and y have a relative difference of no more than
 // max_abs_relative_difference. If either x or y is zero, then the relative
 // difference is interpreted as an absolute difference.
@@ -77,6 +80,11 @@ CERES_NO_EXPORT std::string TestFileAbsolutePath(const std::string& filename);
 
 CERES_NO_EXPORT std::string ToString(const Solver::Options& options);
 
+// Returns the dense matrix corresponding to the linear operator that applies
+// the preconditioner, by applying it to the columns of the identity matrix.
+CERES_NO_EXPORT Matrix PreconditionerToDenseMatrix(
+    const Preconditioner& preconditioner);
+
 // A templated test fixture, that is used for testing Ceres end to end
 // by computing a solution to the problem for a given solver
 // configuration and comparing it to a reference solver configuration.
@@ -30,6 +30,7 @@
 
 #include "ceres/thread_pool.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -38,6 +39,15 @@
 namespace ceres::internal {
 namespace {
 
+// Number of unsuccessful attempts to find a task before an idle worker parks
+// itself. Spinning for a little while avoids the cost of parking and waking up
+// workers between the closely spaced parallel loops typical for Ceres.
+constexpr int kNumSpinIterations = 256;
+
+// The thread pool and the worker id of the calling thread, if it is a worker.
+thread_local const ThreadPool* current_thread_pool = nullptr;
+thread_local int current_worker_id = -1;
+
 // Constrain the total number of threads to the amount the hardware can support.
 int GetNumAllowedThreads(int requested_num_threads) {
   return std::min(requested_num_threads, ThreadPool::MaxNumThreadsAvailable());
@@ -53,6 +63,33 @@ int ThreadPool::MaxNumThreadsAvailable() {
                                    : num_hardware_threads;
 }
 
+void ThreadPool::TaskQueue::PushBack(Task task) {
+  if (size_ == buffer_.size()) {
+    // Grow the ring buffer, unrolling its content to the front of the new
+    // buffer. The capacity is always a power of two.
+    std::vector<Task> buffer(std::max<std::size_t>(16, 2 * buffer_.size()));
+    for (std::size_t i = 0; i < size_; ++i) {
+      buffer[i] = std::move(buffer_[(head_ + i) & (buffer_.size() - 1)]);
+    }
+    buffer_.swap(buffer);
+    head_ = 0;
+  }
+  buffer_[(head_ + size_) & (buffer_.size() - 1)] = std::move(task);
+  ++size_;
+}
+
+ThreadPool::Task ThreadPool::TaskQueue::PopBack() {
+  --size_;
+  return std::move(buffer_[(head_ + size_) & (buffer_.size() - 1)]);
+}
+
+ThreadPool::Task ThreadPool::TaskQueue::PopFront() {
+  Task task = std::move(buffer_[head_]);
+  head_ = (head_ + 1) & (buffer_.size() - 1);
+  --size_;
+  return task;
+}
+
 ThreadPool::ThreadPool() = default;
 
 ThreadPool::ThreadPool(int num_threads) { Resize(num_threads); }
@@ -77,14 +114,26 @@ void ThreadPool::Resize(int num_threads) {
 
   const int create_num_threads =
       GetNumAllowedThreads(num_threads) - num_current_threads;
+  if (create_num_threads <= 0) {
+    return;
+  }
 
+  // Publish the new workers before starting the threads, so that every worker
+  // can steal from all the others.
+  auto workers = std::make_unique<std::vector<Worker*>>();
   for (int i = 0; i < create_num_threads; ++i) {
-    thread_pool_.emplace_back(&ThreadPool::ThreadMainLoop, this);
+    worker_storage_.push_back(std::make_unique<Worker>());
   }
-}
+  for (const auto& worker : worker_storage_) {
+    workers->push_back(worker.get());
+  }
+  workers_.store(workers.get());
+  worker_lists_.push_back(std::move(workers));
 
-void ThreadPool::AddTask(const std::function<void()>& func) {
-  task_queue_.Push(func);
+  for (int i = 0; i < create_num_threads; ++i) {
+    thread_pool_.emplace_back(
+        &ThreadPool::ThreadMainLoop, this, num_current_threads + i);
+  }
 }
 
 int ThreadPool::Size() {
@@ -92,13 +141,106 @@ int ThreadPool::Size() {
   return thread_pool_.size();
 }
 
-void ThreadPool::ThreadMainLoop() {
-  std::function<void()> task;
-  while (task_queue_.Wait(&task)) {
-    task();
+void ThreadPool::Push(Task task) {
+  if (current_thread_pool == this) {
+    Worker* worker = (*workers_.load())[current_worker_id];
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->tasks.PushBack(std::move(task));
+  } else {
+    std::lock_guard<std::mutex> lock(injection_mutex_);
+    injection_queue_.PushBack(std::move(task));
+    ++injection_queue_size_;
   }
+
+  // A worker parks only after incrementing num_parked_workers_ and then
+  // finding num_pending_tasks_ to be zero, so either it sees this increment
+  // or this thread sees it as parked and wakes it up.
+  ++num_pending_tasks_;
+  if (num_parked_workers_.load() > 0) {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_condition_.notify_one();
+  }
+}
+
+bool ThreadPool::FindTask(int worker_id, Task* task) {
+  const std::vector<Worker*>& workers = *workers_.load();
+
+  // The most recently added task of the worker's own queue is the most likely
+  // to have its data in cache.
+  {
+    Worker* worker = workers[worker_id];
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    if (!worker->tasks.empty()) {
+      *task = worker->tasks.PopBack();
+      --num_pending_tasks_;
+      return true;
+    }
+  }
+
+  if (injection_queue_size_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(injection_mutex_);
+    if (!injection_queue_.empty()) {
+      *task = injection_queue_.PopFront();
+      --injection_queue_size_;
+      --num_pending_tasks_;
+      return true;
+    }
+  }
+
+  // Steal the oldest task of another worker, starting with the next one in
+  // order to spread the thieves over the victims.
+  const int num_workers = workers.size();
+  for (int i = 1; i < num_workers; ++i) {
+    Worker* victim = workers[(worker_id + i) % num_workers];
+    std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+    if (lock.owns_lock() && !victim->tasks.empty()) {
+      *task = victim->tasks.PopFront();
+      --num_pending_tasks_;
+      return true;
+    }
+  }
+  return false;
 }
 
-void ThreadPool::Stop() { task_queue_.StopWaiters(); }
+void ThreadPool::ThreadMainLoop(int worker_id) {
+  current_thread_pool = this;
+  current_worker_id = worker_id;
+
+  Task task;
+  int num_failed_attempts = 0;
+  while (true) {
+    if (FindTask(worker_id, &task)) {
+      task();
+      task = Task();
+      num_failed_attempts = 0;
+      continue;
+    }
+
+    if (num_pending_tasks_.load() > 0 ||
+        ++num_failed_attempts < kNumSpinIterations) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    if (stop_ && num_pending_tasks_.load() <= 0) {
+      break;
+    }
+    ++num_parked_workers_;
+    park_condition_.wait(
+        lock, [this]() { return stop_ || num_pending_tasks_.load() > 0; });
+    --num_parked_workers_;
+    num_failed_attempts = 0;
+  }
+
+  current_thread_pool = nullptr;
+  current_worker_id = -1;
+}
+
+void ThreadPool::Stop() {
+  std::lock_guard<std::mutex> lock(park_mutex_);
+  stop_ = true;
+  park_condition_.notify_all();
+}
 
 }  // namespace ceres::internal
@@ -31,17 +31,22 @@
 #ifndef CERES_INTERNAL_THREAD_POOL_H_
 #define CERES_INTERNAL_THREAD_POOL_H_
 
-#include <functional>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-#include "ceres/concurrent_queue.h"
 #include "ceres/internal/export.h"
 
 namespace ceres::internal {
 
-// A thread-safe thread pool with an unbounded task queue and a resizable number
+// A thread-safe thread pool with unbounded task queues and a resizable number
 // of workers.  The size of the thread pool can be increased but never decreased
 // in order to support the largest number of threads requested.  The ThreadPool
 // has three states:
@@ -57,8 +62,108 @@ namespace ceres::internal {
 //  workers to stop.  The workers will finish all of the tasks that have already
 //  been added to the thread pool.
 //
+// Scheduling is done by work stealing. Every worker owns a task queue guarded
+// by its own mutex. Tasks added by a worker, e.g., by the nested tasks
+// scheduled by ParallelFor, go to the back of the queue of that worker, and
+// tasks added by other threads go to a shared injection queue. An idle worker
+// first takes the most recently added task from its own queue, then the oldest
+// task from the injection queue, and finally steals the oldest task from the
+// queues of the other workers. A worker which does not find any work spins for
+// a short while before it parks itself on a condition variable. As a result,
+// threads only contend for a lock when they operate on the same queue.
+//
+// Tasks are stored in a small buffer inside the task queues, so adding a task
+// whose callable fits into Task::kInlineSize bytes does not allocate memory.
 class CERES_NO_EXPORT ThreadPool {
  public:
+  // A move-only type-erased void() callable with inline storage for
+  // callables up to kInlineSize bytes. Larger callables are stored on the
+  // heap.
+  class Task {
+   public:
+    static constexpr std::size_t kInlineSize = 64;
+
+    Task() = default;
+
+    template <typename F,
+              typename = std::enable_if_t<
+                  !std::is_same_v<std::decay_t<F>, Task>>>
+    explicit Task(F&& function) {
+      using Function = std::decay_t<F>;
+      if constexpr (sizeof(Function) <= kInlineSize &&
+                    alignof(Function) <= alignof(std::max_align_t) &&
+                    std::is_nothrow_move_constructible_v<Function>) {
+        new (storage_) Function(std::forward<F>(function));
+        invoke_ = [](void* storage) {
+          (*std::launder(reinterpret_cast<Function*>(storage)))();
+        };
+        manage_ = [](void* source, void* destination) {
+          auto* function = std::launder(reinterpret_cast<Function*>(source));
+          if (destination != nullptr) {
+            new (destination) Function(std::move(*function));
+          }
+          function->~Function();
+        };
+      } else {
+        new (storage_) Function*(new Function(std::forward<F>(function)));
+        invoke_ = [](void* storage) {
+          (**std::launder(reinterpret_cast<Function**>(storage)))();
+        };
+        manage_ = [](void* source, void* destination) {
+          auto* function = std::launder(reinterpret_cast<Function**>(source));
+          if (destination != nullptr) {
+            new (destination) Function*(*function);
+          } else {
+            delete *function;
+          }
+        };
+      }
+    }
+
+    Task(Task&& other) noexcept { MoveFrom(other); }
+
+    Task& operator=(Task&& other) noexcept {
+      if (this != &other) {
+        Reset();
+        MoveFrom(other);
+      }
+      return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { Reset(); }
+
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+    void operator()() { invoke_(storage_); }
+
+   private:
+    void MoveFrom(Task& other) {
+      if (other.invoke_ == nullptr) {
+        return;
+      }
+      other.manage_(other.storage_, storage_);
+      invoke_ = std::exchange(other.invoke_, nullptr);
+      manage_ = std::exchange(other.manage_, nullptr);
+    }
+
+    void Reset() {
+      if (invoke_ != nullptr) {
+        manage_(storage_, nullptr);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+      }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    void (*invoke_)(void* storage) = nullptr;
+    // Move constructs the callable stored in source into destination, if
+    // destination is not nullptr, and destroys the one stored in source.
+    void (*manage_)(void* source, void* destination) = nullptr;
+  };
+
   // Returns the maximum number of hardware threads.
   static int MaxNumThreadsAvailable();
 
@@ -88,28 +193,80 @@ class CERES_NO_EXPORT ThreadPool {
   // complete upon return.
   void Resize(int num_threads);
 
-  // Adds a task to the queue and wakes up a blocked thread.  If the thread pool
-  // size is greater than zero, then the task will be executed by a currently
-  // idle thread or when a thread becomes available.  If the thread pool has no
-  // threads, then the task will never be executed and the user should use
-  // Resize() to create a non-empty thread pool.
-  void AddTask(const std::function<void()>& func);
+  // Adds a task to the thread pool and wakes up a parked worker.  If the
+  // thread pool size is greater than zero, then the task will be executed by a
+  // currently idle worker or when a worker becomes available.  If the thread
+  // pool has no threads, then the task will never be executed and the user
+  // should use Resize() to create a non-empty thread pool.
+  template <typename F>
+  void AddTask(F&& function) {
+    Push(Task(std::forward<F>(function)));
+  }
 
   // Returns the current size of the thread pool.
   int Size();
 
  private:
-  // Main loop for the threads which blocks on the task queue until work becomes
-  // available.  It will return if and only if Stop has been called.
-  void ThreadMainLoop();
+  // A double ended queue of tasks backed by a ring buffer which only grows, so
+  // that a queue which has reached its working size never allocates.
+  class TaskQueue {
+   public:
+    bool empty() const { return size_ == 0; }
+    void PushBack(Task task);
+    Task PopBack();
+    Task PopFront();
+
+   private:
+    std::vector<Task> buffer_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+  };
+
+  // A task queue with its own lock. Workers are padded to separate cache
+  // lines to avoid false sharing between the locks of different workers.
+  struct alignas(64) Worker {
+    std::mutex mutex;
+    TaskQueue tasks;
+  };
+
+  // Enqueues the task and wakes up a parked worker if there is one.
+  void Push(Task task);
+
+  // Tries to take a task from the queue of worker, the injection queue or
+  // the queues of the other workers, in this order.
+  bool FindTask(int worker_id, Task* task);
+
+  // Main loop for the threads, which runs tasks until the thread pool is
+  // stopped and no tasks are left.
+  void ThreadMainLoop(int worker_id);
 
   // Signal all the threads to stop.  It does not block until the threads are
   // finished.
   void Stop();
 
-  // The queue that stores the units of work available for the thread pool.  The
-  // task queue maintains its own thread safety.
-  ConcurrentQueue<std::function<void()>> task_queue_;
+  // The workers. The vector is published through workers_ and is never
+  // modified once published; Resize publishes a new vector, and the old ones
+  // are kept alive until the thread pool is destroyed, since other workers
+  // might still be stealing through them.
+  std::atomic<const std::vector<Worker*>*> workers_{nullptr};
+  std::vector<std::unique_ptr<Worker>> worker_storage_;
+  std::vector<std::unique_ptr<const std::vector<Worker*>>> worker_lists_;
+
+  // Tasks added by threads which are not workers of this thread pool.
+  std::mutex injection_mutex_;
+  TaskQueue injection_queue_;
+  std::atomic<int> injection_queue_size_{0};
+
+  // Number of tasks which have been added and not yet taken by a worker.
+  std::atomic<int> num_pending_tasks_{0};
+
+  // Parked workers wait on park_condition_ until there are pending tasks or
+  // the thread pool is stopped.
+  std::mutex park_mutex_;
+  std::condition_variable park_condition_;
+  std::atomic<int> num_parked_workers_{0};
+  std::atomic<bool> stop_{false};
+
   std::vector<std::thread> thread_pool_;
   std::mutex thread_pool_mutex_;
 };
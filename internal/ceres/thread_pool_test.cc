@@ -30,6 +30,8 @@
 
 #include "ceres/thread_pool.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
@@ -166,6 +168,64 @@ TEST(ThreadPool, Destructor) {
   EXPECT_EQ(100, value);
 }
 
+// Adds tasks from within the tasks running on the workers, which are scheduled
+// on the queues of the workers and stolen by the other workers.
+TEST(ThreadPool, AddTaskFromWorker) {
+  const int num_tasks = 100;
+  const int num_nested_tasks = 10;
+  std::atomic<int> value = 0;
+  {
+    ThreadPool thread_pool(/*num_threads=*/4);
+
+    std::condition_variable condition;
+    std::mutex mutex;
+    auto increment = [&]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++value;
+      condition.notify_all();
+    };
+
+    for (int i = 0; i < num_tasks; ++i) {
+      thread_pool.AddTask([&]() {
+        for (int j = 0; j < num_nested_tasks; ++j) {
+          thread_pool.AddTask(increment);
+        }
+        increment();
+      });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() {
+      return value == num_tasks * (num_nested_tasks + 1);
+    });
+  }
+
+  EXPECT_EQ(num_tasks * (num_nested_tasks + 1), value);
+}
+
+// Tasks with callables which do not fit into the inline storage of
+// ThreadPool::Task are stored on the heap.
+TEST(ThreadPool, AddLargeTask) {
+  std::array<int, 64> values;
+  values.fill(1);
+  static_assert(sizeof(values) > ThreadPool::Task::kInlineSize);
+
+  std::atomic<int> sum = 0;
+  {
+    ThreadPool thread_pool(/*num_threads=*/2);
+    for (int i = 0; i < 10; ++i) {
+      thread_pool.AddTask([values, &sum]() {
+        for (int value : values) {
+          sum += value;
+        }
+      });
+    }
+    // The destructor waits for all of the tasks to finish.
+  }
+
+  EXPECT_EQ(10 * 64, sum);
+}
+
 TEST(ThreadPool, Resize) {
   // Ensure the hardware supports more than 1 thread to ensure the test will
   // pass.
@@ -37,6 +37,8 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ceres/callbacks.h"
 #include "ceres/context_impl.h"
 #include "ceres/evaluator.h"
@@ -71,8 +73,12 @@ std::shared_ptr<ParameterBlockOrdering> CreateDefaultLinearSolverOrdering(
 
 // Check if all the user supplied values in the parameter blocks are
 // sane or not, and if the program is feasible or not.
-bool IsProgramValid(const Program& program, std::string* error) {
-  return (program.ParameterBlocksAreFinite(error) && program.IsFeasible(error));
+bool IsProgramValid(const Program& program,
+                    ContextImpl* context,
+                    int num_threads,
+                    std::string* error) {
+  return (program.ParameterBlocksAreFinite(context, num_threads, error) &&
+          program.IsFeasible(context, num_threads, error));
 }
 
 void AlternateLinearSolverAndPreconditionerForSchurTypeLinearSolver(
@@ -118,6 +124,8 @@ bool ReorderProgram(PreprocessedProblem* pp) {
         options.sparse_linear_algebra_library_type,
         options.linear_solver_ordering_type,
         pp->problem->parameter_map(),
+        pp->problem->context(),
+        options.num_threads,
         options.linear_solver_ordering.get(),
         pp->reduced_program.get(),
         &pp->error);
@@ -130,6 +138,8 @@ bool ReorderProgram(PreprocessedProblem* pp) {
         options.linear_solver_ordering_type,
         *options.linear_solver_ordering,
         0, /* use all the rows of the jacobian */
+        pp->problem->context(),
+        options.num_threads,
         pp->reduced_program.get(),
         &pp->error);
   }
@@ -146,6 +156,8 @@ bool ReorderProgram(PreprocessedProblem* pp) {
         options.linear_solver_ordering_type,
         *options.linear_solver_ordering,
         pp->linear_solver_options.subset_preconditioner_start_row_block,
+        pp->problem->context(),
+        options.num_threads,
         pp->reduced_program.get(),
         &pp->error);
   }
@@ -191,7 +203,11 @@ bool SetupLinearSolver(PreprocessedProblem* pp) {
 
   // Reorder the program to reduce fill in and improve cache coherency
   // of the Jacobian.
-  if (!ReorderProgram(pp)) {
+  const absl::Time reordering_start_time = absl::Now();
+  const bool reordered = ReorderProgram(pp);
+  pp->program_reordering_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - reordering_start_time);
+  if (!reordered) {
     return false;
   }
 
@@ -221,6 +237,18 @@ bool SetupLinearSolver(PreprocessedProblem* pp) {
       options.use_mixed_precision_solves;
   pp->linear_solver_options.max_num_refinement_iterations =
       options.max_num_refinement_iterations;
+  pp->linear_solver_options.max_num_cg_refinement_iterations =
+      options.max_num_cg_refinement_iterations;
+  pp->linear_solver_options.use_single_precision_jacobian =
+      options.use_single_precision_jacobian;
+  pp->linear_solver_options.use_pipelined_conjugate_gradients =
+      options.use_pipelined_conjugate_gradients;
+  pp->linear_solver_options.num_deflation_vectors =
+      options.num_deflation_vectors;
+  pp->linear_solver_options.max_num_preconditioner_reuses =
+      options.max_num_preconditioner_reuses;
+  pp->linear_solver_options.preconditioner_refresh_iteration_ratio =
+      options.preconditioner_refresh_iteration_ratio;
   pp->linear_solver_options.num_threads = options.num_threads;
   pp->linear_solver_options.context = pp->problem->context();
 
@@ -276,11 +304,16 @@ bool SetupEvaluator(PreprocessedProblem* pp) {
 
   pp->evaluator_options.num_threads = options.num_threads;
   pp->evaluator_options.dynamic_sparsity = options.dynamic_sparsity;
+  pp->evaluator_options.use_single_precision_jacobian =
+      options.use_single_precision_jacobian;
   pp->evaluator_options.context = pp->problem->context();
   pp->evaluator_options.evaluation_callback =
       pp->reduced_program->mutable_evaluation_callback();
+  const absl::Time evaluator_creation_start_time = absl::Now();
   pp->evaluator = Evaluator::Create(
       pp->evaluator_options, pp->reduced_program.get(), &pp->error);
+  pp->evaluator_creation_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - evaluator_creation_start_time);
 
   return (pp->evaluator != nullptr);
 }
@@ -327,7 +360,8 @@ bool SetupInnerIterationMinimizer(PreprocessedProblem* pp) {
   } else {
     // The user did not supply an ordering, so create one.
     options.inner_iteration_ordering =
-        CoordinateDescentMinimizer::CreateOrdering(*pp->reduced_program);
+        CoordinateDescentMinimizer::CreateOrdering(
+            *pp->reduced_program, pp->problem->context(), options.num_threads);
   }
 
   pp->inner_iteration_minimizer =
@@ -366,6 +400,7 @@ bool SetupMinimizerOptions(PreprocessedProblem* pp) {
   strategy_options.dogleg_type = options.dogleg_type;
   strategy_options.context = pp->problem->context();
   strategy_options.num_threads = options.num_threads;
+  pp->trust_region_strategy_options = strategy_options;
   pp->minimizer_options.trust_region_strategy =
       TrustRegionStrategy::Create(strategy_options);
   CHECK(pp->minimizer_options.trust_region_strategy != nullptr);
@@ -383,12 +418,27 @@ bool TrustRegionPreprocessor::Preprocess(const Solver::Options& options,
 
   pp->problem = problem;
   Program* program = problem->mutable_program();
-  if (!IsProgramValid(*program, &pp->error)) {
+  ContextImpl* context = problem->context();
+  const int num_threads = pp->options.num_threads;
+
+  const absl::Time validation_start_time = absl::Now();
+  const bool is_valid =
+      IsProgramValid(*program, context, num_threads, &pp->error);
+  pp->program_validation_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - validation_start_time);
+  if (!is_valid) {
     return false;
   }
 
-  pp->reduced_program = program->CreateReducedProgram(
-      &pp->removed_parameter_blocks, &pp->fixed_cost, &pp->error);
+  const absl::Time reduction_start_time = absl::Now();
+  pp->reduced_program =
+      program->CreateReducedProgram(context,
+                                    num_threads,
+                                    &pp->removed_parameter_blocks,
+                                    &pp->fixed_cost,
+                                    &pp->error);
+  pp->program_reduction_time_in_seconds =
+      absl::ToDoubleSeconds(absl::Now() - reduction_start_time);
 
   if (pp->reduced_program.get() == nullptr) {
     return false;
@@ -83,6 +83,7 @@ const char* PreconditionerTypeToString(PreconditionerType type) {
     CASESTR(CLUSTER_JACOBI);
     CASESTR(CLUSTER_TRIDIAGONAL);
     CASESTR(SUBSET);
+    CASESTR(INCOMPLETE_CHOLESKY);
     default:
       return "UNKNOWN";
   }
@@ -97,6 +98,7 @@ bool StringToPreconditionerType(std::string value, PreconditionerType* type) {
   STRENUM(CLUSTER_JACOBI);
   STRENUM(CLUSTER_TRIDIAGONAL);
   STRENUM(SUBSET);
+  STRENUM(INCOMPLETE_CHOLESKY);
   return false;
 }
 